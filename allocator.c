@@ -0,0 +1,143 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "allocator.h"
+
+/* Subsystem of a block which has been allocated before the accounting has been enabled */
+#define MEMORY_UNTRACKED (-1)
+
+/* Header in front of every block, the union keeps the block aligned for any type */
+typedef union BlockHeader {
+    struct {
+        size_t size;       /* The number of bytes of the block. */
+        int subsystem;     /* The subsystem of the block, or MEMORY_UNTRACKED. */
+    } block;
+    long double alignment;
+    void *pointer;
+} BlockHeader;
+
+/* Accounting of the memory of a subsystem */
+typedef struct MemoryAccount {
+    unsigned long allocations;   /* The number of blocks which have been allocated. */
+    unsigned long bytes;         /* The number of bytes which have been allocated. */
+    unsigned long inUse;         /* The number of bytes in use. */
+    unsigned long peak;          /* The largest number of bytes which have been in use at once. */
+    unsigned long blocksInUse;   /* The number of blocks in use. */
+} MemoryAccount;
+
+static const char *subsystemNames[MEMORY_NUM_OF_SUBSYSTEMS] = {"symbols", "extern uses", "macros", "encoding",
+                                                               "objects", "tools", "diagnostics", "trace", "io",
+                                                               "optimizer"};
+static MemoryAccount accounts[MEMORY_NUM_OF_SUBSYSTEMS];
+static MemoryAccount totalAccount;
+static int accountingFlag = 0;
+static pthread_mutex_t accountingMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Record a block which is taken into use */
+static void recordAllocation(int subsystem, size_t size) {
+    MemoryAccount *account = &accounts[subsystem];
+
+    pthread_mutex_lock(&accountingMutex);
+    account->allocations++;
+    account->bytes += size;
+    account->inUse += size;
+    account->blocksInUse++;
+    if (account->inUse > account->peak)
+        account->peak = account->inUse;
+
+    totalAccount.allocations++;
+    totalAccount.bytes += size;
+    totalAccount.inUse += size;
+    totalAccount.blocksInUse++;
+    if (totalAccount.inUse > totalAccount.peak)
+        totalAccount.peak = totalAccount.inUse;
+    pthread_mutex_unlock(&accountingMutex);
+}
+
+/* Record a block which is out of use */
+static void recordRelease(int subsystem, size_t size) {
+    pthread_mutex_lock(&accountingMutex);
+    accounts[subsystem].inUse -= size;
+    accounts[subsystem].blocksInUse--;
+    totalAccount.inUse -= size;
+    totalAccount.blocksInUse--;
+    pthread_mutex_unlock(&accountingMutex);
+}
+
+void *allocateMemory(int subsystem, size_t size) {
+    BlockHeader *header = (BlockHeader *) malloc(sizeof(BlockHeader) + size);
+
+    if (header == NULL)
+        return NULL;
+
+    header->block.size = size;
+    header->block.subsystem = accountingFlag ? subsystem : MEMORY_UNTRACKED;
+    if (accountingFlag)
+        recordAllocation(subsystem, size);
+    return header + 1;
+}
+
+void *allocateZeroedMemory(int subsystem, size_t count, size_t size) {
+    void *block = allocateMemory(subsystem, count * size);
+
+    if (block != NULL)
+        memset(block, 0, count * size);
+    return block;
+}
+
+void *reallocateMemory(int subsystem, void *block, size_t size) {
+    BlockHeader *header;
+    size_t oldSize;
+
+    if (block == NULL)
+        return allocateMemory(subsystem, size);
+
+    header = (BlockHeader *) block - 1;
+    oldSize = header->block.size;
+    header = (BlockHeader *) realloc(header, sizeof(BlockHeader) + size);
+    if (header == NULL)
+        return NULL;
+
+    /* A reallocation is recorded as the release of the old block and the allocation of the new one */
+    header->block.size = size;
+    if (header->block.subsystem != MEMORY_UNTRACKED) {
+        recordRelease(header->block.subsystem, oldSize);
+        recordAllocation(header->block.subsystem, size);
+    }
+    return header + 1;
+}
+
+void freeMemory(void *block) {
+    BlockHeader *header;
+
+    if (block == NULL)
+        return;
+
+    header = (BlockHeader *) block - 1;
+    if (header->block.subsystem != MEMORY_UNTRACKED)
+        recordRelease(header->block.subsystem, header->block.size);
+    free(header);
+}
+
+void enableMemoryAccounting() {
+    accountingFlag = 1;
+}
+
+/* Write a row of the report */
+static void reportAccount(FILE *file, const char *name, const MemoryAccount *account) {
+    fprintf(file, "  %-12s %12lu %14lu %12lu %10lu %12lu\n", name, account->allocations, account->bytes,
+            account->peak, account->blocksInUse, account->inUse);
+}
+
+void reportMemory(FILE *file) {
+    int i = 0;
+
+    fprintf(file, "Memory report:\n");
+    fprintf(file, "  %-12s %12s %14s %12s %10s %12s\n", "subsystem", "allocations", "bytes", "peak bytes",
+            "live", "live bytes");
+    for (; i < MEMORY_NUM_OF_SUBSYSTEMS; ++i)
+        reportAccount(file, subsystemNames[i], &accounts[i]);
+    reportAccount(file, "total", &totalAccount);
+}
@@ -0,0 +1,83 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+/**
+ * @file allocator.h
+ * @brief Functions to allocate memory, with an accounting of the memory used by every subsystem.
+ *
+ * Every block is allocated with a small header in front of it, which holds it's size and the subsystem it has
+ * been allocated for, so a block is freed/reallocated without telling it's subsystem again. Once the accounting
+ * is enabled, the number of allocations, the bytes allocated, the peak of the bytes in use and the blocks which
+ * are still in use are recorded for every subsystem. Blocks which have been allocated before the accounting has
+ * been enabled aren't recorded. The accounting is synchronized, so memory can be allocated from several threads
+ * at once, but it should be enabled before the threads start.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * The subsystems memory is allocated for.
+ */
+#define MEMORY_SYMBOLS 0        /* The symbol table. */
+#define MEMORY_EXTERN_USES 1    /* The table of extern uses. */
+#define MEMORY_MACROS 2         /* The macro table and the output of the pre-assembler. */
+#define MEMORY_ENCODING 3       /* The code/data images and relocation tables. */
+#define MEMORY_OBJECTS 4        /* Object files and archives, in memory and encoded. */
+#define MEMORY_TOOLS 5          /* Tables of the linker, archiver, disassembler and simulator. */
+#define MEMORY_DIAGNOSTICS 6    /* The errors which have been found in a source. */
+#define MEMORY_TRACE 7          /* The timeline of the --trace option. */
+#define MEMORY_IO 8             /* The contents of the files which are read/written in batches. */
+#define MEMORY_OPTIMIZER 9      /* The lines of the program which is optimized. */
+#define MEMORY_NUM_OF_SUBSYSTEMS 10
+
+/**
+ * @brief Allocates a block of memory.
+ *
+ * @param subsystem The subsystem the block is allocated for.
+ * @param size The number of bytes of the block.
+ * @return The block, or NULL if memory allocation has been failed.
+ */
+void *allocateMemory(int subsystem, size_t size);
+
+/**
+ * @brief Allocates a block of memory for an array, with every byte set to zero.
+ *
+ * @param subsystem The subsystem the block is allocated for.
+ * @param count The number of elements.
+ * @param size The number of bytes of an element.
+ * @return The block, or NULL if memory allocation has been failed.
+ */
+void *allocateZeroedMemory(int subsystem, size_t count, size_t size);
+
+/**
+ * @brief Changes the size of a block of memory, keeping it's contents.
+ *
+ * @param subsystem The subsystem a new block is allocated for (a block which already exists keeps it's subsystem).
+ * @param block The block, or NULL to allocate a new block.
+ * @param size The new number of bytes of the block.
+ * @return The block, or NULL if memory allocation has been failed (the block is left as it is).
+ */
+void *reallocateMemory(int subsystem, void *block, size_t size);
+
+/**
+ * @brief Frees a block of memory.
+ *
+ * @param block The block, which has been allocated by this allocator, or NULL.
+ */
+void freeMemory(void *block);
+
+/**
+ * @brief Starts recording the allocations of every subsystem.
+ */
+void enableMemoryAccounting();
+
+/**
+ * @brief Writes the allocations, the bytes allocated, the peak of the bytes in use and the blocks still in use
+ * of every subsystem.
+ *
+ * @param file The file to write into.
+ */
+void reportMemory(FILE *file);
+
+#endif
@@ -1,206 +1,213 @@
-#include <stdio.h>
-#include <string.h>
-#include "data.h"
-#include "symbols.h"
-#include "machinecode.h"
-#include "utilities.h"
-#include "analyze.h"
-#include "instructions.h"
-
-int address = INITIAL_ADDRESS_VALUE;
-int lineNum = 0;
-int directFlag = 0;
-int endFirstPassFlag = 0;
-int errorFlag = 0;
-
-void processLabelDeclaration(const char *fileName, char *line) {
-    char copiedLine[MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
-    strcpy(copiedLine, line); /* Make a copy of the original line */
-    char *token = strtok(line, " \t\n");
-
-    /* Add the label to the symbol table with the current address */
-    char *label = token;
-    label[strlen(label) - 1] = '\0'; /* Remove the ':' character from the label */
-
-    /* Add symbol to the symbol table if not exist yet, otherwise update it's address */
-    if (!isSymbolExist(label) && !endFirstPassFlag)
-        addToSymbolTable(fileName, label, address, 0, 0);
-    else {
-        /* Update the symbol's value if it's value is casual, a value that is 0 */
-        if(getSymbolValue(label) == 0)
-            updateSymbolTable(label, address);
-        else        /* The symbol is already exist and it's value isn't casual, meaning it's value unequal to 0 */
-            if(!endFirstPassFlag) {     /* Skip second pass, meaning still processing first pass */
-                reportError(fileName, 19, copiedLine);   /* Report an error for a duplicated symbol */
-                return;
-            }
-    }
-
-    token = strtok(NULL, " \t\n"); /* Move to the next part of the line */
-
-    /* Check for directive/instruction */
-    if (token != NULL) {
-        if (strcmp(token, ".data") == 0 || strcmp(token, ".string") == 0 ||
-            strcmp(token, ".entry") == 0 || strcmp(token, ".extern") == 0)
-            processDirective(fileName, token, copiedLine);
-        else
-            processInstruction(fileName, token, copiedLine);
-    } else /* Missing Operands - No operands have been found */
-        reportError(fileName, 2, copiedLine);
-}
-
-void processInstruction(const char *fileName, char *line, const char *orgLine) {
-    char *token;
-    char *opCode;
-    char copiedLine [MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
-    strcpy(copiedLine, line); /* Make a copy of the line */
-
-    /* Tokenizing according to the last source whom has been tokenized */
-    tokenizeArguments(line, &opCode, &token);
-
-    /* Remove new line/carriage return character from the instruction name */
-    opCode[strcspn(opCode, "\r\n")] = '\0';
-
-    /* Check existence of opCode in the instruction table */
-    if (isInstructionExist(opCode)) {
-        /* Tokenize the line to extract the opCode and operands */
-        char *operand1;
-        char *operand2;
-        char *operand3;
-        int addressingMethod1, addressingMethod2;
-        int expectedOperands = getInstructionNumOfOperands(opCode);
-        operand1 = token;
-        token = strtok(NULL, " ,\t\n");
-        operand2 = token;
-
-        /* Getting addressing method for each operand */
-        addressingMethod1 = getAddressingMethod(operand1);
-        addressingMethod2 = getAddressingMethod(operand2);
-        token = strtok(NULL, " ,\t\n");
-        operand3 = token;
-
-        /* Report error if addressing method isn't valid*/
-        if (!isValidAddressingMethod(opCode, addressingMethod2, addressingMethod1)) {
-            reportError(fileName, 3, orgLine);
-            return;
-        }
-
-        /* Report error if num of operands of instruction is larger/lower than expected operands of current instruction */
-        if (checkNumOfOperands(operand1, operand2, operand3) > expectedOperands) {
-            reportError(fileName, 1, orgLine);
-            return;
-        } else if (checkNumOfOperands(operand1, operand2, operand3) < expectedOperands) {
-            reportError(fileName, 2, orgLine);
-            return;
-        }
-
-        /* Generating the code machine according to the num of expected operands of current instruction */
-        switch (expectedOperands) {
-            case 0:
-                processInstructionWith0Operands(fileName, copiedLine, opCode);
-                break;
-            case 1:
-                processInstructionWith1Operands(fileName, copiedLine, opCode, operand1, addressingMethod1);
-                break;
-            case 2:
-                processInstructionWith2Operands(fileName, copiedLine, opCode, operand1, addressingMethod1, addressingMethod2, operand2);
-                break;
-        }
-    } else /* Instruction isn't exist in the instruction table */
-        reportError(fileName, 7, orgLine);
-}
-
-void processDirective(const char *fileName, char *line, char *orgLine) {
-    char copiedLine [MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
-    strcpy(copiedLine, line); /* Make a copy of the original line */
-
-    /* Tokenizing parameters according the last source of line */
-    char *directive;
-    char *arguments;
-    tokenizeArguments(line, &directive, &arguments);
-
-    /*  Missing operands */
-    if (arguments == NULL)
-        reportError(fileName, 2, copiedLine);
-
-    /* ".data" directive */
-    if (strcmp(directive, ".data") == 0) {
-        processDataDirective(fileName, copiedLine, arguments);
-        /* If processing directive through label declaration, send copiedLine as a parameter to checkCommas,
-         otherwise send orgLine as a parameter */
-        if(directFlag)
-            checkCommas(fileName, copiedLine);
-        else
-            checkCommas(fileName, orgLine);
-    } else if (strcmp(directive, ".string") == 0) {         /* ".string" directive */
-        processStringDirective(fileName, copiedLine, arguments);
-    } else if (strcmp(directive, ".entry") == 0) {         /* ".entry" directive */
-        processEntryDirective(fileName, copiedLine, arguments);
-    } else if (strcmp(directive, ".extern") == 0) { /* ".extern" directive */
-        processExternDirective(fileName, copiedLine, arguments);
-    } else /* Invalid directive */
-        reportError(fileName, 8, copiedLine);
-}
-
-void firstPass(FILE *file, const char *fileName) {
-    address = INITIAL_ADDRESS_VALUE; /* Initializing address to it's initial value */
-    char line[MAX_LINE_LENGTH]; /* Line to process */
-    char copiedLine[MAX_LINE_LENGTH]; /* The copy of the line being processed */
-    char orgLine[MAX_LINE_LENGTH]; /* The original line being processed  */
-
-    while (fgets(line, sizeof(line), file)) {
-        /* Remove newline/carriage return character from the end of the line */
-        line[strcspn(line, "\r\n")] = '\0';
-
-        /* Avoid double increment for line value. Increment line value only if first pass isn't finished yet */
-        if (!endFirstPassFlag)
-            lineNum++;
-
-        /* Skip commented lines */
-        if (line[0] == ';')
-            continue;
-
-        /* Make a copies of the line being processed */
-        strcpy(copiedLine, line);
-        strcpy(orgLine, line);
-        directFlag = 0;
-
-        /* Report error for overflow line */
-        if(strlen(line) > MAX_LINE_LENGTH) {
-            reportError(fileName, 15, copiedLine);
-            continue;
-        }
-
-        char *token = strtok(line, " \n\t");
-        /* Skip empty line */
-        if (token == NULL || token[0] == ';')
-            continue;
-
-        /* Label declaration has been found */
-        if (isLabelDeclaration(fileName, token)) {
-            /* Process label declaration */
-            processLabelDeclaration(fileName, copiedLine);
-        } else if (isDirectiveDeclaration(token)) {     /* Directive declaration has been found */
-            directFlag = 1;
-            /* Process directive */
-            processDirective(fileName, copiedLine, NULL);
-        } else { /* Line is instruction */
-            directFlag = 1;
-            /* Process instruction */
-            processInstruction(fileName, copiedLine, orgLine);
-        }
-    }
-    /* Raising a flag that notates the end of the first passage */
-    endFirstPassFlag = 1;
-}
-
-void secondPass(FILE *file, const char *fileName) {
-    firstPass(file, fileName);
-}
-
-void produceObjectFile(FILE *file) {
-    int i = 0;
-    for (; i < address - INITIAL_ADDRESS_VALUE; ++i) {
-        fprintf(file, "%s\n", convertToBase64(codeWordTable[i].binaryCode));
-    }
-}
+#include <stdio.h>
+#include <string.h>
+#include "data.h"
+#include "symbols.h"
+#include "machinecode.h"
+#include "utilities.h"
+#include "analyze.h"
+#include "instructions.h"
+
+void processLabelDeclaration(AssemblerContext *context, char *line) {
+    char copiedLine[MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
+    strcpy(copiedLine, line); /* Make a copy of the original line */
+    char *token = nextToken(context, line, " \t\n");
+
+    char *label = token;
+    label[strlen(label) - 1] = '\0'; /* Remove the ':' character from the label */
+
+    token = nextToken(context, NULL, " \t\n"); /* Move to the next part of the line */
+
+    /* Labels of .data/.string get the data counter, they are relocated after the code at the end of the first pass */
+    int isDataLabel = token != NULL && (strcmp(token, ".data") == 0 || strcmp(token, ".string") == 0);
+    int value = isDataLabel ? context->dataCounter : context->address;
+
+    /* Add symbol to the symbol table if not exist yet, otherwise update it's address */
+    if (!isSymbolExist(context, label) && !context->endFirstPassFlag) {
+        addToSymbolTable(context, label, value, 0, 0);
+        if (isDataLabel)
+            setDataSymbol(context, label);
+    } else {
+        /* Update the symbol's value if it's value is casual, a value that is 0 */
+        if(getSymbolValue(context, label) == 0 && !isDataSymbol(context, label)) {
+            updateSymbolTable(context, label, value);
+            if (isDataLabel)
+                setDataSymbol(context, label);
+        } else        /* The symbol is already exist and it's value isn't casual, meaning it's value unequal to 0 */
+            if(!context->endFirstPassFlag) {     /* Skip second pass, meaning still processing first pass */
+                reportError(context, 19, copiedLine);   /* Report an error for a duplicated symbol */
+                return;
+            }
+    }
+
+    /* Check for directive/instruction */
+    if (token != NULL) {
+        if (strcmp(token, ".data") == 0 || strcmp(token, ".string") == 0 ||
+            strcmp(token, ".entry") == 0 || strcmp(token, ".extern") == 0)
+            processDirective(context, token, copiedLine);
+        else
+            processInstruction(context, token, copiedLine);
+    } else /* Missing Operands - No operands have been found */
+        reportError(context, 2, copiedLine);
+}
+
+void processInstruction(AssemblerContext *context, char *line, const char *orgLine) {
+    char *token;
+    char *opCode;
+    char copiedLine [MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
+    strcpy(copiedLine, line); /* Make a copy of the line */
+
+    /* Tokenizing according to the last source whom has been tokenized */
+    tokenizeArguments(context, line, &opCode, &token);
+
+    /* Remove new line/carriage return character from the instruction name */
+    opCode[strcspn(opCode, "\r\n")] = '\0';
+
+    /* Check existence of opCode in the instruction table */
+    if (isInstructionExist(opCode)) {
+        /* Tokenize the line to extract the opCode and operands */
+        char *operand1;
+        char *operand2;
+        char *operand3;
+        int addressingMethod1, addressingMethod2;
+        int expectedOperands = getInstructionNumOfOperands(opCode);
+        operand1 = token;
+        token = nextToken(context, NULL, " ,\t\n");
+        operand2 = token;
+
+        /* Getting addressing method for each operand */
+        addressingMethod1 = getAddressingMethod(context, operand1);
+        addressingMethod2 = getAddressingMethod(context, operand2);
+        token = nextToken(context, NULL, " ,\t\n");
+        operand3 = token;
+
+        /* Report error if addressing method isn't valid*/
+        if (!isValidAddressingMethod(opCode, addressingMethod2, addressingMethod1)) {
+            reportError(context, 3, orgLine);
+            return;
+        }
+
+        /* Report error if num of operands of instruction is larger/lower than expected operands of current instruction */
+        if (checkNumOfOperands(operand1, operand2, operand3) > expectedOperands) {
+            reportError(context, 1, orgLine);
+            return;
+        } else if (checkNumOfOperands(operand1, operand2, operand3) < expectedOperands) {
+            reportError(context, 2, orgLine);
+            return;
+        }
+
+        /* Generating the code machine according to the num of expected operands of current instruction */
+        switch (expectedOperands) {
+            case 0:
+                processInstructionWith0Operands(context, copiedLine, opCode);
+                break;
+            case 1:
+                processInstructionWith1Operands(context, copiedLine, opCode, operand1, addressingMethod1);
+                break;
+            case 2:
+                processInstructionWith2Operands(context, copiedLine, opCode, operand1, addressingMethod1, addressingMethod2, operand2);
+                break;
+        }
+    } else /* Instruction isn't exist in the instruction table */
+        reportError(context, 7, orgLine);
+}
+
+void processDirective(AssemblerContext *context, char *line, char *orgLine) {
+    char copiedLine [MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
+    strcpy(copiedLine, line); /* Make a copy of the original line */
+
+    /* Tokenizing parameters according the last source of line */
+    char *directive;
+    char *arguments;
+    tokenizeArguments(context, line, &directive, &arguments);
+
+    /*  Missing operands */
+    if (arguments == NULL)
+        reportError(context, 2, copiedLine);
+
+    /* ".data" directive */
+    if (strcmp(directive, ".data") == 0) {
+        /* The line of a directive which follows a label is the directive name alone, the numbers are in orgLine */
+        processDataDirective(context, context->directFlag ? copiedLine : orgLine, arguments);
+        /* If processing directive through label declaration, send copiedLine as a parameter to checkCommas,
+         otherwise send orgLine as a parameter */
+        if(context->directFlag)
+            checkCommas(context, copiedLine);
+        else
+            checkCommas(context, orgLine);
+    } else if (strcmp(directive, ".string") == 0) {         /* ".string" directive */
+        processStringDirective(context, copiedLine, arguments);
+    } else if (strcmp(directive, ".entry") == 0) {         /* ".entry" directive */
+        processEntryDirective(context, copiedLine, arguments);
+    } else if (strcmp(directive, ".extern") == 0) { /* ".extern" directive */
+        processExternDirective(context, copiedLine, arguments);
+    } else /* Invalid directive */
+        reportError(context, 8, copiedLine);
+}
+
+void firstPass(AssemblerContext *context, SourceReader *source) {
+    context->address = INITIAL_ADDRESS_VALUE; /* Initializing address to it's initial value */
+    context->dataCounter = 0; /* Initializing data counter to the start of the data image */
+    char line[MAX_LINE_LENGTH]; /* Line to process */
+    char copiedLine[MAX_LINE_LENGTH]; /* The copy of the line being processed */
+    char orgLine[MAX_LINE_LENGTH]; /* The original line being processed  */
+
+    /* The second pass counts the lines again, for the errors only it finds */
+    if (!context->endFirstPassFlag)
+        context->firstLineNum = context->lineNum;
+    else
+        context->lineNum = context->firstLineNum;
+
+    while (readSourceLine(source, line, sizeof(line))) {
+        /* Remove newline/carriage return character from the end of the line */
+        line[strcspn(line, "\r\n")] = '\0';
+
+        /* Avoid double counting of the lines by the stats. Count lines only if first pass isn't finished yet */
+        context->lineNum++;
+        if (!context->endFirstPassFlag)
+            STATS_INCREMENT(lines);
+
+        /* Skip commented lines */
+        if (line[0] == ';')
+            continue;
+
+        /* Make a copies of the line being processed */
+        strcpy(copiedLine, line);
+        strcpy(orgLine, line);
+        context->directFlag = 0;
+
+        /* Report error for overflow line */
+        if(strlen(line) > MAX_LINE_LENGTH) {
+            reportError(context, 15, copiedLine);
+            continue;
+        }
+
+        char *token = nextToken(context, line, " \n\t");
+        /* Skip empty line */
+        if (token == NULL || token[0] == ';')
+            continue;
+
+        /* Label declaration has been found */
+        if (isLabelDeclaration(context, token)) {
+            /* Process label declaration */
+            processLabelDeclaration(context, copiedLine);
+        } else if (isDirectiveDeclaration(token)) {     /* Directive declaration has been found */
+            context->directFlag = 1;
+            /* Process directive */
+            processDirective(context, copiedLine, NULL);
+        } else { /* Line is instruction */
+            context->directFlag = 1;
+            /* Process instruction */
+            processInstruction(context, copiedLine, orgLine);
+        }
+    }
+    /* Place the data image right after the code image by relocating the data symbols (only once, on the first pass) */
+    if (!context->endFirstPassFlag)
+        relocateDataSymbols(context, context->address);
+
+    /* Raising a flag that notates the end of the first passage */
+    context->endFirstPassFlag = 1;
+}
+
+void secondPass(AssemblerContext *context, SourceReader *source) {
+    firstPass(context, source);
+}
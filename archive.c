@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "objectfile.h"
+#include "archive.h"
+
+/* Round a byte offset up to the next multiple of 4 */
+#define ALIGN4(offset) (((offset) + 3) & ~3L)
+
+unsigned long hashSymbolName(const char *name) {
+    unsigned long hash = 2166136261UL;
+    while (*name != '\0') {
+        hash ^= (unsigned char) *name++;
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+int isValidArchive(const unsigned char *bytes, long size) {
+    unsigned long members, capacity, stringsSize, stringsEnd, indexOffset;
+    unsigned long numOfEmpty = 0;
+    unsigned long i = 0;
+
+    if (size < ARCHIVE_HEADER_SIZE || memcmp(bytes, ARCHIVE_MAGIC, 4) != 0 ||
+        readObjectField(bytes, ARCHIVE_FIELD_VERSION) != ARCHIVE_VERSION ||
+        readObjectField(bytes, ARCHIVE_FIELD_FILE_SIZE) != (unsigned long) size)
+        return false;
+
+    /* The index has to be a power of 2 */
+    members = readObjectField(bytes, ARCHIVE_FIELD_MEMBER_COUNT);
+    capacity = readObjectField(bytes, ARCHIVE_FIELD_INDEX_CAPACITY);
+    indexOffset = readObjectField(bytes, ARCHIVE_FIELD_INDEX_OFFSET);
+    stringsSize = readObjectField(bytes, ARCHIVE_FIELD_STRINGS_SIZE);
+    stringsEnd = readObjectField(bytes, ARCHIVE_FIELD_STRINGS_OFFSET) + stringsSize;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        readObjectField(bytes, ARCHIVE_FIELD_SYMBOL_COUNT) >= capacity ||
+        readObjectField(bytes, ARCHIVE_FIELD_MEMBER_OFFSET) + members * ARCHIVE_MEMBER_SIZE > (unsigned long) size ||
+        indexOffset + capacity * ARCHIVE_BUCKET_SIZE > (unsigned long) size ||
+        stringsEnd > (unsigned long) size ||
+        (stringsSize > 0 && bytes[stringsEnd - 1] != '\0'))
+        return false;
+
+    /* Every member and it's name have to fit in the archive */
+    for (; i < members; ++i) {
+        long record = (long) (readObjectField(bytes, ARCHIVE_FIELD_MEMBER_OFFSET) + i * ARCHIVE_MEMBER_SIZE);
+        unsigned long memberOffset = readObjectField(bytes, record + 4);
+
+        if (readObjectField(bytes, record) >= stringsSize || memberOffset > (unsigned long) size ||
+            readObjectField(bytes, record + 8) > (unsigned long) size - memberOffset)
+            return false;
+    }
+
+    /* Every symbol of the index has a name in the strings table and a member, and an empty bucket has to be left so a
+      lookup of a missing name ends */
+    for (i = 0; i < capacity; ++i) {
+        long bucket = (long) (indexOffset + i * ARCHIVE_BUCKET_SIZE);
+        unsigned long nameOffset = readObjectField(bytes, bucket + 4);
+
+        if (nameOffset == ARCHIVE_EMPTY_BUCKET)
+            numOfEmpty++;
+        else if (nameOffset >= stringsSize || readObjectField(bytes, bucket + 8) >= members)
+            return false;
+    }
+    return numOfEmpty > 0;
+}
+
+int mapArchive(const char *path, MappedObjectFile *mapped) {
+    if (!mapFile(path, mapped))
+        return false;
+
+    if (!isValidArchive(mapped->bytes, mapped->size)) {
+        unmapObjectFile(mapped);
+        return false;
+    }
+    return true;
+}
+
+int getArchiveMemberCount(const unsigned char *bytes) {
+    return (int) readObjectField(bytes, ARCHIVE_FIELD_MEMBER_COUNT);
+}
+
+const char *getArchiveMemberName(const unsigned char *bytes, int member) {
+    long record = (long) readObjectField(bytes, ARCHIVE_FIELD_MEMBER_OFFSET) + (long) member * ARCHIVE_MEMBER_SIZE;
+    return (const char *) bytes + readObjectField(bytes, ARCHIVE_FIELD_STRINGS_OFFSET) + readObjectField(bytes, record);
+}
+
+const unsigned char *getArchiveMember(const unsigned char *bytes, int member, long *size) {
+    long record = (long) readObjectField(bytes, ARCHIVE_FIELD_MEMBER_OFFSET) + (long) member * ARCHIVE_MEMBER_SIZE;
+    *size = (long) readObjectField(bytes, record + 8);
+    return bytes + readObjectField(bytes, record + 4);
+}
+
+int findArchiveSymbol(const unsigned char *bytes, const char *name) {
+    unsigned long hash = hashSymbolName(name);
+    unsigned long capacity = readObjectField(bytes, ARCHIVE_FIELD_INDEX_CAPACITY);
+    long indexOffset = (long) readObjectField(bytes, ARCHIVE_FIELD_INDEX_OFFSET);
+    const char *strings = (const char *) bytes + readObjectField(bytes, ARCHIVE_FIELD_STRINGS_OFFSET);
+    unsigned long i = hash & (capacity - 1);
+    unsigned long probes = 0;
+
+    /* Linear probing until the name or an empty bucket, the names are compared only when the hashes are equal, and
+      no bucket is probed twice even if the index has no empty bucket */
+    for (; probes < capacity; ++probes) {
+        long bucket = indexOffset + (long) i * ARCHIVE_BUCKET_SIZE;
+        unsigned long nameOffset = readObjectField(bytes, bucket + 4);
+
+        if (nameOffset == ARCHIVE_EMPTY_BUCKET)
+            return -1;
+        if (readObjectField(bytes, bucket) == hash && strcmp(strings + nameOffset, name) == 0)
+            return (int) readObjectField(bytes, bucket + 8);
+        i = (i + 1) & (capacity - 1);
+    }
+    return -1;
+}
+
+/* Append a name to the strings table, returns it's offset */
+static unsigned long appendString(unsigned char *strings, long *stringsSize, const char *name) {
+    unsigned long offset = (unsigned long) *stringsSize;
+    size_t length = strlen(name) + 1;
+
+    memcpy(strings + *stringsSize, name, length);
+    *stringsSize += (long) length;
+    return offset;
+}
+
+/* Add an entry point to the hashed index, returns false if it's already there */
+static int indexSymbol(unsigned char *bytes, long indexOffset, unsigned long capacity, long stringsOffset,
+                       long *stringsSize, const char *name, int member) {
+    unsigned long hash = hashSymbolName(name);
+    unsigned long i = hash & (capacity - 1);
+    long bucket = indexOffset + (long) i * ARCHIVE_BUCKET_SIZE;
+
+    while (readObjectField(bytes, bucket + 4) != ARCHIVE_EMPTY_BUCKET) {
+        if (readObjectField(bytes, bucket) == hash &&
+            strcmp((const char *) bytes + stringsOffset + readObjectField(bytes, bucket + 4), name) == 0)
+            return false;
+        i = (i + 1) & (capacity - 1);
+        bucket = indexOffset + (long) i * ARCHIVE_BUCKET_SIZE;
+    }
+
+    writeObjectField(bytes, bucket, hash);
+    writeObjectField(bytes, bucket + 4, appendString(bytes + stringsOffset, stringsSize, name));
+    writeObjectField(bytes, bucket + 8, (unsigned long) member);
+    return true;
+}
+
+/* Build the content of an archive of encoded members, returns NULL if an entry point is defined by two members */
+static unsigned char *buildArchive(const ObjectFile *objects, const char **names, int numOfMembers,
+                                   unsigned char **encoded, const long *encodedSizes, long *fileSize,
+                                   const char **duplicate) {
+    unsigned char *bytes;
+    unsigned long capacity = 1;
+    long memberOffset = ARCHIVE_HEADER_SIZE, indexOffset, stringsOffset, stringsSize = 0, objectsOffset;
+    long namesSize = 0;
+    int numOfSymbols = 0;
+    int i, j;
+
+    for (i = 0; i < numOfMembers; i++) {
+        numOfSymbols += objects[i].numOfEntries;
+        namesSize += (long) strlen(names[i]) + 1 + (long) objects[i].numOfEntries * (MAX_LABEL_LENGTH + 1);
+    }
+
+    /* The index is at most half full */
+    while (capacity < 2 * (unsigned long) numOfSymbols + 1)
+        capacity *= 2;
+    indexOffset = memberOffset + (long) numOfMembers * ARCHIVE_MEMBER_SIZE;
+    stringsOffset = indexOffset + (long) capacity * ARCHIVE_BUCKET_SIZE;
+
+    /* The objects can't start later than after every name at it's maximal length */
+    *fileSize = ALIGN4(stringsOffset + namesSize);
+    for (i = 0; i < numOfMembers; i++)
+        *fileSize += ALIGN4(encodedSizes[i]);
+    bytes = (unsigned char *) allocateZeroedMemory(MEMORY_OBJECTS, (size_t) *fileSize, 1);
+    if (bytes == NULL)
+        return NULL;
+    for (i = 0; i < (int) capacity; i++)
+        writeObjectField(bytes, indexOffset + (long) i * ARCHIVE_BUCKET_SIZE + 4, ARCHIVE_EMPTY_BUCKET);
+
+    /* Member records and the hashed index of their entry points */
+    for (i = 0; i < numOfMembers; i++) {
+        long record = memberOffset + (long) i * ARCHIVE_MEMBER_SIZE;
+
+        writeObjectField(bytes, record, appendString(bytes + stringsOffset, &stringsSize, names[i]));
+        writeObjectField(bytes, record + 8, (unsigned long) encodedSizes[i]);
+
+        for (j = 0; j < objects[i].numOfEntries; j++) {
+            /* The same entry point can't be defined by two members */
+            if (!indexSymbol(bytes, indexOffset, capacity, stringsOffset, &stringsSize, objects[i].entries[j].name, i)) {
+                *duplicate = objects[i].entries[j].name;
+                freeMemory(bytes);
+                return NULL;
+            }
+        }
+    }
+
+    /* The objects follow the strings table */
+    objectsOffset = ALIGN4(stringsOffset + stringsSize);
+    for (i = 0; i < numOfMembers; i++) {
+        writeObjectField(bytes, memberOffset + (long) i * ARCHIVE_MEMBER_SIZE + 4, (unsigned long) objectsOffset);
+        memcpy(bytes + objectsOffset, encoded[i], (size_t) encodedSizes[i]);
+        objectsOffset += ALIGN4(encodedSizes[i]);
+    }
+    *fileSize = objectsOffset;
+
+    /* Header */
+    memcpy(bytes, ARCHIVE_MAGIC, 4);
+    writeObjectField(bytes, ARCHIVE_FIELD_VERSION, ARCHIVE_VERSION);
+    writeObjectField(bytes, ARCHIVE_FIELD_MEMBER_COUNT, (unsigned long) numOfMembers);
+    writeObjectField(bytes, ARCHIVE_FIELD_MEMBER_OFFSET, (unsigned long) memberOffset);
+    writeObjectField(bytes, ARCHIVE_FIELD_INDEX_CAPACITY, capacity);
+    writeObjectField(bytes, ARCHIVE_FIELD_INDEX_OFFSET, (unsigned long) indexOffset);
+    writeObjectField(bytes, ARCHIVE_FIELD_SYMBOL_COUNT, (unsigned long) numOfSymbols);
+    writeObjectField(bytes, ARCHIVE_FIELD_STRINGS_OFFSET, (unsigned long) stringsOffset);
+    writeObjectField(bytes, ARCHIVE_FIELD_STRINGS_SIZE, (unsigned long) stringsSize);
+    writeObjectField(bytes, ARCHIVE_FIELD_FILE_SIZE, (unsigned long) *fileSize);
+    return bytes;
+}
+
+int writeArchive(const ObjectFile *objects, const char **names, int numOfMembers, FILE *file, const char **duplicate) {
+    unsigned char **encoded = (unsigned char **) allocateZeroedMemory(MEMORY_OBJECTS, numOfMembers + 1,
+                                                                      sizeof(unsigned char *));
+    long *encodedSizes = (long *) allocateZeroedMemory(MEMORY_OBJECTS, numOfMembers + 1, sizeof(long));
+    unsigned char *bytes = NULL;
+    long fileSize = 0;
+    int encodedFlag = encoded != NULL && encodedSizes != NULL;
+    int written;
+    int i;
+
+    *duplicate = NULL;
+    for (i = 0; encodedFlag && i < numOfMembers; i++) {
+        encoded[i] = encodeBinaryObjectFile(&objects[i], &encodedSizes[i]);
+        encodedFlag = encoded[i] != NULL;
+    }
+
+    if (encodedFlag)
+        bytes = buildArchive(objects, names, numOfMembers, encoded, encodedSizes, &fileSize, duplicate);
+    written = bytes != NULL && fwrite(bytes, 1, (size_t) fileSize, file) == (size_t) fileSize;
+
+    if (encoded != NULL)
+        for (i = 0; i < numOfMembers; i++)
+            freeMemory(encoded[i]);
+    freeMemory(encoded);
+    freeMemory(encodedSizes);
+    freeMemory(bytes);
+    return written;
+}
@@ -0,0 +1,135 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+/**
+ * @file archive.h
+ * @brief Definitions and functions related to the object archive format.
+ *
+ * An object archive bundles many binary object files (see objectfile.h) into one file, together with a hashed
+ * index of the entry points of all the members which is built when the archive is created. All the fields are
+ * 32-bit little endian numbers, and every table is aligned to 4 bytes, so the archive can be memory-mapped and
+ * a symbol can be resolved in one lookup, without reading any member:
+ *
+ *   header   ARCHIVE_HEADER_SIZE bytes (see the ARCHIVE_* field offsets below)
+ *   members  memberCount records of {name offset, object offset, object size}
+ *   index    indexCapacity buckets of {hash, name offset, member index}, open addressing with linear probing
+ *   strings  null terminated member and symbol names, the name offsets are relative to the start of this table
+ *   objects  the binary object files of the members, each aligned to 4 bytes
+ */
+
+/**
+ * The magic number at the start of an object archive.
+ */
+#define ARCHIVE_MAGIC "AARC"
+
+/**
+ * The version of the object archive format.
+ */
+#define ARCHIVE_VERSION 1
+
+/**
+ * Size of the header of an object archive.
+ */
+#define ARCHIVE_HEADER_SIZE 40
+
+/**
+ * Byte offsets of the header fields.
+ */
+#define ARCHIVE_FIELD_VERSION 4
+#define ARCHIVE_FIELD_MEMBER_COUNT 8
+#define ARCHIVE_FIELD_MEMBER_OFFSET 12
+#define ARCHIVE_FIELD_INDEX_CAPACITY 16
+#define ARCHIVE_FIELD_INDEX_OFFSET 20
+#define ARCHIVE_FIELD_SYMBOL_COUNT 24
+#define ARCHIVE_FIELD_STRINGS_OFFSET 28
+#define ARCHIVE_FIELD_STRINGS_SIZE 32
+#define ARCHIVE_FIELD_FILE_SIZE 36
+
+/**
+ * Size of a member record and of an index bucket.
+ */
+#define ARCHIVE_MEMBER_SIZE 12
+#define ARCHIVE_BUCKET_SIZE 12
+
+/**
+ * Name offset of an empty index bucket.
+ */
+#define ARCHIVE_EMPTY_BUCKET 0xFFFFFFFFUL
+
+/**
+ * @brief Hashes a symbol name (32-bit FNV-1a), the hash of the archive index.
+ *
+ * @param name The name of the symbol.
+ * @return The hash of the name.
+ */
+unsigned long hashSymbolName(const char *name);
+
+/**
+ * @brief Checks that a buffer holds a valid object archive.
+ *
+ * @param bytes The content of the archive.
+ * @param size The size of the content in bytes.
+ * @return True if the header, the tables, the members and every name fit in the buffer, and the index has an empty
+ * bucket, false otherwise.
+ */
+int isValidArchive(const unsigned char *bytes, long size);
+
+/**
+ * @brief Memory-maps an object archive.
+ *
+ * @param path The path of the archive.
+ * @param mapped Pointer to store the mapping.
+ * @return True if the archive has been mapped and is valid, false otherwise.
+ */
+int mapArchive(const char *path, MappedObjectFile *mapped);
+
+/**
+ * @brief Gets the number of members of an object archive.
+ *
+ * @param bytes The content of the archive.
+ * @return The number of members.
+ */
+int getArchiveMemberCount(const unsigned char *bytes);
+
+/**
+ * @brief Gets the name of a member of an object archive.
+ *
+ * @param bytes The content of the archive.
+ * @param member The index of the member.
+ * @return The null terminated name of the member.
+ */
+const char *getArchiveMemberName(const unsigned char *bytes, int member);
+
+/**
+ * @brief Gets the binary object file of a member of an object archive.
+ *
+ * @param bytes The content of the archive.
+ * @param member The index of the member.
+ * @param size Pointer to store the size of the binary object file.
+ * @return The content of the binary object file, inside the archive.
+ */
+const unsigned char *getArchiveMember(const unsigned char *bytes, int member, long *size);
+
+/**
+ * @brief Finds the member of an object archive which defines an entry point, using the hashed index.
+ *
+ * @param bytes The content of the archive.
+ * @param name The name of the entry point.
+ * @return The index of the defining member, or -1 if no member defines it.
+ */
+int findArchiveSymbol(const unsigned char *bytes, const char *name);
+
+/**
+ * @brief Writes an object archive of binary object files.
+ *
+ * @param objects The binary object files of the members.
+ * @param names The names of the members.
+ * @param numOfMembers The number of members.
+ * @param file The output file, opened in binary mode.
+ * @param duplicate Pointer to store the name of an entry point which is defined by two members, NULL if there's none.
+ * @return True if the archive has been written, false if an entry point is defined by two members or
+ * writing has been failed.
+ */
+int writeArchive(const ObjectFile *objects, const char **names, int numOfMembers, FILE *file, const char **duplicate);
+
+#endif
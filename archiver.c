@@ -0,0 +1,105 @@
+/**
+ * @file archiver.c
+ * @details This program bundles the outputs of the assembler into an object archive (".oa", see archive.h),
+ * with a hashed index of the entry points of all the members, and looks up symbols in existing archives.
+ * A member is read from it's binary object file (".obj") if there's one, otherwise from it's text files
+ * (".ob" + ".ent"/".ext").
+ * @example Run ./archiver library file1, file2, ..., etc        to bundle file1, file2, ... into library.oa.
+ * @example Run ./archiver -t library                           to list the members of library.oa.
+ * @example Run ./archiver -f library SYMBOL1, SYMBOL2, ..., etc  to find the members defining the symbols.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "objectfile.h"
+#include "archive.h"
+
+/* Bundle the members into an archive */
+static int createArchive(const char *archiveName, char **memberNames, int numOfMembers) {
+    char fileName[FILENAME_MAX];
+    ObjectFile *objects = (ObjectFile *) allocateZeroedMemory(MEMORY_TOOLS, numOfMembers + 1, sizeof(ObjectFile));
+    const char *duplicate;
+    int status = EXIT_SUCCESS;
+    int numOfLoaded = 0;
+    FILE *file;
+
+    if (objects == NULL) {
+        printf("Memory allocation has been failed.\n");
+        return EXIT_FAILURE;
+    }
+
+    for (; numOfLoaded < numOfMembers; numOfLoaded++) {
+        strcat(strcpy(fileName, memberNames[numOfLoaded]), ".obj");
+        if (!readBinaryObjectFile(fileName, &objects[numOfLoaded]) &&
+            !readTextObjectFiles(memberNames[numOfLoaded], &objects[numOfLoaded])) {
+            printf("Couldn't read %s.obj/%s.ob.\n", memberNames[numOfLoaded], memberNames[numOfLoaded]);
+            status = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    if (status == EXIT_SUCCESS) {
+        strcat(strcpy(fileName, archiveName), ".oa");
+        file = fopen(fileName, "wb");
+        if (file == NULL || !writeArchive(objects, (const char **) memberNames, numOfMembers, file, &duplicate)) {
+            if (file != NULL && duplicate != NULL)
+                printf("Entry %s is defined by two members of %s.\n", duplicate, fileName);
+            else
+                printf("Couldn't write %s.\n", fileName);
+            status = EXIT_FAILURE;
+        }
+        if (file != NULL)
+            fclose(file);
+        if (status == EXIT_FAILURE)
+            remove(fileName);
+    }
+
+    while (numOfLoaded > 0)
+        freeObjectFile(&objects[--numOfLoaded]);
+    freeMemory(objects);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    char fileName[FILENAME_MAX];
+    MappedObjectFile mapped;
+    int status = EXIT_SUCCESS;
+    int i;
+
+    if (argc >= 3 && (strcmp(argv[1], "-t") == 0 || strcmp(argv[1], "-f") == 0)) {
+        strcat(strcpy(fileName, argv[2]), ".oa");
+        if (!mapArchive(fileName, &mapped)) {
+            printf("%s isn't a valid object archive.\n", fileName);
+            return EXIT_FAILURE;
+        }
+
+        if (strcmp(argv[1], "-t") == 0) {
+            /* List the members */
+            for (i = 0; i < getArchiveMemberCount(mapped.bytes); i++) {
+                long size;
+                getArchiveMember(mapped.bytes, i, &size);
+                printf("%s %ld\n", getArchiveMemberName(mapped.bytes, i), size);
+            }
+        } else {
+            /* Resolve the symbols through the index */
+            for (i = 3; i < argc; i++) {
+                int member = findArchiveSymbol(mapped.bytes, argv[i]);
+                if (member < 0) {
+                    printf("%s isn't defined in %s.\n", argv[i], fileName);
+                    status = EXIT_FAILURE;
+                } else
+                    printf("%s %s\n", argv[i], getArchiveMemberName(mapped.bytes, member));
+            }
+        }
+        unmapObjectFile(&mapped);
+        return status;
+    }
+
+    if (argc < 3) {
+        printf("Usage: %s archive member... | -t archive | -f archive symbol...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    return createArchive(argv[1], argv + 2, argc - 2);
+}
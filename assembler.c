@@ -1,148 +1,709 @@
-/**
- * @file assembler.c
- * @author Elad Reuveny
- * @details This program is an assembler that translates assembly language source code
- * into machine code. It supports macros,  symbols, and generates output files including the object code,
- * entry symbols, and extern symbols.
- * @example Run ./assembler file1, file2, file3, ..., etc             (on command line) to execute this program.
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "data.h"
-#include "symbols.h"
-#include "utilities.h"
-#include "analyze.h"
-#include "macro.h"
-
-int main(int argc, char *argv[]) {
-    /* Finish the program when no source file provided */
-    if (argc < 2) {
-        reportError(NULL, 4, *argv);
-        return EXIT_FAILURE;
-    }
-
-    /* Setting different types of files */
-    FILE *file;
-    FILE *amFile;
-    FILE *obFile;
-    FILE *entFile;
-    FILE *extFile;
-
-    int i;
-    for (i = 1; i < argc; i++) {
-        /* Setting memory for files names and initializing memory*/
-        char asFileName[MAX_LINE_LENGTH];
-        char amFileName[MAX_LINE_LENGTH];
-        char obFileName[MAX_LINE_LENGTH];
-        char entFileName[MAX_LINE_LENGTH];
-        char extFileName[MAX_LINE_LENGTH];
-        initializeMemory();
-
-        /* Open new assembly file with ".as" ending */
-        strcat(strcpy(asFileName, argv[i]), ".as");
-        file = fopen(asFileName, "r");
-
-        /* File couldn't being found/opened  */
-        if (file == NULL) {
-            reportError(argv[i], 5, argv[i]);
-            continue;
-        }
-
-        /* File has at least one macro declaration. Assuming the .am file would be opened even thou
-          there's an error has been found in the source file, but the output files won't be produced anyway */
-        if (hasMacro(file)) {
-            /* Open new assembly file with ".am" ending */
-            strcat(strcpy(amFileName, argv[i]), ".am");
-            amFile = fopen(amFileName, "a");
-
-            /* File couldn't being found/opened */
-            if (amFile == NULL) {
-                reportError(NULL, 5, argv[i]);
-                continue;
-            }
-
-            /* Span macros and write their definition into the amFile */
-            macroSpanning(file, amFile, argv[i]);
-            fclose(amFile); /* Close the amFile after writing macro data */
-            file = fopen(amFileName, "r"); /* Reopen the file for the first and second pass */
-        } else /* File doesn't have any macro declaration */
-            file = fopen(asFileName, "r"); /* Reopen the file for the first and second pass */
-
-        /* Checking for errors after pre assembly process.
-          It wasn't clear enough if after the pre assembly process, the source file needs to be skipped,
-          so I've assumed to skip to the next source file right after.*/
-        if(errorFlag) {
-            printf("-------------------------------------------------------------------------------\n");
-            printf("***The assembler couldn't process %s file cause at least one error has been found***\n\n", argv[i]);
-	    printf("-------------------------------------------------------------------------------\n");
-            continue;
-        }
-
-        /* Executing first and second passes */
-        firstPass(file, argv[i]);
-        fseek(file, 0, SEEK_SET); /* Reset file pointer before the second pass */
-        secondPass(file, argv[i]);
-
-        /* Checking for errors after first and second passes  */
-        if(errorFlag) {
-            printf("-------------------------------------------------------------------------------\n");
-            printf("***The assembler couldn't process %s file cause at least one error has been found***\n\n", argv[i]);
-	    printf("-------------------------------------------------------------------------------\n");
-            continue;
-        }
-
-       /* Open object file for the machine code */
-        strcat(strcpy(obFileName, argv[i]), ".ob");
-        obFile = fopen(obFileName, "a");
-
-        /* File couldn't being found/opened */
-        if (obFile == NULL) {
-            reportError(argv[i], 5, argv[i]);
-            continue;
-        }
-
-        /* Write machine code into the object file */
-        produceObjectFile(obFile);
-        fclose(obFile);
-
-        /* File has at least one entry point declaration  */
-        if (hasEntry(file)) {
-            /* Open entry file for the entry symbols  */
-            strcat(strcpy(entFileName, argv[i]), ".ent");
-            entFile = fopen(entFileName, "a");
-
-            /* File couldn't being found/opened  */
-            if (entFile == NULL) {
-                reportError(argv[i], 5, argv[i]);
-                continue;
-            }
-
-            /* Write entry point symbols into the entry file */
-            produceEntryFile(entFile);
-            fclose(entFile);
-        }
-
-        /* File has at least one extern point declaration  */
-        if (hasExtern(file)) {
-            /* Open extern file for the extern symbols  */
-            strcat(strcpy(extFileName, argv[i]), ".ext");
-            extFile = fopen(extFileName, "a");
-
-            /* File couldn't being found/opened  */
-            if (extFile == NULL) {
-                reportError(argv[i], 5, argv[i]);
-                continue;
-            }
-
-            /* Write extern point symbols into the extern file */
-            produceExternFile(extFile);
-            fclose(extFile);
-        }
-
-        fclose(file); /* Closing file */
-    }
-
-    return EXIT_SUCCESS;
-}
+/**
+ * @file assembler.c
+ * @author Elad Reuveny
+ * @details This program is an assembler that translates assembly language source code
+ * into machine code. It supports macros,  symbols, and generates output files including the object code,
+ * entry symbols, and extern symbols. The files are read, assembled and written by three stages running at once,
+ * so reading the next sources and writing the outputs of the previous ones overlap with assembling.
+ * @example Run ./assembler file1, file2, file3, ..., etc             (on command line) to execute this program.
+ * @example Run ./assembler --binary file1, file2, ..., etc            to also produce binary object files (".obj").
+ * @example Run ./assembler --stats file1, file2, ..., etc             to write the time of every phase and the hot path
+ * counters of every file into the standard error (the assembler has to be built with ASSEMBLER_STATS defined).
+ * @example Run ./assembler --mem-report file1, file2, ..., etc        to write the allocations, peak memory and the
+ * blocks still in use at exit of every subsystem into the standard error.
+ * @example Run ./assembler --trace out.json file1, file2, ..., etc    to write a timeline of every file and it's
+ * phases, in the Chrome trace event format, into out.json.
+ * @example Run ./assembler --io-uring file1, file2, ..., etc          to read the source files and write the output
+ * files in batches of 64 files through an io_uring, where it's available.
+ * @example Run ./assembler -O file1, file2, ..., etc                  to thread the jumps, remove the code which is never
+ * executed and the instructions which have no effect, and report the words saved.
+ * @example Run ./assembler --pool-literals file1, file2, ..., etc     to keep a single copy of the equal .data/.string
+ * payloads (and of a payload which ends a longer one), and report the data words saved.
+ * @example Run ./assembler --macro-cache dir file1, file2, ..., etc   to keep the macro libraries the sources include
+ * (by .include "file") precompiled in dir, for the next runs.
+ * @example Run ./assembler --watch file1, file2, ..., etc             to assemble the sources, then keep running and
+ * assemble again only the sources which have changed (or whose included files have), until it's interrupted. The
+ * output files are replaced rather than appended to, each through a temporary file which is renamed over it.
+ * @example Run ./assembler -j 8 file1, file2, ..., etc                to parse every large source by up to 8 threads
+ * (1 to 64).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "data.h"
+#include "libasm.h"
+#include "batchio.h"
+#include "pipeline.h"
+#include "watch.h"
+
+/* The largest number of characters of a message */
+#define MAX_MESSAGE_LENGTH (3 * MAX_LINE_LENGTH + 128)
+
+/* The largest number of output files of a single source (.am, .ob, .obj, .ent, .ext) */
+#define MAX_OUTPUTS_PER_SOURCE 5
+
+/* The largest number of characters of the ending of a file of a source (".obj") */
+#define MAX_ENDING_LENGTH 4
+
+/* The number of sources which are in the pipeline at once: a batch being read, a batch being assembled and a
+  batch being written */
+#define PIPELINE_NUM_OF_JOBS (3 * BATCH_IO_ENTRIES)
+
+/* How long no file has to be changed before the changed sources are assembled again, in milliseconds */
+#define WATCH_SETTLE_MILLISECONDS 50
+
+/* What the --watch option keeps of a source between it's assemblies */
+typedef struct WatchedSource {
+    MacroDependency *includedFiles;     /* The files the source has included when it has been assembled last. */
+    int numOfIncludedFiles;             /* The number of included files. */
+    IncrementalAssembly incremental;    /* The model of the source, only it's edited lines are assembled again. */
+} WatchedSource;
+
+/* A source and what has been produced from it, handed from stage to stage */
+typedef struct SourceJob {
+    BatchFile source;                              /* The source file, read by the read stage. */
+    BatchFile messages;                            /* The messages of the source, printed by the write stage. */
+    BatchFile outputs[MAX_OUTPUTS_PER_SOURCE];     /* The output files, written by the write stage. */
+    int numOfOutputs;                              /* The number of output files. */
+    WatchedSource *watched;                        /* What the --watch option keeps of the source, NULL without it. */
+} SourceJob;
+
+/* The stages of the assembler: read -> assemble -> write, joined by bounded queues. The jobs go around, from the
+  free jobs back to the free jobs, so the sources which are in the pipeline at once are bounded as well */
+typedef struct Pipeline {
+    SourceJob jobs[PIPELINE_NUM_OF_JOBS];   /* The jobs. */
+    PipelineQueue freeJobs;                 /* The jobs which are free for the read stage. */
+    PipelineQueue readJobs;                 /* The jobs which have been read, for the assemble stage. */
+    PipelineQueue assembledJobs;            /* The jobs which have been assembled, for the write stage. */
+    BatchIo readIo;                         /* The batch I/O of the read stage. */
+    BatchIo writeIo;                        /* The batch I/O of the write stage. */
+    char **sourceNames;                     /* The names of the sources. */
+    int numOfSources;                       /* The number of sources. */
+    WatchedSource **watchedSources;         /* What the --watch option keeps of the sources, NULL without it. */
+    int batchSize;                          /* The number of sources which are read together. */
+    int binaryFlag;                         /* Produce binary object files as well. */
+    int statsFlag;                          /* Report the statistics of every file. */
+    AssemblyOptions options;                /* The options of assembling every file. */
+} Pipeline;
+
+/* Format an error in the format of the assembler, names and lines which are too long are truncated */
+static void formatError(char *message, const char *sourceName, int line, const char *text, int errorCode) {
+    sprintf(message, "ERROR has been occurred in %.*s file at line <%d>: %.*s --->>> *%s*\n\n", MAX_LINE_LENGTH,
+            sourceName, line, MAX_LINE_LENGTH, text, getErrorMessage(errorCode));
+}
+
+/* Print an error which has been found outside of a source, such as a file which couldn't being opened */
+static void printError(const char *sourceName, int errorCode, const char *errorMessage) {
+    char message[MAX_MESSAGE_LENGTH];
+
+    formatError(message, sourceName, 0, errorMessage, errorCode);
+    fputs(message, stdout);
+}
+
+/* Add a message of a source, which is printed by the write stage in the order of the sources. A message which
+  couldn't being added is printed right away */
+static void addMessage(SourceJob *job, const char *message) {
+    if (!appendBatchData(&job->messages, message, (long) strlen(message)))
+        fputs(message, stdout);
+}
+
+/* Add an error which has been found outside of a source */
+static void addError(SourceJob *job, int errorCode) {
+    char message[MAX_MESSAGE_LENGTH];
+
+    formatError(message, job->source.name, 0, job->source.name, errorCode);
+    addMessage(job, message);
+}
+
+/* Add the diagnostics of a source, errors in the format of the assembler, notes as they are */
+static void addDiagnostics(SourceJob *job, const Assembly *assembly) {
+    char message[MAX_MESSAGE_LENGTH];
+    int i = 0;
+
+    for (; i < assembly->numOfDiagnostics; ++i) {
+        const AssemblerDiagnostic *diagnostic = &assembly->diagnostics[i];
+
+        if (diagnostic->code == DIAGNOSTIC_NOTE)
+            sprintf(message, "%s\n", diagnostic->text);
+        else
+            formatError(message, job->source.name, diagnostic->line, diagnostic->text, diagnostic->code);
+        addMessage(job, message);
+    }
+}
+
+/* Get the path of a file of a source by it's ending, false (and an empty path) if the name of the source is too long
+  for the path of any of it's files */
+static int getFilePath(const char *sourceName, const char *ending, char *path) {
+    path[0] = '\0';
+    if (strlen(sourceName) + MAX_ENDING_LENGTH >= MAX_LINE_LENGTH)
+        return false;
+    strcat(strcpy(path, sourceName), ending);
+    return true;
+}
+
+/* Get the path of a source file (with ".as" ending), false if the name is too long */
+static int getSourcePath(const char *sourceName, char *path) {
+    return getFilePath(sourceName, ".as", path);
+}
+
+/* Add an empty output file of a source, a source whose name is too long has been rejected when it has been read */
+static BatchFile *addOutput(SourceJob *job, const char *ending, int append) {
+    BatchFile *file = &job->outputs[job->numOfOutputs++];
+
+    memset(file, 0, sizeof(BatchFile));
+    getFilePath(job->source.name, ending, file->path);
+    file->name = job->source.name;
+    file->append = append;
+    file->replace = job->watched != NULL; /* A watched source is assembled again and again */
+    return file;
+}
+
+/* Drop the last output file of a source when it's content couldn't being allocated */
+static void checkOutput(SourceJob *job, BatchFile *file, int isAllocated) {
+    if (isAllocated)
+        return;
+    addError(job, 12);
+    freeBatchFile(file);
+    job->numOfOutputs--;
+}
+
+/* Write the "name address" lines of a table into the content of a file */
+static int produceSymbolFile(BatchFile *file, const ObjectSymbol *symbols, int numOfSymbols) {
+    char line[MAX_LINE_LENGTH + 16];
+    int isAllocated = true;
+    int i = 0;
+
+    for (; i < numOfSymbols && isAllocated; ++i) {
+        sprintf(line, "%s %d\n", symbols[i].name, symbols[i].value);
+        isAllocated = appendBatchData(file, line, (long) strlen(line));
+    }
+    return isAllocated;
+}
+
+/* Produce the object, binary object, entry and extern files of a source file which has been assembled */
+static void produceOutputFiles(SourceJob *job, const Assembly *assembly, int binaryFlag) {
+    const ObjectFile *object = &assembly->object;
+    char base64Line[ISA_BASE64_DIGITS + 2];
+    BatchFile *file;
+    int isAllocated = true;
+    int i = 0;
+
+    /* Object file for the machine code, instruction words first and data words follow them */
+    file = addOutput(job, ".ob", true);
+    for (; i < object->codeWords + object->dataWords && isAllocated; ++i) {
+        convertToBase64(object->words[i], base64Line);
+        base64Line[ISA_BASE64_DIGITS] = '\n';
+        isAllocated = appendBatchData(file, base64Line, ISA_BASE64_DIGITS + 1);
+    }
+    STATS_ADD(wordsEmitted, object->codeWords + object->dataWords);
+    checkOutput(job, file, isAllocated);
+
+    /* Binary object file has been requested, for the machine code and the entry/extern tables */
+    if (binaryFlag) {
+        long size;
+        unsigned char *bytes = encodeBinaryObjectFile(object, &size);
+
+        file = addOutput(job, ".obj", false);
+        checkOutput(job, file, bytes != NULL && appendBatchData(file, (const char *) bytes, size));
+        freeMemory(bytes);
+    }
+
+    /* File has at least one entry point declaration  */
+    if (object->numOfEntries > 0) {
+        file = addOutput(job, ".ent", true);
+        checkOutput(job, file, produceSymbolFile(file, object->entries, object->numOfEntries));
+    }
+
+    /* File has at least one extern point declaration  */
+    if (assembly->hasExternDeclarations) {
+        file = addOutput(job, ".ext", true);
+        checkOutput(job, file, produceSymbolFile(file, object->externs, object->numOfExterns));
+    }
+}
+
+/* The assemble stage: assemble a source file which has been read, and produce it's messages and output files */
+static void assembleJob(SourceJob *job, const AssemblyOptions *options, int binaryFlag, int statsFlag) {
+    const char *sourceName = job->source.name;
+    AssemblyOptions sourceOptions = *options; /* The included files are relative to the source */
+    Assembly assembly;
+    BatchFile *file;
+    double fileStart = traceBegin();
+    double phaseStart;
+
+    sourceOptions.sourcePath = job->source.path;
+
+#ifdef ASSEMBLER_STATS
+    resetStats();
+#endif
+
+    /* File name is too long for the paths of it's files, or file couldn't being found/opened */
+    if (job->source.path[0] == '\0')
+        addError(job, 27);
+    else if (job->source.status != 0)
+        addError(job, 5);
+    else {
+        /* The source is assembled in memory, an empty file is assembled as an empty source. A watched source is
+          assembled incrementally, the lines which haven't been edited since it's last assembly are reused */
+        if (job->watched != NULL)
+            reassembleSource(&job->watched->incremental, job->source.data != NULL ? job->source.data : "",
+                             job->source.size, &sourceOptions, &assembly);
+        else
+            assembleSourceWithOptions(job->source.data != NULL ? job->source.data : "", job->source.size,
+                                      &sourceOptions, &assembly);
+        freeBatchFile(&job->source);
+
+        /* The included files are watched from now on instead of those of the last assembly */
+        if (job->watched != NULL) {
+            freeMemory(job->watched->includedFiles);
+            job->watched->includedFiles = assembly.includedFiles;
+            job->watched->numOfIncludedFiles = assembly.numOfIncludedFiles;
+            assembly.includedFiles = NULL;
+        }
+
+        /* File has at least one macro declaration. Assuming the .am file would be written even thou
+          there's an error has been found in the source file, but the output files won't be produced anyway */
+        if (assembly.expandedSource != NULL) {
+            file = addOutput(job, ".am", true);
+            checkOutput(job, file, appendBatchData(file, assembly.expandedSource, assembly.expandedSize));
+        }
+
+        addDiagnostics(job, &assembly);
+
+        /* Checking for errors after pre assembly process, and after first and second passes  */
+        if (assembly.failed) {
+            addMessage(job, "-------------------------------------------------------------------------------\n");
+            addMessage(job, "***The assembler couldn't process ");
+            addMessage(job, sourceName);
+            addMessage(job, " file cause at least one error has been found***\n\n");
+            addMessage(job, "-------------------------------------------------------------------------------\n");
+        } else {
+            /* Report the words the optimizer and the literal pool have saved */
+            if ((options->optimizations & OPTIMIZE_SOURCE) != 0) {
+                char message[MAX_MESSAGE_LENGTH];
+
+                sprintf(message, "The optimizer has saved %d words of %.*s file.\n", assembly.wordsSaved,
+                        MAX_LINE_LENGTH, sourceName);
+                addMessage(job, message);
+            }
+            if ((options->optimizations & OPTIMIZE_POOL_LITERALS) != 0) {
+                char message[MAX_MESSAGE_LENGTH];
+
+                sprintf(message, "The literal pool has saved %d data words of %.*s file.\n",
+                        assembly.dataWordsSaved, MAX_LINE_LENGTH, sourceName);
+                addMessage(job, message);
+            }
+
+            phaseStart = traceBegin();
+            STATS_START(STATS_PHASE_OUTPUT);
+            produceOutputFiles(job, &assembly, binaryFlag);
+            STATS_STOP(STATS_PHASE_OUTPUT);
+            traceEnd(TRACE_CATEGORY_PHASE, "output", phaseStart);
+        }
+        freeAssembly(&assembly);
+    }
+    traceEnd(TRACE_CATEGORY_FILE, sourceName, fileStart);
+
+#ifdef ASSEMBLER_STATS
+    if (statsFlag)
+        reportFileStats(stderr, sourceName);
+#else
+    (void) statsFlag;
+#endif
+}
+
+/* The write stage: print the messages of a source, write it's output files and report the ones which couldn't
+  being written */
+static void writeJob(BatchIo *io, SourceJob *job) {
+    double phaseStart;
+    int i = 0;
+
+    if (job->messages.size > 0)
+        fwrite(job->messages.data, 1, (size_t) job->messages.size, stdout);
+
+    phaseStart = traceBegin();
+    writeFiles(io, job->outputs, job->numOfOutputs);
+    traceEnd(TRACE_CATEGORY_PHASE, "write", phaseStart);
+
+    for (; i < job->numOfOutputs; ++i) {
+        if (job->outputs[i].status != 0)
+            printError(job->outputs[i].name, 5, job->outputs[i].name);
+        freeBatchFile(&job->outputs[i]);
+    }
+    freeBatchFile(&job->source);
+    freeBatchFile(&job->messages);
+    job->numOfOutputs = 0;
+}
+
+/* The read stage: read a batch of source files (with ".as" ending) into free jobs, and hand them to the assemble
+  stage */
+static void readBatch(Pipeline *pipeline, int start, int count) {
+    BatchFile sources[BATCH_IO_ENTRIES];
+    SourceJob *batch[BATCH_IO_ENTRIES];
+    double phaseStart;
+    int i = 0;
+
+    memset(sources, 0, sizeof(sources));
+    for (; i < count; ++i) {
+        getSourcePath(pipeline->sourceNames[start + i], sources[i].path); /* An empty path if it's too long */
+        sources[i].name = pipeline->sourceNames[start + i];
+    }
+    phaseStart = traceBegin();
+    readFiles(&pipeline->readIo, sources, count);
+    traceEnd(TRACE_CATEGORY_PHASE, "read", phaseStart);
+
+    for (i = 0; i < count; ++i) {
+        batch[i] = (SourceJob *) popPipelineQueue(&pipeline->freeJobs);
+        batch[i]->source = sources[i];
+        batch[i]->watched = pipeline->watchedSources != NULL ? pipeline->watchedSources[start + i] : NULL;
+        pushPipelineQueue(&pipeline->readJobs, batch[i]);
+    }
+}
+
+/* Get the number of sources of the batch which starts at a source */
+static int getBatchSize(const Pipeline *pipeline, int start) {
+    return pipeline->numOfSources - start < pipeline->batchSize ? pipeline->numOfSources - start
+                                                                  : pipeline->batchSize;
+}
+
+/* Run the read stage, on a thread of it's own */
+static void *runReadStage(void *argument) {
+    Pipeline *pipeline = (Pipeline *) argument;
+    int start = 0;
+
+    for (; start < pipeline->numOfSources; start += pipeline->batchSize)
+        readBatch(pipeline, start, getBatchSize(pipeline, start));
+    closePipelineQueue(&pipeline->readJobs);
+    return NULL;
+}
+
+/* Run the write stage, on a thread of it's own */
+static void *runWriteStage(void *argument) {
+    Pipeline *pipeline = (Pipeline *) argument;
+    SourceJob *job;
+
+    while ((job = (SourceJob *) popPipelineQueue(&pipeline->assembledJobs)) != NULL) {
+        writeJob(&pipeline->writeIo, job);
+        pushPipelineQueue(&pipeline->freeJobs, job);
+    }
+    return NULL;
+}
+
+/* Assemble the sources of a pipeline on this thread, while the read stage prefetches the next sources and the
+  write stage writes the output files of the previous sources. The messages are printed by the write stage, so
+  they are printed in the order of the sources */
+static void runPipeline(Pipeline *pipeline) {
+    pthread_t reader;
+    pthread_t writer;
+    int hasWriter;
+    int hasReader;
+    SourceJob *job;
+    int i = 0;
+
+    /* The queues are emptied, the pipeline may run again */
+    reopenPipelineQueue(&pipeline->freeJobs);
+    reopenPipelineQueue(&pipeline->readJobs);
+    reopenPipelineQueue(&pipeline->assembledJobs);
+    for (; i < PIPELINE_NUM_OF_JOBS; ++i)
+        pushPipelineQueue(&pipeline->freeJobs, &pipeline->jobs[i]);
+    hasWriter = pthread_create(&writer, NULL, runWriteStage, pipeline) == 0;
+    hasReader = hasWriter && pthread_create(&reader, NULL, runReadStage, pipeline) == 0;
+
+    if (hasReader) {
+        while ((job = (SourceJob *) popPipelineQueue(&pipeline->readJobs)) != NULL) {
+            assembleJob(job, &pipeline->options, pipeline->binaryFlag, pipeline->statsFlag);
+            pushPipelineQueue(&pipeline->assembledJobs, job);
+        }
+    } else {
+        /* The threads couldn't being created, the stages take turns on this thread */
+        int start = 0;
+
+        for (; start < pipeline->numOfSources; start += pipeline->batchSize) {
+            int count = getBatchSize(pipeline, start);
+
+            readBatch(pipeline, start, count);
+            for (i = 0; i < count; ++i) {
+                job = (SourceJob *) popPipelineQueue(&pipeline->readJobs);
+                assembleJob(job, &pipeline->options, pipeline->binaryFlag, pipeline->statsFlag);
+                if (hasWriter)
+                    pushPipelineQueue(&pipeline->assembledJobs, job);
+                else {
+                    writeJob(&pipeline->writeIo, job);
+                    pushPipelineQueue(&pipeline->freeJobs, job);
+                }
+            }
+        }
+    }
+
+    closePipelineQueue(&pipeline->assembledJobs);
+    if (hasWriter)
+        pthread_join(writer, NULL);
+    if (hasReader)
+        pthread_join(reader, NULL);
+}
+
+/* Set when the assembler is interrupted while it's watching the sources */
+static volatile sig_atomic_t stopFlag = 0;
+
+/* Stop watching the sources, the signal handler of an interrupt */
+static void stopWatching(int signalNumber) {
+    (void) signalNumber;
+    stopFlag = 1;
+}
+
+/* Watch a source file and the files it has included */
+static void watchSource(FileWatcher *watcher, const char *sourceName, const WatchedSource *source) {
+    char path[MAX_LINE_LENGTH];
+    int i = 0;
+
+    if (getSourcePath(sourceName, path))
+        watchFile(watcher, path);
+    for (; i < source->numOfIncludedFiles; ++i)
+        watchFile(watcher, source->includedFiles[i].path);
+}
+
+/* Check if a source file or one of the files it has included has been changed */
+static int isSourceChanged(const FileWatcher *watcher, const char *sourceName, const WatchedSource *source) {
+    char path[MAX_LINE_LENGTH];
+    int i = 0;
+
+    if (getSourcePath(sourceName, path) && hasFileChanged(watcher, path))
+        return true;
+    for (; i < source->numOfIncludedFiles; ++i)
+        if (hasFileChanged(watcher, source->includedFiles[i].path))
+            return true;
+    return false;
+}
+
+/* Keep the assembler running once the sources have been assembled, and assemble again only the sources which have
+  been changed, until it's interrupted. Everything but the changed sources stays as it is, the macro libraries
+  which haven't been changed are kept by the cache of the run */
+static void watchSources(Pipeline *pipeline, const char *programName) {
+    char **sourceNames = pipeline->sourceNames;
+    WatchedSource **watchedSources = pipeline->watchedSources;
+    int numOfSources = pipeline->numOfSources;
+    char **changedNames = (char **) allocateMemory(MEMORY_IO, numOfSources * sizeof(char *));
+    WatchedSource **changedSources = (WatchedSource **) allocateMemory(MEMORY_IO,
+                                                                       numOfSources * sizeof(WatchedSource *));
+    FileWatcher watcher;
+    int i = 0;
+
+    if (!openFileWatcher(&watcher) || changedNames == NULL || changedSources == NULL) {
+        fprintf(stderr, "%s couldn't watch the source files, they have been assembled once.\n", programName);
+        closeFileWatcher(&watcher);
+        freeMemory(changedNames);
+        freeMemory(changedSources);
+        return;
+    }
+    for (; i < numOfSources; ++i)
+        watchSource(&watcher, sourceNames[i], watchedSources[i]);
+    fprintf(stderr, "Watching %d source files for changes, interrupt (Ctrl+C) to stop.\n", numOfSources);
+
+    signal(SIGINT, stopWatching);
+    signal(SIGTERM, stopWatching);
+    while (!stopFlag && waitForChanges(&watcher, WATCH_SETTLE_MILLISECONDS)) {
+        /* The pipeline runs again on the changed sources only */
+        pipeline->sourceNames = changedNames;
+        pipeline->watchedSources = changedSources;
+        pipeline->numOfSources = 0;
+        for (i = 0; i < numOfSources; ++i) {
+            if (isSourceChanged(&watcher, sourceNames[i], watchedSources[i])) {
+                changedNames[pipeline->numOfSources] = sourceNames[i];
+                changedSources[pipeline->numOfSources++] = watchedSources[i];
+            }
+        }
+        if (pipeline->numOfSources == 0)
+            continue;
+
+        runPipeline(pipeline);
+        fflush(stdout);
+        fprintf(stderr, "%d of %d source files have been assembled again.\n", pipeline->numOfSources, numOfSources);
+
+        /* A source may include other files now */
+        for (i = 0; i < pipeline->numOfSources; ++i)
+            watchSource(&watcher, changedNames[i], changedSources[i]);
+    }
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    pipeline->sourceNames = sourceNames;
+    pipeline->watchedSources = watchedSources;
+    pipeline->numOfSources = numOfSources;
+    closeFileWatcher(&watcher);
+    freeMemory(changedNames);
+    freeMemory(changedSources);
+}
+
+/* Write the timeline of the files into a trace file */
+static void produceTraceFile(const char *traceFileName) {
+    FILE *traceFile = fopen(traceFileName, "w");
+
+    /* File couldn't being found/opened */
+    if (traceFile == NULL) {
+        printError(traceFileName, 5, traceFileName);
+        return;
+    }
+    writeTrace(traceFile);
+    fclose(traceFile);
+}
+
+/* Parse the number of threads of the -j option, false if it isn't a number from 1 to MAX_ASSEMBLY_THREADS */
+static int parseNumOfThreads(const char *text, int *numOfThreads) {
+    char *end;
+    long number = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || number < 1 || number > MAX_ASSEMBLY_THREADS)
+        return false;
+    *numOfThreads = (int) number;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    static Pipeline pipeline; /* The stages of the assembler */
+    int memoryReportFlag = 0; /* Report the memory of every subsystem */
+    const char *traceFileName = NULL; /* Write a timeline of the files */
+    int ringFlag = 0; /* Read and write the files in batches through an io_uring */
+    int watchFlag = 0; /* Keep running and assemble the sources which have been changed again */
+    WatchedSource *watchedSources = NULL;
+    int numOfFiles = 0;
+    int isReady;
+
+    /* Options start with '-', every other argument is a source file */
+    int i;
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--trace") == 0 || strcmp(argv[i], "--macro-cache") == 0 || strcmp(argv[i], "-j") == 0) &&
+            i + 1 == argc) {
+            fprintf(stderr, "%s: the %s option needs a value.\n", *argv, argv[i]);
+            return EXIT_FAILURE;
+        } else if (strcmp(argv[i], "--trace") == 0)
+            traceFileName = argv[++i];
+        else if (strcmp(argv[i], "--macro-cache") == 0)
+            pipeline.options.macroCacheDirectory = argv[++i];
+        else if (strcmp(argv[i], "-j") == 0) {
+            if (!parseNumOfThreads(argv[++i], &pipeline.options.numOfThreads)) {
+                fprintf(stderr, "%s: the number of threads of -j has to be 1 to %d, not \"%s\".\n", *argv,
+                        MAX_ASSEMBLY_THREADS, argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--binary") == 0)
+            pipeline.binaryFlag = 1;
+        else if (strcmp(argv[i], "--stats") == 0)
+            pipeline.statsFlag = 1;
+        else if (strcmp(argv[i], "--mem-report") == 0)
+            memoryReportFlag = 1;
+        else if (strcmp(argv[i], "--io-uring") == 0)
+            ringFlag = 1;
+        else if (strcmp(argv[i], "--watch") == 0)
+            watchFlag = 1;
+        else if (strcmp(argv[i], "-O") == 0)
+            pipeline.options.optimizations |= OPTIMIZE_SOURCE;
+        else if (strcmp(argv[i], "--pool-literals") == 0)
+            pipeline.options.optimizations |= OPTIMIZE_POOL_LITERALS;
+        else if (argv[i][0] != '-')
+            numOfFiles++;
+        else {
+            fprintf(stderr, "%s: unknown option %s.\n", *argv, argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Finish the program when no source file provided */
+    if (numOfFiles == 0) {
+        printError(*argv, 4, *argv);
+        return EXIT_FAILURE;
+    }
+
+#ifndef ASSEMBLER_STATS
+    /* The counters have been compiled out */
+    if (pipeline.statsFlag) {
+        fprintf(stderr, "%s has been built without statistics, build it with ASSEMBLER_STATS defined for --stats.\n",
+                *argv);
+        pipeline.statsFlag = 0;
+    }
+#endif
+
+    /* The counters are global, the statistics of a source are only right when it's assembled by a single thread */
+    if (pipeline.statsFlag)
+        pipeline.options.numOfThreads = 0;
+
+    /* Every allocation from now on is recorded */
+    if (memoryReportFlag)
+        enableMemoryAccounting();
+    if (traceFileName != NULL)
+        enableTracing();
+
+    /* Collect the sources, skipping options, the file name of the trace and the macro cache directory */
+    pipeline.sourceNames = (char **) allocateMemory(MEMORY_IO, numOfFiles * sizeof(char *));
+    isReady = pipeline.sourceNames != NULL && initPipelineQueue(&pipeline.freeJobs) &&
+              initPipelineQueue(&pipeline.readJobs) && initPipelineQueue(&pipeline.assembledJobs);
+    if (!isReady) {
+        printError(*argv, 12, *argv);
+        return EXIT_FAILURE;
+    }
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--trace") == 0 || strcmp(argv[i], "--macro-cache") == 0 || strcmp(argv[i], "-j") == 0) &&
+            i + 1 < argc)
+            i++;
+        else if (argv[i][0] != '-')
+            pipeline.sourceNames[pipeline.numOfSources++] = argv[i];
+    }
+
+    /* Every source keeps the files it includes, to be watched along with it */
+    if (watchFlag) {
+        watchedSources = (WatchedSource *) allocateMemory(MEMORY_IO, numOfFiles * sizeof(WatchedSource));
+        pipeline.watchedSources = (WatchedSource **) allocateMemory(MEMORY_IO, numOfFiles * sizeof(WatchedSource *));
+        if (watchedSources == NULL || pipeline.watchedSources == NULL) {
+            printError(*argv, 12, *argv);
+            return EXIT_FAILURE;
+        }
+        memset(watchedSources, 0, numOfFiles * sizeof(WatchedSource));
+        for (i = 0; i < numOfFiles; i++) {
+            initIncrementalAssembly(&watchedSources[i].incremental);
+            pipeline.watchedSources[i] = &watchedSources[i];
+        }
+    }
+
+    /* Without an io_uring every source is a batch of it's own, the batches are done by plain system calls */
+    pipeline.batchSize = ringFlag ? BATCH_IO_ENTRIES : 1;
+    isReady = openBatchIo(&pipeline.readIo, ringFlag);
+    isReady = openBatchIo(&pipeline.writeIo, ringFlag) && isReady;
+    if (!isReady && ringFlag)
+        fprintf(stderr, "%s couldn't set up an io_uring, the files are read and written by plain system calls.\n",
+                *argv);
+
+    runPipeline(&pipeline);
+    fflush(stdout);
+    if (watchFlag)
+        watchSources(&pipeline, *argv);
+
+    closeBatchIo(&pipeline.readIo);
+    closeBatchIo(&pipeline.writeIo);
+    destroyPipelineQueue(&pipeline.freeJobs);
+    destroyPipelineQueue(&pipeline.readJobs);
+    destroyPipelineQueue(&pipeline.assembledJobs);
+    freeMemory(pipeline.sourceNames);
+    for (i = 0; watchedSources != NULL && i < numOfFiles; i++) {
+        freeMemory(watchedSources[i].includedFiles);
+        freeIncrementalAssembly(&watchedSources[i].incremental);
+    }
+    freeMemory(watchedSources);
+    freeMemory(pipeline.watchedSources);
+    freeMacroLibraries();
+
+#ifdef ASSEMBLER_STATS
+    if (pipeline.statsFlag)
+        reportTotalStats(stderr, numOfFiles);
+#endif
+
+    if (traceFileName != NULL) {
+        produceTraceFile(traceFileName);
+        freeTrace();
+    }
+
+    /* Every source has been freed after it's output files, so only blocks which have been leaked are left in use */
+    if (memoryReportFlag)
+        reportMemory(stderr);
+
+    return EXIT_SUCCESS;
+}
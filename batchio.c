@@ -0,0 +1,517 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "data.h"
+#include "batchio.h"
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#include <linux/io_uring.h>
+#define BATCH_IO_RING
+#endif
+
+/* The number of bytes allocated for the content of a file which is read, doubled until it fits */
+#define BATCH_INITIAL_CAPACITY 16384
+
+/* The mode of a file which is created, before the umask */
+#define BATCH_FILE_MODE 0666
+
+/* The result of an operation which hasn't completed yet */
+#define BATCH_PENDING (-0x7fffffff)
+
+/* The ending of the temporary file a file which is replaced is written into */
+#define BATCH_REPLACE_ENDING ".tmp"
+
+int appendBatchData(BatchFile *file, const char *data, long size) {
+    if (file->size + size + 1 > file->capacity) {
+        long newCapacity = file->capacity == 0 ? 1024 : file->capacity;
+        char *newData;
+
+        while (file->size + size + 1 > newCapacity)
+            newCapacity *= 2;
+        newData = (char *) reallocateMemory(MEMORY_IO, file->data, (size_t) newCapacity);
+        if (newData == NULL)
+            return false;
+        file->data = newData;
+        file->capacity = newCapacity;
+    }
+
+    memcpy(file->data + file->size, data, (size_t) size);
+    file->size += size;
+    file->data[file->size] = '\0';
+    return true;
+}
+
+void freeBatchFile(BatchFile *file) {
+    freeMemory(file->data);
+    file->data = NULL;
+    file->size = 0;
+    file->capacity = 0;
+}
+
+/* Make room for at least one more byte (and the null terminator) in the content of a file */
+static int growBatchFile(BatchFile *file) {
+    long newCapacity = file->capacity == 0 ? BATCH_INITIAL_CAPACITY : file->capacity * 2;
+    char *newData;
+
+    if (file->size + 1 < file->capacity)
+        return true;
+    newData = (char *) reallocateMemory(MEMORY_IO, file->data, (size_t) newCapacity);
+    if (newData == NULL)
+        return false;
+    file->data = newData;
+    file->capacity = newCapacity;
+    return true;
+}
+
+/* Get the flags a file is opened with for writing */
+static int getWriteFlags(const BatchFile *file) {
+    return O_WRONLY | O_CREAT | (file->append && !file->replace ? O_APPEND : O_TRUNC);
+}
+
+/* Read a whole file by plain system calls */
+static void readFilePlain(BatchFile *file) {
+    int descriptor = open(file->path, O_RDONLY);
+    long length;
+
+    file->status = 0;
+    if (descriptor < 0) {
+        file->status = errno;
+        return;
+    }
+
+    /* Read until the end of the file */
+    do {
+        if (!growBatchFile(file)) {
+            file->status = ENOMEM;
+            break;
+        }
+        length = (long) read(descriptor, file->data + file->size, (size_t) (file->capacity - file->size - 1));
+        if (length < 0 && errno != EINTR) {
+            file->status = errno;
+            break;
+        }
+        if (length > 0)
+            file->size += length;
+    } while (length != 0);
+
+    if (file->data != NULL)
+        file->data[file->size] = '\0';
+    close(descriptor);
+}
+
+/* Write a whole file by plain system calls */
+static void writeFilePlain(BatchFile *file) {
+    int descriptor = open(file->path, getWriteFlags(file), BATCH_FILE_MODE);
+    long written = 0;
+
+    file->status = 0;
+    if (descriptor < 0) {
+        file->status = errno;
+        return;
+    }
+
+    while (written < file->size) {
+        long length = (long) write(descriptor, file->data + written, (size_t) (file->size - written));
+        if (length < 0 && errno != EINTR) {
+            file->status = errno;
+            break;
+        }
+        if (length > 0)
+            written += length;
+    }
+    if (close(descriptor) != 0 && file->status == 0)
+        file->status = errno;
+}
+
+#ifdef BATCH_IO_RING
+
+/* Check that the kernel supports every operation of a batch */
+static int isRingSupported(int ringFd) {
+    struct io_uring_probe *probe;
+    int supported;
+    int operations[4];
+    int i = 0;
+
+    operations[0] = IORING_OP_OPENAT;
+    operations[1] = IORING_OP_READ;
+    operations[2] = IORING_OP_WRITE;
+    operations[3] = IORING_OP_CLOSE;
+
+    probe = (struct io_uring_probe *) allocateZeroedMemory(MEMORY_IO, 1, sizeof(struct io_uring_probe) +
+                                                                           256 * sizeof(struct io_uring_probe_op));
+    if (probe == NULL)
+        return false;
+
+    supported = syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, 256) >= 0;
+    for (; supported && i < 4; ++i)
+        supported = operations[i] <= probe->last_op && (probe->ops[operations[i]].flags & IO_URING_OP_SUPPORTED);
+    freeMemory(probe);
+    return supported;
+}
+
+/* Set up an io_uring and map it's rings */
+static void setUpRing(BatchIo *io) {
+    struct io_uring_params params;
+    unsigned char *submissionRing;
+    unsigned char *completionRing;
+    int ringFd;
+
+    memset(&params, 0, sizeof(params));
+    ringFd = (int) syscall(__NR_io_uring_setup, BATCH_IO_ENTRIES, &params);
+    if (ringFd < 0)
+        return;
+    if (!isRingSupported(ringFd)) {
+        close(ringFd);
+        return;
+    }
+
+    io->submissionSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    io->completionSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (io->completionSize > io->submissionSize)
+            io->submissionSize = io->completionSize;
+        io->completionSize = io->submissionSize;
+    }
+    io->entriesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    io->submissionRing = mmap(NULL, io->submissionSize, PROT_READ | PROT_WRITE, MAP_SHARED, ringFd,
+                              IORING_OFF_SQ_RING);
+    if (io->submissionRing == MAP_FAILED) {
+        close(ringFd);
+        return;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        io->completionRing = io->submissionRing;
+    else
+        io->completionRing = mmap(NULL, io->completionSize, PROT_READ | PROT_WRITE, MAP_SHARED, ringFd,
+                                  IORING_OFF_CQ_RING);
+    io->entries = mmap(NULL, io->entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED, ringFd, IORING_OFF_SQES);
+    if (io->completionRing == MAP_FAILED || io->entries == MAP_FAILED) {
+        if (io->entries != MAP_FAILED)
+            munmap(io->entries, io->entriesSize);
+        if (io->completionRing != MAP_FAILED && io->completionRing != io->submissionRing)
+            munmap(io->completionRing, io->completionSize);
+        munmap(io->submissionRing, io->submissionSize);
+        close(ringFd);
+        return;
+    }
+
+    submissionRing = (unsigned char *) io->submissionRing;
+    completionRing = (unsigned char *) io->completionRing;
+    io->submissionHead = (unsigned *) (submissionRing + params.sq_off.head);
+    io->submissionTail = (unsigned *) (submissionRing + params.sq_off.tail);
+    io->submissionMask = (unsigned *) (submissionRing + params.sq_off.ring_mask);
+    io->submissionArray = (unsigned *) (submissionRing + params.sq_off.array);
+    io->completionHead = (unsigned *) (completionRing + params.cq_off.head);
+    io->completionTail = (unsigned *) (completionRing + params.cq_off.tail);
+    io->completionMask = (unsigned *) (completionRing + params.cq_off.ring_mask);
+    io->completions = completionRing + params.cq_off.cqes;
+    io->ringFd = ringFd;
+}
+
+/* Add an entry to the submission queue, the result of the operation is stored at the index of it's file */
+static struct io_uring_sqe *addRingEntry(BatchIo *io, unsigned *tail, int fileIndex, int opCode, int fd) {
+    unsigned index = *tail & *io->submissionMask;
+    struct io_uring_sqe *entry = (struct io_uring_sqe *) io->entries + index;
+
+    memset(entry, 0, sizeof(struct io_uring_sqe));
+    entry->opcode = (unsigned char) opCode;
+    entry->fd = fd;
+    entry->user_data = (unsigned long) fileIndex;
+    io->submissionArray[index] = index;
+    (*tail)++;
+    return entry;
+}
+
+/* Submit the entries which have been added, and wait for all of their completions */
+static void runRing(BatchIo *io, unsigned tail, int count, int *results, int numOfFiles) {
+    int submitted = 0;
+    int completed = 0;
+
+    __atomic_store_n(io->submissionTail, tail, __ATOMIC_RELEASE);
+    while (completed < count) {
+        const struct io_uring_cqe *completions = (const struct io_uring_cqe *) io->completions;
+        unsigned head = *io->completionHead;
+        long entered = syscall(__NR_io_uring_enter, io->ringFd, (unsigned) (count - submitted), 1,
+                               IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if (entered < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            /* The ring is broken, the operations which haven't completed fail */
+            int error = errno;
+            int i = 0;
+            for (; i < numOfFiles; ++i)
+                if (results[i] == BATCH_PENDING)
+                    results[i] = -error;
+            return;
+        }
+        if (entered > 0)
+            submitted += (int) entered;
+
+        /* Reap the completions */
+        while (head != __atomic_load_n(io->completionTail, __ATOMIC_ACQUIRE)) {
+            const struct io_uring_cqe *completion = &completions[head & *io->completionMask];
+            results[completion->user_data] = completion->res;
+            head++;
+            completed++;
+        }
+        __atomic_store_n(io->completionHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+/* Run a step of a batch, an operation for every file index which is flagged in the operations array. Files are
+  opened for writing when there are offsets, which are the number of bytes of every file which have been written */
+static void runRingStep(BatchIo *io, BatchFile *files, int count, int opCode, const int *descriptors,
+                        const int *operations, const int *offsets, int *results) {
+    unsigned tail = *io->submissionTail;
+    int submitted = 0;
+    int i = 0;
+
+    for (; i < count; ++i) {
+        struct io_uring_sqe *entry;
+        BatchFile *file = &files[i];
+
+        results[i] = BATCH_PENDING;
+        if (!operations[i])
+            continue;
+
+        entry = addRingEntry(io, &tail, i, opCode, opCode == IORING_OP_OPENAT ? AT_FDCWD : descriptors[i]);
+        if (opCode == IORING_OP_OPENAT) {
+            entry->addr = (unsigned long) file->path;
+            entry->open_flags = (unsigned) (offsets != NULL ? getWriteFlags(file) : O_RDONLY);
+            entry->len = BATCH_FILE_MODE;
+        } else if (opCode == IORING_OP_READ) {
+            entry->addr = (unsigned long) (file->data + file->size);
+            entry->len = (unsigned) (file->capacity - file->size - 1);
+            entry->off = (unsigned long) file->size;
+        } else if (opCode == IORING_OP_WRITE) {
+            entry->addr = (unsigned long) (file->data + offsets[i]);
+            entry->len = (unsigned) (file->size - offsets[i]);
+            entry->off = file->append && !file->replace ? 0 : (unsigned long) offsets[i];
+        }
+        submitted++;
+    }
+    if (submitted > 0)
+        runRing(io, tail, submitted, results, count);
+}
+
+/* Open the files of a step (for writing when there are offsets), the descriptor of a file which couldn't be opened
+  is -1 */
+static void openRingFiles(BatchIo *io, BatchFile *files, int count, const int *offsets, int *descriptors,
+                          int *results) {
+    int operations[BATCH_IO_ENTRIES] = {0}; /* Every entry is set, also past count */
+    int i = 0;
+
+    for (; i < count; ++i)
+        operations[i] = 1;
+    runRingStep(io, files, count, IORING_OP_OPENAT, NULL, operations, offsets, results);
+    for (i = 0; i < count; ++i) {
+        descriptors[i] = results[i] >= 0 ? results[i] : -1;
+        files[i].status = results[i] >= 0 ? 0 : -results[i];
+    }
+}
+
+/* Close the descriptors of a step */
+static void closeRingFiles(BatchIo *io, BatchFile *files, int count, const int *descriptors, int *results) {
+    int operations[BATCH_IO_ENTRIES] = {0}; /* Every entry is set, also past count */
+    int i = 0;
+
+    for (; i < count; ++i)
+        operations[i] = descriptors[i] >= 0;
+    runRingStep(io, files, count, IORING_OP_CLOSE, descriptors, operations, NULL, results);
+}
+
+/* Read up to BATCH_IO_ENTRIES files through the io_uring */
+static void readFilesWithRing(BatchIo *io, BatchFile *files, int count) {
+    int descriptors[BATCH_IO_ENTRIES];
+    int operations[BATCH_IO_ENTRIES];
+    int results[BATCH_IO_ENTRIES];
+    int numOfReads;
+    int i;
+
+    openRingFiles(io, files, count, NULL, descriptors, results);
+    for (i = 0; i < count; ++i)
+        operations[i] = descriptors[i] >= 0;
+
+    /* Read every file until it's end, a step at a time */
+    do {
+        numOfReads = 0;
+        for (i = 0; i < count; ++i) {
+            if (operations[i] && !growBatchFile(&files[i])) {
+                files[i].status = ENOMEM;
+                operations[i] = 0;
+            }
+            numOfReads += operations[i];
+        }
+        runRingStep(io, files, count, IORING_OP_READ, descriptors, operations, NULL, results);
+        for (i = 0; i < count; ++i) {
+            if (!operations[i])
+                continue;
+            if (results[i] < 0) {
+                files[i].status = -results[i];
+                operations[i] = 0;
+            } else if (results[i] == 0)
+                operations[i] = 0; /* End of the file */
+            else
+                files[i].size += results[i];
+        }
+    } while (numOfReads > 0);
+
+    for (i = 0; i < count; ++i)
+        if (files[i].data != NULL)
+            files[i].data[files[i].size] = '\0';
+    closeRingFiles(io, files, count, descriptors, results);
+}
+
+/* Write up to BATCH_IO_ENTRIES files with different paths through the io_uring */
+static void writeFilesWithRing(BatchIo *io, BatchFile *files, int count) {
+    int descriptors[BATCH_IO_ENTRIES];
+    int operations[BATCH_IO_ENTRIES];
+    int results[BATCH_IO_ENTRIES];
+    int written[BATCH_IO_ENTRIES] = {0}; /* Nothing has been written yet */
+    int numOfWrites;
+    int i;
+
+    openRingFiles(io, files, count, written, descriptors, results);
+    for (i = 0; i < count; ++i)
+        operations[i] = descriptors[i] >= 0 && files[i].size > 0;
+
+    /* Write every file until all of it's content has been written, a step at a time */
+    do {
+        numOfWrites = 0;
+        for (i = 0; i < count; ++i)
+            numOfWrites += operations[i];
+        runRingStep(io, files, count, IORING_OP_WRITE, descriptors, operations, written, results);
+        for (i = 0; i < count; ++i) {
+            if (!operations[i])
+                continue;
+            if (results[i] < 0) {
+                files[i].status = -results[i];
+                operations[i] = 0;
+            } else {
+                written[i] += results[i];
+                operations[i] = written[i] < files[i].size;
+            }
+        }
+    } while (numOfWrites > 0);
+
+    closeRingFiles(io, files, count, descriptors, results);
+    for (i = 0; i < count; ++i)
+        if (descriptors[i] >= 0 && results[i] < 0 && files[i].status == 0)
+            files[i].status = -results[i];
+}
+
+#endif
+
+int openBatchIo(BatchIo *io, int useRing) {
+    memset(io, 0, sizeof(BatchIo));
+    io->ringFd = -1;
+#ifdef BATCH_IO_RING
+    if (useRing)
+        setUpRing(io);
+#endif
+    return io->ringFd >= 0;
+}
+
+void closeBatchIo(BatchIo *io) {
+    if (io->ringFd < 0)
+        return;
+    munmap(io->entries, io->entriesSize);
+    if (io->completionRing != io->submissionRing)
+        munmap(io->completionRing, io->completionSize);
+    munmap(io->submissionRing, io->submissionSize);
+    close(io->ringFd);
+    io->ringFd = -1;
+}
+
+void readFiles(BatchIo *io, BatchFile *files, int count) {
+    int i = 0;
+
+    for (; i < count; ++i) {
+        files[i].size = 0;
+        files[i].status = 0;
+    }
+
+#ifdef BATCH_IO_RING
+    if (io->ringFd >= 0) {
+        for (i = 0; i < count; i += BATCH_IO_ENTRIES)
+            readFilesWithRing(io, files + i, count - i < BATCH_IO_ENTRIES ? count - i : BATCH_IO_ENTRIES);
+        return;
+    }
+#endif
+
+    for (i = 0; i < count; ++i)
+        readFilePlain(&files[i]);
+}
+
+/* Write the files at their paths, in their order */
+static void writeFilesInOrder(BatchIo *io, BatchFile *files, int count) {
+    int start = 0;
+
+#ifdef BATCH_IO_RING
+    if (io->ringFd >= 0) {
+        /* Every step takes files with different paths, so files with the same path are written in their order */
+        while (start < count) {
+            int end = start + 1;
+            int isRepeated = false;
+
+            while (end < count && end - start < BATCH_IO_ENTRIES && !isRepeated) {
+                int i = start;
+                for (; i < end && !isRepeated; ++i)
+                    isRepeated = strcmp(files[i].path, files[end].path) == 0;
+                if (!isRepeated)
+                    end++;
+            }
+            writeFilesWithRing(io, files + start, end - start);
+            start = end;
+        }
+        return;
+    }
+#endif
+
+    for (; start < count; ++start)
+        writeFilePlain(&files[start]);
+}
+
+/* Move the files which are replaced to their temporary files, a file whose temporary path doesn't fit is written
+  in place */
+static void beginReplacing(BatchFile *files, int count) {
+    int i = 0;
+
+    for (; i < count; ++i) {
+        if (!files[i].replace)
+            continue;
+        if (strlen(files[i].path) + strlen(BATCH_REPLACE_ENDING) < MAX_LINE_LENGTH)
+            strcat(files[i].path, BATCH_REPLACE_ENDING);
+        else
+            files[i].replace = false;
+    }
+}
+
+/* Rename the temporary files which have been written whole over the files they replace, and remove the others */
+static void finishReplacing(BatchFile *files, int count) {
+    char temporaryPath[MAX_LINE_LENGTH];
+    int i = 0;
+
+    for (; i < count; ++i) {
+        if (!files[i].replace)
+            continue;
+        strcpy(temporaryPath, files[i].path);
+        files[i].path[strlen(files[i].path) - strlen(BATCH_REPLACE_ENDING)] = '\0';
+        if (files[i].status == 0 && rename(temporaryPath, files[i].path) != 0)
+            files[i].status = errno;
+        if (files[i].status != 0)
+            unlink(temporaryPath);
+    }
+}
+
+void writeFiles(BatchIo *io, BatchFile *files, int count) {
+    beginReplacing(files, count);
+    writeFilesInOrder(io, files, count);
+    finishReplacing(files, count);
+}
@@ -0,0 +1,114 @@
+#ifndef BATCHIO_H
+#define BATCHIO_H
+
+/**
+ * @file batchio.h
+ * @brief Functions to read and write whole files in batches (the --io-uring option).
+ *
+ * Every step of a batch (opening the files, reading/writing them, closing them) is submitted for all the files of
+ * the batch at once through an io_uring, so a batch of files costs a few system calls instead of a few for every
+ * file. The io_uring is set up by raw system calls (no liburing). When it's unavailable (an older kernel, a
+ * kernel which has it disabled, a seccomp filter, another platform), the same batches are done by plain
+ * open/read/write/close calls, one file at a time.
+ */
+
+/**
+ * The number of entries of the io_uring, the largest number of files of a single step.
+ */
+#define BATCH_IO_ENTRIES 64
+
+/**
+ * @struct BatchFile
+ * @brief Structure to represent a whole file to read or write.
+ */
+typedef struct BatchFile {
+    char path[MAX_LINE_LENGTH];   /* The path of the file. */
+    const char *name;             /* The name the file is reported by. */
+    int append;                   /* True to append to the file, false to truncate it (when it's written). */
+    int replace;                  /* True to write a temporary file which is renamed over the file once it's whole. */
+    char *data;                   /* The content of the file. */
+    long size;                    /* The number of bytes of the content. */
+    long capacity;                /* The number of bytes allocated for the content. */
+    int status;                   /* 0 if the file has been read/written, the error number otherwise. */
+} BatchFile;
+
+/**
+ * @struct BatchIo
+ * @brief Structure to represent an io_uring, or it's absence.
+ */
+typedef struct BatchIo {
+    int ringFd;                      /* The file descriptor of the io_uring, -1 for plain system calls. */
+    void *submissionRing;            /* The mapping of the submission queue ring. */
+    void *completionRing;            /* The mapping of the completion queue ring (may be the submission ring). */
+    void *entries;                   /* The mapping of the submission queue entries. */
+    unsigned long submissionSize;    /* The size of the submission queue ring mapping. */
+    unsigned long completionSize;    /* The size of the completion queue ring mapping. */
+    unsigned long entriesSize;       /* The size of the submission queue entries mapping. */
+    unsigned *submissionHead;        /* The head of the submission queue, moved by the kernel. */
+    unsigned *submissionTail;        /* The tail of the submission queue. */
+    unsigned *submissionMask;        /* The mask of an index of the submission queue. */
+    unsigned *submissionArray;       /* The indices of the entries of the submission queue. */
+    unsigned *completionHead;        /* The head of the completion queue. */
+    unsigned *completionTail;        /* The tail of the completion queue, moved by the kernel. */
+    unsigned *completionMask;        /* The mask of an index of the completion queue. */
+    void *completions;               /* The entries of the completion queue. */
+} BatchIo;
+
+/**
+ * @brief Sets up an io_uring, or plain system calls.
+ *
+ * @param io The batch I/O to set up.
+ * @param useRing True to try an io_uring, false for plain system calls.
+ * @return True if an io_uring has been set up, false if plain system calls are used.
+ */
+int openBatchIo(BatchIo *io, int useRing);
+
+/**
+ * @brief Releases an io_uring.
+ *
+ * @param io The batch I/O to release.
+ */
+void closeBatchIo(BatchIo *io);
+
+/**
+ * @brief Reads whole files.
+ *
+ * The content of every file is allocated (null terminated), and it's status is set.
+ *
+ * @param io The batch I/O.
+ * @param files The files, with their paths.
+ * @param count The number of files.
+ */
+void readFiles(BatchIo *io, BatchFile *files, int count);
+
+/**
+ * @brief Writes whole files, created when they don't exist.
+ *
+ * Files with the same path are written in their order. A file which is replaced is written into a temporary file
+ * next to it (it's path with ".tmp" ending) which is renamed over it once it has been written whole, so the file
+ * is never seen half written; it's truncated, whatever it's mode is.
+ *
+ * @param io The batch I/O.
+ * @param files The files, with their paths, contents and modes.
+ * @param count The number of files.
+ */
+void writeFiles(BatchIo *io, BatchFile *files, int count);
+
+/**
+ * @brief Appends bytes to the content of a file.
+ *
+ * @param file The file.
+ * @param data The bytes.
+ * @param size The number of bytes.
+ * @return True if the bytes have been appended, false if memory allocation has been failed.
+ */
+int appendBatchData(BatchFile *file, const char *data, long size);
+
+/**
+ * @brief Frees the content of a file.
+ *
+ * @param file The file.
+ */
+void freeBatchFile(BatchFile *file);
+
+#endif
@@ -0,0 +1,89 @@
+#!/bin/sh
+# End-to-end throughput benchmark of the assembler over generated workloads (see benchgen.c).
+#
+# Usage: ./bench.sh [assembler] [benchgen]
+#   assembler  The assembler to time (default ./assembler).
+#   benchgen   The workload generator (default ./benchgen).
+#
+# Extra options for benchgen can be given in BENCHGEN_OPTIONS, e.g. BENCHGEN_OPTIONS="-l 80 -f 90" ./bench.sh
+# Two curves are reported:
+#   size   one file of a growing number of lines, the time per line grows with a quadratic path
+#   files  a growing number of files of the same size in one run of the assembler
+
+ASSEMBLER=$(cd "$(dirname "${1:-./assembler}")" && pwd)/$(basename "${1:-./assembler}")
+BENCHGEN=$(cd "$(dirname "${2:-./benchgen}")" && pwd)/$(basename "${2:-./benchgen}")
+SIZES="${BENCH_SIZES:-1000 2000 4000 8000 16000}"
+FILES="${BENCH_FILES:-1 2 4 8 16}"
+FILE_LINES="${BENCH_FILE_LINES:-2000}"
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/asm-bench.XXXXXX") || exit 1
+trap 'rm -rf "$WORK"' EXIT
+
+for tool in "$ASSEMBLER" "$BENCHGEN"; do
+    if [ ! -x "$tool" ]; then
+        echo "$tool isn't built, run make first." >&2
+        exit 1
+    fi
+done
+
+# Time a run of the assembler over the given files (without endings), prints the seconds it took
+timeAssembler() {
+    rm -f "$WORK"/*.am "$WORK"/*.ob "$WORK"/*.ent "$WORK"/*.ext
+    start=$(date +%s%N)
+    (cd "$WORK" && "$ASSEMBLER" "$@" > "$WORK/assembler.log") || {
+        echo "The assembler has been failed, see $WORK/assembler.log" >&2
+        exit 1
+    }
+    if grep -q ERROR "$WORK/assembler.log"; then
+        echo "The generated workload has errors:" >&2
+        head -5 "$WORK/assembler.log" >&2
+        exit 1
+    fi
+    end=$(date +%s%N)
+    echo "$start $end" | awk '{ printf "%.4f", ($2 - $1) / 1e9 }'
+}
+
+# Print a row of a curve: label, lines, seconds, lines per second and the time per line relative to the first row
+report() {
+    echo "$1 $2 $3 $FIRST_RATE" | awk '{
+        rate = $3 > 0 ? $2 / $3 : 0
+        relative = $4 > 0 && rate > 0 ? $4 / rate : 1
+        printf "%-12s %10d %10.4f %14.0f %12.2f\n", $1, $2, $3, rate, relative
+    }'
+}
+
+header() {
+    echo
+    echo "$1"
+    printf "%-12s %10s %10s %14s %12s\n" "$2" "lines" "seconds" "lines/second" "time/line"
+}
+
+header "Scaling over the size of one file" "size"
+FIRST_RATE=0
+for size in $SIZES; do
+    "$BENCHGEN" -n "$size" $BENCHGEN_OPTIONS -o "$WORK/size.as" || exit 1
+    lines=$(wc -l < "$WORK/size.as")
+    seconds=$(timeAssembler size) || exit 1
+    report "$size" "$lines" "$seconds"
+    if [ "$FIRST_RATE" = 0 ]; then
+        FIRST_RATE=$(echo "$lines $seconds" | awk '{ printf "%.0f", ($2 > 0 ? $1 / $2 : 0) }')
+    fi
+done
+
+header "Scaling over the number of files of $FILE_LINES lines" "files"
+FIRST_RATE=0
+for count in $FILES; do
+    names=""
+    lines=0
+    i=1
+    while [ "$i" -le "$count" ]; do
+        "$BENCHGEN" -n "$FILE_LINES" -r "$i" $BENCHGEN_OPTIONS -o "$WORK/file$i.as" || exit 1
+        lines=$((lines + $(wc -l < "$WORK/file$i.as")))
+        names="$names file$i"
+        i=$((i + 1))
+    done
+    seconds=$(timeAssembler $names) || exit 1
+    report "$count" "$lines" "$seconds"
+    if [ "$FIRST_RATE" = 0 ]; then
+        FIRST_RATE=$(echo "$lines $seconds" | awk '{ printf "%.0f", ($2 > 0 ? $1 / $2 : 0) }')
+    fi
+done
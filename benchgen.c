@@ -0,0 +1,270 @@
+/**
+ * @file benchgen.c
+ * @details This program generates large, valid assembly source files for benchmarking the assembler.
+ * The output only depends on the options (and the seed), so a workload can be generated again at any time.
+ * @example Run ./benchgen -n 10000 -o big.as                     to generate 10000 statement lines into big.as.
+ * @example Run ./benchgen -n 5000 -l 50 -f 80 -m 20 -x 30 -e 30     to tune the label/reference/macro/symbol mix.
+ *
+ * Options (percentages are of the statement lines, unless told otherwise):
+ *   -n lines       The number of statement lines (default 10000).
+ *   -l percent     Lines which declare a label (default 30).
+ *   -f percent     References to labels which are forward references, of all the label references (default 50).
+ *   -m macros      The number of macros (default 10).
+ *   -b lines       The number of lines of each macro body (default 3, shortened to fit the macro content buffer).
+ *   -c percent     Lines which invoke a macro (default 5).
+ *   -x externs     The number of extern symbols (default 10).
+ *   -u percent     Direct operands which use an extern symbol, of all the direct operands (default 10).
+ *   -e entries     The number of .entry declarations (default 10).
+ *   -d percent     .data lines (default 10).
+ *   -s percent     .string lines (default 5).
+ *   -r seed        The seed of the generator (default 1).
+ *   -o file        The output file (default the standard output).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+
+/**
+ * Kinds of statement lines.
+ */
+#define LINE_INSTRUCTION 0
+#define LINE_DATA 1
+#define LINE_STRING 2
+#define LINE_MACRO 3
+
+/**
+ * The longest macro body, the pre-assembler keeps a macro body in a single line buffer.
+ */
+#define MAX_MACRO_BODY_LENGTH (MAX_LINE_LENGTH - 1)
+
+/* Settings of the workload */
+typedef struct Workload {
+    long lines;
+    int labelPercent;
+    int forwardPercent;
+    int macros;
+    int macroBodyLines;
+    int macroCallPercent;
+    int externs;
+    int externUsePercent;
+    int entries;
+    int dataPercent;
+    int stringPercent;
+    unsigned long seed;
+} Workload;
+
+/* State of the generator, a 32-bit linear congruential generator gives the same output on every platform */
+static unsigned long randomState;
+
+/* Get a random number in the range 0 to limit - 1 */
+static long randomNumber(long limit) {
+    unsigned long value;
+
+    randomState = (randomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    value = (randomState >> 16) & 0x7FFF;
+    randomState = (randomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    value = (value << 15) | ((randomState >> 16) & 0x7FFF);
+    return limit <= 0 ? 0 : (long) (value % (unsigned long) limit);
+}
+
+/* Check a random percentage */
+static int randomPercent(int percent) {
+    return randomNumber(100) < percent;
+}
+
+/* Write a direct operand: a label defined before/after the current line, or an extern symbol */
+static void writeDirectOperand(FILE *file, const Workload *workload, long definedLabels, long totalLabels) {
+    int forward = randomPercent(workload->forwardPercent);
+
+    if (workload->externs > 0 && (totalLabels == 0 || randomPercent(workload->externUsePercent)))
+        fprintf(file, "X%ld", randomNumber(workload->externs));
+    else if ((forward && definedLabels < totalLabels) || definedLabels == 0)
+        fprintf(file, "L%ld", definedLabels + randomNumber(totalLabels - definedLabels));
+    else
+        fprintf(file, "L%ld", randomNumber(definedLabels));
+}
+
+/* Write an operand with one of the given addressing methods */
+static void writeOperand(FILE *file, const Workload *workload, long definedLabels, long totalLabels,
+                         int allowImmediate) {
+    int method = (int) randomNumber(allowImmediate ? 3 : 2);
+    int canBeDirect = totalLabels > 0 || workload->externs > 0;
+
+    if (method == 0 || !canBeDirect)
+        fprintf(file, "@r%ld", randomNumber(8));
+    else if (method == 1)
+        writeDirectOperand(file, workload, definedLabels, totalLabels);
+    else
+        fprintf(file, "%ld", randomNumber(1000) - 500);
+}
+
+/* Write an instruction, with the addressing methods the assembler accepts for it */
+static void writeInstruction(FILE *file, const Workload *workload, long definedLabels, long totalLabels) {
+    const char *twoOperands[] = {"mov", "add", "sub", "cmp"};
+    const char *oneOperand[] = {"not", "clr", "inc", "dec", "jmp", "bne", "red", "jsr", "prn"};
+    long kind = randomNumber(20);
+
+    if (kind < 8) {
+        const char *name = twoOperands[randomNumber(4)];
+        int isCmp = strcmp(name, "cmp") == 0;
+
+        fprintf(file, "%s ", name);
+        writeOperand(file, workload, definedLabels, totalLabels, isCmp);
+        fprintf(file, ", ");
+        writeOperand(file, workload, definedLabels, totalLabels, isCmp);
+    } else if (kind < 19) {
+        const char *name = oneOperand[randomNumber(9)];
+
+        fprintf(file, "%s ", name);
+        writeOperand(file, workload, definedLabels, totalLabels, strcmp(name, "prn") == 0);
+    } else
+        fprintf(file, randomNumber(2) ? "rts" : "stop");
+    fprintf(file, "\n");
+}
+
+/* Write the macro definitions, bodies of register instructions only */
+static void writeMacros(FILE *file, const Workload *workload) {
+    const char *names[] = {"inc", "dec", "clr", "not", "prn"};
+    int i = 0;
+
+    for (; i < workload->macros; ++i) {
+        int length = 0;
+        int j = 0;
+
+        fprintf(file, "mcro m%d\n", i);
+        for (; j < workload->macroBodyLines; ++j) {
+            char line[MAX_LINE_LENGTH];
+
+            if (randomNumber(2))
+                sprintf(line, "%s @r%ld\n", names[randomNumber(5)], randomNumber(8));
+            else
+                sprintf(line, "sub @r%ld, @r%ld\n", randomNumber(8), randomNumber(8));
+            if (length + (int) strlen(line) > MAX_MACRO_BODY_LENGTH)
+                break;
+            fputs(line, file);
+            length += (int) strlen(line);
+        }
+        fprintf(file, "endmcro\n");
+    }
+}
+
+/* Generate the whole workload */
+static int generate(FILE *file, const Workload *workload) {
+    int dataShare = workload->dataPercent, stringShare = workload->stringPercent;
+    int macroShare = workload->macros > 0 ? workload->macroCallPercent : 0;
+    char *kinds = (char *) malloc((size_t) workload->lines + 1);
+    char *labelled = (char *) malloc((size_t) workload->lines + 1);
+    long totalLabels = 0, definedLabels = 0;
+    long i = 0;
+    int j = 0;
+
+    if (kinds == NULL || labelled == NULL) {
+        free(kinds);
+        free(labelled);
+        return false;
+    }
+
+    /* Plan the lines first, so references can go forward to labels which haven't been written yet */
+    randomState = workload->seed;
+    for (; i < workload->lines; ++i) {
+        long kind = randomNumber(100);
+
+        if (kind < dataShare)
+            kinds[i] = LINE_DATA;
+        else if (kind < dataShare + stringShare)
+            kinds[i] = LINE_STRING;
+        else if (kind < dataShare + stringShare + macroShare)
+            kinds[i] = LINE_MACRO;
+        else
+            kinds[i] = LINE_INSTRUCTION;
+        labelled[i] = kinds[i] != LINE_MACRO && randomPercent(workload->labelPercent);
+        totalLabels += labelled[i];
+    }
+
+    fprintf(file, "; Generated by benchgen: %ld lines, seed %lu\n", workload->lines, workload->seed);
+    for (j = 0; j < workload->externs; ++j)
+        fprintf(file, ".extern X%d\n", j);
+    writeMacros(file, workload);
+
+    for (i = 0; i < workload->lines; ++i) {
+        if (labelled[i])
+            fprintf(file, "L%ld: ", definedLabels++);
+
+        if (kinds[i] == LINE_DATA) {
+            long numbers = 1 + randomNumber(6);
+            /* The comma check of the assembler mistakes a first number of 4 characters for a leading comma */
+            fprintf(file, ".data %ld", randomNumber(1000));
+            while (--numbers > 0)
+                fprintf(file, ", %ld", randomNumber(4000) - 2000);
+            fprintf(file, "\n");
+        } else if (kinds[i] == LINE_STRING) {
+            long length = 1 + randomNumber(20);
+            fprintf(file, ".string \"");
+            while (length-- > 0)
+                fputc('a' + (int) randomNumber(26), file);
+            fprintf(file, "\"\n");
+        } else if (kinds[i] == LINE_MACRO)
+            fprintf(file, "m%ld\n", randomNumber(workload->macros));
+        else
+            writeInstruction(file, workload, definedLabels, totalLabels);
+    }
+
+    /* Entry points spread over all the labels */
+    for (j = 0; j < workload->entries && j < totalLabels; ++j)
+        fprintf(file, ".entry L%ld\n", (long) j * totalLabels / (workload->entries < totalLabels ? workload->entries : totalLabels));
+    fprintf(file, "stop\n");
+
+    free(kinds);
+    free(labelled);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    Workload workload = {10000, 30, 50, 10, 3, 5, 10, 10, 10, 10, 5, 1};
+    const char *outputName = NULL;
+    FILE *file = stdout;
+    int status;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        const char *option = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (option[0] != '-' || strlen(option) != 2 || value == NULL) {
+            fprintf(stderr, "Usage: %s [-n lines] [-l %%] [-f %%] [-m macros] [-b lines] [-c %%] [-x externs] [-u %%] "
+                            "[-e entries] [-d %%] [-s %%] [-r seed] [-o file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
+
+        switch (option[1]) {
+            case 'n': workload.lines = strtol(value, NULL, 10); break;
+            case 'l': workload.labelPercent = atoi(value); break;
+            case 'f': workload.forwardPercent = atoi(value); break;
+            case 'm': workload.macros = atoi(value); break;
+            case 'b': workload.macroBodyLines = atoi(value); break;
+            case 'c': workload.macroCallPercent = atoi(value); break;
+            case 'x': workload.externs = atoi(value); break;
+            case 'u': workload.externUsePercent = atoi(value); break;
+            case 'e': workload.entries = atoi(value); break;
+            case 'd': workload.dataPercent = atoi(value); break;
+            case 's': workload.stringPercent = atoi(value); break;
+            case 'r': workload.seed = strtoul(value, NULL, 10); break;
+            case 'o': outputName = value; break;
+            default:
+                fprintf(stderr, "Unknown option %s.\n", option);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (outputName != NULL && (file = fopen(outputName, "w")) == NULL) {
+        fprintf(stderr, "Couldn't open %s.\n", outputName);
+        return EXIT_FAILURE;
+    }
+    status = generate(file, &workload) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (outputName != NULL)
+        fclose(file);
+    return status;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <string.h>
+#include "data.h"
+#include "cfg.h"
+
+/* Check if an instruction ends a basic block */
+static int isBlockEnd(const ProgramLine *programLine) {
+    return programLine->opCode == OPCODE_JMP || programLine->opCode == OPCODE_BNE ||
+           programLine->opCode == OPCODE_JSR || programLine->opCode == OPCODE_RTS ||
+           programLine->opCode == OPCODE_STOP;
+}
+
+/* Check if an instruction jumps to it's destination operand */
+static int isJump(const ProgramLine *programLine) {
+    return programLine->opCode == OPCODE_JMP || programLine->opCode == OPCODE_BNE ||
+           programLine->opCode == OPCODE_JSR;
+}
+
+/* Get the block which starts at a label, or -1 if the label isn't declared by an instruction of the program */
+static int getLabelBlock(const Program *program, const ControlFlowGraph *graph, const char *name) {
+    int line = findProgramLabel(program, name);
+
+    return line == -1 ? -1 : graph->blockOfLine[line];
+}
+
+/* Add a successor to a block */
+static void addSuccessor(BasicBlock *block, int successor) {
+    if (successor != -1 && block->numOfSuccessors < MAX_SUCCESSORS)
+        block->successors[block->numOfSuccessors++] = successor;
+}
+
+int buildControlFlowGraph(const Program *program, ControlFlowGraph *graph) {
+    int previous = -1;
+    int i = 0;
+
+    graph->numOfBlocks = 0;
+    graph->hasIndirectJumps = false;
+    graph->blocks = (BasicBlock *) allocateMemory(MEMORY_OPTIMIZER, (program->numOfLines + 1) * sizeof(BasicBlock));
+    graph->blockOfLine = (int *) allocateMemory(MEMORY_OPTIMIZER, (program->numOfLines + 1) * sizeof(int));
+    if (graph->blocks == NULL || graph->blockOfLine == NULL) {
+        freeControlFlowGraph(graph);
+        return false;
+    }
+
+    /* Split the instructions into blocks, a block starts at a label and after an instruction which ends a block */
+    for (; i < program->numOfLines; ++i) {
+        const ProgramLine *programLine = &program->lines[i];
+
+        graph->blockOfLine[i] = -1;
+        if (programLine->kind != PROGRAM_LINE_INSTRUCTION || programLine->removed)
+            continue;
+
+        if (previous == -1 || programLine->label[0] != '\0' || isBlockEnd(&program->lines[previous])) {
+            BasicBlock *block = &graph->blocks[graph->numOfBlocks++];
+
+            block->first = i;
+            block->numOfSuccessors = 0;
+            block->isReachable = false;
+        }
+        graph->blocks[graph->numOfBlocks - 1].last = i;
+        graph->blockOfLine[i] = graph->numOfBlocks - 1;
+        previous = i;
+    }
+
+    /* Connect every block to the blocks it's last instruction may continue at */
+    for (i = 0; i < graph->numOfBlocks; ++i) {
+        BasicBlock *block = &graph->blocks[i];
+        const ProgramLine *last = &program->lines[block->last];
+        int hasNext = i + 1 < graph->numOfBlocks;
+
+        if (hasNext && last->opCode != OPCODE_JMP && last->opCode != OPCODE_RTS && last->opCode != OPCODE_STOP)
+            addSuccessor(block, i + 1);
+        if (isJump(last)) {
+            if (last->destination.method == METHOD_DIRECT_REGISTER)
+                graph->hasIndirectJumps = true;
+            else /* A label which isn't declared by an instruction (an extern symbol) leaves the program */
+                addSuccessor(block, getLabelBlock(program, graph, last->destination.text));
+        }
+    }
+    return true;
+}
+
+/* Mark the block which starts at a label as an entry */
+static void addEntryBlock(const Program *program, const ControlFlowGraph *graph, const char *name, int *stack,
+                          int *stackSize) {
+    int block = getLabelBlock(program, graph, name);
+
+    if (block != -1 && !graph->blocks[block].isReachable) {
+        graph->blocks[block].isReachable = true;
+        stack[(*stackSize)++] = block;
+    }
+}
+
+int markReachableBlocks(const Program *program, ControlFlowGraph *graph) {
+    int *stack;
+    int stackSize = 0;
+    int i = 0;
+
+    if (graph->numOfBlocks == 0)
+        return true;
+    stack = (int *) allocateMemory(MEMORY_OPTIMIZER, graph->numOfBlocks * sizeof(int));
+    if (stack == NULL)
+        return false;
+
+    /* The program starts at it's first instruction */
+    graph->blocks[0].isReachable = true;
+    stack[stackSize++] = 0;
+
+    for (; i < program->numOfLines; ++i) {
+        const ProgramLine *programLine = &program->lines[i];
+
+        if (programLine->removed)
+            continue;
+        if (programLine->kind == PROGRAM_LINE_ENTRY)
+            addEntryBlock(program, graph, programLine->destination.text, stack, &stackSize);
+        else if (programLine->kind == PROGRAM_LINE_INSTRUCTION) {
+            /* A label whose address is taken, rather than jumped to */
+            if (programLine->source.method == METHOD_DIRECT)
+                addEntryBlock(program, graph, programLine->source.text, stack, &stackSize);
+            if (programLine->destination.method == METHOD_DIRECT && !isJump(programLine))
+                addEntryBlock(program, graph, programLine->destination.text, stack, &stackSize);
+        }
+        if (graph->hasIndirectJumps && programLine->label[0] != '\0')
+            addEntryBlock(program, graph, programLine->label, stack, &stackSize);
+    }
+
+    /* Depth first search from the entries */
+    while (stackSize > 0) {
+        const BasicBlock *block = &graph->blocks[stack[--stackSize]];
+
+        for (i = 0; i < block->numOfSuccessors; ++i) {
+            BasicBlock *successor = &graph->blocks[block->successors[i]];
+
+            if (!successor->isReachable) {
+                successor->isReachable = true;
+                stack[stackSize++] = block->successors[i];
+            }
+        }
+    }
+
+    freeMemory(stack);
+    return true;
+}
+
+void freeControlFlowGraph(ControlFlowGraph *graph) {
+    freeMemory(graph->blocks);
+    freeMemory(graph->blockOfLine);
+    graph->blocks = NULL;
+    graph->blockOfLine = NULL;
+    graph->numOfBlocks = 0;
+}
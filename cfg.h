@@ -0,0 +1,72 @@
+#ifndef CFG_H
+#define CFG_H
+
+/**
+ * @file cfg.h
+ * @brief Definitions and functions related to the control flow graph of a program which is optimized.
+ *
+ * The instructions of a program are split into basic blocks: a block starts at the first instruction, at an
+ * instruction which declares a label, and after a jmp, bne, jsr, rts or stop, and it's executed from it's first
+ * instruction to it's last one. The successors of a block are the blocks it's last instruction may continue at: the
+ * next block (unless it's last instruction is a jmp, rts or stop) and the block of the label of a jmp, bne or jsr.
+ * A jsr continues at the next block as well, once the subroutine returns.
+ */
+
+#include "optimizer.h"
+
+/**
+ * The largest number of successors of a block.
+ */
+#define MAX_SUCCESSORS 2
+
+/**
+ * @struct BasicBlock
+ * @brief Structure to represent a basic block.
+ */
+typedef struct BasicBlock {
+    int first;                          /* The index of the line of the first instruction. */
+    int last;                           /* The index of the line of the last instruction. */
+    int successors[MAX_SUCCESSORS];     /* The indices of the successors. */
+    int numOfSuccessors;                /* The number of successors. */
+    int isReachable;                    /* True if the block is reachable from an entry of the program. */
+} BasicBlock;
+
+/**
+ * @struct ControlFlowGraph
+ * @brief Structure to represent the control flow graph of a program.
+ */
+typedef struct ControlFlowGraph {
+    BasicBlock *blocks;         /* The blocks, in the order of the source. */
+    int numOfBlocks;            /* The number of blocks. */
+    int *blockOfLine;           /* The index of the block of every line, -1 for a line which isn't an instruction. */
+    int hasIndirectJumps;       /* True if a jmp, bne or jsr jumps to an address in a register. */
+} ControlFlowGraph;
+
+/**
+ * @brief Builds the control flow graph of the instructions of a program which haven't been removed.
+ *
+ * @param program The program.
+ * @param graph The graph to build.
+ * @return True if the graph has been built, false if memory allocation has been failed.
+ */
+int buildControlFlowGraph(const Program *program, ControlFlowGraph *graph);
+
+/**
+ * @brief Marks the blocks which are reachable from the entries of a program: the first instruction, the entry
+ * points, and every label which is used as an operand other than the target of a jump (the address of such a label
+ * may be jumped to through a register). When the program jumps through a register, every label is an entry.
+ *
+ * @param program The program.
+ * @param graph The graph of the program.
+ * @return True if the blocks have been marked, false if memory allocation has been failed.
+ */
+int markReachableBlocks(const Program *program, ControlFlowGraph *graph);
+
+/**
+ * @brief Frees a control flow graph.
+ *
+ * @param graph The graph.
+ */
+void freeControlFlowGraph(ControlFlowGraph *graph);
+
+#endif
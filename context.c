@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "context.h"
+
+void initAssemblerContext(AssemblerContext *context) {
+    memset(context, 0, sizeof(AssemblerContext));
+    context->address = INITIAL_ADDRESS_VALUE;
+    context->relocationTable.lastAddress = INITIAL_ADDRESS_VALUE;
+}
+
+void freeAssemblerContext(AssemblerContext *context) {
+    freeSymbolTable(context);
+    freeExternSymbolTable(context);
+    freeCodeImage(&context->codeImage);
+    freeCodeImage(&context->dataImage);
+    freeRelocationTable(&context->relocationTable);
+    freeMemory(context->diagnostics);
+    context->diagnostics = NULL;
+    context->numOfDiagnostics = 0;
+    context->diagnosticsCapacity = 0;
+}
+
+char *nextToken(AssemblerContext *context, char *line, const char *delimiters) {
+    char *token;
+
+    if (line == NULL)
+        line = context->tokenPosition;
+    if (line == NULL)
+        return NULL;
+
+    /* Skip the delimiters before the token */
+    line += strspn(line, delimiters);
+    if (*line == '\0') {
+        context->tokenPosition = line;
+        return NULL;
+    }
+
+    /* Cut the token at the first delimiter after it, and continue after that delimiter next time */
+    token = line;
+    line += strcspn(line, delimiters);
+    if (*line != '\0')
+        *line++ = '\0';
+    context->tokenPosition = line;
+    return token;
+}
+
+void addDiagnostic(AssemblerContext *context, int code, const char *text) {
+    AssemblerDiagnostic *diagnostic;
+
+    if (context->numOfDiagnostics == context->diagnosticsCapacity) {
+        int newCapacity = context->diagnosticsCapacity == 0 ? 8 : context->diagnosticsCapacity * 2;
+        AssemblerDiagnostic *newDiagnostics = (AssemblerDiagnostic *) reallocateMemory(MEMORY_DIAGNOSTICS,
+                context->diagnostics, newCapacity * sizeof(AssemblerDiagnostic));
+
+        /* The error is still notated by the errorFlag */
+        if (newDiagnostics == NULL)
+            return;
+        context->diagnostics = newDiagnostics;
+        context->diagnosticsCapacity = newCapacity;
+    }
+
+    diagnostic = &context->diagnostics[context->numOfDiagnostics++];
+    diagnostic->line = context->lineNum;
+    diagnostic->code = code;
+    strncpy(diagnostic->text, text != NULL ? text : "", MAX_LINE_LENGTH);
+    diagnostic->text[MAX_LINE_LENGTH] = '\0';
+}
+
+void initSourceReader(SourceReader *reader, const char *text, long size) {
+    reader->text = text;
+    reader->size = size;
+    reader->position = 0;
+}
+
+int readSourceLine(SourceReader *reader, char *line, int size) {
+    int length = 0;
+
+    if (reader->position >= reader->size || size <= 1)
+        return false;
+
+    while (length < size - 1 && reader->position < reader->size) {
+        char c = reader->text[reader->position++];
+        line[length++] = c;
+        if (c == '\n')
+            break;
+    }
+    line[length] = '\0';
+    return true;
+}
+
+int appendText(TextBuffer *buffer, const char *text) {
+    long length = (long) strlen(text);
+
+    if (buffer->size + length + 1 > buffer->capacity) {
+        long newCapacity = buffer->capacity == 0 ? 1024 : buffer->capacity;
+        char *newText;
+
+        while (buffer->size + length + 1 > newCapacity)
+            newCapacity *= 2;
+        newText = (char *) reallocateMemory(MEMORY_MACROS, buffer->text, (size_t) newCapacity);
+        if (newText == NULL)
+            return false;
+        buffer->text = newText;
+        buffer->capacity = newCapacity;
+    }
+
+    memcpy(buffer->text + buffer->size, text, (size_t) length + 1);
+    buffer->size += length;
+    return true;
+}
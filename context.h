@@ -0,0 +1,146 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+/**
+ * @file context.h
+ * @brief Definitions and functions related to the state of assembling a single source.
+ *
+ * Every piece of state of the assembler (the counters, the flags, the symbol tables, the code/data images, the
+ * relocation table, the position of the tokenizer and the diagnostics) is kept in an AssemblerContext, which is
+ * passed to every function explicitly. Sources which are assembled with different contexts don't share anything,
+ * so they can be assembled from several threads at once.
+ */
+
+/**
+ * Represents the state of assembling a source.
+ */
+typedef struct AssemblerContext AssemblerContext;
+
+#include "machinecode.h"
+#include "relocation.h"
+
+/**
+ * Code of a diagnostic which isn't an error, it's text is the whole message.
+ */
+#define DIAGNOSTIC_NOTE 0
+
+/**
+ * @struct AssemblerDiagnostic
+ * @brief Structure to represent an error (or a note) which has been found in a source.
+ */
+typedef struct AssemblerDiagnostic {
+    int line;                           /* The number of the line the error has been found at. */
+    int code;                           /* The error code (see getErrorMessage), or DIAGNOSTIC_NOTE. */
+    char text[MAX_LINE_LENGTH + 1];     /* The line the error has been found at, or the message of a note. */
+} AssemblerDiagnostic;
+
+/**
+ * @struct SourceReader
+ * @brief Structure to represent a sequential reader of the lines of a source held in memory.
+ */
+typedef struct SourceReader {
+    const char *text;   /* The source. */
+    long size;          /* The number of characters of the source. */
+    long position;      /* The position of the next character to read. */
+} SourceReader;
+
+/**
+ * @struct TextBuffer
+ * @brief Structure to represent a growable text, such as the source after macro spanning.
+ */
+typedef struct TextBuffer {
+    char *text;         /* The text, null terminated. */
+    long size;          /* The number of characters of the text. */
+    long capacity;      /* The number of characters allocated. */
+} TextBuffer;
+
+/**
+ * @struct AssemblerContext
+ * @brief Structure to represent the state of assembling a source.
+ */
+struct AssemblerContext {
+    int address;                          /* The instruction counter of the code image. */
+    int dataCounter;                      /* The index of the next word in the data image. */
+    int lineNum;                          /* The number of the current line. */
+    int firstLineNum;                     /* The number of the line before the first line of the passes. */
+    int directFlag;                       /* Set when a line is processed directly by processDirective/Instruction. */
+    int endFirstPassFlag;                 /* Set at the end of the first pass. */
+    int errorFlag;                        /* Set when at least one error has been found. */
+    struct Symbol *symbolTable;           /* The symbols, in the order they have been declared. */
+    struct Symbol *externSymbolTable;     /* The uses of the extern symbols, in the order of the extern file. */
+    CodeImage codeImage;                  /* The instruction words. */
+    CodeImage dataImage;                  /* The data words. */
+    RelocationTable relocationTable;      /* The words which hold an address. */
+    char *tokenPosition;                  /* Where the tokenizer continues from, like the state of strtok. */
+    const char *sourcePath;               /* The path of the source, the included files are relative to it. */
+    const char *macroCacheDirectory;      /* Where the precompiled macro libraries are kept, NULL for none. */
+    int includeDepth;                     /* The number of .include directives the source is included through. */
+    AssemblerDiagnostic *diagnostics;     /* The errors which have been found. */
+    int numOfDiagnostics;                 /* The number of diagnostics. */
+    int diagnosticsCapacity;              /* The number of diagnostics allocated. */
+};
+
+/**
+ * @brief Initializes a context for assembling a new source.
+ *
+ * @param context The context to initialize.
+ */
+void initAssemblerContext(AssemblerContext *context);
+
+/**
+ * @brief Frees the memory used by a context, the tables, the images and the diagnostics.
+ *
+ * @param context The context to be freed.
+ */
+void freeAssemblerContext(AssemblerContext *context);
+
+/**
+ * @brief Splits a line into tokens, exactly like strtok but with it's position kept in the context.
+ *
+ * @param context The context which keeps the position of the tokenizer.
+ * @param line The line to start tokenizing, or NULL to continue from the last token.
+ * @param delimiters The characters which separate tokens.
+ * @return The next token, or NULL if there are no tokens left.
+ */
+char *nextToken(AssemblerContext *context, char *line, const char *delimiters);
+
+/**
+ * @brief Records a diagnostic.
+ *
+ * @param context The context of the source.
+ * @param code The error code, or DIAGNOSTIC_NOTE.
+ * @param text The line the error has been found at, or the message of a note (truncated to MAX_LINE_LENGTH).
+ */
+void addDiagnostic(AssemblerContext *context, int code, const char *text);
+
+/**
+ * @brief Initializes a reader of a source held in memory.
+ *
+ * @param reader The reader to initialize.
+ * @param text The source.
+ * @param size The number of characters of the source.
+ */
+void initSourceReader(SourceReader *reader, const char *text, long size);
+
+/**
+ * @brief Reads the next line of a source, exactly like fgets.
+ *
+ * At most size - 1 characters are read, and reading stops after a new line character.
+ *
+ * @param reader The reader.
+ * @param line The buffer to read the line into, null terminated.
+ * @param size The size of the buffer.
+ * @return True if a line has been read, false at the end of the source.
+ */
+int readSourceLine(SourceReader *reader, char *line, int size);
+
+/**
+ * @brief Appends a string to a text.
+ *
+ * @param buffer The text.
+ * @param text The string to append.
+ * @return True if the string has been appended, false if memory allocation has been failed.
+ */
+int appendText(TextBuffer *buffer, const char *text);
+
+#endif
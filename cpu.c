@@ -0,0 +1,222 @@
+#include <limits.h>
+#include "data.h"
+#include "decoder.h"
+#include "cpu.h"
+
+/* Sentinel entries after the last address, so running past the end of the memory stops at an invalid entry */
+#define CPU_SENTINELS 3
+
+/* The sign bit of a word (0x800 on the classic machine) */
+#define SIGN_BIT (1L << (ISA_WORD_BITS - 1))
+
+/* Wrap a number into the range of a word in Two's complement notation */
+#define WRAP_WORD(value) ((int) ((((value) + SIGN_BIT) & (long) ISA_WORD_MASK) - SIGN_BIT))
+
+/* Get the storage of an operand, or NULL if it can't be accessed */
+static int *resolveOperand(Cpu *cpu, const DecodedOperand *operand, int *constant) {
+    if (operand->addressingMethod == METHOD_IMMEDIATE) {
+        *constant = operand->value;
+        return constant;
+    }
+    if (operand->addressingMethod == METHOD_DIRECT)
+        return operand->value < CPU_MEMORY_SIZE ? &cpu->memory[operand->value] : NULL;
+    if (operand->addressingMethod == METHOD_DIRECT_REGISTER)
+        return operand->value < CPU_NUM_OF_REGISTERS ? &cpu->registers[operand->value] : NULL;
+    return constant; /* A missing operand */
+}
+
+/* Decode the instruction at an address into it's entry, an entry which can't be decoded is an invalid entry */
+static void threadInstruction(Cpu *cpu, const unsigned int *words, int numOfWords, int index) {
+    ThreadedInstruction *entry = &cpu->program[INITIAL_ADDRESS_VALUE + index];
+    DecodedInstruction decoded;
+    int length = decodeInstruction(words + index, numOfWords - index, &decoded);
+
+    if (length == 0)
+        return;
+
+    entry->operation = decoded.instruction->code;
+    entry->next = entry + length;
+    entry->source = resolveOperand(cpu, &decoded.source, &entry->sourceValue);
+    entry->destination = resolveOperand(cpu, &decoded.destination, &entry->destinationValue);
+
+    /* lea takes the address of it's source operand, not it's value */
+    if (strcmp(decoded.instruction->name, "lea") == 0) {
+        entry->sourceValue = decoded.source.value;
+        entry->source = &entry->sourceValue;
+    }
+
+    /* A jump to a label goes straight to the entry of it's address */
+    if ((strcmp(decoded.instruction->name, "jmp") == 0 || strcmp(decoded.instruction->name, "bne") == 0 ||
+         strcmp(decoded.instruction->name, "jsr") == 0) && decoded.destination.addressingMethod == METHOD_DIRECT)
+        entry->target = decoded.destination.value < CPU_MEMORY_SIZE ? &cpu->program[decoded.destination.value]
+                                                                    : &cpu->program[CPU_MEMORY_SIZE];
+
+    if (entry->source == NULL || entry->destination == NULL)
+        entry->operation = CPU_OPERATION_INVALID;
+}
+
+int loadCpu(Cpu *cpu, const unsigned int *words, int numOfWords) {
+    int i = 0;
+
+    if (INITIAL_ADDRESS_VALUE + numOfWords > CPU_MEMORY_SIZE)
+        return false;
+    cpu->program = (ThreadedInstruction *) allocateZeroedMemory(MEMORY_TOOLS, CPU_MEMORY_SIZE + CPU_SENTINELS,
+                                                                sizeof(ThreadedInstruction));
+    if (cpu->program == NULL)
+        return false;
+
+    memset(cpu->memory, 0, sizeof(cpu->memory));
+    memset(cpu->registers, 0, sizeof(cpu->registers));
+    for (; i < CPU_MEMORY_SIZE + CPU_SENTINELS; ++i)
+        cpu->program[i].operation = CPU_OPERATION_INVALID;
+    for (i = 0; i < numOfWords; ++i)
+        cpu->memory[INITIAL_ADDRESS_VALUE + i] = decodeDataWord(words[i]);
+
+    /* Every word is decoded once, a jump into the middle of an instruction runs whatever the word decodes to */
+    for (i = 0; i < numOfWords; ++i)
+        threadInstruction(cpu, words, numOfWords, i);
+
+    cpu->zeroFlag = 0;
+    cpu->pc = &cpu->program[INITIAL_ADDRESS_VALUE];
+    cpu->stackSize = 0;
+    cpu->executed = 0;
+    return true;
+}
+
+/* Get the entry a jump through a register goes to */
+static ThreadedInstruction *jumpTarget(Cpu *cpu, const ThreadedInstruction *entry) {
+    if (entry->target != NULL)
+        return entry->target;
+    if (*entry->destination < 0 || *entry->destination >= CPU_MEMORY_SIZE)
+        return &cpu->program[CPU_MEMORY_SIZE]; /* An invalid sentinel entry */
+    return &cpu->program[*entry->destination];
+}
+
+/*
+ * The operations are written once, and dispatched either by jumping straight to the code of the next entry
+ * (direct threading, with the labels as values extension of GCC), or by a switch over the operation
+ * (other compilers, or when CPU_SWITCH_DISPATCH is defined).
+ */
+#if defined(__GNUC__) && !defined(CPU_SWITCH_DISPATCH)
+#define CPU_DIRECT_THREADING
+#endif
+
+#ifdef CPU_DIRECT_THREADING
+#define OPERATION(name, code) operation_##name:
+#define NEXT(entry) pc = (entry); if (remaining-- == 0) goto outOfBudget; goto *pc->handler
+#else
+#define OPERATION(name, code) case code:
+#define NEXT(entry) pc = (entry); continue
+#endif
+
+int runCpu(Cpu *cpu, unsigned long budget) {
+    ThreadedInstruction *pc = cpu->pc;
+    unsigned long remaining = budget == 0 ? ULONG_MAX : budget;
+    int status;
+    int value;
+#ifdef CPU_DIRECT_THREADING
+    static const void *handlers[INSTRUCTIONS_LENGTH + 1] = {
+            &&operation_mov, &&operation_cmp, &&operation_add, &&operation_sub, &&operation_not, &&operation_clr,
+            &&operation_lea, &&operation_inc, &&operation_dec, &&operation_jmp, &&operation_bne, &&operation_red,
+            &&operation_prn, &&operation_jsr, &&operation_rts, &&operation_stop, &&operation_invalid
+    };
+    int i = 0;
+
+    /* Thread the entries to the code of their operations */
+    for (; i < CPU_MEMORY_SIZE + CPU_SENTINELS; ++i)
+        cpu->program[i].handler = handlers[cpu->program[i].operation];
+
+    NEXT(pc);
+#else
+    for (;;) {
+        if (remaining-- == 0)
+            goto outOfBudget;
+        switch (pc->operation) {
+#endif
+    OPERATION(mov, 0)
+        *pc->destination = *pc->source;
+        NEXT(pc->next);
+    OPERATION(cmp, 1)
+        cpu->zeroFlag = *pc->source == *pc->destination;
+        NEXT(pc->next);
+    OPERATION(add, 2)
+        *pc->destination = WRAP_WORD(*pc->destination + *pc->source);
+        NEXT(pc->next);
+    OPERATION(sub, 3)
+        *pc->destination = WRAP_WORD(*pc->destination - *pc->source);
+        NEXT(pc->next);
+    OPERATION(not, 4)
+        *pc->destination = ~*pc->destination;
+        NEXT(pc->next);
+    OPERATION(clr, 5)
+        *pc->destination = 0;
+        NEXT(pc->next);
+    OPERATION(lea, 6)
+        *pc->destination = *pc->source;
+        NEXT(pc->next);
+    OPERATION(inc, 7)
+        *pc->destination = WRAP_WORD(*pc->destination + 1);
+        NEXT(pc->next);
+    OPERATION(dec, 8)
+        *pc->destination = WRAP_WORD(*pc->destination - 1);
+        NEXT(pc->next);
+    OPERATION(jmp, 9)
+        NEXT(jumpTarget(cpu, pc));
+    OPERATION(bne, 10)
+        NEXT(cpu->zeroFlag ? pc->next : jumpTarget(cpu, pc));
+    OPERATION(red, 11)
+        value = getchar();
+        *pc->destination = value == EOF ? -1 : WRAP_WORD(value);
+        NEXT(pc->next);
+    OPERATION(prn, 12)
+        printf("%d\n", *pc->destination);
+        NEXT(pc->next);
+    OPERATION(jsr, 13)
+        if (cpu->stackSize == CPU_STACK_SIZE) {
+            status = CPU_STACK_OVERFLOW;
+            goto stopped;
+        }
+        cpu->stack[cpu->stackSize++] = pc->next;
+        NEXT(jumpTarget(cpu, pc));
+    OPERATION(rts, 14)
+        if (cpu->stackSize == 0) {
+            status = CPU_STACK_UNDERFLOW;
+            goto stopped;
+        }
+        NEXT(cpu->stack[--cpu->stackSize]);
+    OPERATION(stop, 15)
+        status = CPU_STOPPED;
+        goto stopped;
+    OPERATION(invalid, CPU_OPERATION_INVALID)
+        status = CPU_INVALID_INSTRUCTION;
+        goto stopped;
+#ifndef CPU_DIRECT_THREADING
+        }
+    }
+#endif
+
+outOfBudget:
+    /* The budget ran out before the instruction pc points to */
+    cpu->pc = pc;
+    cpu->executed += budget;
+    return CPU_OUT_OF_BUDGET;
+
+stopped:
+    /* pc points to the instruction which has stopped the program, it's counted only if it's stop */
+    cpu->pc = pc;
+    cpu->executed += (budget == 0 ? ULONG_MAX : budget) - remaining - (status == CPU_STOPPED ? 0 : 1);
+    return status;
+}
+
+#undef OPERATION
+#undef NEXT
+
+int getCpuAddress(const Cpu *cpu) {
+    return (int) (cpu->pc - cpu->program);
+}
+
+void freeCpu(Cpu *cpu) {
+    freeMemory(cpu->program);
+    cpu->program = NULL;
+    cpu->pc = NULL;
+}
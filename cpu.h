@@ -0,0 +1,117 @@
+#ifndef CPU_H
+#define CPU_H
+
+/**
+ * @file cpu.h
+ * @brief Definitions and functions related to simulating the machine the assembler produces code for.
+ *
+ * Every word of the image is decoded once when it's loaded, into a threaded code array with an entry for every
+ * address: the operation, pointers to the storage of it's operands (a register, a memory word, or a constant of
+ * the entry itself) and the entry to jump to. Running a program is then a direct dispatch from an entry to the
+ * next, without decoding any word again (writing over an instruction word doesn't change the instruction).
+ *
+ * The machine has ISA_NUM_OF_REGISTERS registers of ISA_WORD_BITS bits (8 of 12 bits on the classic machine, see
+ * isa.h), a flag which is set by cmp when both operands are equal, and a
+ * return stack of it's own for jsr/rts. red reads a character from the standard input into it's operand
+ * (-1 at the end of the input), and prn writes it's operand as a number on a line of it's own.
+ */
+
+/**
+ * The number of words of the memory, every address a direct operand can hold (1024 words on the classic machine),
+ * but 64K words at most. A direct operand above the memory makes an invalid instruction.
+ */
+#if ISA_MAX_OPERAND_ADDRESS < 65536
+#define CPU_MEMORY_SIZE ((int) ISA_MAX_OPERAND_ADDRESS + 1)
+#else
+#define CPU_MEMORY_SIZE 65536
+#endif
+
+/**
+ * The number of registers.
+ */
+#define CPU_NUM_OF_REGISTERS ISA_NUM_OF_REGISTERS
+
+/**
+ * The depth of the return stack.
+ */
+#define CPU_STACK_SIZE 1024
+
+/**
+ * Operation of an entry which isn't the first word of a valid instruction.
+ */
+#define CPU_OPERATION_INVALID INSTRUCTIONS_LENGTH
+
+/**
+ * The reasons a program stops running.
+ */
+#define CPU_STOPPED 0
+#define CPU_OUT_OF_BUDGET 1
+#define CPU_INVALID_INSTRUCTION 2
+#define CPU_STACK_OVERFLOW 3
+#define CPU_STACK_UNDERFLOW 4
+
+/**
+ * @struct ThreadedInstruction
+ * @brief Structure to represent an entry of the threaded code array, the instruction at an address.
+ */
+typedef struct ThreadedInstruction {
+    const void *handler;                  /* The code running the operation (with direct threading). */
+    int operation;                        /* The opcode, or CPU_OPERATION_INVALID. */
+    int *source;                          /* The storage of the source operand. */
+    int *destination;                     /* The storage of the destination operand. */
+    struct ThreadedInstruction *target;   /* The entry a direct jump goes to, NULL for a jump through a register. */
+    struct ThreadedInstruction *next;     /* The entry of the instruction which follows. */
+    int sourceValue;                      /* The constant of an immediate source operand/the address of lea. */
+    int destinationValue;                 /* The constant of an immediate destination operand. */
+} ThreadedInstruction;
+
+/**
+ * @struct Cpu
+ * @brief Structure to represent the state of the simulated machine.
+ */
+typedef struct Cpu {
+    int memory[CPU_MEMORY_SIZE];                      /* The memory words, as signed numbers. */
+    int registers[CPU_NUM_OF_REGISTERS];              /* The registers, as signed numbers. */
+    int zeroFlag;                                     /* Set by cmp when both operands are equal. */
+    ThreadedInstruction *program;                     /* An entry for every address, and sentinels after the last. */
+    ThreadedInstruction *pc;                          /* The entry of the next instruction. */
+    ThreadedInstruction *stack[CPU_STACK_SIZE];       /* The return addresses of jsr. */
+    int stackSize;                                    /* The number of return addresses. */
+    unsigned long executed;                           /* The number of instructions that have been run. */
+} Cpu;
+
+/**
+ * @brief Loads an image into the memory at INITIAL_ADDRESS_VALUE and decodes it into the threaded code array.
+ *
+ * @param cpu The machine to load into.
+ * @param words The words of the image.
+ * @param numOfWords The number of words of the image.
+ * @return True if the image has been loaded, false if it doesn't fit in the memory or memory allocation has been failed.
+ */
+int loadCpu(Cpu *cpu, const unsigned int *words, int numOfWords);
+
+/**
+ * @brief Runs the loaded program from the current instruction.
+ *
+ * @param cpu The machine to run.
+ * @param budget The maximal number of instructions to run, 0 for no limit.
+ * @return The reason the program has stopped (CPU_STOPPED, CPU_OUT_OF_BUDGET, ...).
+ */
+int runCpu(Cpu *cpu, unsigned long budget);
+
+/**
+ * @brief Gets the address of the next instruction.
+ *
+ * @param cpu The machine.
+ * @return The address of the next instruction.
+ */
+int getCpuAddress(const Cpu *cpu);
+
+/**
+ * @brief Frees the memory used by a machine.
+ *
+ * @param cpu The machine to be freed.
+ */
+void freeCpu(Cpu *cpu);
+
+#endif
@@ -1,74 +1,101 @@
-#ifndef DATA_H
-#define DATA_H
-
-/**
- * @file data.h
- * @brief Definitions of constant macros to facilitate maintaining the project more clearly.
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "analyze.h"
-#include "macro.h"
-#include "instructions.h"
-#include "symbols.h"
-#include "machinecode.h"
-#include "utilities.h"
-
-/**
- * Valid line length.
- */
-#define MAX_LINE_LENGTH 80
-
-/**
- * Valid macro name length.
- */
-#define MAX_MACRO_NAME_LENGTH 20
-
-/**
- * Valid label length.
- */
-#define MAX_LABEL_LENGTH 31
-
-/**
- * Length of instructions table.
- */
-#define INSTRUCTIONS_LENGTH 16
-
-/**
- * Initial value of address in the memory.
- */
-#define INITIAL_ADDRESS_VALUE 100
-
-/**
- * Length of available machine code in the memory.
- */
-#define MAX_CODE_WORD_TABLE_SIZE 1024
-
-/**
- * Mark 1 as true.
- */
-#define true 1
-
-/**
- * Mark 0 as false .
- */
-#define false 0
-
-/**
- * Immediate addressing mark.
- */
-#define METHOD_IMMEDIATE 1
-
-/**
- * Direct addressing mark.
- */
-#define METHOD_DIRECT 3
-
-/**
- * Direct register addressing mark.
- */
-#define METHOD_DIRECT_REGISTER 5
-
-#endif
+#ifndef DATA_H
+#define DATA_H
+
+/**
+ * @file data.h
+ * @brief Definitions of constant macros to facilitate maintaining the project more clearly.
+ */
+
+#include "isa.h"
+
+/**
+ * Valid line length.
+ */
+#define MAX_LINE_LENGTH 80
+
+/**
+ * Valid macro name length.
+ */
+#define MAX_MACRO_NAME_LENGTH 20
+
+/**
+ * Valid label length.
+ */
+#define MAX_LABEL_LENGTH 31
+
+/**
+ * Length of instructions table.
+ */
+#define INSTRUCTIONS_LENGTH 16
+
+/**
+ * Initial value of address in the memory (100 on the classic machine, see isa.h).
+ */
+#define INITIAL_ADDRESS_VALUE ISA_BASE_ADDRESS
+
+/**
+ * Number of machine code words held by a single chunk of a code image.
+ */
+#define CODE_IMAGE_CHUNK_SIZE 256
+
+/**
+ * Number of bytes of a chunk of a code image, two 12-bit words are packed in 3 bytes, wider words take whole bytes.
+ */
+#if ISA_WORD_BITS == 12
+#define CODE_IMAGE_CHUNK_BYTES (CODE_IMAGE_CHUNK_SIZE / 2 * 3)
+#else
+#define CODE_IMAGE_CHUNK_BYTES (CODE_IMAGE_CHUNK_SIZE * ISA_WORD_BYTES)
+#endif
+
+/**
+ * Number of words encoded/emitted at a time when a code image is processed in blocks.
+ */
+#define CODE_IMAGE_BLOCK_SIZE 64
+
+/**
+ * Mark 1 as true.
+ */
+#define true 1
+
+/**
+ * Mark 0 as false .
+ */
+#define false 0
+
+/**
+ * Mark of a missing operand.
+ */
+#define METHOD_NONE 0
+
+/**
+ * Immediate addressing mark.
+ */
+#define METHOD_IMMEDIATE 1
+
+/**
+ * Direct addressing mark.
+ */
+#define METHOD_DIRECT 3
+
+/**
+ * Direct register addressing mark.
+ */
+#define METHOD_DIRECT_REGISTER 5
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "context.h"
+#include "analyze.h"
+#include "macro.h"
+#include "macrolib.h"
+#include "instructions.h"
+#include "symbols.h"
+#include "machinecode.h"
+#include "utilities.h"
+#include "relocation.h"
+#include "stats.h"
+#include "allocator.h"
+#include "trace.h"
+
+#endif
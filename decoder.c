@@ -0,0 +1,122 @@
+#include "data.h"
+#include "decoder.h"
+
+/* The mask of a register field of a register word */
+#define REGISTER_MASK ((1U << ISA_REGISTER_BITS) - 1)
+
+/* The index in the instructions table of every first word, -1 for a word which isn't a first word */
+static signed char instructionIndexTable[DECODER_TABLE_SIZE];
+static int instructionIndexTableFlag = 0; /* The table has been built */
+
+/* Build the table of first words from every opcode and every addressing method it's operands can have */
+static void buildInstructionIndexTable() {
+    const int methods[] = {METHOD_IMMEDIATE, METHOD_DIRECT, METHOD_DIRECT_REGISTER};
+    int i = 0;
+
+    memset(instructionIndexTable, -1, sizeof(instructionIndexTable));
+    for (; i < INSTRUCTIONS_LENGTH; ++i) {
+        const Instruction *instruction = &instructionsTable[i];
+        int src, dest;
+
+        /* A missing operand has no addressing method (0), an instruction with 1 operand has a destination operand */
+        for (src = 0; src < (instruction->numOfOperands == 2 ? 3 : 1); ++src) {
+            for (dest = 0; dest < (instruction->numOfOperands >= 1 ? 3 : 1); ++dest) {
+                int srcMethod = instruction->numOfOperands == 2 ? methods[src] : 0;
+                int destMethod = instruction->numOfOperands >= 1 ? methods[dest] : 0;
+                instructionIndexTable[generateBinaryCode(destMethod, instruction->code, srcMethod)] = (signed char) i;
+            }
+        }
+    }
+    instructionIndexTableFlag = 1;
+}
+
+int decodeDataWord(unsigned int word) {
+    /* The top bit of the word (bit 11 of a 12-bit word) is the sign bit of the Two's complement notation */
+    word &= ISA_WORD_MASK;
+    return (word >> (ISA_WORD_BITS - 1)) ? (int) word - (int) (1L << ISA_WORD_BITS) : (int) word;
+}
+
+/* Decode an operand word which doesn't share it's word with another operand */
+static void decodeOperandWord(unsigned int word, int isSource, DecodedOperand *operand) {
+    if (operand->addressingMethod == METHOD_IMMEDIATE)
+        operand->value = decodeDataWord(word);
+    else if (operand->addressingMethod == METHOD_DIRECT) {
+        operand->value = (int) ((word >> 2) & ISA_MAX_OPERAND_ADDRESS);
+        operand->type = (int) word & 0x3;
+    } else /* The destination register takes the field above the ARE bits, the source register the field above it */
+        operand->value = (int) ((isSource ? word >> (2 + ISA_REGISTER_BITS) : word >> 2) & REGISTER_MASK);
+}
+
+int decodeInstruction(const unsigned int *words, int numOfWords, DecodedInstruction *decoded) {
+    int index, next = 1;
+
+    if (!instructionIndexTableFlag)
+        buildInstructionIndexTable();
+    if (numOfWords < 1 || words[0] >= DECODER_TABLE_SIZE || (index = instructionIndexTable[words[0]]) < 0)
+        return 0;
+
+    decoded->instruction = &instructionsTable[index];
+    decoded->source.addressingMethod = (int) (words[0] >> 9) & 0x7;
+    decoded->destination.addressingMethod = (int) (words[0] >> 2) & 0x7;
+    decoded->source.value = decoded->destination.value = 0;
+    decoded->source.type = decoded->destination.type = 0;
+    decoded->length = getInstructionLength(words[0]);
+    if (decoded->length > numOfWords)
+        return 0;
+
+    /* Two registers share a single word */
+    if (decoded->source.addressingMethod == METHOD_DIRECT_REGISTER &&
+        decoded->destination.addressingMethod == METHOD_DIRECT_REGISTER) {
+        decoded->source.value = (int) ((words[1] >> (2 + ISA_REGISTER_BITS)) & REGISTER_MASK);
+        decoded->destination.value = (int) ((words[1] >> 2) & REGISTER_MASK);
+        return decoded->length;
+    }
+
+    /* A word for the source operand, then a word for the destination operand */
+    if (decoded->source.addressingMethod != 0)
+        decodeOperandWord(words[next++], true, &decoded->source);
+    if (decoded->destination.addressingMethod != 0)
+        decodeOperandWord(words[next], false, &decoded->destination);
+    return decoded->length;
+}
+
+/* Encode an operand word which doesn't share it's word with another operand */
+static unsigned int encodeOperandWord(const DecodedOperand *operand, int isSource) {
+    if (operand->addressingMethod == METHOD_IMMEDIATE)
+        return decimalToBinary12Bit(operand->value) & ISA_WORD_MASK;
+    if (operand->addressingMethod == METHOD_DIRECT)
+        return convertTo12BitBinary(operand->value, operand->type);
+    if (isSource)
+        return registersToBinary(0, operand->value);
+    return registersToBinary(operand->value, 0);
+}
+
+int encodeInstruction(const DecodedInstruction *decoded, unsigned int *words) {
+    int length = 1;
+
+    words[0] = generateBinaryCode(decoded->destination.addressingMethod, decoded->instruction->code,
+                                  decoded->source.addressingMethod);
+
+    /* Two registers share a single word */
+    if (decoded->source.addressingMethod == METHOD_DIRECT_REGISTER &&
+        decoded->destination.addressingMethod == METHOD_DIRECT_REGISTER) {
+        words[1] = registersToBinary(decoded->destination.value, decoded->source.value);
+        return 2;
+    }
+
+    if (decoded->source.addressingMethod != 0)
+        words[length++] = encodeOperandWord(&decoded->source, true);
+    if (decoded->destination.addressingMethod != 0)
+        words[length++] = encodeOperandWord(&decoded->destination, false);
+    return length;
+}
+
+int findCodeWords(const unsigned int *words, int numOfWords) {
+    DecodedInstruction decoded;
+    int codeWords = 0;
+    int length;
+
+    while ((length = decodeInstruction(words + codeWords, numOfWords - codeWords, &decoded)) > 0)
+        codeWords += length;
+    return codeWords;
+}
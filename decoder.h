@@ -0,0 +1,78 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+/**
+ * @file decoder.h
+ * @brief Definitions and functions related to decoding machine code words back into instructions.
+ *
+ * The decoder inverts generateBinaryCode, registersToBinary, convertTo12BitBinary and decimalToBinary12Bit.
+ * The first word of an instruction is decoded through a table of all the 4096 words of it's 12 bits, built once
+ * from generateBinaryCode and instructionsTable, so decoding a whole image is a single loop of table lookups.
+ * The operand and data words take the width of the words of the machine (see isa.h).
+ */
+
+/**
+ * The number of different first words, the bits of a first word above bit 11 are zero on every machine.
+ */
+#define DECODER_TABLE_SIZE 4096
+
+/**
+ * @struct DecodedOperand
+ * @brief Structure to represent an operand of a decoded instruction.
+ */
+typedef struct DecodedOperand {
+    int addressingMethod;   /* The addressing method of the operand, 0 for a missing operand. */
+    int value;              /* The immediate number, the address or the register number. */
+    int type;               /* The ARE bits of a direct operand word. */
+} DecodedOperand;
+
+/**
+ * @struct DecodedInstruction
+ * @brief Structure to represent a decoded instruction.
+ */
+typedef struct DecodedInstruction {
+    const Instruction *instruction;   /* The instruction in the instructions table. */
+    DecodedOperand source;            /* The source operand (only of instructions with 2 operands). */
+    DecodedOperand destination;       /* The destination operand (of instructions with 1 or 2 operands). */
+    int length;                       /* The number of words of the instruction. */
+} DecodedInstruction;
+
+/**
+ * @brief Decodes the instruction which starts at the given word.
+ *
+ * @param words The words of the image.
+ * @param numOfWords The number of words left in the image, from the first word of the instruction.
+ * @param decoded Pointer to store the decoded instruction.
+ * @return The number of words of the instruction, or 0 if the words aren't a valid instruction.
+ */
+int decodeInstruction(const unsigned int *words, int numOfWords, DecodedInstruction *decoded);
+
+/**
+ * @brief Encodes a decoded instruction again, with the functions the assembler encodes instructions with.
+ *
+ * @param decoded The decoded instruction.
+ * @param words Array to store the words of the instruction (at most 3 words).
+ * @return The number of words of the instruction.
+ */
+int encodeInstruction(const DecodedInstruction *decoded, unsigned int *words);
+
+/**
+ * @brief Decodes a data word into the signed number it holds.
+ *
+ * @param word The data word.
+ * @return The number, in the range of an ISA_WORD_BITS bits word (-2048 to 2047 on the classic machine).
+ */
+int decodeDataWord(unsigned int word);
+
+/**
+ * @brief Finds how many of the words of an image are instruction words, when the image doesn't tell.
+ *
+ * The instruction words are the longest run of valid instructions from the start of the image.
+ *
+ * @param words The words of the image.
+ * @param numOfWords The number of words of the image.
+ * @return The number of instruction words.
+ */
+int findCodeWords(const unsigned int *words, int numOfWords);
+
+#endif
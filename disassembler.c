@@ -0,0 +1,241 @@
+/**
+ * @file disassembler.c
+ * @details This program reads the outputs of the assembler back and disassembles them into a listing of
+ * addresses, words and instructions. A module is read from it's binary object file (".obj") if there's one,
+ * otherwise from it's text files (".ob" + ".ent"/".ext"), where the instruction words are the longest run of
+ * valid instructions from the start of the image.
+ * With --verify nothing is listed: every word is decoded, encoded again and compared with the original word.
+ * @example Run ./disassembler file1, file2, ..., etc               to list the instructions of the files.
+ * @example Run ./disassembler --verify file1, file2, ..., etc      to verify that the files decode and encode back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "objectfile.h"
+#include "decoder.h"
+
+/**
+ * Size of the output buffer of the listing.
+ */
+#define LISTING_BUFFER_SIZE 65536
+
+/**
+ * The number of hexadecimal digits of a word (3 on the classic machine).
+ */
+#define WORD_HEX_DIGITS ((ISA_WORD_BITS + 3) / 4)
+
+/* Name of a label, long enough for every label and for a generated label of an address */
+typedef char Label[MAX_LABEL_LENGTH + 1];
+
+/* Load a module, from it's binary object file if there's one, otherwise from it's text files */
+static int loadModule(const char *name, ObjectFile *object) {
+    char fileName[FILENAME_MAX];
+
+    strcat(strcpy(fileName, name), ".obj");
+    return readBinaryObjectFile(fileName, object) || readTextObjectFiles(name, object);
+}
+
+/* Compare the words of an instruction with their encoding, returns the number of words which differ */
+static int verifyWords(const char *name, int address, const unsigned int *words, const unsigned int *encoded, int length) {
+    int mismatches = 0;
+    int i = 0;
+    for (; i < length; ++i) {
+        if (words[i] != encoded[i]) {
+            printf("%s: word %d is %0*X, encoded back as %0*X.\n", name, address + i, WORD_HEX_DIGITS, words[i],
+                   WORD_HEX_DIGITS, encoded[i]);
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/* Decode every word of a module, encode it again and compare, returns the number of words which differ */
+static int verifyModule(const char *name, const ObjectFile *object) {
+    DecodedInstruction decoded;
+    unsigned int encoded[3];
+    int numOfWords = object->codeWords + object->dataWords;
+    int mismatches = 0, numOfInstructions = 0;
+    int i = 0;
+
+    /* Instruction words */
+    while (i < object->codeWords) {
+        int length = decodeInstruction(object->words + i, object->codeWords - i, &decoded);
+        if (length == 0) {
+            printf("%s: word %d (%0*X) isn't a valid instruction.\n", name, INITIAL_ADDRESS_VALUE + i, WORD_HEX_DIGITS,
+                   object->words[i]);
+            mismatches++;
+            i++;
+            continue;
+        }
+        encodeInstruction(&decoded, encoded);
+        mismatches += verifyWords(name, INITIAL_ADDRESS_VALUE + i, object->words + i, encoded, length);
+        numOfInstructions++;
+        i += length;
+    }
+
+    /* Data words, encoded like encodeDataList does: the Two's complement of the number masked to a word (the
+      smallest number of a word is out of the range of decimalToBinary12Bit) */
+    for (; i < numOfWords; ++i) {
+        encoded[0] = (unsigned int) decodeDataWord(object->words[i]) & ISA_WORD_MASK;
+        mismatches += verifyWords(name, INITIAL_ADDRESS_VALUE + i, object->words + i, encoded, 1);
+    }
+
+    printf("%s: %d words, %d instructions, %d data words, %d mismatches\n", name, numOfWords, numOfInstructions,
+           object->dataWords, mismatches);
+    return mismatches;
+}
+
+/* Format an operand, direct operands by the names of their labels/extern symbols */
+static void formatOperand(char *buffer, const DecodedOperand *operand, int wordIndex, const Label *labels,
+                          const Label *externUses, int numOfWords) {
+    int target = operand->value - INITIAL_ADDRESS_VALUE;
+
+    if (operand->addressingMethod == METHOD_IMMEDIATE)
+        sprintf(buffer, "%d", operand->value);
+    else if (operand->addressingMethod == METHOD_DIRECT_REGISTER)
+        sprintf(buffer, "@r%d", operand->value);
+    else if (operand->type == RELOCATION_EXTERNAL && externUses[wordIndex][0] != '\0')
+        strcpy(buffer, externUses[wordIndex]);
+    else if (operand->type == RELOCATION_RELOCATABLE && target >= 0 && target < numOfWords && labels[target][0] != '\0')
+        strcpy(buffer, labels[target]);
+    else
+        sprintf(buffer, "%d", operand->value);
+}
+
+/* Name every word which is the target of a direct operand, entry points by their own names */
+static void collectLabels(const ObjectFile *object, Label *labels, Label *externUses) {
+    DecodedInstruction decoded;
+    int numOfWords = object->codeWords + object->dataWords;
+    int i = 0;
+
+    for (; i < object->numOfEntries; ++i)
+        if (object->entries[i].value >= INITIAL_ADDRESS_VALUE && object->entries[i].value - INITIAL_ADDRESS_VALUE < numOfWords)
+            strcpy(labels[object->entries[i].value - INITIAL_ADDRESS_VALUE], object->entries[i].name);
+    for (i = 0; i < object->numOfExterns; ++i)
+        if (object->externs[i].value >= INITIAL_ADDRESS_VALUE && object->externs[i].value - INITIAL_ADDRESS_VALUE < numOfWords)
+            strcpy(externUses[object->externs[i].value - INITIAL_ADDRESS_VALUE], object->externs[i].name);
+
+    for (i = 0; i < object->codeWords;) {
+        int length = decodeInstruction(object->words + i, object->codeWords - i, &decoded);
+        const DecodedOperand *operands[2];
+        int j = 0;
+
+        if (length == 0) {
+            i++;
+            continue;
+        }
+        operands[0] = &decoded.source;
+        operands[1] = &decoded.destination;
+        for (; j < 2; ++j) {
+            int target = operands[j]->value - INITIAL_ADDRESS_VALUE;
+            if (operands[j]->addressingMethod == METHOD_DIRECT && operands[j]->type == RELOCATION_RELOCATABLE &&
+                target >= 0 && target < numOfWords && labels[target][0] == '\0')
+                sprintf(labels[target], "L%d", operands[j]->value);
+        }
+        i += length;
+    }
+}
+
+/* List the instructions and the data of a module */
+static int listModule(const ObjectFile *object) {
+    DecodedInstruction decoded;
+    int numOfWords = object->codeWords + object->dataWords;
+    Label *labels = (Label *) allocateZeroedMemory(MEMORY_TOOLS, numOfWords + 1, sizeof(Label));
+    Label *externUses = (Label *) allocateZeroedMemory(MEMORY_TOOLS, numOfWords + 1, sizeof(Label));
+    char source[MAX_LINE_LENGTH], destination[MAX_LINE_LENGTH];
+    char base64Words[3][ISA_BASE64_DIGITS + 1];
+    int i;
+
+    if (labels == NULL || externUses == NULL) {
+        freeMemory(labels);
+        freeMemory(externUses);
+        return false;
+    }
+    collectLabels(object, labels, externUses);
+
+    for (i = 0; i < object->numOfEntries; ++i)
+        printf("\t\t\t.entry %s\n", object->entries[i].name);
+    for (i = 0; i < object->numOfExterns; ++i) {
+        /* An extern symbol is listed once, at it's first use */
+        int j = 0;
+        while (j < i && strcmp(object->externs[j].name, object->externs[i].name) != 0)
+            j++;
+        if (j == i)
+            printf("\t\t\t.extern %s\n", object->externs[i].name);
+    }
+
+    for (i = 0; i < numOfWords;) {
+        int length = i < object->codeWords ? decodeInstruction(object->words + i, object->codeWords - i, &decoded) : 0;
+        int j = 0;
+
+        printf("%04d\t", INITIAL_ADDRESS_VALUE + i);
+        if (length == 0) {
+            /* A data word, or an instruction word which can't be decoded */
+            convertToBase64((int) object->words[i], base64Words[0]);
+            printf("%s\t\t%s%s.data %d\n", base64Words[0], labels[i], labels[i][0] != '\0' ? ": " : "",
+                   decodeDataWord(object->words[i]));
+            i++;
+            continue;
+        }
+
+        for (; j < length; ++j) {
+            convertToBase64((int) object->words[i + j], base64Words[j]);
+            printf(j == 0 ? "%s" : " %s", base64Words[j]);
+        }
+        printf(length == 3 ? "\t" : "\t\t");
+        printf("%s%s%s", labels[i], labels[i][0] != '\0' ? ": " : "", decoded.instruction->name);
+
+        /* The source operand word comes before the destination operand word, unless both are registers */
+        formatOperand(source, &decoded.source, i + 1, labels, externUses, numOfWords);
+        formatOperand(destination, &decoded.destination, i + (decoded.source.addressingMethod != 0 && length == 3 ? 2 : 1),
+                      labels, externUses, numOfWords);
+        if (decoded.source.addressingMethod != 0)
+            printf(" %s, %s\n", source, destination);
+        else if (decoded.destination.addressingMethod != 0)
+            printf(" %s\n", destination);
+        else
+            printf("\n");
+        i += length;
+    }
+
+    freeMemory(labels);
+    freeMemory(externUses);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    static char listingBuffer[LISTING_BUFFER_SIZE];
+    int verifyFlag = 0; /* Verify the files instead of listing them */
+    int status = EXIT_SUCCESS;
+    int i;
+
+    setvbuf(stdout, listingBuffer, _IOFBF, sizeof(listingBuffer));
+
+    for (i = 1; i < argc; i++) {
+        ObjectFile object;
+
+        if (strcmp(argv[i], "--verify") == 0) {
+            verifyFlag = 1;
+            continue;
+        }
+
+        if (!loadModule(argv[i], &object)) {
+            printf("Couldn't read %s.obj/%s.ob.\n", argv[i], argv[i]);
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        if (verifyFlag) {
+            if (verifyModule(argv[i], &object) > 0)
+                status = EXIT_FAILURE;
+        } else if (!listModule(&object)) {
+            printf("Memory allocation has been failed.\n");
+            status = EXIT_FAILURE;
+        }
+        freeObjectFile(&object);
+    }
+
+    return status;
+}
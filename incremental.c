@@ -0,0 +1,1030 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "data.h"
+#include "libasm.h"
+#include "incremental.h"
+
+/**
+ * A line of a source which is split like the passes read it.
+ */
+typedef struct LineSpan {
+    long offset;    /* The index of the first character of the line. */
+    int length;     /* The number of characters of the line. */
+} LineSpan;
+
+/* The least number of lines a thread parses, a source with fewer lines is parsed by fewer threads */
+#define MIN_LINES_PER_THREAD 2048
+
+/**
+ * An entry point of the source, by the position of it's first declaration.
+ */
+typedef struct LinkedEntry {
+    long position;  /* The index of the line of the declaration times MAX_LINE_LENGTH, plus the index of it's mention. */
+    int symbol;     /* The index of the symbol. */
+} LinkedEntry;
+
+/**
+ * Consecutive lines which are parsed, placed and linked by a thread of their own.
+ */
+typedef struct LineChunk {
+    const SourceModel *model;       /* The model, while it's lines are linked. */
+    const char *text;               /* The source, while it's lines are parsed. */
+    const LineSpan *spans;          /* The spans of the lines in the source, while they are parsed. */
+    ModelLine *lines;               /* The lines of the chunk. */
+    int numOfLines;                 /* The number of lines. */
+    AssemblerContext *scratch;      /* The context the lines are parsed by. */
+    int codeWords;                  /* The number of instruction words of the lines. */
+    int dataWords;                  /* The number of data words of the lines. */
+    int numOfInvalidLines;          /* The number of lines which have errors. */
+    int address;                    /* The address of the first instruction word of the chunk. */
+    int dataIndex;                  /* The index of the first data word of the chunk. */
+    int isParsed;                   /* False if memory allocation has been failed while parsing the lines. */
+    int numOfMisses;                /* The number of references to symbols which aren't in the model yet. */
+    int numOfEncoded;               /* The number of references whose words have been encoded. */
+    int numOfWrapped;               /* The number of references whose symbol doesn't fit in the operand. */
+} LineChunk;
+
+/* Get the number of chunks lines are split into, every chunk has enough lines to be worth a thread */
+static int getNumOfChunks(int numOfLines, int numOfThreads) {
+    int numOfChunks = numOfThreads < MAX_ASSEMBLY_THREADS ? numOfThreads : MAX_ASSEMBLY_THREADS;
+
+    while (numOfChunks > 1 && numOfLines / numOfChunks < MIN_LINES_PER_THREAD)
+        numOfChunks--;
+    return numOfChunks < 1 ? 1 : numOfChunks;
+}
+
+/* Split lines (and their spans) into chunks of about the same number of lines */
+static void splitChunks(LineChunk *chunks, int numOfChunks, ModelLine *lines, const LineSpan *spans, int numOfLines) {
+    int i = 0;
+
+    memset(chunks, 0, numOfChunks * sizeof(LineChunk));
+    for (; i < numOfChunks; ++i) {
+        int start = (int) ((long) numOfLines * i / numOfChunks);
+
+        chunks[i].lines = lines + start;
+        chunks[i].spans = spans != NULL ? spans + start : NULL;
+        chunks[i].numOfLines = (int) ((long) numOfLines * (i + 1) / numOfChunks) - start;
+    }
+}
+
+/* Run a work on every chunk at once: the first chunk on this thread and every other chunk on a thread of it's own.
+  A chunk whose thread couldn't being created is run on this thread afterwards */
+static void runChunks(void *(*work)(void *), LineChunk *chunks, int numOfChunks) {
+    pthread_t threads[MAX_ASSEMBLY_THREADS];
+    int isStarted[MAX_ASSEMBLY_THREADS];
+    int i = 1;
+
+    for (; i < numOfChunks; ++i)
+        isStarted[i] = pthread_create(&threads[i], NULL, work, &chunks[i]) == 0;
+    work(&chunks[0]);
+    for (i = 1; i < numOfChunks; ++i) {
+        if (isStarted[i])
+            pthread_join(threads[i], NULL);
+        else
+            work(&chunks[i]);
+    }
+}
+
+/* Hash the name of a symbol */
+static unsigned long hashName(const char *name, int length) {
+    unsigned long hash = 2166136261UL;
+    int i = 0;
+
+    for (; i < length; ++i)
+        hash = ((hash ^ (unsigned char) name[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    return hash;
+}
+
+/* Split a source into it's lines exactly like readSourceLine does, returns the number of lines or -1 */
+static int splitLines(const char *text, long size, LineSpan **spans) {
+    int capacity = 1024;
+    int numOfLines = 0;
+    long position = 0;
+
+    *spans = (LineSpan *) allocateMemory(MEMORY_ENCODING, capacity * sizeof(LineSpan));
+    if (*spans == NULL)
+        return -1;
+
+    while (position < size) {
+        const char *newLine;
+        long length = size - position < MAX_LINE_LENGTH - 1 ? size - position : MAX_LINE_LENGTH - 1;
+
+        /* A line ends after a new line character, or once the line buffer is full */
+        if ((newLine = (const char *) memchr(text + position, '\n', (size_t) length)) != NULL)
+            length = newLine - (text + position) + 1;
+
+        if (numOfLines == capacity) {
+            LineSpan *newSpans = (LineSpan *) reallocateMemory(MEMORY_ENCODING, *spans,
+                                                               2 * capacity * sizeof(LineSpan));
+            if (newSpans == NULL) {
+                freeMemory(*spans);
+                *spans = NULL;
+                return -1;
+            }
+            *spans = newSpans;
+            capacity *= 2;
+        }
+        (*spans)[numOfLines].offset = position;
+        (*spans)[numOfLines++].length = (int) length;
+        position += length;
+    }
+    return numOfLines;
+}
+
+/* Add a mention of a symbol to the mentions of a line */
+static void addMention(ModelMention *mentions, int *numOfMentions, int kind, const char *line, const char *name,
+                       int length, int word) {
+    mentions[*numOfMentions].kind = kind;
+    mentions[*numOfMentions].start = (int) (name - line);
+    mentions[*numOfMentions].length = length;
+    mentions[*numOfMentions].symbol = -1;
+    mentions[(*numOfMentions)++].word = word;
+}
+
+/* Find the symbols a line which has been assembled without errors declares and uses, tokenized exactly like the
+  first pass tokenizes it. Returns the number of mentions, or -1 if a symbol is too long for the symbol table */
+static int findMentions(AssemblerContext *scratch, const char *line, ModelMention *mentions) {
+    char copiedLine[MAX_LINE_LENGTH];
+    char *token;
+    int isLabel;
+    int numOfMentions = 0;
+
+    strcpy(copiedLine, line);
+    token = nextToken(scratch, copiedLine, " \t\n");
+    /* Skip commented and empty lines */
+    if (line[0] == ';' || token == NULL || token[0] == ';')
+        return 0;
+    isLabel = isCharacter(token[0]) && token[strlen(token) - 1] == ':';
+
+    strcpy(copiedLine, line);
+    if (isLabel) {
+        /* Label declaration, the directive or instruction follows it */
+        char *label = nextToken(scratch, copiedLine, " \t\n");
+
+        token = nextToken(scratch, NULL, " \t\n");
+        addMention(mentions, &numOfMentions,
+                   token != NULL && (strcmp(token, ".data") == 0 || strcmp(token, ".string") == 0)
+                   ? MENTION_DATA_LABEL : MENTION_LABEL, copiedLine, label, (int) strlen(label) - 1, 0);
+    } else
+        token = nextToken(scratch, copiedLine, " ,\t\n");
+
+    if (token == NULL)
+        return numOfMentions;
+
+    if (strcmp(token, ".entry") == 0 || strcmp(token, ".extern") == 0) {
+        int kind = strcmp(token, ".entry") == 0 ? MENTION_ENTRY : MENTION_EXTERN;
+
+        while ((token = nextToken(scratch, NULL, " ,\t\n")) != NULL) {
+            if (strlen(token) >= MAX_LABEL_LENGTH)
+                return -1;
+            addMention(mentions, &numOfMentions, kind, copiedLine, token, (int) strlen(token), 0);
+        }
+    } else if (isInstructionExist(token)) {
+        int numOfOperands = getInstructionNumOfOperands(token);
+        char *operand1 = nextToken(scratch, NULL, " ,\t\n");
+        char *operand2 = nextToken(scratch, NULL, " ,\t\n");
+        int addressingMethod1 = getAddressingMethod(scratch, operand1);
+        int addressingMethod2 = getAddressingMethod(scratch, operand2);
+
+        /* A word for the source operand, then a word for the destination operand, unless both are registers */
+        if (numOfOperands >= 1 && addressingMethod1 == METHOD_DIRECT)
+            addMention(mentions, &numOfMentions, MENTION_REFERENCE, copiedLine, operand1, (int) strlen(operand1), 1);
+        if (numOfOperands == 2 && addressingMethod2 == METHOD_DIRECT)
+            addMention(mentions, &numOfMentions, MENTION_REFERENCE, copiedLine, operand2, (int) strlen(operand2), 2);
+    }
+    return numOfMentions;
+}
+
+/* Parse a line on it's own by the first pass, returns false if memory allocation has been failed */
+static int parseLine(AssemblerContext *scratch, const char *text, const LineSpan *span, ModelLine *modelLine) {
+    ModelMention mentions[MAX_LINE_LENGTH];
+    char line[MAX_LINE_LENGTH];
+    SourceReader reader;
+    int numOfMentions;
+    int i = 0;
+
+    memset(modelLine, 0, sizeof(ModelLine));
+    modelLine->offset = span->offset;
+    modelLine->length = span->length;
+
+    /* The scratch context keeps it's images, only the symbols and the errors of the previous line are dropped */
+    freeSymbolTable(scratch);
+    freeExternSymbolTable(scratch);
+    scratch->endFirstPassFlag = 0;
+    scratch->errorFlag = 0;
+    scratch->numOfDiagnostics = 0;
+    initSourceReader(&reader, text + span->offset, span->length);
+    firstPass(scratch, &reader);
+    if (scratch->errorFlag || scratch->numOfDiagnostics > 0 ||
+        scratch->address - INITIAL_ADDRESS_VALUE > MAX_INSTRUCTION_WORDS)
+        return true;
+
+    memcpy(line, text + span->offset, (size_t) span->length);
+    line[span->length] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+    if ((numOfMentions = findMentions(scratch, line, mentions)) < 0 || scratch->numOfDiagnostics > 0)
+        return true;
+
+    modelLine->numOfCodeWords = scratch->address - INITIAL_ADDRESS_VALUE;
+    for (; i < modelLine->numOfCodeWords; ++i)
+        modelLine->codeWords[i] = getCodeImageWord(&scratch->codeImage, i);
+    if (scratch->dataCounter > 0) {
+        modelLine->dataWords = (unsigned int *) allocateMemory(MEMORY_ENCODING,
+                                                               scratch->dataCounter * sizeof(unsigned int));
+        if (modelLine->dataWords == NULL)
+            return false;
+        modelLine->numOfDataWords = scratch->dataCounter;
+        for (i = 0; i < modelLine->numOfDataWords; ++i)
+            modelLine->dataWords[i] = getCodeImageWord(&scratch->dataImage, i);
+    }
+    if (numOfMentions > 0) {
+        modelLine->mentions = (ModelMention *) allocateMemory(MEMORY_ENCODING, numOfMentions * sizeof(ModelMention));
+        if (modelLine->mentions == NULL) {
+            freeMemory(modelLine->dataWords);
+            modelLine->dataWords = NULL;
+            return false;
+        }
+        memcpy(modelLine->mentions, mentions, numOfMentions * sizeof(ModelMention));
+        modelLine->numOfMentions = numOfMentions;
+    }
+    modelLine->isValid = true;
+    return true;
+}
+
+/* Free the words and the mentions of lines */
+static void freeLines(ModelLine *lines, int count) {
+    int i = 0;
+
+    for (; i < count; ++i) {
+        freeMemory(lines[i].dataWords);
+        freeMemory(lines[i].mentions);
+    }
+}
+
+/* Parse the lines of a chunk and count their words, the thread work of parseLines */
+static void *parseChunk(void *argument) {
+    LineChunk *chunk = (LineChunk *) argument;
+    int i = 0;
+
+    chunk->isParsed = true;
+    for (; i < chunk->numOfLines; ++i) {
+        if (!parseLine(chunk->scratch, chunk->text, &chunk->spans[i], &chunk->lines[i])) {
+            freeLines(chunk->lines, i);
+            chunk->isParsed = false;
+            return NULL;
+        }
+        chunk->codeWords += chunk->lines[i].numOfCodeWords;
+        chunk->dataWords += chunk->lines[i].numOfDataWords;
+        chunk->numOfInvalidLines += !chunk->lines[i].isValid;
+    }
+    return NULL;
+}
+
+/* Give the lines of a chunk their addresses, from the address of the chunk on */
+static void *placeChunk(void *argument) {
+    LineChunk *chunk = (LineChunk *) argument;
+    int address = chunk->address;
+    int dataIndex = chunk->dataIndex;
+    int i = 0;
+
+    for (; i < chunk->numOfLines; ++i) {
+        chunk->lines[i].address = address;
+        chunk->lines[i].dataIndex = dataIndex;
+        address += chunk->lines[i].numOfCodeWords;
+        dataIndex += chunk->lines[i].numOfDataWords;
+    }
+    return NULL;
+}
+
+/* Parse lines into a model which follows the given address and data index: the lines are split into chunks which
+  are parsed by threads at once, the address of every chunk is the sum of the words of the chunks before it, and
+  then the chunks place their lines at once. Returns false if memory allocation has been failed */
+static int parseLines(SourceModel *model, const char *text, const LineSpan *spans, ModelLine *lines,
+                      int numOfLines, int address, int dataIndex, int numOfThreads, int *codeWords, int *dataWords) {
+    LineChunk chunks[MAX_ASSEMBLY_THREADS];
+    AssemblerContext *scratches = NULL;
+    int numOfChunks = getNumOfChunks(numOfLines, numOfThreads);
+    int isParsed = true;
+    int i = 0;
+
+    /* The first chunk is parsed by the context of the model, every other chunk by a context of it's own */
+    if (numOfChunks > 1) {
+        scratches = (AssemblerContext *) allocateMemory(MEMORY_ENCODING, numOfChunks * sizeof(AssemblerContext));
+        if (scratches == NULL)
+            numOfChunks = 1;
+    }
+    splitChunks(chunks, numOfChunks, lines, spans, numOfLines);
+    for (; i < numOfChunks; ++i) {
+        chunks[i].text = text;
+        chunks[i].scratch = &model->scratch;
+        if (i > 0) {
+            initAssemblerContext(&scratches[i]);
+            chunks[i].scratch = &scratches[i];
+        }
+    }
+    runChunks(parseChunk, chunks, numOfChunks);
+
+    *codeWords = 0;
+    *dataWords = 0;
+    for (i = 0; i < numOfChunks; ++i) {
+        chunks[i].address = address + *codeWords;
+        chunks[i].dataIndex = dataIndex + *dataWords;
+        *codeWords += chunks[i].codeWords;
+        *dataWords += chunks[i].dataWords;
+        model->numOfInvalidLines += chunks[i].numOfInvalidLines;
+        isParsed = isParsed && chunks[i].isParsed;
+        if (i > 0)
+            freeAssemblerContext(&scratches[i]);
+    }
+    freeMemory(scratches);
+
+    /* The chunks which have been parsed are freed when another one has failed */
+    if (!isParsed) {
+        for (i = 0; i < numOfChunks; ++i)
+            if (chunks[i].isParsed)
+                freeLines(chunks[i].lines, chunks[i].numOfLines);
+        return false;
+    }
+    runChunks(placeChunk, chunks, numOfChunks);
+    return true;
+}
+
+/* Check if a line of the model is the same as a line of a new source */
+static int isSameLine(const SourceModel *model, const ModelLine *modelLine, const char *text, const LineSpan *span) {
+    return modelLine->length == span->length &&
+           memcmp(model->text + modelLine->offset, text + span->offset, (size_t) span->length) == 0;
+}
+
+/* Check if a line declares symbols (by a label, an .entry or an .extern directive) */
+static int hasDeclarations(const ModelLine *line) {
+    int i = 0;
+
+    for (; i < line->numOfMentions; ++i)
+        if (line->mentions[i].kind != MENTION_REFERENCE)
+            return true;
+    return false;
+}
+
+/* Drop the declarations of a line which is replaced from the symbols of the model. Returns false if the first
+  declaration of an entry point which is declared again is dropped, the symbols have to be declared again then */
+static int undeclareLine(SourceModel *model, int index) {
+    const ModelLine *line = &model->lines[index];
+    int i = 0;
+
+    for (; i < line->numOfMentions; ++i) {
+        const ModelMention *mention = &line->mentions[i];
+        LinkedSymbol *symbol;
+
+        if (mention->kind == MENTION_REFERENCE)
+            continue;
+        symbol = &model->symbols.symbols[mention->symbol];
+        if (mention->kind == MENTION_LABEL || mention->kind == MENTION_DATA_LABEL) {
+            if (--symbol->numOfLabels == 0)
+                symbol->definingLine = -1;
+        } else if (mention->kind == MENTION_ENTRY) {
+            if (--symbol->numOfEntries == 0)
+                symbol->entryLine = -1;
+            else if (symbol->entryLine == index && symbol->entryMention == i)
+                return false;
+        } else if (--symbol->numOfExterns == 0)
+            model->numOfExternSymbols--;
+    }
+    return true;
+}
+
+/* Bring the model up to date with a new source: the lines which haven't been changed at it's start and at it's end
+  are kept, the lines between them are parsed again, and the lines which follow them are shifted (as well as the
+  symbols they declare). Returns false if memory allocation has been failed, the model has to be freed then */
+static int updateModel(SourceModel *model, const char *text, long size, int numOfThreads) {
+    LineSpan *spans;
+    ModelLine *parsed;
+    char *newText;
+    int numOfLines = splitLines(text, size, &spans);
+    int prefix = 0;
+    int suffix = 0;
+    int numOfParsed;
+    int end;
+    int codeDelta;
+    int dataDelta;
+    int address = INITIAL_ADDRESS_VALUE;
+    int dataIndex = 0;
+    int i;
+
+    if (numOfLines < 0)
+        return false;
+    while (prefix < model->numOfLines && prefix < numOfLines &&
+           isSameLine(model, &model->lines[prefix], text, &spans[prefix]))
+        prefix++;
+    while (suffix < model->numOfLines - prefix && suffix < numOfLines - prefix &&
+           isSameLine(model, &model->lines[model->numOfLines - 1 - suffix], text, &spans[numOfLines - 1 - suffix]))
+        suffix++;
+
+    /* Parse the changed lines before the model is changed at all, they follow the lines which are kept at the start */
+    numOfParsed = numOfLines - prefix - suffix;
+    parsed = (ModelLine *) allocateMemory(MEMORY_ENCODING, (numOfParsed + 1) * sizeof(ModelLine));
+    newText = (char *) allocateMemory(MEMORY_ENCODING, (size_t) size + 1);
+    if (prefix > 0) {
+        address = model->lines[prefix - 1].address + model->lines[prefix - 1].numOfCodeWords;
+        dataIndex = model->lines[prefix - 1].dataIndex + model->lines[prefix - 1].numOfDataWords;
+    }
+    if (parsed == NULL || newText == NULL || !parseLines(model, text, spans + prefix, parsed, numOfParsed, address,
+                                                         dataIndex, numOfThreads, &codeDelta, &dataDelta)) {
+        freeMemory(spans);
+        freeMemory(parsed);
+        freeMemory(newText);
+        return false;
+    }
+    if (isTracing())
+        traceCounter("lines parsed", numOfParsed);
+
+    /* The lines which have been changed are replaced by the parsed lines, and their symbols are dropped */
+    end = model->numOfLines - suffix;
+    model->areSymbolsMoved = false;
+    for (i = prefix; i < end; ++i) {
+        codeDelta -= model->lines[i].numOfCodeWords;
+        dataDelta -= model->lines[i].numOfDataWords;
+        model->numOfInvalidLines -= !model->lines[i].isValid;
+        model->areSymbolsMoved = model->areSymbolsMoved || hasDeclarations(&model->lines[i]);
+        model->isLinked = model->isLinked && undeclareLine(model, i);
+    }
+    freeLines(model->lines + prefix, end - prefix);
+    if (numOfLines > model->linesCapacity) {
+        int newCapacity = model->linesCapacity == 0 ? numOfLines : model->linesCapacity;
+        ModelLine *newLines;
+
+        while (newCapacity < numOfLines)
+            newCapacity *= 2;
+        newLines = (ModelLine *) reallocateMemory(MEMORY_ENCODING, model->lines, newCapacity * sizeof(ModelLine));
+        if (newLines == NULL) {
+            /* The lines which are kept are the model, until it's freed */
+            memmove(model->lines + prefix, model->lines + end, suffix * sizeof(ModelLine));
+            model->numOfLines = prefix + suffix;
+            freeLines(parsed, numOfParsed);
+            freeMemory(spans);
+            freeMemory(parsed);
+            freeMemory(newText);
+            return false;
+        }
+        model->lines = newLines;
+        model->linesCapacity = newCapacity;
+    }
+    memmove(model->lines + prefix + numOfParsed, model->lines + end, suffix * sizeof(ModelLine));
+    memcpy(model->lines + prefix, parsed, numOfParsed * sizeof(ModelLine));
+    model->numOfLines = numOfLines;
+    model->firstParsed = prefix;
+    model->numOfParsed = numOfParsed;
+
+    /* The lines at the end are shifted, the symbols they declare follow them */
+    for (i = prefix + numOfParsed; i < numOfLines; ++i) {
+        model->lines[i].offset = spans[i].offset;
+        model->lines[i].address += codeDelta;
+        model->lines[i].dataIndex += dataDelta;
+    }
+    if (model->isLinked && prefix + numOfParsed != end) {
+        for (i = 0; i < model->symbols.numOfSymbols; ++i) {
+            LinkedSymbol *symbol = &model->symbols.symbols[i];
+
+            if (symbol->definingLine >= end)
+                symbol->definingLine += prefix + numOfParsed - end;
+            if (symbol->entryLine >= end)
+                symbol->entryLine += prefix + numOfParsed - end;
+        }
+    }
+    model->codeWords += codeDelta;
+    model->dataWords += dataDelta;
+    model->areSymbolsMoved = model->areSymbolsMoved || codeDelta != 0 || dataDelta != 0;
+
+    memcpy(newText, text, (size_t) size);
+    newText[size] = '\0';
+    freeMemory(model->text);
+    model->text = newText;
+    model->size = size;
+
+    freeMemory(spans);
+    freeMemory(parsed);
+    return true;
+}
+
+/* Find a symbol by it's name, returns it's index or -1, and sets the bucket it's in (or would be added into) */
+static int findLinkedSymbol(const LinkedSymbols *table, const char *name, int length, unsigned long hash,
+                            unsigned long *bucket) {
+    unsigned long i = hash & (table->capacity - 1);
+
+    for (; table->buckets[i] != -1; i = (i + 1) & (table->capacity - 1)) {
+        const LinkedSymbol *symbol = &table->symbols[table->buckets[i]];
+
+        if (symbol->hash == hash && symbol->length == length && memcmp(symbol->name, name, (size_t) length) == 0) {
+            *bucket = i;
+            return table->buckets[i];
+        }
+    }
+    *bucket = i;
+    return -1;
+}
+
+/* Double the buckets of the symbols and hash the symbols into them again, returns false if memory allocation has
+  been failed */
+static int growBuckets(LinkedSymbols *table) {
+    unsigned long capacity = table->capacity == 0 ? 64 : 2 * table->capacity;
+    int *buckets = (int *) allocateMemory(MEMORY_SYMBOLS, capacity * sizeof(int));
+    int i = 0;
+
+    if (buckets == NULL)
+        return false;
+    memset(buckets, 0xFF, capacity * sizeof(int));
+    freeMemory(table->buckets);
+    table->buckets = buckets;
+    table->capacity = capacity;
+    for (; i < table->numOfSymbols; ++i) {
+        unsigned long bucket = table->symbols[i].hash & (capacity - 1);
+
+        while (buckets[bucket] != -1)
+            bucket = (bucket + 1) & (capacity - 1);
+        buckets[bucket] = i;
+    }
+    return true;
+}
+
+/* Get the index of a symbol by it's name, the symbol is added (without declarations) if it isn't in the model yet.
+  Returns -1 if memory allocation has been failed */
+static int getLinkedSymbol(LinkedSymbols *table, const char *name, int length) {
+    unsigned long hash = hashName(name, length);
+    unsigned long bucket;
+    int index = findLinkedSymbol(table, name, length, hash, &bucket);
+    LinkedSymbol *symbol;
+
+    if (index != -1)
+        return index;
+    if (table->numOfSymbols == table->symbolsCapacity) {
+        int newCapacity = table->symbolsCapacity == 0 ? 64 : 2 * table->symbolsCapacity;
+        LinkedSymbol *newSymbols = (LinkedSymbol *) reallocateMemory(MEMORY_SYMBOLS, table->symbols,
+                                                                     newCapacity * sizeof(LinkedSymbol));
+        if (newSymbols == NULL)
+            return -1;
+        table->symbols = newSymbols;
+        table->symbolsCapacity = newCapacity;
+    }
+    /* The buckets are kept at most half full */
+    if (2UL * (unsigned long) (table->numOfSymbols + 1) > table->capacity) {
+        if (!growBuckets(table))
+            return -1;
+        findLinkedSymbol(table, name, length, hash, &bucket);
+    }
+
+    index = table->numOfSymbols++;
+    symbol = &table->symbols[index];
+    memset(symbol, 0, sizeof(LinkedSymbol));
+    memcpy(symbol->name, name, (size_t) length);
+    symbol->length = length;
+    symbol->hash = hash;
+    symbol->definingLine = -1;
+    symbol->entryLine = -1;
+    symbol->value = -1;
+    symbol->type = -1;
+    table->buckets[bucket] = index;
+    return index;
+}
+
+/* Declare the symbols a line declares, like the first pass adds them into the symbol table. Returns false if memory
+  allocation has been failed or a symbol is declared in a way the passes treat specially */
+static int declareLine(SourceModel *model, int index) {
+    ModelLine *line = &model->lines[index];
+    int i = 0;
+
+    for (; i < line->numOfMentions; ++i) {
+        ModelMention *mention = &line->mentions[i];
+        LinkedSymbol *symbol;
+
+        if (mention->kind == MENTION_REFERENCE)
+            continue;
+        mention->symbol = getLinkedSymbol(&model->symbols, model->text + line->offset + mention->start,
+                                          mention->length);
+        if (mention->symbol == -1)
+            return false;
+        symbol = &model->symbols.symbols[mention->symbol];
+
+        if (mention->kind == MENTION_LABEL || mention->kind == MENTION_DATA_LABEL) {
+            if (symbol->numOfLabels++ == 0) {
+                symbol->definingLine = index;
+                symbol->isData = mention->kind == MENTION_DATA_LABEL;
+            }
+        } else if (mention->kind == MENTION_ENTRY) {
+            if (symbol->numOfEntries++ == 0 || index < symbol->entryLine ||
+                (index == symbol->entryLine && i < symbol->entryMention)) {
+                symbol->entryLine = index;
+                symbol->entryMention = i;
+            }
+        } else if (symbol->numOfExterns++ == 0)
+            model->numOfExternSymbols++;
+
+        /* A duplicated label, or a symbol which is both entry and extern, is an error. A label which is extern
+          keeps it's address, the source is assembled whole for those */
+        if (symbol->numOfLabels > 1 ||
+            (symbol->numOfExterns > 0 && (symbol->numOfEntries > 0 || symbol->numOfLabels > 0)))
+            return false;
+    }
+    return true;
+}
+
+/* Add the symbols which are used by a line but aren't in the model yet, so the references follow them once they are
+  declared. Returns false if memory allocation has been failed */
+static int addUsedSymbols(SourceModel *model, ModelLine *line) {
+    int i = 0;
+
+    for (; i < line->numOfMentions; ++i) {
+        ModelMention *mention = &line->mentions[i];
+
+        if (mention->kind == MENTION_REFERENCE && mention->symbol == -1 &&
+            (mention->symbol = getLinkedSymbol(&model->symbols, model->text + line->offset + mention->start,
+                                               mention->length)) == -1)
+            return false;
+    }
+    return true;
+}
+
+/* Get the value of a symbol after the data image has been placed after the code image */
+static int getLinkedValue(const SourceModel *model, const LinkedSymbol *symbol) {
+    const ModelLine *line;
+
+    /* A symbol which isn't declared has the value -1, like getSymbolValue returns */
+    if (symbol->numOfLabels == 0 && symbol->numOfEntries == 0 && symbol->numOfExterns == 0)
+        return -1;
+    /* An extern symbol, or an entry point which isn't declared by a label, keeps the value 0 */
+    if (symbol->definingLine == -1)
+        return 0;
+    line = &model->lines[symbol->definingLine];
+    return symbol->isData ? INITIAL_ADDRESS_VALUE + model->codeWords + line->dataIndex : line->address;
+}
+
+/* Get the type of the words of the references to a symbol, -1 if it isn't declared like getSymbolType returns */
+static int getLinkedType(const LinkedSymbol *symbol) {
+    if (symbol->numOfLabels == 0 && symbol->numOfEntries == 0 && symbol->numOfExterns == 0)
+        return -1;
+    return symbol->numOfExterns > 0 ? 1 : 2;
+}
+
+/* Give the symbols their values and types after the lines have been placed, returns the number of symbols whose
+  value or type has been changed since the model has been linked last */
+static int placeSymbols(SourceModel *model) {
+    int numOfChanged = 0;
+    int i = 0;
+
+    for (; i < model->symbols.numOfSymbols; ++i) {
+        LinkedSymbol *symbol = &model->symbols.symbols[i];
+        int value = getLinkedValue(model, symbol);
+        int type = getLinkedType(symbol);
+
+        symbol->isChanged = value != symbol->value || type != symbol->type;
+        symbol->value = value;
+        symbol->type = type;
+        numOfChanged += symbol->isChanged;
+    }
+    return numOfChanged;
+}
+
+/* Encode the words of the references of a chunk: every reference of a line which has been parsed, and a reference of
+  another line only if the value or the type of it's symbol has been changed. The thread work of linkModel */
+static void *resolveChunk(void *argument) {
+    LineChunk *chunk = (LineChunk *) argument;
+    const SourceModel *model = chunk->model;
+    const LinkedSymbols *table = &model->symbols;
+    int first = (int) (chunk->lines - model->lines);
+    int i = 0;
+
+    for (; i < chunk->numOfLines; ++i) {
+        ModelLine *line = &chunk->lines[i];
+        int isParsed = first + i >= model->firstParsed && first + i < model->firstParsed + model->numOfParsed;
+        int j = 0;
+
+        for (; j < line->numOfMentions; ++j) {
+            ModelMention *mention = &line->mentions[j];
+
+            if (mention->kind != MENTION_REFERENCE)
+                continue;
+            if (mention->symbol == -1) {
+                /* A symbol which isn't in the model yet is added once the chunks have been encoded */
+                const char *name = model->text + line->offset + mention->start;
+                unsigned long bucket;
+
+                mention->symbol = findLinkedSymbol(table, name, mention->length, hashName(name, mention->length),
+                                                   &bucket);
+                chunk->numOfMisses += mention->symbol == -1;
+            } else if (!isParsed && !table->symbols[mention->symbol].isChanged)
+                continue;
+
+            /* A symbol which isn't declared has the value and the type -1, like getSymbolValue/Type return */
+            line->codeWords[mention->word] = mention->symbol == -1
+                                             ? convertTo12BitBinary(-1, -1)
+                                             : convertTo12BitBinary(table->symbols[mention->symbol].value,
+                                                                    table->symbols[mention->symbol].type);
+            chunk->numOfEncoded++;
+            /* The passes report a symbol whose address doesn't fit in the operand */
+            chunk->numOfWrapped += mention->symbol != -1 && table->symbols[mention->symbol].type != -1 &&
+                                   !isOperandAddress(table->symbols[mention->symbol].value);
+        }
+    }
+    return NULL;
+}
+
+/* Record the extern uses and the relocations of the references in the order of the lines, like the second pass.
+  Returns false if memory allocation has been failed */
+static int collectReferences(const SourceModel *model, ObjectFile *object, RelocationTable *relocations) {
+    int numOfExternUses = 0;
+    int i = 0;
+
+    for (; i < model->numOfLines; ++i) {
+        const ModelLine *line = &model->lines[i];
+        int j = 0;
+
+        for (; j < line->numOfMentions; ++j) {
+            const ModelMention *mention = &line->mentions[j];
+            int isExternSymbol;
+
+            if (mention->kind != MENTION_REFERENCE)
+                continue;
+            /* The type of the word of an extern symbol is 1 (see resolveChunk) */
+            isExternSymbol = (line->codeWords[mention->word] & 0x3) == 1;
+
+            if (isExternSymbol) {
+                if (numOfExternUses % 64 == 0) {
+                    ObjectSymbol *newExterns = (ObjectSymbol *) reallocateMemory(
+                            MEMORY_OBJECTS, object->externs, (numOfExternUses + 64) * sizeof(ObjectSymbol));
+                    if (newExterns == NULL)
+                        return false;
+                    object->externs = newExterns;
+                }
+                memcpy(object->externs[numOfExternUses].name, model->text + line->offset + mention->start,
+                       (size_t) mention->length);
+                object->externs[numOfExternUses].name[mention->length] = '\0';
+                object->externs[numOfExternUses++].value = line->address + mention->word;
+                object->numOfExterns = numOfExternUses;
+            }
+            if (!addRelocation(relocations, line->address + mention->word,
+                               isExternSymbol ? RELOCATION_EXTERNAL : RELOCATION_RELOCATABLE))
+                return false;
+        }
+    }
+    return true;
+}
+
+/* Compare entry points by the position of their first declaration, for qsort */
+static int compareEntries(const void *first, const void *second) {
+    long difference = ((const LinkedEntry *) first)->position - ((const LinkedEntry *) second)->position;
+
+    return difference < 0 ? -1 : difference > 0;
+}
+
+/* Collect the entry points in the order of their first declaration, like the symbol table keeps them. Returns false
+  if memory allocation has been failed */
+static int collectLinkedEntries(const SourceModel *model, ObjectFile *object) {
+    const LinkedSymbols *table = &model->symbols;
+    LinkedEntry *entries = (LinkedEntry *) allocateMemory(MEMORY_OBJECTS,
+                                                          (table->numOfSymbols + 1) * sizeof(LinkedEntry));
+    int numOfEntries = 0;
+    int i = 0;
+
+    object->entries = (ObjectSymbol *) allocateMemory(MEMORY_OBJECTS, (table->numOfSymbols + 1) * sizeof(ObjectSymbol));
+    if (entries == NULL || object->entries == NULL) {
+        freeMemory(entries);
+        return false;
+    }
+    for (; i < table->numOfSymbols; ++i) {
+        const LinkedSymbol *symbol = &table->symbols[i];
+
+        if (symbol->numOfEntries == 0)
+            continue;
+        /* The label of a line is it's first mention */
+        entries[numOfEntries].position = (long) symbol->entryLine * MAX_LINE_LENGTH + symbol->entryMention;
+        if (symbol->definingLine != -1 && symbol->definingLine <= symbol->entryLine)
+            entries[numOfEntries].position = (long) symbol->definingLine * MAX_LINE_LENGTH;
+        entries[numOfEntries++].symbol = i;
+    }
+    qsort(entries, (size_t) numOfEntries, sizeof(LinkedEntry), compareEntries);
+
+    for (i = 0; i < numOfEntries; ++i) {
+        const LinkedSymbol *symbol = &table->symbols[entries[i].symbol];
+
+        memcpy(object->entries[i].name, symbol->name, (size_t) symbol->length);
+        object->entries[i].name[symbol->length] = '\0';
+        object->entries[i].value = symbol->value;
+    }
+    object->numOfEntries = numOfEntries;
+    freeMemory(entries);
+    return true;
+}
+
+/* Forget the symbols of the model, so they are declared again from all it's lines as if they all have been parsed */
+static void resetSymbols(SourceModel *model) {
+    int i = 0;
+
+    model->symbols.numOfSymbols = 0;
+    if (model->symbols.buckets != NULL)
+        memset(model->symbols.buckets, 0xFF, model->symbols.capacity * sizeof(int));
+    model->numOfExternSymbols = 0;
+    for (; i < model->numOfLines; ++i) {
+        int j = 0;
+
+        for (; j < model->lines[i].numOfMentions; ++j)
+            model->lines[i].mentions[j].symbol = -1;
+    }
+    model->firstParsed = 0;
+    model->numOfParsed = model->numOfLines;
+    model->areSymbolsMoved = true;
+}
+
+/* Link the model into the results, like the end of the first pass and the second pass do: the symbols of the parsed
+  lines are declared, the symbols are placed, then the references of the parsed lines are encoded, and the
+  references of the other lines only if a symbol has been changed, by chunks of lines at once. Returns false if
+  memory allocation has been failed or the source has to be assembled whole */
+static int linkModel(SourceModel *model, Assembly *assembly, int numOfThreads) {
+    ObjectFile *object = &assembly->object;
+    RelocationTable relocations = {NULL, 0, 0, 0, INITIAL_ADDRESS_VALUE};
+    LineChunk chunks[MAX_ASSEMBLY_THREADS];
+    ModelLine *lines = NULL;
+    int numOfLines = 0;
+    int numOfChunks;
+    int numOfMisses = 0;
+    int numOfWrapped = 0;
+    long numOfEncoded = 0;
+    int isLinked = model->symbols.capacity > 0 || growBuckets(&model->symbols);
+    int i;
+
+    memset(assembly, 0, sizeof(Assembly));
+    if (!model->isLinked)
+        resetSymbols(model);
+    model->isLinked = false;
+
+    for (i = model->firstParsed; isLinked && i < model->firstParsed + model->numOfParsed; ++i) {
+        model->areSymbolsMoved = model->areSymbolsMoved || hasDeclarations(&model->lines[i]);
+        isLinked = declareLine(model, i);
+    }
+    if (isLinked) {
+        /* The other lines are encoded only if a symbol has been changed */
+        lines = model->lines + model->firstParsed;
+        numOfLines = model->numOfParsed;
+        if (model->areSymbolsMoved && placeSymbols(model) > 0) {
+            lines = model->lines;
+            numOfLines = model->numOfLines;
+        }
+        numOfChunks = getNumOfChunks(numOfLines, numOfThreads);
+        splitChunks(chunks, numOfChunks, lines, NULL, numOfLines);
+        for (i = 0; i < numOfChunks; ++i)
+            chunks[i].model = model;
+        runChunks(resolveChunk, chunks, numOfChunks);
+        for (i = 0; i < numOfChunks; ++i) {
+            numOfMisses += chunks[i].numOfMisses;
+            numOfEncoded += chunks[i].numOfEncoded;
+            numOfWrapped += chunks[i].numOfWrapped;
+        }
+        isLinked = numOfWrapped == 0;
+    }
+    for (i = model->firstParsed; isLinked && numOfMisses > 0 && i < model->firstParsed + model->numOfParsed; ++i)
+        isLinked = addUsedSymbols(model, &model->lines[i]);
+    isLinked = isLinked && collectReferences(model, object, &relocations) && collectLinkedEntries(model, object);
+
+    object->codeWords = model->codeWords;
+    object->dataWords = model->dataWords;
+    object->words = (unsigned int *) allocateMemory(MEMORY_OBJECTS,
+                                                    (object->codeWords + object->dataWords + 1) * sizeof(unsigned int));
+    object->relocations = (unsigned char *) allocateMemory(MEMORY_OBJECTS, (size_t) relocations.size + 1);
+    isLinked = isLinked && object->words != NULL && object->relocations != NULL;
+
+    if (isLinked) {
+        /* Instruction words first, data words follow them */
+        for (i = 0; i < model->numOfLines; ++i) {
+            const ModelLine *line = &model->lines[i];
+
+            memcpy(object->words + line->address - INITIAL_ADDRESS_VALUE, line->codeWords,
+                   line->numOfCodeWords * sizeof(unsigned int));
+            if (line->numOfDataWords > 0)
+                memcpy(object->words + object->codeWords + line->dataIndex, line->dataWords,
+                       line->numOfDataWords * sizeof(unsigned int));
+        }
+        if (relocations.size > 0)
+            memcpy(object->relocations, relocations.bytes, (size_t) relocations.size);
+        object->numOfRelocations = relocations.count;
+        object->relocationsSize = relocations.size;
+
+        assembly->hasExternDeclarations = model->numOfExternSymbols > 0;
+        if (isTracing()) {
+            long numOfDefined = 0;
+
+            for (i = 0; i < model->symbols.numOfSymbols; ++i)
+                numOfDefined += model->symbols.symbols[i].type == 2;
+            traceCounter("words emitted", (long) object->codeWords + object->dataWords);
+            traceCounter("symbols defined", numOfDefined);
+            traceCounter("references encoded", numOfEncoded);
+        }
+    } else
+        freeAssembly(assembly);
+
+    freeRelocationTable(&relocations);
+    model->isLinked = isLinked;
+    return isLinked;
+}
+
+/* Span the macros of a source like assembleSourceWithOptions does, returns false if an error has been found. The
+  scope keeps the included files */
+static int expandSource(const char *source, long size, const AssemblyOptions *options, TextBuffer *expanded,
+                        MacroScope *scope, int *hasMacroDeclaration) {
+    AssemblerContext context;
+    SourceReader reader;
+    int isExpanded;
+
+    initAssemblerContext(&context);
+    initSourceReader(&reader, source, size);
+    context.sourcePath = options->sourcePath;
+    context.macroCacheDirectory = options->macroCacheDirectory;
+
+    *hasMacroDeclaration = hasMacro(&context, &reader);
+    if (*hasMacroDeclaration)
+        spanMacros(&context, &reader, expanded, scope);
+    isExpanded = !context.errorFlag && context.numOfDiagnostics == 0;
+    freeAssemblerContext(&context);
+    return isExpanded;
+}
+
+void initIncrementalAssembly(IncrementalAssembly *incremental) {
+    incremental->model = NULL;
+}
+
+int reassembleSource(IncrementalAssembly *incremental, const char *source, long size, const AssemblyOptions *options,
+                     Assembly *assembly) {
+    TextBuffer expanded = {NULL, 0, 0};
+    MacroScope scope = {NULL, NULL, 0, 0, NULL, 0, 0};
+    AssemblyOptions wholeOptions = *options;
+    const char *text = source;
+    long textSize = size;
+    int hasMacroDeclaration;
+    int isModeled;
+    double phaseStart;
+
+    /* The optimizations rewrite the whole source, and a source whose macros have errors is reported by the passes.
+      The passes run on this thread (a source which is assembled by threads is assembled by this function) */
+    wholeOptions.numOfThreads = 0;
+    if (options->optimizations != 0 ||
+        !expandSource(source, size, options, &expanded, &scope, &hasMacroDeclaration)) {
+        freeMemory(expanded.text);
+        freeMacroScope(&scope);
+        freeIncrementalAssembly(incremental);
+        return assembleSourceWithOptions(source, size, &wholeOptions, assembly);
+    }
+    if (hasMacroDeclaration) {
+        text = expanded.text != NULL ? expanded.text : "";
+        textSize = expanded.size;
+    }
+
+    if (incremental->model == NULL) {
+        incremental->model = (SourceModel *) allocateMemory(MEMORY_ENCODING, sizeof(SourceModel));
+        if (incremental->model != NULL) {
+            memset(incremental->model, 0, sizeof(SourceModel));
+            initAssemblerContext(&incremental->model->scratch);
+        }
+    }
+
+    phaseStart = traceBegin();
+    isModeled = incremental->model != NULL && updateModel(incremental->model, text, textSize, options->numOfThreads);
+    traceEnd(TRACE_CATEGORY_PHASE, "reparse", phaseStart);
+    if (!isModeled)
+        freeIncrementalAssembly(incremental);
+
+    /* The lines with errors are reported by the passes, as well as the symbols they treat specially. The symbols of
+      a model which isn't linked are declared again from all it's lines, when it's linked next */
+    if (isModeled && incremental->model->numOfInvalidLines > 0)
+        incremental->model->isLinked = false;
+    phaseStart = traceBegin();
+    isModeled = isModeled && incremental->model->numOfInvalidLines == 0 &&
+                linkModel(incremental->model, assembly, options->numOfThreads);
+    traceEnd(TRACE_CATEGORY_PHASE, "link", phaseStart);
+    if (!isModeled) {
+        freeMemory(expanded.text);
+        freeMacroScope(&scope);
+        return assembleSourceWithOptions(source, size, &wholeOptions, assembly);
+    }
+
+    /* The expanded source and the included files are handed to the caller */
+    assembly->expandedSource = hasMacroDeclaration ? expanded.text : NULL;
+    assembly->expandedSize = hasMacroDeclaration ? expanded.size : 0;
+    assembly->includedFiles = scope.includedFiles;
+    assembly->numOfIncludedFiles = scope.numOfIncludedFiles;
+    scope.includedFiles = NULL;
+    freeMacroScope(&scope);
+    return true;
+}
+
+void freeIncrementalAssembly(IncrementalAssembly *incremental) {
+    SourceModel *model = incremental->model;
+
+    if (model == NULL)
+        return;
+    freeLines(model->lines, model->numOfLines);
+    freeMemory(model->lines);
+    freeMemory(model->text);
+    freeMemory(model->symbols.symbols);
+    freeMemory(model->symbols.buckets);
+    freeAssemblerContext(&model->scratch);
+    freeMemory(model);
+    incremental->model = NULL;
+}
@@ -0,0 +1,140 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+/**
+ * @file incremental.h
+ * @brief The model of a source which is assembled again and again as it's edited (see reassembleSource).
+ *
+ * The model keeps every line of the source (after macro spanning) the way the passes read it: it's instruction
+ * words, it's data words, and the symbols it declares and uses, by their position in the line. When the source is
+ * assembled again, the lines at it's start and at it's end which haven't been changed are kept as they are, only
+ * the lines between them are parsed again (each on it's own, by the first pass), and the lines which follow them are
+ * shifted by the difference of the words.
+ *
+ * The symbols are kept by the model as well, with the value and the type their references have been encoded with
+ * last, and every mention of a line refers to it's symbol. When the source is linked again, only the symbols of the
+ * lines which have been replaced are dropped and only the symbols of the parsed lines are declared, then the words
+ * of the references of the parsed lines are encoded, and the words of the other references only where the value or
+ * the type of their symbol has been changed (by a shift of the lines or by a declaration). The results are still
+ * copied out of the model whole: the words, and the relocations and the extern uses, whose addresses are shifted.
+ *
+ * A source which has errors, or whose symbols are declared in ways the passes treat specially (a label which is
+ * declared twice, an entry point which is extern, a label which is extern) or whose references don't fit in the
+ * operand of a word, is assembled whole instead, so the results are always those of assembleSourceWithOptions.
+ */
+
+/**
+ * A label of an instruction (or of an .entry/.extern directive), it's value is the address of the line.
+ */
+#define MENTION_LABEL 0
+
+/**
+ * A label of a .data/.string directive, it's value is the index of the data of the line after the code image.
+ */
+#define MENTION_DATA_LABEL 1
+
+/**
+ * A symbol which is declared as an entry point by an .entry directive.
+ */
+#define MENTION_ENTRY 2
+
+/**
+ * A symbol which is declared as an extern symbol by an .extern directive.
+ */
+#define MENTION_EXTERN 3
+
+/**
+ * A symbol whose address is held by a word of an instruction (a direct operand).
+ */
+#define MENTION_REFERENCE 4
+
+/**
+ * The largest number of words of an instruction.
+ */
+#define MAX_INSTRUCTION_WORDS 3
+
+/**
+ * @struct ModelMention
+ * @brief Structure to represent a symbol which is declared or used by a line.
+ */
+typedef struct ModelMention {
+    int kind;       /* The kind of the mention (MENTION_*). */
+    int start;      /* The index of the first character of the symbol in the line. */
+    int length;     /* The number of characters of the symbol. */
+    int word;       /* The index of the word which holds the address of a reference, in the line. */
+    int symbol;     /* The index of the symbol in the symbols of the model, -1 until the line is linked. */
+} ModelMention;
+
+/**
+ * @struct ModelLine
+ * @brief Structure to represent a line of the source, as the passes read it.
+ */
+typedef struct ModelLine {
+    long offset;                                    /* The index of the first character of the line. */
+    int length;                                     /* The number of characters of the line. */
+    int isValid;                                    /* False if an error has been found in the line. */
+    int address;                                    /* The address of the first instruction word. */
+    int dataIndex;                                  /* The index of the first data word. */
+    int numOfCodeWords;                             /* The number of instruction words. */
+    unsigned int codeWords[MAX_INSTRUCTION_WORDS];  /* The instruction words, as they have been linked last. */
+    int numOfDataWords;                             /* The number of data words. */
+    unsigned int *dataWords;                        /* The data words, NULL if there are none. */
+    int numOfMentions;                              /* The number of mentions of symbols. */
+    ModelMention *mentions;                         /* The mentions of symbols, NULL if there are none. */
+} ModelLine;
+
+/**
+ * @struct LinkedSymbol
+ * @brief Structure to represent a symbol of the model, which is declared or used by it's lines.
+ */
+typedef struct LinkedSymbol {
+    char name[MAX_LINE_LENGTH]; /* The name of the symbol. */
+    int length;                 /* The number of characters of the name. */
+    unsigned long hash;         /* The hash of the name. */
+    int definingLine;           /* The index of the line whose label declares the symbol, -1 if none. */
+    int numOfLabels;            /* The number of labels which declare the symbol. */
+    int isData;                 /* True if the symbol is the label of data. */
+    int numOfEntries;           /* The number of mentions which declare the symbol as an entry point. */
+    int entryLine;              /* The index of the line of the first of them, -1 if none. */
+    int entryMention;           /* The index of the first of them in it's line. */
+    int numOfExterns;           /* The number of mentions which declare the symbol as extern. */
+    int value;                  /* The value the references have been encoded with last, -1 if it isn't declared. */
+    int type;                   /* The type they have been encoded with (1 extern, 2 relocatable, -1 undeclared). */
+    int isChanged;              /* True if the value or the type has been changed by the last link. */
+} LinkedSymbol;
+
+/**
+ * @struct LinkedSymbols
+ * @brief Structure to represent the symbols of the model, with a hash table of them.
+ */
+typedef struct LinkedSymbols {
+    LinkedSymbol *symbols;      /* The symbols, in the order they have been added. */
+    int numOfSymbols;           /* The number of symbols. */
+    int symbolsCapacity;        /* The number of symbols allocated. */
+    int *buckets;               /* The index of the symbol of every bucket, -1 for an empty bucket. */
+    unsigned long capacity;     /* The number of buckets, a power of 2 (0 until the model is linked first). */
+} LinkedSymbols;
+
+/**
+ * @struct SourceModel
+ * @brief Structure to represent the model of a source, as it has been assembled last.
+ */
+typedef struct SourceModel {
+    char *text;                 /* The source (after macro spanning), the lines refer to it. */
+    long size;                  /* The number of characters of the source. */
+    ModelLine *lines;           /* The lines, in the order of the source. */
+    int numOfLines;             /* The number of lines. */
+    int linesCapacity;          /* The number of lines allocated. */
+    int numOfInvalidLines;      /* The number of lines which have errors. */
+    int codeWords;              /* The number of instruction words of all the lines. */
+    int dataWords;              /* The number of data words of all the lines. */
+    LinkedSymbols symbols;      /* The symbols of the lines, as they have been linked last. */
+    int numOfExternSymbols;     /* The number of symbols which are declared as extern. */
+    int isLinked;               /* False if the symbols have to be declared again from all the lines. */
+    int firstParsed;            /* The index of the first line which has been parsed by the last update. */
+    int numOfParsed;            /* The number of lines which have been parsed by the last update. */
+    int areSymbolsMoved;        /* True if the last update may have changed the values of symbols. */
+    AssemblerContext scratch;   /* The context the lines are parsed by, a line at a time. */
+} SourceModel;
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef ISA_H
+#define ISA_H
+
+/**
+ * @file isa.h
+ * @brief The geometry of the machine the assembler is built for: its word width, its registers and the address
+ * its code is loaded at.
+ *
+ * The geometry is decided when the assembler is compiled, by ISA_VARIANT (0, the classic machine, when it isn't
+ * defined), so the encoder and the emitter are compiled with constant masks and widths and pay nothing at run time.
+ * The build produces an assembler, a disassembler and a simulator for every variant (see the CMake and make files).
+ *
+ * Whatever the width, the instruction word keeps its layout: bits 0-1 are the A,R,E bits, bits 2-4 the destination
+ * addressing method, bits 5-8 the opcode and bits 9-11 the source addressing method. The wider bits of the first
+ * word stay zero. The address of a direct operand takes every bit above the A,R,E bits, and the two registers of a
+ * register word split them into two fields, destination first.
+ */
+
+#ifndef ISA_VARIANT
+#define ISA_VARIANT 0
+#endif
+
+#if ISA_VARIANT == 0
+/* The classic machine */
+#define ISA_NAME "isa0"
+#define ISA_WORD_BITS 12
+#define ISA_NUM_OF_REGISTERS 8
+#define ISA_BASE_ADDRESS 100
+#elif ISA_VARIANT == 1
+/* Revision B: a wider address field */
+#define ISA_NAME "isa1"
+#define ISA_WORD_BITS 14
+#define ISA_NUM_OF_REGISTERS 8
+#define ISA_BASE_ADDRESS 100
+#elif ISA_VARIANT == 2
+/* Revision C: 16-bit words and twice the registers, the code is loaded after the first 256 words */
+#define ISA_NAME "isa2"
+#define ISA_WORD_BITS 16
+#define ISA_NUM_OF_REGISTERS 16
+#define ISA_BASE_ADDRESS 256
+#elif ISA_VARIANT == 3
+/* Revision D: 24-bit words, the code is loaded after the first 1024 words */
+#define ISA_NAME "isa3"
+#define ISA_WORD_BITS 24
+#define ISA_NUM_OF_REGISTERS 32
+#define ISA_BASE_ADDRESS 1024
+#else
+#error "Unknown ISA_VARIANT, the variants are 0 to 3"
+#endif
+
+/**
+ * The mask of the bits of a word.
+ */
+#define ISA_WORD_MASK ((1UL << ISA_WORD_BITS) - 1)
+
+/**
+ * The number of bits of the address of a direct operand, above the A,R,E bits.
+ */
+#define ISA_OPERAND_BITS (ISA_WORD_BITS - 2)
+
+/**
+ * The largest address a direct operand holds, a symbol above it doesn't fit in the word of a reference.
+ */
+#define ISA_MAX_OPERAND_ADDRESS ((1L << ISA_OPERAND_BITS) - 1)
+
+/**
+ * The number of bits of each of the two register fields of a register word.
+ */
+#define ISA_REGISTER_BITS (ISA_OPERAND_BITS / 2)
+
+/**
+ * The number of base 64 characters of a word in the ".ob" file.
+ */
+#define ISA_BASE64_DIGITS ((ISA_WORD_BITS + 5) / 6)
+
+/**
+ * The number of bytes a word takes in the code image and the binary object file, when words aren't packed in pairs.
+ */
+#define ISA_WORD_BYTES ((ISA_WORD_BITS + 7) / 8)
+
+#if ISA_WORD_BITS < 12 || ISA_WORD_BITS > 24
+#error "The width of a word has to be 12 to 24 bits"
+#endif
+
+#if ISA_NUM_OF_REGISTERS > (1 << ISA_REGISTER_BITS)
+#error "The registers don't fit in the register fields of a word"
+#endif
+
+#endif
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <string.h>
+#include "data.h"
+#include "libasm.h"
+#include "literals.h"
+
+/* The least number of characters of a source which is parsed by several threads, a smaller source isn't worth them */
+#define MIN_THREADED_SOURCE_SIZE 65536
+
+/* Unpack the first count words of an image into an array, unwritten words are zero words */
+static void collectImageWords(const CodeImage *image, unsigned int *words, int count) {
+    CodeImageIterator iterator;
+    int read = 0;
+    int blockLength;
+
+    initCodeImageIterator(&iterator, image);
+    while (read < count && (blockLength = nextCodeImageBlock(&iterator, words + read, count - read)) > 0)
+        read += blockLength;
+    for (; read < count; ++read)
+        words[read] = 0;
+}
+
+/* Copy the machine code and the tables of a source which has been assembled into an object */
+static int collectObject(AssemblerContext *context, ObjectFile *object) {
+    object->codeWords = context->address - INITIAL_ADDRESS_VALUE;
+    object->dataWords = context->dataCounter;
+    object->words = (unsigned int *) allocateMemory(MEMORY_OBJECTS,
+                                                    (object->codeWords + object->dataWords + 1) * sizeof(unsigned int));
+    object->numOfEntries = collectEntrySymbols(context, &object->entries);
+    object->numOfExterns = collectExternUses(context, &object->externs);
+    object->numOfRelocations = context->relocationTable.count;
+    object->relocationsSize = context->relocationTable.size;
+    object->relocations = (unsigned char *) allocateMemory(MEMORY_OBJECTS, (size_t) object->relocationsSize + 1);
+
+    if (object->words == NULL || object->numOfEntries < 0 || object->numOfExterns < 0 || object->relocations == NULL)
+        return false;
+
+    /* Instruction words first, data words follow them */
+    collectImageWords(&context->codeImage, object->words, object->codeWords);
+    collectImageWords(&context->dataImage, object->words + object->codeWords, object->dataWords);
+    if (object->relocationsSize > 0)
+        memcpy(object->relocations, context->relocationTable.bytes, (size_t) object->relocationsSize);
+    return true;
+}
+
+/* Hand the results of a context to the caller and free the context */
+static int finishAssembly(AssemblerContext *context, Assembly *assembly) {
+    /* Memory allocation has been failed while collecting the object */
+    if (!context->errorFlag && !collectObject(context, &assembly->object)) {
+        freeObjectFile(&assembly->object);
+        context->errorFlag = 1;
+        addDiagnostic(context, 12, "");
+    }
+    assembly->failed = context->errorFlag;
+    assembly->hasExternDeclarations = hasExtern(context);
+    if (isTracing()) {
+        traceCounter("words emitted", (long) assembly->object.codeWords + assembly->object.dataWords);
+        traceCounter("symbols defined", getNumOfDefinedSymbols(context));
+    }
+
+    /* The diagnostics are handed to the caller, everything else is freed with the context */
+    assembly->diagnostics = context->diagnostics;
+    assembly->numOfDiagnostics = context->numOfDiagnostics;
+    context->diagnostics = NULL;
+    freeAssemblerContext(context);
+    return !assembly->failed;
+}
+
+int assembleSource(const char *source, long size, Assembly *assembly) {
+    AssemblyOptions options = {0};
+
+    return assembleSourceWithOptions(source, size, &options, assembly);
+}
+
+int assembleSourceWithOptions(const char *source, long size, const AssemblyOptions *options, Assembly *assembly) {
+    AssemblerContext context;
+    SourceReader reader;
+    TextBuffer expanded = {NULL, 0, 0};
+    TextBuffer optimized = {NULL, 0, 0};
+    LiteralPool pool = {NULL, 0, 0};
+    MacroScope scope = {NULL, NULL, 0, 0, NULL, 0, 0};
+    int hasMacroDeclaration;
+    double phaseStart;
+    int isAssembled;
+
+    /* A large source is split into chunks of lines which are parsed by threads at once, through a model of it's
+      lines which is dropped right away (see incremental.h) */
+    if (options->numOfThreads > 1 && options->optimizations == 0 && size >= MIN_THREADED_SOURCE_SIZE) {
+        IncrementalAssembly threaded;
+
+        initIncrementalAssembly(&threaded);
+        isAssembled = reassembleSource(&threaded, source, size, options, assembly);
+        freeIncrementalAssembly(&threaded);
+        return isAssembled;
+    }
+
+    memset(assembly, 0, sizeof(Assembly));
+    initAssemblerContext(&context);
+    initSourceReader(&reader, source, size);
+    context.sourcePath = options->sourcePath;
+    context.macroCacheDirectory = options->macroCacheDirectory;
+
+    /* Source has at least one macro declaration or include, the passes are executed on the source after macro
+      spanning */
+    phaseStart = traceBegin();
+    STATS_START(STATS_PHASE_MACRO_SCAN);
+    hasMacroDeclaration = hasMacro(&context, &reader);
+    STATS_STOP(STATS_PHASE_MACRO_SCAN);
+    if (hasMacroDeclaration) {
+        STATS_START(STATS_PHASE_MACRO_SPANNING);
+        spanMacros(&context, &reader, &expanded, &scope);
+        STATS_STOP(STATS_PHASE_MACRO_SPANNING);
+
+        /* The included files are handed to the caller, the macros are freed right away */
+        assembly->includedFiles = scope.includedFiles;
+        assembly->numOfIncludedFiles = scope.numOfIncludedFiles;
+        scope.includedFiles = NULL;
+        freeMacroScope(&scope);
+        initSourceReader(&reader, expanded.text != NULL ? expanded.text : "", expanded.size);
+        assembly->expandedSource = expanded.text;
+        assembly->expandedSize = expanded.size;
+    }
+    traceEnd(TRACE_CATEGORY_PHASE, "preprocess", phaseStart);
+
+    /* The passes are executed on the optimized source, the source isn't optimized when there's an error already or
+      memory allocation has been failed */
+    if ((options->optimizations & OPTIMIZE_SOURCE) != 0 && !context.errorFlag) {
+        phaseStart = traceBegin();
+        assembly->wordsSaved = optimizeSource(reader.text, reader.size, options->optimizations, &optimized);
+        if (assembly->wordsSaved >= 0)
+            initSourceReader(&reader, optimized.text != NULL ? optimized.text : "", optimized.size);
+        else
+            assembly->wordsSaved = 0;
+        traceEnd(TRACE_CATEGORY_PHASE, "optimize", phaseStart);
+    }
+
+    /* Skip the passes when an error has been found by the pre assembly process */
+    if (!context.errorFlag) {
+        phaseStart = traceBegin();
+        STATS_START(STATS_PHASE_FIRST_PASS);
+        reader.position = 0;
+        firstPass(&context, &reader);
+        STATS_STOP(STATS_PHASE_FIRST_PASS);
+        traceEnd(TRACE_CATEGORY_PHASE, "pass 1", phaseStart);
+
+        /* The data symbols are moved to the pooled data image before the second pass encodes their uses, the data
+          image isn't pooled when memory allocation has been failed */
+        if ((options->optimizations & OPTIMIZE_POOL_LITERALS) != 0 && !context.errorFlag) {
+            phaseStart = traceBegin();
+            if (!planLiteralPool(&context, &pool))
+                freeLiteralPool(&pool);
+            traceEnd(TRACE_CATEGORY_PHASE, "pool literals", phaseStart);
+        }
+        phaseStart = traceBegin();
+        STATS_START(STATS_PHASE_SECOND_PASS);
+        reader.position = 0; /* Read the source again from it's start */
+        secondPass(&context, &reader);
+        STATS_STOP(STATS_PHASE_SECOND_PASS);
+        traceEnd(TRACE_CATEGORY_PHASE, "pass 2", phaseStart);
+
+        if (pool.sourceIndices != NULL && !context.errorFlag) {
+            if (applyLiteralPool(&context, &pool))
+                assembly->dataWordsSaved = pool.originalWords - pool.numOfWords;
+            else {
+                context.errorFlag = 1;
+                addDiagnostic(&context, 12, "");
+            }
+        }
+        freeLiteralPool(&pool);
+    }
+
+    isAssembled = finishAssembly(&context, assembly);
+    freeMemory(optimized.text);
+    return isAssembled;
+}
+
+void initAssemblyBuilder(AssemblyBuilder *builder) {
+    initAssemblerContext(&builder->context);
+    builder->fixups = NULL;
+    builder->numOfFixups = 0;
+    builder->fixupsCapacity = 0;
+}
+
+/* Copy the name of a symbol, a name which is too long is reported and truncated */
+static void copySymbolName(AssemblyBuilder *builder, const char *name, char *symbolName) {
+    if (strlen(name) > MAX_LABEL_LENGTH)
+        reportError(&builder->context, 9, name);
+    strncpy(symbolName, name, MAX_LABEL_LENGTH);
+    symbolName[MAX_LABEL_LENGTH] = '\0';
+}
+
+void emitLabel(AssemblyBuilder *builder, const char *name, int isDataLabel) {
+    AssemblerContext *context = &builder->context;
+    char label[MAX_LABEL_LENGTH + 1];
+    int value = isDataLabel ? context->dataCounter : context->address;
+
+    context->lineNum++;
+    copySymbolName(builder, name, label);
+
+    /* Add symbol to the symbol table if not exist yet, a symbol which has only been declared as an entry
+      point gets it's address, any other symbol is a duplicated symbol (like processLabelDeclaration) */
+    if (!isSymbolExist(context, label)) {
+        addToSymbolTable(context, label, value, 0, 0);
+        if (isDataLabel)
+            setDataSymbol(context, label);
+    } else if (getSymbolValue(context, label) == 0 && !isDataSymbol(context, label)) {
+        updateSymbolTable(context, label, value);
+        if (isDataLabel)
+            setDataSymbol(context, label);
+    } else
+        reportError(context, 19, name);
+}
+
+/* Add the word of an operand at the current address, the address of a symbol is added when the builder finishes */
+static void emitOperandWord(AssemblyBuilder *builder, const AssemblyOperand *operand, int addressingMethod,
+                            int isSource) {
+    AssemblerContext *context = &builder->context;
+    unsigned int binaryCode = 0;
+
+    if (addressingMethod == METHOD_IMMEDIATE)
+        binaryCode = decimalToBinary12Bit(operand->value);
+    else if (addressingMethod == METHOD_DIRECT) {
+        if (builder->numOfFixups == builder->fixupsCapacity) {
+            int newCapacity = builder->fixupsCapacity == 0 ? 64 : builder->fixupsCapacity * 2;
+            AssemblyFixup *newFixups = (AssemblyFixup *) reallocateMemory(MEMORY_ENCODING, builder->fixups,
+                                                                          newCapacity * sizeof(AssemblyFixup));
+            if (newFixups == NULL) {
+                reportError(context, 12, operand->symbol);
+                return;
+            }
+            builder->fixups = newFixups;
+            builder->fixupsCapacity = newCapacity;
+        }
+        builder->fixups[builder->numOfFixups].address = context->address;
+        copySymbolName(builder, operand->symbol, builder->fixups[builder->numOfFixups].symbol);
+        builder->numOfFixups++;
+    } else if (isSource) /* Source register takes bits 7-11 */
+        binaryCode = registersToBinary(0, operand->value);
+    else /* Destination register takes bits 2-6 */
+        binaryCode = registersToBinary(operand->value, 0);
+
+    addToCodeWordTable(context, "", binaryCode);
+    context->address++;
+}
+
+void emitInstruction(AssemblyBuilder *builder, int opCode, int srcMethod, const AssemblyOperand *src,
+                     int dstMethod, const AssemblyOperand *dst) {
+    AssemblerContext *context = &builder->context;
+
+    context->lineNum++;
+    addToCodeWordTable(context, "", generateBinaryCode(dstMethod, opCode, srcMethod));
+    context->address++;
+
+    /* Two registers share a single word */
+    if (srcMethod == METHOD_DIRECT_REGISTER && dstMethod == METHOD_DIRECT_REGISTER) {
+        addToCodeWordTable(context, "", registersToBinary(dst->value, src->value));
+        context->address++;
+        return;
+    }
+
+    /* A word for the source operand, then a word for the destination operand */
+    if (srcMethod != METHOD_NONE)
+        emitOperandWord(builder, src, srcMethod, true);
+    if (dstMethod != METHOD_NONE)
+        emitOperandWord(builder, dst, dstMethod, false);
+}
+
+void emitData(AssemblyBuilder *builder, const int *values, int count) {
+    AssemblerContext *context = &builder->context;
+    int i = 0;
+
+    context->lineNum++;
+    for (; i < count; ++i) {
+        addToDataWordTable(context, "", decimalToBinary12Bit(values[i]));
+        context->dataCounter++;
+    }
+}
+
+void emitString(AssemblyBuilder *builder, const char *text) {
+    builder->context.lineNum++;
+    encodeString(&builder->context, text, text);
+}
+
+void emitEntry(AssemblyBuilder *builder, const char *name) {
+    AssemblerContext *context = &builder->context;
+    char symbolName[MAX_LABEL_LENGTH + 1];
+
+    context->lineNum++;
+    copySymbolName(builder, name, symbolName);
+
+    /* Mark the symbol as an entry point, unless it has been marked as an extern point (like processEntryDirective) */
+    if (!isSymbolExist(context, symbolName))
+        addToSymbolTable(context, symbolName, 0, 1, 0);
+    else if (!isExtern(context, symbolName))
+        setEntrySymbol(context, symbolName);
+    else
+        reportError(context, 10, name);
+}
+
+void emitExtern(AssemblyBuilder *builder, const char *name) {
+    AssemblerContext *context = &builder->context;
+    char symbolName[MAX_LABEL_LENGTH + 1];
+
+    context->lineNum++;
+    copySymbolName(builder, name, symbolName);
+
+    /* Mark the symbol as an extern point, unless it has been marked as an entry point (like processExternDirective) */
+    if (!isSymbolExist(context, symbolName))
+        addToSymbolTable(context, symbolName, 0, 0, 1);
+    else if (!isEntry(context, symbolName))
+        setExternSymbol(context, symbolName);
+    else
+        reportError(context, 11, name);
+}
+
+int finishAssemblyBuilder(AssemblyBuilder *builder, Assembly *assembly) {
+    AssemblerContext *context = &builder->context;
+    int i = 0;
+
+    memset(assembly, 0, sizeof(Assembly));
+
+    /* Place the data image right after the code image, then resolve the symbols like the second pass does */
+    relocateDataSymbols(context, context->address);
+    for (; i < builder->numOfFixups && !context->errorFlag; ++i) {
+        const AssemblyFixup *fixup = &builder->fixups[i];
+        int isExternSymbol = isExtern(context, fixup->symbol);
+        int value = getSymbolValue(context, fixup->symbol);
+        int type = getSymbolType(context, fixup->symbol);
+
+        /* A symbol whose address doesn't fit in the operand would be wrapped */
+        if (type != -1 && !isOperandAddress(value))
+            reportError(context, 16, fixup->symbol);
+        if (!setCodeImageWord(&context->codeImage, fixup->address - INITIAL_ADDRESS_VALUE,
+                              convertTo12BitBinary(value, type)))
+            reportError(context, 12, fixup->symbol);
+        if (isExternSymbol)
+            addToExternSymbolTable(context, fixup->symbol, fixup->address);
+        if (!addRelocation(&context->relocationTable, fixup->address,
+                           isExternSymbol ? RELOCATION_EXTERNAL : RELOCATION_RELOCATABLE))
+            reportError(context, 12, fixup->symbol);
+    }
+    context->endFirstPassFlag = 1;
+
+    freeMemory(builder->fixups);
+    builder->fixups = NULL;
+    builder->numOfFixups = 0;
+    builder->fixupsCapacity = 0;
+    return finishAssembly(context, assembly);
+}
+
+void freeAssembly(Assembly *assembly) {
+    freeObjectFile(&assembly->object);
+    freeMemory(assembly->expandedSource);
+    freeMemory(assembly->diagnostics);
+    freeMemory(assembly->includedFiles);
+    memset(assembly, 0, sizeof(Assembly));
+}
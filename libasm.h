@@ -0,0 +1,255 @@
+#ifndef LIBASM_H
+#define LIBASM_H
+
+/**
+ * @file libasm.h
+ * @brief The library interface of the assembler, which assembles a source held in memory.
+ *
+ * The library doesn't read or write any file (except for the macro libraries of .include directives): every
+ * source is assembled with a context of it's own, and the results are returned in memory which is owned by the
+ * caller. So sources can be assembled from several threads at once. The state which is shared by the whole process
+ * is:
+ *   - the statistics of --stats (stats.h), which aren't synchronized: a build with ASSEMBLER_STATS counts them for
+ *     every source, so it has to assemble a source at a time,
+ *   - the memory accounting (allocator.h) and the trace events (trace.h), which are guarded by a mutex of their
+ *     own: they're enabled by enableMemoryAccounting/enableTracing before any source is assembled,
+ *   - the cache of macro libraries (macrolib.h), guarded by a mutex as well: a library which has been spanned for a
+ *     source is reused by every other source until freeMacroLibraries is called, with no source being assembled.
+ *
+ * A program which already knows it's instructions can skip the source altogether: an AssemblyBuilder takes the
+ * labels, instructions and data one at a time, feeds them into the same symbol table and encoding rules, and
+ * resolves the symbols at the end, so the results are identical to assembling the equivalent source.
+ *
+ * A source which is edited and assembled again and again (by an editor, or the --watch option) can be assembled
+ * incrementally: an IncrementalAssembly keeps a model of the lines of the source, and reassembleSource parses only
+ * the lines which have been changed since the last time.
+ *
+ * A large source can be parsed by several threads (see AssemblyOptions), every thread parses a chunk of lines of
+ * it's own and the chunks are linked once all of them have been parsed.
+ */
+
+#include "objectfile.h"
+#include "context.h"
+#include "optimizer.h"
+
+/**
+ * @struct Assembly
+ * @brief Structure to represent the results of assembling a source.
+ */
+typedef struct Assembly {
+    ObjectFile object;                  /* The machine code, the entry points, the extern uses and the relocations. */
+    int hasExternDeclarations;          /* True if the source declares at least one extern symbol. */
+    char *expandedSource;               /* The source after macro spanning, or NULL if it has no macros. */
+    long expandedSize;                  /* The number of characters of the expanded source. */
+    AssemblerDiagnostic *diagnostics;   /* The errors (and notes) which have been found, in the order of the lines. */
+    int numOfDiagnostics;               /* The number of diagnostics. */
+    MacroDependency *includedFiles;     /* The files the source includes (by .include), directly or not. */
+    int numOfIncludedFiles;             /* The number of included files. */
+    int failed;                         /* True if at least one error has been found, the object is empty then. */
+    int wordsSaved;                     /* The number of words the optimizer has saved. */
+    int dataWordsSaved;                 /* The number of data words the literal pool has saved. */
+} Assembly;
+
+/**
+ * The largest number of threads a source is assembled by.
+ */
+#define MAX_ASSEMBLY_THREADS 64
+
+/**
+ * @struct AssemblyOptions
+ * @brief Structure to represent the options of assembling a source.
+ */
+typedef struct AssemblyOptions {
+    int optimizations;                  /* The optimizations to apply to the source (OPTIMIZE_*), 0 for none. */
+    const char *sourcePath;             /* The path of the source, the included files are relative to it. */
+    const char *macroCacheDirectory;    /* Where the precompiled macro libraries are kept, NULL for none. */
+    int numOfThreads;                   /* The number of threads the lines of a large source are parsed by. */
+} AssemblyOptions;
+
+/**
+ * @brief Assembles a source held in memory.
+ *
+ * The source is macro spanned, and the first and second passes are executed on it. If no error has been found,
+ * the object holds the instruction words followed by the data words, the entry points, the uses of the extern
+ * symbols and the relocation table, exactly like the binary object file of the source.
+ *
+ * @param source The source, it doesn't have to be null terminated.
+ * @param size The number of characters of the source.
+ * @param assembly The results, which have to be freed with freeAssembly (even if the assembly has failed).
+ * @return True if the source has been assembled, false if an error has been found.
+ */
+int assembleSource(const char *source, long size, Assembly *assembly);
+
+/**
+ * @brief Assembles a source held in memory, with options.
+ *
+ * Like assembleSource, when there are optimizations the source is optimized after macro spanning (see
+ * optimizer.h), and the equal data payloads are pooled by the passes (see literals.h). The expanded source is the
+ * source after macro spanning, before it has been optimized. The macro libraries the source includes are kept by
+ * the cache of the run (see macrolib.h) until freeMacroLibraries is called.
+ *
+ * With more than one thread (and no optimizations), a large source is split into chunks of lines which are
+ * parsed by the threads at once, the chunks are placed one after another and their symbols are linked like
+ * reassembleSource links them. The results are the same either way.
+ *
+ * @param source The source, it doesn't have to be null terminated.
+ * @param size The number of characters of the source.
+ * @param options The options.
+ * @param assembly The results, which have to be freed with freeAssembly (even if the assembly has failed).
+ * @return True if the source has been assembled, false if an error has been found.
+ */
+int assembleSourceWithOptions(const char *source, long size, const AssemblyOptions *options, Assembly *assembly);
+
+/**
+ * @struct IncrementalAssembly
+ * @brief Structure to represent a source which is assembled again and again as it's edited.
+ */
+typedef struct IncrementalAssembly {
+    struct SourceModel *model;  /* The model of the source as it has been assembled last, NULL for none. */
+} IncrementalAssembly;
+
+/**
+ * @brief Initializes an incremental assembly, which has no model of the source yet.
+ *
+ * @param incremental The incremental assembly to initialize.
+ */
+void initIncrementalAssembly(IncrementalAssembly *incremental);
+
+/**
+ * @brief Assembles a source again, parsing only the lines which have been changed since it has been assembled last.
+ *
+ * The results are exactly those of assembleSourceWithOptions. The lines at the start and at the end of the source
+ * which are the same as they have been are reused, the lines between them are parsed again and the symbols are
+ * linked again (see incremental.h). A source with optimizations, with errors, or with symbols which are declared
+ * in ways the passes treat specially is assembled whole.
+ *
+ * @param incremental The incremental assembly of the source, the first call assembles the whole source.
+ * @param source The source, it doesn't have to be null terminated.
+ * @param size The number of characters of the source.
+ * @param options The options.
+ * @param assembly The results, which have to be freed with freeAssembly (even if the assembly has failed).
+ * @return True if the source has been assembled, false if an error has been found.
+ */
+int reassembleSource(IncrementalAssembly *incremental, const char *source, long size, const AssemblyOptions *options,
+                     Assembly *assembly);
+
+/**
+ * @brief Frees the model of an incremental assembly, the next call assembles the whole source.
+ *
+ * @param incremental The incremental assembly to be freed.
+ */
+void freeIncrementalAssembly(IncrementalAssembly *incremental);
+
+/**
+ * @struct AssemblyOperand
+ * @brief Structure to represent an operand of an instruction which is emitted by a builder.
+ */
+typedef struct AssemblyOperand {
+    int value;              /* The value of an immediate operand, or the number of a register. */
+    const char *symbol;     /* The symbol of a direct operand. */
+} AssemblyOperand;
+
+/**
+ * @struct AssemblyFixup
+ * @brief Structure to represent a word which holds the address of a symbol, resolved when the builder finishes.
+ */
+typedef struct AssemblyFixup {
+    int address;                        /* The address of the word. */
+    char symbol[MAX_LABEL_LENGTH + 1];  /* The symbol. */
+} AssemblyFixup;
+
+/**
+ * @struct AssemblyBuilder
+ * @brief Structure to represent a program which is built without a source.
+ */
+typedef struct AssemblyBuilder {
+    AssemblerContext context;   /* The state of the assembler, the diagnostics refer to the number of the emitted item. */
+    AssemblyFixup *fixups;      /* The words which hold the address of a symbol, in the order of their addresses. */
+    int numOfFixups;            /* The number of fixups. */
+    int fixupsCapacity;         /* The number of fixups allocated. */
+} AssemblyBuilder;
+
+/**
+ * @brief Initializes a builder for a new program.
+ *
+ * @param builder The builder to initialize.
+ */
+void initAssemblyBuilder(AssemblyBuilder *builder);
+
+/**
+ * @brief Declares a label at the current address (or at the current data word, for a label of data).
+ *
+ * @param builder The builder.
+ * @param name The name of the label.
+ * @param isDataLabel True for a label of the next .data/.string, false for a label of the next instruction.
+ */
+void emitLabel(AssemblyBuilder *builder, const char *name, int isDataLabel);
+
+/**
+ * @brief Emits an instruction, exactly like the equivalent line of a source.
+ *
+ * An instruction with a single operand takes it as the destination operand, with METHOD_NONE and NULL as the
+ * source operand. The addressing methods aren't validated.
+ *
+ * @param builder The builder.
+ * @param opCode The opcode of the instruction (see instructionsTable).
+ * @param srcMethod The addressing method of the source operand, or METHOD_NONE.
+ * @param src The source operand, or NULL.
+ * @param dstMethod The addressing method of the destination operand, or METHOD_NONE.
+ * @param dst The destination operand, or NULL.
+ */
+void emitInstruction(AssemblyBuilder *builder, int opCode, int srcMethod, const AssemblyOperand *src,
+                     int dstMethod, const AssemblyOperand *dst);
+
+/**
+ * @brief Emits data words, like a .data directive.
+ *
+ * @param builder The builder.
+ * @param values The values.
+ * @param count The number of values.
+ */
+void emitData(AssemblyBuilder *builder, const int *values, int count);
+
+/**
+ * @brief Emits a string, like a .string directive (only it's alphabetic characters are encoded).
+ *
+ * @param builder The builder.
+ * @param text The string, without double quotes.
+ */
+void emitString(AssemblyBuilder *builder, const char *text);
+
+/**
+ * @brief Declares an entry point, like an .entry directive.
+ *
+ * @param builder The builder.
+ * @param name The name of the symbol.
+ */
+void emitEntry(AssemblyBuilder *builder, const char *name);
+
+/**
+ * @brief Declares an extern symbol, like an .extern directive.
+ *
+ * @param builder The builder.
+ * @param name The name of the symbol.
+ */
+void emitExtern(AssemblyBuilder *builder, const char *name);
+
+/**
+ * @brief Resolves the symbols of a built program and returns it's results.
+ *
+ * The builder is freed, and has to be initialized again before building another program.
+ *
+ * @param builder The builder.
+ * @param assembly The results, which have to be freed with freeAssembly (even if the assembly has failed).
+ * @return True if the program has been built, false if an error has been found.
+ */
+int finishAssemblyBuilder(AssemblyBuilder *builder, Assembly *assembly);
+
+/**
+ * @brief Frees the memory used by the results of assembling a source.
+ *
+ * @param assembly The results to be freed.
+ */
+void freeAssembly(Assembly *assembly);
+
+#endif
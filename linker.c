@@ -0,0 +1,358 @@
+/**
+ * @file linker.c
+ * @details This program links binary object files (".obj", produced by ./assembler --binary) into one image.
+ * The instruction words of all the modules come first, in the order of the command line, followed by the data
+ * words of all the modules. Every relocatable address is moved to the new location of it's module (in one sweep
+ * over the relocation table of the module), and every use of an extern symbol is patched with the address of the
+ * entry point of the module defining it. The linked image has a relocation table of it's own, so it can be rebased too.
+ * Extern symbols which none of the modules defines are resolved through the index of the object archives given
+ * with -l (see archive.h), and the members defining them are linked as well.
+ * The output is written as <output>.ob/.ent and <output>.obj.
+ * @example Run ./linker -o program file1, file2, ..., etc            (on command line) to execute this program.
+ * @example Run ./linker -o program -l library file1, file2, ..., etc  to link with the members of library.oa.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "objectfile.h"
+#include "archive.h"
+
+/**
+ * @struct Module
+ * @brief Structure to represent an object file being linked and it's location in the linked image.
+ */
+typedef struct Module {
+    const char *name;     /* The name of the module. */
+    ObjectFile object;    /* The content of the object file. */
+    int codeBase;         /* The address of the first instruction word in the linked image. */
+    int dataBase;         /* The address of the first data word in the linked image. */
+} Module;
+
+/**
+ * @struct GlobalSymbol
+ * @brief Structure to represent a bucket of the hashed table of the entry points of all the modules.
+ */
+typedef struct GlobalSymbol {
+    const char *name;     /* The name of the entry point, NULL for an empty bucket. */
+    int value;            /* The address of the entry point in the linked image. */
+    int module;           /* The index of the defining module. */
+} GlobalSymbol;
+
+/* Find the bucket of a name, or the empty bucket it should be stored at */
+static GlobalSymbol *findGlobalSymbol(GlobalSymbol *table, unsigned long capacity, const char *name) {
+    unsigned long i = hashSymbolName(name) & (capacity - 1);
+
+    while (table[i].name != NULL && strcmp(table[i].name, name) != 0)
+        i = (i + 1) & (capacity - 1);
+    return &table[i];
+}
+
+/* Check if one of the loaded modules defines an entry point */
+static int isDefinedByModule(const Module *modules, int numOfModules, const char *name) {
+    int i, j;
+    for (i = 0; i < numOfModules; i++)
+        for (j = 0; j < modules[i].object.numOfEntries; j++)
+            if (strcmp(modules[i].object.entries[j].name, name) == 0)
+                return true;
+    return false;
+}
+
+/* Move an address of a module (as assembled at INITIAL_ADDRESS_VALUE) to it's location in the linked image */
+static int relocateAddress(const Module *module, int moduleAddress) {
+    int offset = moduleAddress - INITIAL_ADDRESS_VALUE;
+
+    if (offset < module->object.codeWords)
+        return module->codeBase + offset;
+    return module->dataBase + offset - module->object.codeWords;
+}
+
+/* Check that a relocated address fits in an operand, reports the symbol by the name of it's entry point, or by the
+  name the disassembler gives it (L and it's address) */
+static int isRelocatedAddress(const Module *module, int moduleAddress, int address) {
+    char name[MAX_LABEL_LENGTH + 1];
+    int i = 0;
+
+    if (isOperandAddress(address))
+        return true;
+
+    sprintf(name, "L%d", moduleAddress);
+    for (; i < module->object.numOfEntries; ++i)
+        if (module->object.entries[i].value == moduleAddress)
+            strcpy(name, module->object.entries[i].name);
+    printf("Symbol %s of %s is linked at %d, which doesn't fit in an operand.\n", name, module->name, address);
+    return false;
+}
+
+/* Relocate an operand word if it holds a relocatable address, and record it in the relocation table of the linked
+  image, returns false if the address doesn't fit in an operand */
+static int relocateOperandWord(const Module *module, unsigned int *words, int operand, int addressingMethod,
+                               RelocationTable *linkedRelocations) {
+    if (operand >= module->object.codeWords || addressingMethod != METHOD_DIRECT)
+        return true;
+
+    if ((words[operand] & 0x3) == RELOCATION_RELOCATABLE) {
+        int address = relocateAddress(module, (int) (words[operand] >> 2));
+
+        if (!isRelocatedAddress(module, (int) (words[operand] >> 2), address))
+            return false;
+        words[operand] = convertTo12BitBinary(address, RELOCATION_RELOCATABLE);
+    }
+    addRelocation(linkedRelocations, module->codeBase + operand, RELOCATION_RELOCATABLE);
+    return true;
+}
+
+/* Relocate a module which has no relocation table (converted from text) by walking it's instruction words, returns
+  false if an address doesn't fit in an operand */
+static int relocateModuleInstructions(const Module *module, unsigned int *words, RelocationTable *linkedRelocations) {
+    int isRelocated = true;
+    int i = 0;
+
+    while (i < module->object.codeWords) {
+        unsigned int firstWord = words[i];
+        int srcOperandAddressing = (firstWord >> 9) & 0x7;
+        int destOperandAddressing = (firstWord >> 2) & 0x7;
+        int length = getInstructionLength(firstWord);
+
+        /* Only a direct operand holds an address, the source operand word comes before the destination operand word */
+        if (length == 3) {
+            isRelocated &= relocateOperandWord(module, words, i + 1, srcOperandAddressing, linkedRelocations);
+            isRelocated &= relocateOperandWord(module, words, i + 2, destOperandAddressing, linkedRelocations);
+        } else if (length == 2 && srcOperandAddressing == 0)
+            isRelocated &= relocateOperandWord(module, words, i + 1, destOperandAddressing, linkedRelocations);
+
+        i += length;
+    }
+    return isRelocated;
+}
+
+/* Relocate a module in one sweep over it's relocation table, returns false if an address doesn't fit in an operand */
+static int relocateModule(const Module *module, unsigned int *words, RelocationTable *linkedRelocations) {
+    RelocationReader reader;
+    int address, type;
+
+    if (module->object.numOfRelocations == 0)
+        return relocateModuleInstructions(module, words, linkedRelocations);
+
+    if (rebaseWords(words, module->object.codeWords, module->object.codeWords, module->object.relocations,
+                    module->object.relocationsSize, module->codeBase - INITIAL_ADDRESS_VALUE,
+                    module->dataBase - INITIAL_ADDRESS_VALUE - module->object.codeWords) < 0) {
+        /* Report every address which doesn't fit, from the words of the module as they have been assembled */
+        initRelocationReader(&reader, module->object.relocations, module->object.relocationsSize);
+        while (nextRelocation(&reader, &address, &type)) {
+            int index = address - INITIAL_ADDRESS_VALUE;
+
+            if (type == RELOCATION_RELOCATABLE && index >= 0 && index < module->object.codeWords)
+                isRelocatedAddress(module, (int) (module->object.words[index] >> 2),
+                                   relocateAddress(module, (int) (module->object.words[index] >> 2)));
+        }
+        return false;
+    }
+
+    /* Relocatable words stay relocatable, and external words become relocatable once they are patched */
+    initRelocationReader(&reader, module->object.relocations, module->object.relocationsSize);
+    while (nextRelocation(&reader, &address, &type))
+        if (type != RELOCATION_ABSOLUTE)
+            addRelocation(linkedRelocations, module->codeBase + address - INITIAL_ADDRESS_VALUE, RELOCATION_RELOCATABLE);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const char *outputName = "linked";
+    Module *modules;
+    MappedObjectFile *archives;
+    GlobalSymbol *globalTable;
+    const unsigned char *memberBytes;
+    long memberSize;
+    RelocationTable linkedRelocations = {NULL, 0, 0, 0, INITIAL_ADDRESS_VALUE};
+    unsigned long capacity = 1;
+    ObjectFile linked;
+    int numOfModules = 0, moduleCapacity = argc, numOfArchives = 0, numOfEntries = 0, codeWords = 0, dataWords = 0;
+    int errorFlag = 0;
+    int i, j;
+    char fileName[FILENAME_MAX];
+    FILE *file;
+
+    modules = (Module *) allocateZeroedMemory(MEMORY_TOOLS, moduleCapacity, sizeof(Module));
+    archives = (MappedObjectFile *) allocateZeroedMemory(MEMORY_TOOLS, argc, sizeof(MappedObjectFile));
+    if (modules == NULL || archives == NULL)
+        return EXIT_FAILURE;
+
+    /* Load the modules and map the archives */
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputName = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            strcat(strcpy(fileName, argv[++i]), ".oa");
+            if (!mapArchive(fileName, &archives[numOfArchives])) {
+                printf("%s isn't a valid object archive.\n", fileName);
+                errorFlag = 1;
+            } else
+                numOfArchives++;
+            continue;
+        }
+
+        strcat(strcpy(fileName, argv[i]), ".obj");
+        if (!readBinaryObjectFile(fileName, &modules[numOfModules].object)) {
+            printf("%s isn't a valid binary object file.\n", fileName);
+            errorFlag = 1;
+            continue;
+        }
+        modules[numOfModules].name = argv[i];
+        numOfEntries += modules[numOfModules].object.numOfEntries;
+        numOfModules++;
+    }
+
+    if (numOfModules == 0 || errorFlag) {
+        if (numOfModules == 0)
+            printf("No object file provided.\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Pull the archive members which define the extern symbols that no loaded module defines, members pulled
+     * this way are scanned as well, so their own extern symbols are resolved too */
+    for (i = 0; i < numOfModules && numOfArchives > 0; i++) {
+        for (j = 0; j < modules[i].object.numOfExterns; j++) {
+            const char *name = modules[i].object.externs[j].name;
+            int archive = 0, member = -1;
+
+            if (isDefinedByModule(modules, numOfModules, name))
+                continue;
+            while (archive < numOfArchives && (member = findArchiveSymbol(archives[archive].bytes, name)) < 0)
+                archive++;
+            if (member < 0)
+                continue;
+
+            if (numOfModules == moduleCapacity) {
+                Module *newModules = (Module *) reallocateMemory(MEMORY_TOOLS, modules,
+                                                                 moduleCapacity * 2 * sizeof(Module));
+                if (newModules == NULL) {
+                    printf("Memory allocation has been failed.\n");
+                    return EXIT_FAILURE;
+                }
+                modules = newModules;
+                moduleCapacity *= 2;
+            }
+
+            memberBytes = getArchiveMember(archives[archive].bytes, member, &memberSize);
+            if (!loadObjectFile(memberBytes, memberSize, &modules[numOfModules].object)) {
+                printf("Member %s of an archive isn't a valid binary object file.\n",
+                       getArchiveMemberName(archives[archive].bytes, member));
+                return EXIT_FAILURE;
+            }
+            modules[numOfModules].name = getArchiveMemberName(archives[archive].bytes, member);
+            numOfEntries += modules[numOfModules].object.numOfEntries;
+            numOfModules++;
+        }
+    }
+
+    /* Instruction words of all the modules first, then the data words of all the modules */
+    for (i = 0; i < numOfModules; i++) {
+        modules[i].codeBase = INITIAL_ADDRESS_VALUE + codeWords;
+        codeWords += modules[i].object.codeWords;
+    }
+    for (i = 0; i < numOfModules; i++) {
+        modules[i].dataBase = INITIAL_ADDRESS_VALUE + codeWords + dataWords;
+        dataWords += modules[i].object.dataWords;
+    }
+
+    /* Hashed table of the entry points of all the modules, at most half full */
+    while (capacity < 2 * (unsigned long) numOfEntries + 1)
+        capacity *= 2;
+    globalTable = (GlobalSymbol *) allocateZeroedMemory(MEMORY_TOOLS, capacity, sizeof(GlobalSymbol));
+    linked.words = (unsigned int *) allocateMemory(MEMORY_OBJECTS, (codeWords + dataWords + 1) * sizeof(unsigned int));
+    linked.entries = (ObjectSymbol *) allocateMemory(MEMORY_OBJECTS, (numOfEntries + 1) * sizeof(ObjectSymbol));
+    linked.externs = (ObjectSymbol *) allocateMemory(MEMORY_OBJECTS, sizeof(ObjectSymbol));
+    linked.relocations = NULL;
+    if (globalTable == NULL || linked.words == NULL || linked.entries == NULL || linked.externs == NULL) {
+        printf("Memory allocation has been failed.\n");
+        return EXIT_FAILURE;
+    }
+    linked.codeWords = codeWords;
+    linked.dataWords = dataWords;
+    linked.numOfEntries = 0;
+    linked.numOfExterns = 0;
+
+    for (i = 0; i < numOfModules; i++) {
+        for (j = 0; j < modules[i].object.numOfEntries; j++) {
+            ObjectSymbol *entry = &modules[i].object.entries[j];
+            GlobalSymbol *symbol = findGlobalSymbol(globalTable, capacity, entry->name);
+
+            /* The same entry point can't be defined by two modules */
+            if (symbol->name != NULL) {
+                printf("Entry %s is defined both in %s and in %s.\n", entry->name, modules[symbol->module].name, modules[i].name);
+                errorFlag = 1;
+                continue;
+            }
+            symbol->name = entry->name;
+            symbol->value = relocateAddress(&modules[i], entry->value);
+            symbol->module = i;
+
+            strcpy(linked.entries[linked.numOfEntries].name, entry->name);
+            linked.entries[linked.numOfEntries++].value = symbol->value;
+        }
+    }
+
+    for (i = 0; i < numOfModules; i++) {
+        Module *module = &modules[i];
+        unsigned int *code = linked.words + (module->codeBase - INITIAL_ADDRESS_VALUE);
+
+        /* Copy the words of the module into their locations, and relocate them */
+        memcpy(code, module->object.words, module->object.codeWords * sizeof(unsigned int));
+        memcpy(linked.words + (module->dataBase - INITIAL_ADDRESS_VALUE), module->object.words + module->object.codeWords,
+               module->object.dataWords * sizeof(unsigned int));
+        if (!relocateModule(module, code, &linkedRelocations))
+            errorFlag = 1;
+
+        /* Patch every use of an extern symbol with the address of it's entry point */
+        for (j = 0; j < module->object.numOfExterns; j++) {
+            ObjectSymbol *use = &module->object.externs[j];
+            GlobalSymbol *symbol = findGlobalSymbol(globalTable, capacity, use->name);
+            int offset = use->value - INITIAL_ADDRESS_VALUE;
+
+            if (symbol->name == NULL) {
+                printf("Extern %s used by %s at address %d isn't defined by any module.\n", use->name, module->name, use->value);
+                errorFlag = 1;
+            } else if (!isOperandAddress(symbol->value)) {
+                printf("Extern %s used by %s at address %d is linked at %d, which doesn't fit in an operand.\n",
+                       use->name, module->name, use->value, symbol->value);
+                errorFlag = 1;
+            } else if (offset >= 0 && offset < module->object.codeWords)
+                code[offset] = convertTo12BitBinary(symbol->value, RELOCATION_RELOCATABLE);
+        }
+    }
+
+    if (errorFlag) {
+        printf("***The linker couldn't link %s cause at least one error has been found***\n", outputName);
+        return EXIT_FAILURE;
+    }
+
+    /* Write the linked image */
+    linked.numOfRelocations = linkedRelocations.count;
+    linked.relocationsSize = linkedRelocations.size;
+    linked.relocations = linkedRelocations.bytes;
+    if (!writeTextObjectFiles(&linked, outputName)) {
+        printf("Couldn't write the output files of %s.\n", outputName);
+        return EXIT_FAILURE;
+    }
+    strcat(strcpy(fileName, outputName), ".obj");
+    file = fopen(fileName, "wb");
+    if (file == NULL || !writeBinaryObjectFile(&linked, file)) {
+        printf("Couldn't write %s.\n", fileName);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    for (i = 0; i < numOfModules; i++)
+        freeObjectFile(&modules[i].object);
+    freeObjectFile(&linked);
+    for (i = 0; i < numOfArchives; i++)
+        unmapObjectFile(&archives[i]);
+    freeMemory(archives);
+    freeMemory(globalTable);
+    freeMemory(modules);
+    return EXIT_SUCCESS;
+}
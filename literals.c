@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "literals.h"
+
+/**
+ * A payload of the data image.
+ */
+typedef struct LiteralPayload {
+    int start;          /* The index of the first word in the data image. */
+    int length;         /* The number of words. */
+    int isLabeled;      /* True if the first word is labeled, a payload without a label is always kept. */
+    int keptPayload;    /* The index of the kept payload which holds the words, itself if the payload is kept. */
+    int keptOffset;     /* The index of the first word in the kept payload. */
+    int newStart;       /* The index of the first word in the pooled data image. */
+} LiteralPayload;
+
+/**
+ * A suffix of a kept payload in the hash table, keptPayload is -1 for an empty bucket.
+ */
+typedef struct LiteralSuffix {
+    unsigned long hash;
+    int keptPayload;
+    int offset;
+} LiteralSuffix;
+
+/* Compare payloads by descending length, so a payload is looked up once every longer payload has been kept, and
+  by their order in the data image for equal lengths, so the first copy is kept */
+static int comparePayloads(const void *first, const void *second) {
+    const LiteralPayload *firstPayload = *(const LiteralPayload *const *) first;
+    const LiteralPayload *secondPayload = *(const LiteralPayload *const *) second;
+
+    if (firstPayload->length != secondPayload->length)
+        return secondPayload->length - firstPayload->length;
+    return firstPayload->start - secondPayload->start;
+}
+
+/* Hash a word followed by a suffix whose hash is known, so the hashes of all the suffixes are found from the end */
+static unsigned long hashWord(unsigned long suffixHash, unsigned int word) {
+    return ((suffixHash * 16777619UL) ^ word) & 0xFFFFFFFFUL;
+}
+
+/* Hash the words of a payload */
+static unsigned long hashPayload(const unsigned int *words, const LiteralPayload *payload) {
+    unsigned long hash = 2166136261UL;
+    int i = payload->length - 1;
+
+    for (; i >= 0; --i)
+        hash = hashWord(hash, words[payload->start + i]);
+    return hash;
+}
+
+/* Find a kept payload which holds the words of a payload, returns it's index and sets the offset, or -1 */
+static int findKeptPayload(const LiteralSuffix *table, unsigned long capacity, const unsigned int *words,
+                           const LiteralPayload *payloads, const LiteralPayload *payload, int *offset) {
+    unsigned long hash = hashPayload(words, payload);
+    unsigned long i = hash & (capacity - 1);
+
+    /* Linear probing until an empty bucket, the words are compared only when the hashes are equal */
+    for (; table[i].keptPayload != -1; i = (i + 1) & (capacity - 1)) {
+        const LiteralPayload *kept = &payloads[table[i].keptPayload];
+
+        if (table[i].hash == hash && kept->length - table[i].offset == payload->length &&
+            memcmp(words + kept->start + table[i].offset, words + payload->start,
+                   payload->length * sizeof(unsigned int)) == 0) {
+            *offset = table[i].offset;
+            return table[i].keptPayload;
+        }
+    }
+    return -1;
+}
+
+/* Add every suffix of a kept payload to the hash table */
+static void addKeptPayload(LiteralSuffix *table, unsigned long capacity, const unsigned int *words,
+                           const LiteralPayload *payloads, int kept) {
+    unsigned long hash = 2166136261UL;
+    int offset = payloads[kept].length - 1;
+
+    for (; offset >= 0; --offset) {
+        unsigned long i;
+
+        hash = hashWord(hash, words[payloads[kept].start + offset]);
+        for (i = hash & (capacity - 1); table[i].keptPayload != -1; i = (i + 1) & (capacity - 1));
+        table[i].hash = hash;
+        table[i].keptPayload = kept;
+        table[i].offset = offset;
+    }
+}
+
+/* Split the data image into payloads and find the kept payload of every payload */
+static int poolPayloads(const unsigned int *words, int numOfWords, LiteralPayload *payloads, int numOfPayloads) {
+    LiteralPayload **order = (LiteralPayload **) allocateMemory(MEMORY_OPTIMIZER,
+                                                                 (numOfPayloads + 1) * sizeof(LiteralPayload *));
+    unsigned long capacity = 2;
+    LiteralSuffix *table;
+    int i = 0;
+
+    /* At least twice the number of suffixes, so the probing ends at an empty bucket soon */
+    while (capacity < 2UL * (unsigned long) numOfWords)
+        capacity *= 2;
+    table = (LiteralSuffix *) allocateMemory(MEMORY_OPTIMIZER, capacity * sizeof(LiteralSuffix));
+    if (order == NULL || table == NULL) {
+        freeMemory(order);
+        freeMemory(table);
+        return false;
+    }
+    for (; (unsigned long) i < capacity; ++i)
+        table[i].keptPayload = -1;
+
+    for (i = 0; i < numOfPayloads; ++i)
+        order[i] = &payloads[i];
+    qsort(order, (size_t) numOfPayloads, sizeof(LiteralPayload *), comparePayloads);
+
+    for (i = 0; i < numOfPayloads; ++i) {
+        LiteralPayload *payload = order[i];
+        int kept = -1;
+
+        if (payload->isLabeled)
+            kept = findKeptPayload(table, capacity, words, payloads, payload, &payload->keptOffset);
+        if (kept == -1) {
+            kept = (int) (payload - payloads);
+            payload->keptOffset = 0;
+            addKeptPayload(table, capacity, words, payloads, kept);
+        }
+        payload->keptPayload = kept;
+    }
+
+    freeMemory(order);
+    freeMemory(table);
+    return true;
+}
+
+int planLiteralPool(AssemblerContext *context, LiteralPool *pool) {
+    int numOfWords = context->dataCounter;
+    unsigned int *words = (unsigned int *) allocateMemory(MEMORY_OPTIMIZER, (numOfWords + 1) * sizeof(unsigned int));
+    int *isLabeled = (int *) allocateMemory(MEMORY_OPTIMIZER, (numOfWords + 1) * sizeof(int));
+    int *newIndices = (int *) allocateMemory(MEMORY_OPTIMIZER, (numOfWords + 1) * sizeof(int));
+    LiteralPayload *payloads = (LiteralPayload *) allocateMemory(MEMORY_OPTIMIZER,
+                                                                 (numOfWords + 1) * sizeof(LiteralPayload));
+    int numOfPayloads = 0;
+    int isPlanned = false;
+    int i = 0;
+
+    pool->sourceIndices = (int *) allocateMemory(MEMORY_OPTIMIZER, (numOfWords + 1) * sizeof(int));
+    pool->numOfWords = 0;
+    pool->originalWords = numOfWords;
+
+    if (words != NULL && isLabeled != NULL && newIndices != NULL && payloads != NULL && pool->sourceIndices != NULL) {
+        memset(isLabeled, 0, (numOfWords + 1) * sizeof(int));
+        markDataSymbols(context, isLabeled, context->address);
+
+        /* A payload starts at every labeled word, the words before the first label are a payload of their own */
+        for (; i < numOfWords; ++i) {
+            words[i] = getCodeImageWord(&context->dataImage, i);
+            if (i == 0 || isLabeled[i]) {
+                payloads[numOfPayloads].start = i;
+                payloads[numOfPayloads].length = 0;
+                payloads[numOfPayloads++].isLabeled = isLabeled[i];
+            }
+            payloads[numOfPayloads - 1].length++;
+        }
+
+        isPlanned = poolPayloads(words, numOfWords, payloads, numOfPayloads);
+    }
+
+    if (isPlanned) {
+        /* The kept payloads are laid out in the order of the data image, then the others point into them */
+        for (i = 0; i < numOfPayloads; ++i) {
+            LiteralPayload *payload = &payloads[i];
+            int j = 0;
+
+            if (payload->keptPayload != i)
+                continue;
+            payload->newStart = pool->numOfWords;
+            for (; j < payload->length; ++j)
+                pool->sourceIndices[pool->numOfWords++] = payload->start + j;
+        }
+        for (i = 0; i < numOfPayloads; ++i) {
+            LiteralPayload *payload = &payloads[i];
+            int j = 0;
+
+            payload->newStart = payloads[payload->keptPayload].newStart + payload->keptOffset;
+            for (; j < payload->length; ++j)
+                newIndices[payload->start + j] = payload->newStart + j;
+        }
+        newIndices[numOfWords] = pool->numOfWords;
+        moveDataSymbols(context, newIndices, context->address);
+    } else
+        freeLiteralPool(pool);
+
+    freeMemory(words);
+    freeMemory(isLabeled);
+    freeMemory(newIndices);
+    freeMemory(payloads);
+    return isPlanned;
+}
+
+int applyLiteralPool(AssemblerContext *context, const LiteralPool *pool) {
+    CodeImage pooledImage = {NULL, 0, 0, 0};
+    unsigned int *words;
+    int i = 0;
+
+    /* The second pass has encoded the data image again exactly like the first pass has */
+    if (pool->sourceIndices == NULL)
+        return true;
+
+    words = (unsigned int *) allocateMemory(MEMORY_OPTIMIZER, (pool->numOfWords + 1) * sizeof(unsigned int));
+    if (words == NULL)
+        return false;
+    for (; i < pool->numOfWords; ++i)
+        words[i] = getCodeImageWord(&context->dataImage, pool->sourceIndices[i]);
+
+    if (writeCodeImageWords(&pooledImage, 0, words, pool->numOfWords) != pool->numOfWords) {
+        freeCodeImage(&pooledImage);
+        freeMemory(words);
+        return false;
+    }
+    freeCodeImage(&context->dataImage);
+    context->dataImage = pooledImage;
+    context->dataCounter = pool->numOfWords;
+
+    freeMemory(words);
+    return true;
+}
+
+void freeLiteralPool(LiteralPool *pool) {
+    freeMemory(pool->sourceIndices);
+    pool->sourceIndices = NULL;
+    pool->numOfWords = 0;
+}
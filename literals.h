@@ -0,0 +1,51 @@
+#ifndef LITERALS_H
+#define LITERALS_H
+
+/**
+ * @file literals.h
+ * @brief Definitions and functions related to the literal pool (the --pool-literals option).
+ *
+ * The data image is split into payloads, every payload starts at a word which is labeled by a data symbol and
+ * holds the words of it's .data/.string directive and of the directives without a label which follow it. A payload
+ * which is equal to another payload, or to the end of a longer one (like "cd" and "abcd"), isn't kept: it's label
+ * is moved to the copy which is kept. The pool is planned at the end of the first pass, so the second pass encodes
+ * the instructions and the entry points with the new addresses of the labels, and it's applied to the data image
+ * the second pass encodes again at the end of the second pass.
+ */
+
+/**
+ * @struct LiteralPool
+ * @brief Structure to represent the layout of a pooled data image.
+ */
+typedef struct LiteralPool {
+    int *sourceIndices;     /* The index in the data image of every word of the pooled data image. */
+    int numOfWords;         /* The number of words of the pooled data image. */
+    int originalWords;      /* The number of words of the data image. */
+} LiteralPool;
+
+/**
+ * @brief Plans the pooled data image and moves the data symbols to it, at the end of the first pass.
+ *
+ * @param context The context of the source being assembled.
+ * @param pool The pool to plan.
+ * @return True if the pool has been planned, false if memory allocation has been failed (nothing is moved then).
+ */
+int planLiteralPool(AssemblerContext *context, LiteralPool *pool);
+
+/**
+ * @brief Replaces the data image with the pooled data image, at the end of the second pass.
+ *
+ * @param context The context of the source being assembled.
+ * @param pool The pool which has been planned.
+ * @return True if the data image has been replaced, false if memory allocation has been failed.
+ */
+int applyLiteralPool(AssemblerContext *context, const LiteralPool *pool);
+
+/**
+ * @brief Frees a literal pool.
+ *
+ * @param pool The pool.
+ */
+void freeLiteralPool(LiteralPool *pool);
+
+#endif
@@ -1,120 +1,500 @@
-#include <malloc.h>
-#include "data.h"
-#include "machinecode.h"
-
-CodeWord codeWordTable[MAX_CODE_WORD_TABLE_SIZE];
-
-unsigned int generateBinaryCode(int destOperandAddressing, int opCode, int srcOperandAddressing) {
-    unsigned int binaryCode = 0;
-
-    /* Set bits 0-1: ARE (Absolute/External/Relocatable) */
-    binaryCode |= (0 << 0); /* Bit 0 */
-    binaryCode |= (0 << 1); /* Bit 1 */
-
-    /* Set bits 2-4 to the destination operand addressing */
-    binaryCode |= (destOperandAddressing << 2); /* Bits 2-4 */
-
-    /* Set bits 5-8 to the opCode */
-    binaryCode |= (opCode << 5); /* Bits 5-8 */
-
-    /* Set bits 9-11 to the source operand addressing */
-    binaryCode |= (srcOperandAddressing << 9); /* Bits 9-11 */
-
-    return binaryCode;
-}
-
-unsigned int registersToBinary(int destRegister, int srcRegister) {
-    unsigned int binaryCode = 0;
-
-    /* Set bits 2-6 to the destination operand addressing */
-    binaryCode |= (destRegister << 2); /* Bits 2-6 */
-
-    /* Set bits 7-11 to the source operand addressing */
-    binaryCode |= (srcRegister << 7); /* Bits 7-11 */
-
-    return decimalToBinary12Bit(binaryCode);
-}
-
-/* Function to convert a decimal number to a 10-bit binary number */
-unsigned int decimalToBinary10Bit(int decimal) {
-    unsigned int binary = 0;
-    int bitPosition = 0; /* Starting from the least significant bit (bit 0) */
-
-    while (decimal > 0 && bitPosition < 10) {
-        int bit = decimal % 2; /* Get the least significant bit */
-        binary |= (bit << bitPosition); /* Set the corresponding bit in the binary number */
-        decimal /= 2; /* Right-shift the decimal number */
-        bitPosition++; /* Move to the next bit position */
-    }
-
-    return binary;
-}
-
-/* Function to convert the parameters to a 12-bit binary number */
-unsigned int convertTo12BitBinary(int operand, int type) {
-    unsigned int binaryOperand = decimalToBinary10Bit(operand);
-    unsigned int binaryAddress = type & 0x3; /* Ensure type is within 0-3 range (2 bits) */
-
-    /* Combine the operand and type to form a 12-bit binary number */
-    return (binaryOperand << 2) | binaryAddress;
-}
-
-unsigned int decimalToBinary12Bit(int decimal) {
-    unsigned int binary = 0;
-    int bitPosition = 0;
-    int isNegative = 0;
-
-    if (decimal < 0) {
-        isNegative = 1;
-        decimal = -decimal; /* Convert the number to its positive counterpart */
-    }
-
-    while (decimal > 0 && bitPosition < 11) {
-        /* Get the remainder of the decimal number when divided by 2 */
-        int remainder = decimal % 2;
-        /* Set the corresponding bit in the binary representation */
-        binary |= (remainder << bitPosition);
-        /* Divide the decimal number by 2 to get the next bit */
-        decimal /= 2;
-        /* Move to the next bit position in the binary representation */
-        bitPosition++;
-    }
-
-    /* Handle the 12th bit (sign bit) in Two's complement notation */
-    if (isNegative) {
-        binary = ~binary; /* Invert all bits */
-        binary &= 0xFFF; /* Ensure only the 12 least significant bits are used */
-        binary += 1; /* Add 1 to complete the Two's complement representation */
-    }
-
-    return binary;
-}
-
-unsigned int asciiToBinary12Bit(char ascii_value) {
-    int decimal = (int)ascii_value; /* Convert ASCII value to decimal */
-    return decimalToBinary12Bit(decimal);
-}
-
-char* convertToBase64(int binaryNumber) {
-    /* Base 64 encoding table */
-    const char base64Table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    char* base64Number = (char*)malloc(3 * sizeof(char));
-
-    /* Split the 12-bit binary number into two 6-bit segments */
-    int segment1 = (binaryNumber >> 6) & 0x3F;
-    int segment2 = binaryNumber & 0x3F;
-
-    /* Convert each 6-bit segment into a base 64 character */
-    base64Number[0] = base64Table[segment1];
-    base64Number[1] = base64Table[segment2];
-    base64Number[2] = '\0'; /* Null-terminate the string */
-
-    return base64Number;
-}
-
-void addToCodeWordTable(const char *fileName, const char *line, unsigned int binaryCode) {
-    if(isValidAddress())
-        codeWordTable[address - INITIAL_ADDRESS_VALUE].binaryCode = binaryCode;
-    else
-        reportError(fileName, 16, line);
+#include <stdlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "data.h"
+#include "machinecode.h"
+
+unsigned int generateBinaryCode(int destOperandAddressing, int opCode, int srcOperandAddressing) {
+    unsigned int binaryCode = 0;
+
+    /* Set bits 0-1: ARE (Absolute/External/Relocatable) */
+    binaryCode |= (0 << 0); /* Bit 0 */
+    binaryCode |= (0 << 1); /* Bit 1 */
+
+    /* Set bits 2-4 to the destination operand addressing */
+    binaryCode |= (destOperandAddressing << 2); /* Bits 2-4 */
+
+    /* Set bits 5-8 to the opCode */
+    binaryCode |= (opCode << 5); /* Bits 5-8 */
+
+    /* Set bits 9-11 to the source operand addressing */
+    binaryCode |= (srcOperandAddressing << 9); /* Bits 9-11 */
+
+    return binaryCode;
+}
+
+unsigned int registersToBinary(int destRegister, int srcRegister) {
+    unsigned int binaryCode = 0;
+
+    /* Set the ISA_REGISTER_BITS bits above the ARE bits to the destination register */
+    binaryCode |= (destRegister << 2); /* Bits 2-6 of a 12-bit word */
+
+    /* Set the next ISA_REGISTER_BITS bits to the source register */
+    binaryCode |= (srcRegister << (2 + ISA_REGISTER_BITS)); /* Bits 7-11 of a 12-bit word */
+
+    return decimalToBinary12Bit(binaryCode);
+}
+
+int getInstructionLength(unsigned int firstWord) {
+    int srcOperandAddressing = (firstWord >> 9) & 0x7;
+    int destOperandAddressing = (firstWord >> 2) & 0x7;
+
+    /* Two registers share a single word */
+    if (srcOperandAddressing == METHOD_DIRECT_REGISTER && destOperandAddressing == METHOD_DIRECT_REGISTER)
+        return 2;
+
+    /* Every other operand takes a word of it's own, a missing operand has no addressing method (0) */
+    return 1 + (srcOperandAddressing != 0) + (destOperandAddressing != 0);
+}
+
+/* Function to convert a decimal number to an ISA_OPERAND_BITS-bit binary number (the bits of a word above the ARE
+  bits, 10 bits of a 12-bit word) */
+unsigned int decimalToBinary10Bit(int decimal) {
+    unsigned int binary = 0;
+    int bitPosition = 0; /* Starting from the least significant bit (bit 0) */
+
+    while (decimal > 0 && bitPosition < ISA_OPERAND_BITS) {
+        int bit = decimal % 2; /* Get the least significant bit */
+        binary |= (bit << bitPosition); /* Set the corresponding bit in the binary number */
+        decimal /= 2; /* Right-shift the decimal number */
+        bitPosition++; /* Move to the next bit position */
+    }
+
+    return binary;
+}
+
+/* Function to convert the parameters to a 12-bit binary number */
+unsigned int convertTo12BitBinary(int operand, int type) {
+    unsigned int binaryOperand = decimalToBinary10Bit(operand);
+    unsigned int binaryAddress = type & 0x3; /* Ensure type is within 0-3 range (2 bits) */
+
+    /* Combine the operand and type to form a 12-bit binary number */
+    return (binaryOperand << 2) | binaryAddress;
+}
+
+int isOperandAddress(long address) {
+    return address >= 0 && address <= ISA_MAX_OPERAND_ADDRESS;
+}
+
+unsigned int decimalToBinary12Bit(int decimal) {
+    unsigned int binary = 0;
+    int bitPosition = 0;
+    int isNegative = 0;
+
+    if (decimal < 0) {
+        isNegative = 1;
+        decimal = -decimal; /* Convert the number to its positive counterpart */
+    }
+
+    while (decimal > 0 && bitPosition < ISA_WORD_BITS - 1) {
+        /* Get the remainder of the decimal number when divided by 2 */
+        int remainder = decimal % 2;
+        /* Set the corresponding bit in the binary representation */
+        binary |= (remainder << bitPosition);
+        /* Divide the decimal number by 2 to get the next bit */
+        decimal /= 2;
+        /* Move to the next bit position in the binary representation */
+        bitPosition++;
+    }
+
+    /* Handle the sign bit (bit ISA_WORD_BITS - 1, the highest bit of a word) in Two's complement notation */
+    if (isNegative) {
+        binary = ~binary; /* Invert all bits */
+        binary &= ISA_WORD_MASK; /* Ensure only the ISA_WORD_BITS least significant bits are used */
+        binary += 1; /* Add 1 to complete the Two's complement representation */
+    }
+
+    return binary;
+}
+
+unsigned int asciiToBinary12Bit(char ascii_value) {
+    int decimal = (int)ascii_value; /* Convert ASCII value to decimal */
+    return decimalToBinary12Bit(decimal);
+}
+
+int encodeDataList(CodeImage *image, int index, const char *list) {
+    unsigned int block[CODE_IMAGE_BLOCK_SIZE];
+    int blockLength = 0;
+    int count = 0;
+
+    while (true) {
+        unsigned int value = 0;
+        unsigned int isNegative;
+
+        /* Skip the separators between the numbers */
+        while (*list == ' ' || *list == ',' || *list == '\t')
+            list++;
+        if (*list == '\0')
+            break;
+
+        /* Optional sign, consumed without branching on it */
+        isNegative = (*list == '-');
+        list += (*list == '-') | (*list == '+');
+
+        /* Accumulate the digits, only the bits of a word survive the mask anyway */
+        while (*list >= '0' && *list <= '9')
+            value = value * 10 + (unsigned int) (*list++ - '0');
+
+        /* Stop at the first item which isn't numeric */
+        if (*list != '\0' && *list != ' ' && *list != ',' && *list != '\t')
+            break;
+
+        /* Two's complement of the value, packed into the image a whole block at a time */
+        block[blockLength++] = ((value ^ (0u - isNegative)) + isNegative) & ISA_WORD_MASK;
+        if (blockLength == CODE_IMAGE_BLOCK_SIZE) {
+            count += writeCodeImageWords(image, index + count, block, blockLength);
+            blockLength = 0;
+        }
+    }
+
+    return count + writeCodeImageWords(image, index + count, block, blockLength);
+}
+
+int encodeCharacters(CodeImage *image, int index, const char *characters, int length) {
+    unsigned int block[CODE_IMAGE_BLOCK_SIZE];
+    const unsigned char *bytes = (const unsigned char *) characters;
+    int count = 0;
+
+    while (count < length) {
+        int blockLength = length - count < CODE_IMAGE_BLOCK_SIZE ? length - count : CODE_IMAGE_BLOCK_SIZE;
+        int i = 0;
+
+#ifdef __SSE2__
+        /* Widen 16 characters at a time into 16 words */
+        for (; i + 16 <= blockLength; i += 16) {
+            __m128i zero = _mm_setzero_si128();
+            __m128i chars = _mm_loadu_si128((const __m128i *) (bytes + count + i));
+            __m128i low = _mm_unpacklo_epi8(chars, zero);
+            __m128i high = _mm_unpackhi_epi8(chars, zero);
+
+            _mm_storeu_si128((__m128i *) (block + i), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128((__m128i *) (block + i + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128((__m128i *) (block + i + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128((__m128i *) (block + i + 12), _mm_unpackhi_epi16(high, zero));
+        }
+#endif
+        /* Widen the rest of the characters one by one */
+        for (; i < blockLength; ++i)
+            block[i] = bytes[count + i];
+
+        if (writeCodeImageWords(image, index + count, block, blockLength) < blockLength)
+            break;
+        count += blockLength;
+    }
+    return count;
+}
+
+char* convertToBase64(int binaryNumber, char *base64Number) {
+    /* Base 64 encoding table */
+    const char base64Table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    int i = 0;
+
+    /* Split the binary number into 6-bit segments (two of a 12-bit word), the most significant first, and convert
+     * each segment into a base 64 character */
+    for (; i < ISA_BASE64_DIGITS; ++i)
+        base64Number[i] = base64Table[(binaryNumber >> (6 * (ISA_BASE64_DIGITS - 1 - i))) & 0x3F];
+    base64Number[ISA_BASE64_DIGITS] = '\0'; /* Null-terminate the string */
+
+    return base64Number;
+}
+
+int convertFromBase64(const char *base64Number) {
+    int word = 0;
+    int i = 0;
+
+    /* Decode each base 64 character into a 6-bit segment */
+    for (; i < ISA_BASE64_DIGITS; ++i) {
+        char c = base64Number[i];
+        int segment;
+
+        if (c >= 'A' && c <= 'Z')
+            segment = c - 'A';
+        else if (c >= 'a' && c <= 'z')
+            segment = c - 'a' + 26;
+        else if (c >= '0' && c <= '9')
+            segment = c - '0' + 52;
+        else if (c == '+')
+            segment = 62;
+        else if (c == '/')
+            segment = 63;
+        else
+            return -1; /* Not a base 64 character */
+
+        word = (word << 6) | segment;
+    }
+    return word;
+}
+
+int decodeBase64Words(const char *text, long size, unsigned int *words) {
+    /* Decoding table of every byte value into it's 6-bit segment, -1 for a byte which isn't a base 64 character */
+    static const signed char segments[256] = {
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+        52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+        -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+        15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+        -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+        41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+    };
+    const unsigned char *bytes = (const unsigned char *) text;
+    int count = 0;
+    long i = 0;
+
+    while (i + ISA_BASE64_DIGITS - 1 < size) {
+        unsigned int word = 0;
+        int isValid = 0; /* Negative once a character isn't a base 64 character */
+        int j = 0;
+
+        for (; j < ISA_BASE64_DIGITS; ++j) {
+            int segment = segments[bytes[i + j]];
+            isValid |= segment;
+            word = (word << 6) | (unsigned int) (segment & 0x3F);
+        }
+
+        /* A line which doesn't start with a word of base 64 characters is skipped */
+        if (isValid >= 0)
+            words[count++] = word;
+
+        /* Lines are normally the characters of a word and a new line, anything else is skipped until the new line */
+        if (i + ISA_BASE64_DIGITS < size && bytes[i + ISA_BASE64_DIGITS] == '\n')
+            i += ISA_BASE64_DIGITS + 1;
+        else {
+            while (i < size && bytes[i] != '\n')
+                ++i;
+            ++i;
+        }
+    }
+    return count;
+}
+
+/* Make sure the given chunk (and every chunk before it) is allocated */
+static int reserveChunk(CodeImage *image, int chunk) {
+    /* Grow the directory of chunks, the chunks themselves stay in place */
+    if (chunk >= image->capacity) {
+        int newCapacity = image->capacity == 0 ? 8 : image->capacity;
+        unsigned char **newChunks;
+
+        while (chunk >= newCapacity)
+            newCapacity *= 2;
+        newChunks = (unsigned char **) reallocateMemory(MEMORY_ENCODING, image->chunks,
+                                                        newCapacity * sizeof(unsigned char *));
+        if (newChunks == NULL)
+            return false;
+        image->chunks = newChunks;
+        image->capacity = newCapacity;
+    }
+
+    /* Allocate every missing chunk up to the requested one */
+    while (chunk >= image->numOfChunks) {
+        unsigned char *newChunk = (unsigned char *) allocateZeroedMemory(MEMORY_ENCODING, CODE_IMAGE_CHUNK_BYTES, 1);
+        if (newChunk == NULL)
+            return false;
+        image->chunks[image->numOfChunks++] = newChunk;
+    }
+    return true;
+}
+
+#if ISA_WORD_BITS == 12
+
+/* Pointer to the 3 bytes holding the pair of words the index belongs to */
+#define PAIR_OF(image, index) \
+    ((image)->chunks[(index) / CODE_IMAGE_CHUNK_SIZE] + ((index) % CODE_IMAGE_CHUNK_SIZE) / 2 * 3)
+
+int setCodeImageWord(CodeImage *image, int index, unsigned int binaryCode) {
+    unsigned char *pair;
+
+    if (index < 0 || !reserveChunk(image, index / CODE_IMAGE_CHUNK_SIZE))
+        return false;
+
+    /* Even word: byte 0 and the low nibble of byte 1. Odd word: the high nibble of byte 1 and byte 2 */
+    pair = PAIR_OF(image, index);
+    if (index % 2 == 0) {
+        pair[0] = (unsigned char) (binaryCode & 0xFF);
+        pair[1] = (unsigned char) ((pair[1] & 0xF0) | ((binaryCode >> 8) & 0x0F));
+    } else {
+        pair[1] = (unsigned char) ((pair[1] & 0x0F) | ((binaryCode & 0x0F) << 4));
+        pair[2] = (unsigned char) ((binaryCode >> 4) & 0xFF);
+    }
+
+    if (index >= image->size)
+        image->size = index + 1;
+    return true;
+}
+
+unsigned int getCodeImageWord(const CodeImage *image, int index) {
+    const unsigned char *pair;
+
+    /* Word has never been written */
+    if (index < 0 || index >= image->size)
+        return 0;
+
+    pair = PAIR_OF(image, index);
+    if (index % 2 == 0)
+        return pair[0] | ((pair[1] & 0x0F) << 8);
+    return (pair[1] >> 4) | (pair[2] << 4);
+}
+
+int writeCodeImageWords(CodeImage *image, int index, const unsigned int *words, int count) {
+    int written = 0;
+
+    /* Odd start, fill in the second half of the first pair */
+    if (count > 0 && index % 2 != 0) {
+        if (!setCodeImageWord(image, index, words[0]))
+            return 0;
+        written++;
+    }
+
+    /* Pack whole pairs, three bytes at a time */
+    while (count - written >= 2) {
+        int wordIndex = index + written;
+        int chunkEnd = (wordIndex / CODE_IMAGE_CHUNK_SIZE + 1) * CODE_IMAGE_CHUNK_SIZE;
+        unsigned char *pair;
+
+        if (!reserveChunk(image, wordIndex / CODE_IMAGE_CHUNK_SIZE))
+            return written;
+
+        pair = PAIR_OF(image, wordIndex);
+        for (; count - written >= 2 && wordIndex < chunkEnd; wordIndex += 2, written += 2, pair += 3) {
+            unsigned int even = words[written] & 0xFFF;
+            unsigned int odd = words[written + 1] & 0xFFF;
+
+            pair[0] = (unsigned char) (even & 0xFF);
+            pair[1] = (unsigned char) ((even >> 8) | ((odd & 0x0F) << 4));
+            pair[2] = (unsigned char) (odd >> 4);
+        }
+        if (wordIndex > image->size)
+            image->size = wordIndex;
+    }
+
+    /* Single word left */
+    if (count - written == 1 && setCodeImageWord(image, index + written, words[written]))
+        written++;
+    return written;
+}
+
+#else
+
+/* Pointer to the bytes holding the word of the index, the least significant byte first */
+#define WORD_OF(image, index) \
+    ((image)->chunks[(index) / CODE_IMAGE_CHUNK_SIZE] + ((index) % CODE_IMAGE_CHUNK_SIZE) * ISA_WORD_BYTES)
+
+int setCodeImageWord(CodeImage *image, int index, unsigned int binaryCode) {
+    unsigned char *bytes;
+    int i = 0;
+
+    if (index < 0 || !reserveChunk(image, index / CODE_IMAGE_CHUNK_SIZE))
+        return false;
+
+    bytes = WORD_OF(image, index);
+    for (; i < ISA_WORD_BYTES; ++i)
+        bytes[i] = (unsigned char) ((binaryCode & ISA_WORD_MASK) >> (8 * i));
+
+    if (index >= image->size)
+        image->size = index + 1;
+    return true;
+}
+
+unsigned int getCodeImageWord(const CodeImage *image, int index) {
+    const unsigned char *bytes;
+    unsigned int word = 0;
+    int i = ISA_WORD_BYTES - 1;
+
+    /* Word has never been written */
+    if (index < 0 || index >= image->size)
+        return 0;
+
+    bytes = WORD_OF(image, index);
+    for (; i >= 0; --i)
+        word = (word << 8) | bytes[i];
+    return word;
+}
+
+int writeCodeImageWords(CodeImage *image, int index, const unsigned int *words, int count) {
+    int written = 0;
+
+    /* The words are whole bytes, so every word is written the same way */
+    while (written < count && setCodeImageWord(image, index + written, words[written]))
+        written++;
+    return written;
+}
+
+#endif
+
+void initCodeImageIterator(CodeImageIterator *iterator, const CodeImage *image) {
+    iterator->image = image;
+    iterator->index = 0;
+}
+
+#if ISA_WORD_BITS == 12
+
+int nextCodeImageBlock(CodeImageIterator *iterator, unsigned int *words, int maxWords) {
+    const CodeImage *image = iterator->image;
+    int count = 0;
+
+    /* Odd position, take the second half of the current pair */
+    if (count < maxWords && iterator->index < image->size && iterator->index % 2 != 0)
+        words[count++] = getCodeImageWord(image, iterator->index++);
+
+    /* Unpack whole pairs, three bytes at a time */
+    while (maxWords - count >= 2 && image->size - iterator->index >= 2) {
+        int chunkEnd = (iterator->index / CODE_IMAGE_CHUNK_SIZE + 1) * CODE_IMAGE_CHUNK_SIZE;
+        const unsigned char *pair = PAIR_OF(image, iterator->index);
+
+        for (; maxWords - count >= 2 && image->size - iterator->index >= 2 && iterator->index < chunkEnd;
+               iterator->index += 2, pair += 3) {
+            words[count++] = pair[0] | ((pair[1] & 0x0F) << 8);
+            words[count++] = (pair[1] >> 4) | (pair[2] << 4);
+        }
+    }
+
+    /* Single word left */
+    if (count < maxWords && iterator->index < image->size)
+        words[count++] = getCodeImageWord(image, iterator->index++);
+    return count;
+}
+
+#else
+
+int nextCodeImageBlock(CodeImageIterator *iterator, unsigned int *words, int maxWords) {
+    int count = 0;
+
+    while (count < maxWords && iterator->index < iterator->image->size)
+        words[count++] = getCodeImageWord(iterator->image, iterator->index++);
+    return count;
+}
+
+#endif
+
+void freeCodeImage(CodeImage *image) {
+    int i = 0;
+
+    /* Release each chunk of the image out of the memory */
+    for (; i < image->numOfChunks; ++i)
+        freeMemory(image->chunks[i]);
+    freeMemory(image->chunks);
+
+    image->chunks = NULL;
+    image->numOfChunks = 0;
+    image->capacity = 0;
+    image->size = 0;
+}
+
+void addToCodeWordTable(AssemblerContext *context, const char *line, unsigned int binaryCode) {
+    if (!setCodeImageWord(&context->codeImage, context->address - INITIAL_ADDRESS_VALUE, binaryCode))
+        reportError(context, 12, line);
+}
+
+void addToDataWordTable(AssemblerContext *context, const char *line, unsigned int binaryCode) {
+    if (!setCodeImageWord(&context->dataImage, context->dataCounter, binaryCode))
+        reportError(context, 12, line);
 }
\ No newline at end of file
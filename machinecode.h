@@ -1,113 +1,255 @@
-#ifndef  MACHINECODE_H
-#define MACHINECODE_H
-
-/**
- * @file machinecode.h
- * @brief Definitions and functions related to machine code generation.
- */
-
-/**
- * @struct CodeWord
- * @brief Structure to represent a single machine code word.
- *
- * This structure holds the binary representation of a machine code word.
- */
-typedef struct CodeWord {
-    unsigned int binaryCode; /** The binary representation of the machine code word. */
-} CodeWord;
-
-/**
- * @brief Array of machine code words.
- *
- * This array holds the generated machine code words during the assembly process.
- * Each element of the array represents a single machine code word with its binary representation.
- */
-extern CodeWord codeWordTable[];
-
-/**
- * @brief Generate the binary code for an instruction.
- *
- * This function generates the binary code for an instruction with the specified destination
- * and source operand addressing modes and the opcode.
- *
- * @param destOperandAddressing The destination operand addressing mode (0-7).
- * @param opCode The opcode of the instruction (0-15).
- * @param srcOperandAddressing The source operand addressing mode (0-7).
- * @return The generated 12-bit binary code for the instruction.
- */
-unsigned int generateBinaryCode(int destOperandAddressing, int opCode, int srcOperandAddressing);
-
-/**
- * @brief Convert register numbers to a 12-bit binary representation.
- *
- * This function converts two register numbers (destination and source) to a 12-bit binary representation.
- *
- * @param destRegister The number of the destination register (0-7).
- * @param srcRegister The number of the source register (0-7).
- * @return The 12-bit binary representation of the two registers.
- */
-unsigned int registersToBinary(int destRegister, int srcRegister);
-
-/**
- * @brief Convert a decimal number to a 12-bit binary representation.
- *
- * This function converts a decimal number to a 12-bit binary representation.
- * If the decimal number cannot be represented using 12 bits, it will be truncated.
- *
- * @param decimal The decimal number to convert.
- * @return The 12-bit binary representation of the decimal number.
- */
-unsigned int decimalToBinary12Bit(int decimal);
-
-/**
- * @brief Convert a decimal number to a 10-bit binary representation.
- *
- * This function converts a decimal number to a 10-bit binary representation.
- * If the decimal number cannot be represented using 10 bits, it will be truncated.
- *
- * @param decimal The decimal number to convert.
- * @return The 10-bit binary representation of the decimal number.
- */
-unsigned int decimalToBinary10Bit(int decimal);
-
-/**
- * @brief Convert operand and type to a 12-bit binary representation.
- *
- * This function converts an operand value and its type to a 12-bit binary representation.
- *
- * @param operand The operand value to convert.
- * @param type The type of the operand (0-3).
- * @return The 12-bit binary representation of the operand and type.
- */
-unsigned int convertTo12BitBinary(int operand, int type);
-
-/**
- * @brief Convert an ASCII character to a 12-bit binary representation.
- *
- * This function converts an ASCII character to its 12-bit binary representation.
- *
- * @param ascii_value The ASCII character to convert.
- * @return The 12-bit binary representation of the ASCII character.
- */
-unsigned int asciiToBinary12Bit(char ascii_value);
-
-/**
- * @brief Convert a 12-bit binary number to a base64-encoded string.
- *
- * This function converts a 12-bit binary number to its base64-encoded representation.
- *
- * @param binaryNumber The 12-bit binary number to convert.
- * @return The base64-encoded string representing the binary number.
- */
-char* convertToBase64(int binaryNumber);
-
-/**
- * @brief Adds the given binary code to the codeWordTable at the current address.
- *
- * @param fileName The name of the file being processed.
- * @param line The current line being processed.
- * @param binaryCode The binary code to be added to the codeWordTable.
- */
-void addToCodeWordTable(const char *fileName, const char *line, unsigned int binaryCode);
-
-#endif
+#ifndef  MACHINECODE_H
+#define MACHINECODE_H
+
+/**
+ * @file machinecode.h
+ * @brief Definitions and functions related to machine code generation.
+ */
+
+/**
+ * @struct CodeImage
+ * @brief Structure to represent a growable image of 12-bit machine code words.
+ *
+ * The words are packed two words in 3 bytes (words wider than 12 bits take ISA_WORD_BYTES bytes each), and stored
+ * in fixed size chunks of CODE_IMAGE_CHUNK_SIZE words.
+ * Only the directory of chunk pointers grows, so a word never moves once it has been written.
+ */
+typedef struct CodeImage {
+    unsigned char **chunks;  /* Directory of the allocated chunks of packed words. */
+    int numOfChunks;         /* The number of allocated chunks. */
+    int capacity;            /* The number of chunk pointers the directory can hold. */
+    int size;                /* The number of words in the image (highest written index + 1). */
+} CodeImage;
+
+/**
+ * @struct CodeImageIterator
+ * @brief Structure to represent a sequential reader of a code image, which unpacks words a block at a time.
+ */
+typedef struct CodeImageIterator {
+    const CodeImage *image;  /* The image being read. */
+    int index;               /* The index of the next word to read. */
+} CodeImageIterator;
+
+/**
+ * @brief Generate the binary code for an instruction.
+ *
+ * This function generates the binary code for an instruction with the specified destination
+ * and source operand addressing modes and the opcode.
+ *
+ * @param destOperandAddressing The destination operand addressing mode (0-7).
+ * @param opCode The opcode of the instruction (0-15).
+ * @param srcOperandAddressing The source operand addressing mode (0-7).
+ * @return The generated 12-bit binary code for the instruction.
+ */
+unsigned int generateBinaryCode(int destOperandAddressing, int opCode, int srcOperandAddressing);
+
+/**
+ * @brief Get the number of words of an instruction from it's first word.
+ *
+ * The first word holds the addressing methods of the operands: every operand takes a word of it's own,
+ * except for two register operands which share a single word.
+ *
+ * @param firstWord The first word of the instruction (as generated by generateBinaryCode).
+ * @return The number of words of the instruction (1-3).
+ */
+int getInstructionLength(unsigned int firstWord);
+
+/**
+ * @brief Convert register numbers to a 12-bit binary representation.
+ *
+ * This function converts two register numbers (destination and source) to a 12-bit binary representation.
+ *
+ * @param destRegister The number of the destination register (0-7).
+ * @param srcRegister The number of the source register (0-7).
+ * @return The 12-bit binary representation of the two registers.
+ */
+unsigned int registersToBinary(int destRegister, int srcRegister);
+
+/**
+ * @brief Convert a decimal number to a 12-bit binary representation.
+ *
+ * This function converts a decimal number to a 12-bit binary representation (ISA_WORD_BITS bits, see isa.h).
+ * If the decimal number cannot be represented using ISA_WORD_BITS bits, it will be truncated.
+ *
+ * @param decimal The decimal number to convert.
+ * @return The 12-bit binary representation of the decimal number.
+ */
+unsigned int decimalToBinary12Bit(int decimal);
+
+/**
+ * @brief Convert a decimal number to a 10-bit binary representation.
+ *
+ * This function converts a decimal number to a 10-bit binary representation (ISA_OPERAND_BITS bits, see isa.h).
+ * If the decimal number cannot be represented using ISA_OPERAND_BITS bits, it will be truncated.
+ *
+ * @param decimal The decimal number to convert.
+ * @return The 10-bit binary representation of the decimal number.
+ */
+unsigned int decimalToBinary10Bit(int decimal);
+
+/**
+ * @brief Convert operand and type to a 12-bit binary representation.
+ *
+ * This function converts an operand value and its type to a 12-bit binary representation (a word of
+ * ISA_WORD_BITS bits, see isa.h).
+ *
+ * @param operand The operand value to convert.
+ * @param type The type of the operand (0-3).
+ * @return The 12-bit binary representation of the operand and type.
+ */
+unsigned int convertTo12BitBinary(int operand, int type);
+
+/**
+ * @brief Check if an address fits in the operand of a word.
+ *
+ * convertTo12BitBinary keeps only ISA_OPERAND_BITS bits of an operand, a larger address would be wrapped, so the
+ * address of every reference is checked before it's encoded.
+ *
+ * @param address The address to check.
+ * @return True if the address is between 0 and ISA_MAX_OPERAND_ADDRESS, false otherwise.
+ */
+int isOperandAddress(long address);
+
+/**
+ * @brief Convert an ASCII character to a 12-bit binary representation.
+ *
+ * This function converts an ASCII character to its 12-bit binary representation.
+ *
+ * @param ascii_value The ASCII character to convert.
+ * @return The 12-bit binary representation of the ASCII character.
+ */
+unsigned int asciiToBinary12Bit(char ascii_value);
+
+/**
+ * @brief Encode a list of decimal numbers into consecutive words of a code image.
+ *
+ * The list is parsed in one pass, numbers are separated by commas, spaces or tabs, and each number
+ * is masked to its 12-bit Two's complement representation and written straight into the image.
+ * Encoding stops at the first item which isn't numeric.
+ *
+ * @param image The code image to write into.
+ * @param index The index of the first word to write.
+ * @param list The list of numbers.
+ * @return The number of words that have been encoded.
+ */
+int encodeDataList(CodeImage *image, int index, const char *list);
+
+/**
+ * @brief Encode characters into consecutive words of a code image.
+ *
+ * Each character is widened into a 12-bit word, a whole block at a time (using SSE2 when available),
+ * and the block is packed into the image.
+ *
+ * @param image The code image to write into.
+ * @param index The index of the first word to write.
+ * @param characters The characters to encode.
+ * @param length The number of characters to encode.
+ * @return The number of words that have been encoded.
+ */
+int encodeCharacters(CodeImage *image, int index, const char *characters, int length);
+
+/**
+ * @brief Convert a 12-bit binary number to a base64-encoded string.
+ *
+ * This function converts a 12-bit binary number to its base64-encoded representation.
+ *
+ * @param binaryNumber The 12-bit binary number to convert.
+ * @param base64Number Buffer of at least ISA_BASE64_DIGITS + 1 characters (3 on the classic machine) to hold the
+ * encoded string.
+ * @return base64Number, the base64-encoded string representing the binary number.
+ */
+char* convertToBase64(int binaryNumber, char *base64Number);
+
+/**
+ * @brief Sets the word at the given index of a code image, allocating a new chunk when needed.
+ *
+ * @param image The code image to write into.
+ * @param index The index of the word in the image.
+ * @param binaryCode The binary code to store.
+ * @return True if the word has been stored, false if memory allocation has been failed.
+ */
+int setCodeImageWord(CodeImage *image, int index, unsigned int binaryCode);
+
+/**
+ * @brief Writes consecutive words into a code image, packing them a pair at a time.
+ *
+ * @param image The code image to write into.
+ * @param index The index of the first word to write.
+ * @param words The words to write.
+ * @param count The number of words to write.
+ * @return The number of words that have been written, less than count only if memory allocation has been failed.
+ */
+int writeCodeImageWords(CodeImage *image, int index, const unsigned int *words, int count);
+
+/**
+ * @brief Gets the word at the given index of a code image.
+ *
+ * @param image The code image to read from.
+ * @param index The index of the word in the image.
+ * @return The binary code stored at the index, or 0 if the word has never been written.
+ */
+unsigned int getCodeImageWord(const CodeImage *image, int index);
+
+/**
+ * @brief Initializes an iterator to read a code image from it's first word.
+ *
+ * @param iterator The iterator to initialize.
+ * @param image The code image to read.
+ */
+void initCodeImageIterator(CodeImageIterator *iterator, const CodeImage *image);
+
+/**
+ * @brief Reads the next block of words of a code image.
+ *
+ * @param iterator The iterator reading the image.
+ * @param words Array to store the unpacked words.
+ * @param maxWords The maximal number of words to read.
+ * @return The number of words that have been read, 0 once the whole image has been read.
+ */
+int nextCodeImageBlock(CodeImageIterator *iterator, unsigned int *words, int maxWords);
+
+/**
+ * @brief Frees the memory used by a code image and resets it to an empty image.
+ *
+ * @param image The code image to be freed.
+ */
+void freeCodeImage(CodeImage *image);
+
+/**
+ * @brief Convert a base64-encoded word (ISA_BASE64_DIGITS characters, two on the classic machine) back to its
+ * binary number.
+ *
+ * @param base64Number The base 64 characters of the word.
+ * @return The 12-bit binary number, or -1 if the characters aren't base 64 characters.
+ */
+int convertFromBase64(const char *base64Number);
+
+/**
+ * @brief Decodes a whole ".ob" file in one pass, a word of ISA_BASE64_DIGITS base 64 characters per line.
+ *
+ * @param text The content of the file.
+ * @param size The size of the content in bytes.
+ * @param words Array to store the words, large enough for (size + 1) / 2 words.
+ * @return The number of words that have been decoded, lines which aren't base 64 words are skipped.
+ */
+int decodeBase64Words(const char *text, long size, unsigned int *words);
+
+/**
+ * @brief Adds the given binary code to the code image at the current address.
+ *
+ * @param context The context of the source being assembled.
+ * @param line The current line being processed.
+ * @param binaryCode The binary code to be added to the code image.
+ */
+void addToCodeWordTable(AssemblerContext *context, const char *line, unsigned int binaryCode);
+
+/**
+ * @brief Adds the given binary code to the data image at the current data counter.
+ *
+ * @param context The context of the source being assembled.
+ * @param line The current line being processed.
+ * @param binaryCode The binary code to be added to the data image.
+ */
+void addToDataWordTable(AssemblerContext *context, const char *line, unsigned int binaryCode);
+
+#endif
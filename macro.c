@@ -4,19 +4,13 @@
 #include "data.h"
 #include "macro.h"
 
-typedef struct Macro {
-    char name[MAX_MACRO_NAME_LENGTH];
-    char content[MAX_LINE_LENGTH];
-    Macro *next;
-} Macro;
-
-int hasMacro(FILE *file) {
+int hasMacro(AssemblerContext *context, SourceReader *source) {
     char line[MAX_LINE_LENGTH];
 
-    while (fgets(line, sizeof(line), file)) {
+    while (readSourceLine(source, line, sizeof(line))) {
 
-        char *token = strtok(line, " ,\t\n");
-        if (token != NULL && (strncmp(token, "mcro", 4) == 0)) {
+        char *token = nextToken(context, line, " ,\t\n");
+        if (token != NULL && (strncmp(token, "mcro", 4) == 0 || strcmp(token, ".include") == 0)) {
             return true;
         }
     }
@@ -50,7 +44,7 @@ void addMacro(Macro **macroTable, Macro *newMacro) {
     }
 }
 
-void writeMacro(FILE *postSpanning, Macro *macroTable, char *token) {
+void writeMacro(AssemblerContext *context, TextBuffer *postSpanning, Macro *macroTable, char *token) {
     if (macroTable == NULL) {
         return;
     }
@@ -58,84 +52,196 @@ void writeMacro(FILE *postSpanning, Macro *macroTable, char *token) {
     Macro *macro = macroTable;
     while (macro != NULL) {
         if (strcmp(token, macro->name) == 0) {
-            /* Write the macro content to the output file */
-            fputs(macro->content, postSpanning);
+            /* Write the macro content to the output text */
+            if (!appendText(postSpanning, macro->content))
+                reportError(context, 12, token);
             break;
         }
         macro = macro->next;
     }
 }
 
-void createMacro(FILE *source, const char *fileName, char *line, char *token, Macro *newMacro) {
+void createMacro(AssemblerContext *context, SourceReader *source, char *line, char *token, Macro *newMacro) {
     char copiedLine[MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
     strcpy(copiedLine, line);         /* Make a copy of the original line */
 
-    token = strtok(NULL, " ,\t\n");
+    token = nextToken(context, NULL, " ,\t\n");
 
     /* Report error if macro's name is missing. */
     if (token == NULL) {
-        reportError(fileName, 12, copiedLine);
+        reportError(context, 12, copiedLine);
         return;
     }
 
     
     /* Report error if macro's name is used as a reserved keyword (directive/instruction). */
     if (strncmp(token, ".string", 7) == 0 || strncmp(token, ".data", 5) == 0 ||
-        strncmp(token, ".entry", 6) == 0 || strncmp(token, ".extern", 7) == 0 || isInstructionExist(token)) {
-        reportError(fileName, 13, copiedLine);
+        strncmp(token, ".entry", 6) == 0 || strncmp(token, ".extern", 7) == 0 ||
+        strncmp(token, ".include", 8) == 0 || isInstructionExist(token)) {
+        reportError(context, 13, copiedLine);
         return;
     }
 
     strcpy(newMacro->name, token); /* Set macro's name */
-    token = strtok(NULL, " ,\t\n");
+    token = nextToken(context, NULL, " ,\t\n");
 
     /* Report error if there's another operand after declaring the macro's name. */
     if (token != NULL) {
-        reportError(fileName, 14, copiedLine);
+        reportError(context, 14, copiedLine);
 	return;
     }
 
-    /* Get next line to complete macro definition */
-    fgets(copiedLine, sizeof(copiedLine), source);
-
     newMacro->content[0] = '\0'; /* Initialize content buffer */
     newMacro->next = NULL;
 
+    /* Get next line to complete macro definition, a definition without "endmcro" ends with the source */
+    if (!readSourceLine(source, copiedLine, sizeof(copiedLine)))
+        strcpy(copiedLine, "endmcro");
+
     /* Loop to read and concatenate lines until "endmcro" is encountered */
     while (strncmp(copiedLine, "endmcro", 7) != 0) {
-	lineNum++; /* Update number of line */
-
-        /* Concatenate line to content */
-        strcat(newMacro->content, copiedLine);
-        fgets(copiedLine, sizeof(copiedLine), source);
+	context->lineNum++; /* Update number of line */
+
+        /* Concatenate line to content, the whole content has to fit in a single line buffer */
+        if (strlen(newMacro->content) + strlen(copiedLine) < MAX_LINE_LENGTH)
+            strcat(newMacro->content, copiedLine);
+        else
+            reportError(context, 15, copiedLine);
+        if (!readSourceLine(source, copiedLine, sizeof(copiedLine)))
+            strcpy(copiedLine, "endmcro");
     }
 
-    lineNum++; /* Update number of line */
+    context->lineNum++; /* Update number of line */
 
     strcpy(line, copiedLine); /* Keep last line which has been read */
-    token = strtok(copiedLine, " ,\t\n");
-    token = strtok(NULL, " ,\t\n");
+    token = nextToken(context, copiedLine, " ,\t\n");
+    token = nextToken(context, NULL, " ,\t\n");
     /* Report an error if there's another operand after declaring the end of the macro definition. */
     if (token != NULL) {
-        reportError(fileName, 23, line);
+        reportError(context, 23, line);
     }
 }
 
 
-void macroSpanning(FILE *source, FILE *postSpanning, const char *fileName) {
+const Macro *findMacro(const MacroScope *scope, const char *token) {
+    const Macro *macro = scope->macroTable;
+    int i = 0;
+
+    /* The macros of the source come first */
+    for (; macro != NULL; macro = macro->next)
+        if (strcmp(token, macro->name) == 0)
+            return macro;
+
+    for (; i < scope->numOfLibraries; ++i)
+        for (macro = scope->libraries[i].library->macroTable; macro != NULL; macro = macro->next)
+            if (strcmp(token, macro->name) == 0)
+                return macro;
+    return NULL;
+}
+
+/* Add a file to the files a source includes */
+static int addIncludedFile(MacroScope *scope, const MacroDependency *file) {
+    if (scope->numOfIncludedFiles == scope->includedFilesCapacity) {
+        int newCapacity = scope->includedFilesCapacity == 0 ? 4 : scope->includedFilesCapacity * 2;
+        MacroDependency *newFiles = (MacroDependency *) reallocateMemory(MEMORY_MACROS, scope->includedFiles,
+                                                                         newCapacity * sizeof(MacroDependency));
+        if (newFiles == NULL)
+            return false;
+        scope->includedFiles = newFiles;
+        scope->includedFilesCapacity = newCapacity;
+    }
+    scope->includedFiles[scope->numOfIncludedFiles++] = *file;
+    return true;
+}
+
+/* Include a macro library: it's macros are added to the scope, and it's other lines are written in place of the
+  directive. The file is added to the included files even when it couldn't being included, so whoever watches the
+  files of the source knows about it */
+static void includeLibrary(AssemblerContext *context, const char *line, MacroScope *scope, TextBuffer *postSpanning) {
+    char path[MAX_LINE_LENGTH];
+    const char *start = strstr(line, ".include") + strlen(".include");
+    const char *end;
+    const MacroLibrary *library;
+    MacroDependency file;
+    int i = 0;
+
+    start += strspn(start, " \t");
+    /* Missing operands - no file has been given */
+    if (*start == '\0' || *start == '\r' || *start == '\n') {
+        reportError(context, 2, line);
+        return;
+    }
+    /* The file is enclosed with double quotes */
+    if (*start != '\"') {
+        reportError(context, 17, line);
+        return;
+    }
+    end = strchr(++start, '\"');
+    if (end == NULL) {
+        reportError(context, 18, line);
+        return;
+    }
+    /* Nothing but white spaces may follow the file */
+    if (end[1 + strspn(end + 1, " \t\r\n")] != '\0') {
+        reportError(context, 1, line);
+        return;
+    }
+    strncpy(path, start, (size_t) (end - start));
+    path[end - start] = '\0';
+
+    memset(&file, 0, sizeof(MacroDependency));
+    library = loadMacroLibrary(context, path, &file);
+    if (file.path[0] != '\0' && !addIncludedFile(scope, &file)) {
+        reportError(context, 12, line);
+        return;
+    }
+    if (library == NULL)
+        return;
+    for (i = 0; i < library->numOfDependencies; ++i) {
+        if (!addIncludedFile(scope, &library->dependencies[i])) {
+            reportError(context, 12, line);
+            return;
+        }
+    }
+
+    if (scope->numOfLibraries == scope->librariesCapacity) {
+        int newCapacity = scope->librariesCapacity == 0 ? 4 : scope->librariesCapacity * 2;
+        IncludedLibrary *newLibraries = (IncludedLibrary *) reallocateMemory(MEMORY_MACROS, scope->libraries,
+                                                                             newCapacity * sizeof(IncludedLibrary));
+        if (newLibraries == NULL) {
+            reportError(context, 12, line);
+            return;
+        }
+        scope->libraries = newLibraries;
+        scope->librariesCapacity = newCapacity;
+    }
+    scope->libraries[scope->numOfLibraries].library = library;
+    scope->libraries[scope->numOfLibraries++].file = file;
+
+    if (library->text != NULL && !appendText(postSpanning, library->text))
+        reportError(context, 12, line);
+}
+
+void macroSpanning(AssemblerContext *context, SourceReader *source, TextBuffer *postSpanning) {
+    MacroScope scope = {NULL, NULL, 0, 0, NULL, 0, 0};
+
+    spanMacros(context, source, postSpanning, &scope);
+    freeMacroScope(&scope); /* Reset macro table */
+}
+
+void spanMacros(AssemblerContext *context, SourceReader *source, TextBuffer *postSpanning, MacroScope *scope) {
     char line[MAX_LINE_LENGTH];
     char copiedLine[MAX_LINE_LENGTH]; /* Copy of the line */
     char *token; /* Used to tokenize the line being processed */
+    const Macro *macro;
 
-    fseek(source, 0, SEEK_SET); /* Reset file pointer to the beginning */
-
-    Macro *macroTable = NULL; /* Head pointer for the macro table */
+    source->position = 0; /* Reset the reader to the beginning */
 
     /* Process each line of the file */
-    while (fgets(line, sizeof(line), source)) {
-        lineNum++; /* Update number of line */
+    while (readSourceLine(source, line, sizeof(line))) {
+        context->lineNum++; /* Update number of line */
         strcpy(copiedLine, line); /* Make a copy of the line */
-        token = strtok(line, " ,\t\n"); /* Tokenizing current line */
+        token = nextToken(context, line, " ,\t\n"); /* Tokenizing current line */
 
         /* Skip commented line or new lines */
         if (token == NULL || token[0] == ';' || strcmp(copiedLine, "\n") == 0)
@@ -143,30 +249,47 @@ void macroSpanning(FILE *source, FILE *postSpanning, const char *fileName) {
 
             /* Macro declaration */
         else if (strncmp(line, "mcro", 4) == 0) {
-            Macro *newMacro = (Macro *) malloc(sizeof(Macro));
+            Macro *newMacro = (Macro *) allocateMemory(MEMORY_MACROS, sizeof(Macro));
 
             /* Report memory allocation has been failed for new macro */
             if (newMacro == NULL) {
-                reportError(fileName, 12, copiedLine);
+                reportError(context, 12, copiedLine);
                 return;
             }
 
             /* Create and add macro to the macro table */
-            createMacro(source, fileName, copiedLine, token, newMacro);
+            createMacro(context, source, copiedLine, token, newMacro);
 
-            /* Skip to the next line if error has been found while creating the macro */
-            if (errorFlag)
+            /* Skip to the next line if error has been found while creating the macro, the macro isn't kept */
+            if (context->errorFlag) {
+                freeMemory(newMacro);
                 continue;
+            }
 
-            addMacro(&macroTable, newMacro);
-        } else if (isMacro(macroTable, token)) /* Macro found */
+            addMacro(&scope->macroTable, newMacro);
+        } else if (strcmp(token, ".include") == 0) /* Macro library */
+            includeLibrary(context, copiedLine, scope, postSpanning);
+        else if ((macro = findMacro(scope, token)) != NULL) { /* Macro found */
             /* Write existed macro to pre assembler file with the ending of ".am" */
-            writeMacro(postSpanning, macroTable, token);
-        else     /* Write the line as it is */
-            fputs(copiedLine, postSpanning);
+            if (!appendText(postSpanning, macro->content))
+                reportError(context, 12, token);
+            STATS_INCREMENT(macroExpansions);
+        } else if (!appendText(postSpanning, copiedLine)) /* Write the line as it is */
+            reportError(context, 12, copiedLine);
     }
+}
 
-    freeMacroTable(macroTable); /* Reset macro table */
+void freeMacroScope(MacroScope *scope) {
+    freeMacroTable(scope->macroTable);
+    freeMemory(scope->libraries);
+    freeMemory(scope->includedFiles);
+    scope->macroTable = NULL;
+    scope->libraries = NULL;
+    scope->numOfLibraries = 0;
+    scope->librariesCapacity = 0;
+    scope->includedFiles = NULL;
+    scope->numOfIncludedFiles = 0;
+    scope->includedFilesCapacity = 0;
 }
 
 void freeMacroTable(Macro *macroTable) {
@@ -176,6 +299,6 @@ void freeMacroTable(Macro *macroTable) {
     while (currentMacro != NULL) {
         Macro *temp = currentMacro;
         currentMacro = currentMacro->next;
-        free(temp);
+        freeMemory(temp);
     }
 }
@@ -1,76 +1,155 @@
-#ifndef MACRO_H
-#define MACRO_H
-
-/**
- * @file macro.h
- * @brief Definitions and functions related to macros.
- */
-
-/**
- * Represents a macro structure.
- */
-typedef struct Macro Macro;
-
-/**
- * Checks if the given file contains any macro definitions.
- *
- * @param file The input file to check for macro definitions.
- * @return 1 if the file has at least one macro, otherwise 0.
- */
-int hasMacro(FILE *file);
-
-/**
- * Adds a new macro to the macro table.
- *
- * @param macroTable A pointer to the pointer to the macro table.
- * @param newMacro The new macro to add to the macro table.
- */
-void addMacro(Macro **macroTable, Macro *newMacro);
-
-/**
- * Creates a macro from the given source file, line, and token.
- *
- * @param source The source file containing the macro definition.
- * @param fileName The name of the source file (used for error reporting).
- * @param line The line of the macro definition.
- * @param token The token representing the macro name.
- * @param newMacro The newly created macro structure to store the macro information.
- */
-void createMacro(FILE *source, const char *fileName, char *line, char *token, Macro *newMacro);
-
-/**
- * Checks if the given token is a macro.
- *
- * @param macroTable The macro table containing the macros to search for the given token.
- * @param token The token to check for macro existence.
- * @return 1 if the token is a macro, otherwise 0.
- */
-int isMacro(Macro *macroTable, char *token);
-
-/**
- * Processes the macros spanning multiple lines in the source file and writes the result to the postSpanning file.
- *
- * @param source The source file containing the macros spanning multiple lines.
- * @param postSpanning The output file where the processed macros are written.
- * @param fileName The name of the source file (used for error reporting).
- */
-void macroSpanning(FILE *source, FILE *postSpanning, const char *fileName);
-
-/**
- * Writes the content of a macro to the output file.
- * If a macro with the given name is found in the macro table, its content is written to the output file.
- *
- * @param postSpanning The file pointer to the output file where the macro content will be written.
- * @param macroTable The macro table containing the macros to search for the given token.
- * @param token The name of the macro to be written.
- */
-void writeMacro(FILE *postSpanning, Macro *macroTable, char *token);
-
-/**
- * Frees the memory allocated for the macro table.
- *
- * @param macroTable The macro table to be freed.
- */
-void freeMacroTable(Macro *macroTable);
-
-#endif
+#ifndef MACRO_H
+#define MACRO_H
+
+/**
+ * @file macro.h
+ * @brief Definitions and functions related to macros.
+ *
+ * A source may include the macros of a macro library by an .include "file" directive. The library is spanned once
+ * and kept by the macro library cache (see macrolib.h), the source only refers to it: a macro of the source is
+ * looked up in it's own definitions first, then in the libraries it has included, in the order of the directives.
+ * The lines of a library which aren't macro definitions are written in place of the directive.
+ */
+
+/**
+ * The largest number of .include directives a source may be included through, it stops an endless cycle.
+ */
+#define MAX_INCLUDE_DEPTH 16
+
+/**
+ * @struct Macro
+ * @brief Structure to represent a macro.
+ */
+typedef struct Macro {
+    char name[MAX_MACRO_NAME_LENGTH];   /* The name of the macro. */
+    char content[MAX_LINE_LENGTH];      /* The lines of the macro. */
+    struct Macro *next;                 /* The next macro of the table. */
+} Macro;
+
+/**
+ * @struct MacroDependency
+ * @brief Structure to represent a file which has been included, as it has been read.
+ */
+typedef struct MacroDependency {
+    char path[MAX_LINE_LENGTH];     /* The path of the file. */
+    unsigned long hash;             /* The hash of the content. */
+    unsigned long checkHash;        /* A second hash of the content, which tells apart contents with the same hash. */
+    long size;                      /* The number of characters of the content. */
+} MacroDependency;
+
+/**
+ * @struct IncludedLibrary
+ * @brief Structure to represent a macro library which has been included by a source.
+ */
+typedef struct IncludedLibrary {
+    const struct MacroLibrary *library;     /* The library, kept by the macro library cache. */
+    MacroDependency file;                   /* The file the library has been read from. */
+} IncludedLibrary;
+
+/**
+ * @struct MacroScope
+ * @brief Structure to represent the macros a source can expand.
+ */
+typedef struct MacroScope {
+    Macro *macroTable;              /* The macros the source defines. */
+    IncludedLibrary *libraries;     /* The libraries the source includes, in the order of the directives. */
+    int numOfLibraries;             /* The number of libraries. */
+    int librariesCapacity;          /* The number of libraries allocated. */
+    MacroDependency *includedFiles; /* The files the source includes, directly or not, even those which have failed. */
+    int numOfIncludedFiles;         /* The number of included files. */
+    int includedFilesCapacity;      /* The number of included files allocated. */
+} MacroScope;
+
+/**
+ * Checks if the given source contains any macro definitions or .include directives.
+ *
+ * @param context The context of the source being assembled.
+ * @param source The reader of the source to check for macro definitions.
+ * @return 1 if the source has at least one macro or include, otherwise 0.
+ */
+int hasMacro(AssemblerContext *context, SourceReader *source);
+
+/**
+ * Adds a new macro to the macro table.
+ *
+ * @param macroTable A pointer to the pointer to the macro table.
+ * @param newMacro The new macro to add to the macro table.
+ */
+void addMacro(Macro **macroTable, Macro *newMacro);
+
+/**
+ * Creates a macro from the given source, line, and token.
+ *
+ * @param context The context of the source being assembled (used for error reporting).
+ * @param source The reader of the source containing the macro definition.
+ * @param line The line of the macro definition.
+ * @param token The token representing the macro name.
+ * @param newMacro The newly created macro structure to store the macro information.
+ */
+void createMacro(AssemblerContext *context, SourceReader *source, char *line, char *token, Macro *newMacro);
+
+/**
+ * Checks if the given token is a macro.
+ *
+ * @param macroTable The macro table containing the macros to search for the given token.
+ * @param token The token to check for macro existence.
+ * @return 1 if the token is a macro, otherwise 0.
+ */
+int isMacro(Macro *macroTable, char *token);
+
+/**
+ * Processes the macros spanning multiple lines in the source and writes the result to the postSpanning text.
+ *
+ * @param context The context of the source being assembled (used for error reporting).
+ * @param source The reader of the source containing the macros spanning multiple lines.
+ * @param postSpanning The output text where the processed macros are written (the ".am" file).
+ */
+void macroSpanning(AssemblerContext *context, SourceReader *source, TextBuffer *postSpanning);
+
+/**
+ * Processes the macros and the .include directives of a source like macroSpanning, and keeps it's macros.
+ *
+ * @param context The context of the source being assembled (used for error reporting).
+ * @param source The reader of the source.
+ * @param postSpanning The output text where the processed source is written.
+ * @param scope The scope to add the macros, the included libraries and the included files of the source into, it
+ * has to be freed with freeMacroScope.
+ */
+void spanMacros(AssemblerContext *context, SourceReader *source, TextBuffer *postSpanning, MacroScope *scope);
+
+/**
+ * Finds a macro in the definitions of a source, then in the libraries it has included.
+ *
+ * @param scope The macros of the source.
+ * @param token The name of the macro.
+ * @return The macro, or NULL if there's no macro by that name.
+ */
+const Macro *findMacro(const MacroScope *scope, const char *token);
+
+/**
+ * Frees the macros a source defines, the list of the libraries it has included (the libraries are kept by the
+ * cache) and the list of the files it has included.
+ *
+ * @param scope The scope to be freed.
+ */
+void freeMacroScope(MacroScope *scope);
+
+/**
+ * Writes the content of a macro to the output text.
+ * If a macro with the given name is found in the macro table, its content is written to the output text.
+ *
+ * @param context The context of the source being assembled (used for error reporting).
+ * @param postSpanning The output text where the macro content will be written.
+ * @param macroTable The macro table containing the macros to search for the given token.
+ * @param token The name of the macro to be written.
+ */
+void writeMacro(AssemblerContext *context, TextBuffer *postSpanning, Macro *macroTable, char *token);
+
+/**
+ * Frees the memory allocated for the macro table.
+ *
+ * @param macroTable The macro table to be freed.
+ */
+void freeMacroTable(Macro *macroTable);
+
+#endif
@@ -0,0 +1,482 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "data.h"
+#include "macrolib.h"
+#include "batchio.h"
+
+/* The magic line of a precompiled library, changed whenever it's layout is changed */
+#define PRECOMPILED_MAGIC "MLIB 1\n"
+
+/* The libraries which have been spanned, the newest first */
+static MacroLibrary *libraries = NULL;
+static long numOfWrites = 0; /* Tells apart the temporary files of the precompiled libraries */
+static pthread_mutex_t librariesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Read a whole file by plain system calls */
+static int readWholeFile(const char *path, BatchFile *file) {
+    BatchIo io;
+
+    memset(file, 0, sizeof(BatchFile));
+    strcpy(file->path, path);
+    file->name = file->path;
+    openBatchIo(&io, false);
+    readFiles(&io, file, 1);
+    closeBatchIo(&io);
+    if (file->status != 0) {
+        freeBatchFile(file);
+        return false;
+    }
+    return true;
+}
+
+/* Hash a content twice, FNV-1a and djb2, so two contents are told apart by 64 bits and their size */
+static void hashContent(const char *data, long size, MacroDependency *file) {
+    long i = 0;
+
+    file->hash = 2166136261UL;
+    file->checkHash = 5381UL;
+    file->size = size;
+    for (; i < size; ++i) {
+        file->hash = ((file->hash ^ (unsigned char) data[i]) * 16777619UL) & 0xFFFFFFFFUL;
+        file->checkHash = (file->checkHash * 33 + (unsigned char) data[i]) & 0xFFFFFFFFUL;
+    }
+}
+
+/* Check if two files have the same content */
+static int isSameContent(const MacroDependency *first, const MacroDependency *second) {
+    return first->hash == second->hash && first->checkHash == second->checkHash && first->size == second->size;
+}
+
+/* Find the path of an included file, relative to the directory of the file which includes it */
+static int resolvePath(const char *includer, const char *path, char *resolved) {
+    const char *slash = includer != NULL ? strrchr(includer, '/') : NULL;
+    size_t directoryLength = path[0] == '/' || slash == NULL ? 0 : (size_t) (slash - includer + 1);
+
+    if (directoryLength + strlen(path) >= MAX_LINE_LENGTH)
+        return false;
+    memcpy(resolved, includer, directoryLength);
+    strcpy(resolved + directoryLength, path);
+    return true;
+}
+
+/* Check if a library can be used for a file: it has the same content, and every file it includes is the same as it
+  has been (the includes are relative to the library, so it has to be the same file as well) */
+static int isLibraryCurrent(const MacroLibrary *library, const MacroDependency *file) {
+    int i = 0;
+
+    if (!isSameContent(&library->file, file))
+        return false;
+    if (library->numOfDependencies > 0 && strcmp(library->file.path, file->path) != 0)
+        return false;
+
+    for (; i < library->numOfDependencies; ++i) {
+        BatchFile dependency;
+        MacroDependency current;
+
+        if (!readWholeFile(library->dependencies[i].path, &dependency))
+            return false;
+        hashContent(dependency.data != NULL ? dependency.data : "", dependency.size, &current);
+        freeBatchFile(&dependency);
+        if (!isSameContent(&library->dependencies[i], &current))
+            return false;
+    }
+    return true;
+}
+
+/* Find a library in the cache */
+static const MacroLibrary *findLibrary(const MacroDependency *file) {
+    const MacroLibrary *library;
+
+    pthread_mutex_lock(&librariesMutex);
+    library = libraries;
+    pthread_mutex_unlock(&librariesMutex);
+
+    /* The libraries are only added at the head, so the list after it doesn't change */
+    for (; library != NULL; library = library->next)
+        if (isLibraryCurrent(library, file))
+            return library;
+    return NULL;
+}
+
+/* Free a library which isn't in the cache */
+static void freeLibrary(MacroLibrary *library) {
+    freeMacroTable(library->macroTable);
+    freeMemory(library->text);
+    freeMemory(library->dependencies);
+    freeMemory(library);
+}
+
+/* Check if two libraries have been spanned from the same files */
+static int isSameLibrary(const MacroLibrary *first, const MacroLibrary *second) {
+    int i = 0;
+
+    if (!isSameContent(&first->file, &second->file) || strcmp(first->file.path, second->file.path) != 0 ||
+        first->numOfDependencies != second->numOfDependencies)
+        return false;
+    for (; i < first->numOfDependencies; ++i)
+        if (!isSameContent(&first->dependencies[i], &second->dependencies[i]) ||
+            strcmp(first->dependencies[i].path, second->dependencies[i].path) != 0)
+            return false;
+    return true;
+}
+
+/* Add a library to the cache, unless another source has added the same library meanwhile */
+static const MacroLibrary *addLibrary(MacroLibrary *library) {
+    const MacroLibrary *added;
+
+    pthread_mutex_lock(&librariesMutex);
+    for (added = libraries; added != NULL; added = added->next)
+        if (isSameLibrary(added, library))
+            break;
+    if (added == NULL) {
+        library->next = libraries;
+        libraries = library;
+        added = library;
+    }
+    pthread_mutex_unlock(&librariesMutex);
+
+    if (added != library)
+        freeLibrary(library);
+    return added;
+}
+
+/* Get the path of the precompiled library of a file in the cache directory */
+static int getPrecompiledPath(const char *directory, const MacroDependency *file, char *path) {
+    char name[64];
+
+    sprintf(name, "/%08lx%08lx-%ld.mlib", file->hash, file->checkHash, file->size);
+    if (strlen(directory) + strlen(name) >= MAX_LINE_LENGTH)
+        return false;
+    strcpy(path, directory);
+    strcat(path, name);
+    return true;
+}
+
+/* Append a line of a precompiled library */
+static int appendLibraryLine(BatchFile *precompiled, const char *line) {
+    return appendBatchData(precompiled, line, (long) strlen(line));
+}
+
+/* Append a file to a precompiled library */
+static int appendLibraryFile(BatchFile *precompiled, const MacroDependency *file) {
+    char line[MAX_LINE_LENGTH + 64];
+
+    sprintf(line, "%lu %lu %ld %s\n", file->hash, file->checkHash, file->size, file->path);
+    return appendLibraryLine(precompiled, line);
+}
+
+/* Write a library into the cache directory, through a temporary file which is renamed, so another run never reads a
+  library which is written partly */
+static void writePrecompiledLibrary(const char *directory, const MacroLibrary *library) {
+    BatchFile precompiled;
+    BatchIo io;
+    char path[MAX_LINE_LENGTH];
+    char line[MAX_LINE_LENGTH + 64];
+    const Macro *macro;
+    int numOfMacros = 0;
+    int isWritten;
+    int i = 0;
+
+    long writeNumber;
+
+    if (!getPrecompiledPath(directory, &library->file, path))
+        return;
+    pthread_mutex_lock(&librariesMutex);
+    writeNumber = numOfWrites++;
+    pthread_mutex_unlock(&librariesMutex);
+    sprintf(line, "%s.%ld.%ld.tmp", path, (long) getpid(), writeNumber);
+    if (strlen(line) >= MAX_LINE_LENGTH)
+        return;
+    memset(&precompiled, 0, sizeof(BatchFile));
+    strcpy(precompiled.path, line);
+    precompiled.name = precompiled.path;
+
+    for (macro = library->macroTable; macro != NULL; macro = macro->next)
+        numOfMacros++;
+    sprintf(line, "%d %d %ld\n", library->numOfDependencies, numOfMacros, library->size);
+    isWritten = appendLibraryLine(&precompiled, PRECOMPILED_MAGIC) && appendLibraryLine(&precompiled, line) &&
+                appendLibraryFile(&precompiled, &library->file);
+    for (; isWritten && i < library->numOfDependencies; ++i)
+        isWritten = appendLibraryFile(&precompiled, &library->dependencies[i]);
+
+    /* Every macro is it's name and the length of it's content, followed by the content */
+    for (macro = library->macroTable; isWritten && macro != NULL; macro = macro->next) {
+        sprintf(line, "%s %ld\n", macro->name, (long) strlen(macro->content));
+        isWritten = appendLibraryLine(&precompiled, line) && appendLibraryLine(&precompiled, macro->content);
+    }
+    if (isWritten && library->size > 0)
+        isWritten = appendBatchData(&precompiled, library->text, library->size);
+
+    if (isWritten) {
+        openBatchIo(&io, false);
+        writeFiles(&io, &precompiled, 1);
+        closeBatchIo(&io);
+        if (precompiled.status == 0 && rename(precompiled.path, path) != 0)
+            remove(precompiled.path);
+    }
+    freeBatchFile(&precompiled);
+}
+
+/* Read a number of a precompiled library, followed by a white space */
+static int readLibraryNumber(const char **position, const char *end, unsigned long *number) {
+    char *numberEnd;
+
+    if (*position >= end || (**position < '0' || **position > '9'))
+        return false;
+    *number = strtoul(*position, &numberEnd, 10);
+    if (numberEnd >= end || (*numberEnd != ' ' && *numberEnd != '\n'))
+        return false;
+    *position = numberEnd + 1;
+    return true;
+}
+
+/* Read a file of a precompiled library */
+static int readLibraryFile(const char **position, const char *end, MacroDependency *file) {
+    unsigned long size;
+    const char *lineEnd;
+
+    if (!readLibraryNumber(position, end, &file->hash) || !readLibraryNumber(position, end, &file->checkHash) ||
+        !readLibraryNumber(position, end, &size))
+        return false;
+    lineEnd = (const char *) memchr(*position, '\n', (size_t) (end - *position));
+    if (lineEnd == NULL || lineEnd - *position >= MAX_LINE_LENGTH)
+        return false;
+    file->size = (long) size;
+    memcpy(file->path, *position, (size_t) (lineEnd - *position));
+    file->path[lineEnd - *position] = '\0';
+    *position = lineEnd + 1;
+    return true;
+}
+
+/* Read the macros of a precompiled library */
+static int readLibraryMacros(const char **position, const char *end, MacroLibrary *library,
+                             unsigned long numOfMacros) {
+    unsigned long i = 0;
+
+    for (; i < numOfMacros; ++i) {
+        const char *nameEnd = (const char *) memchr(*position, ' ', (size_t) (end - *position));
+        Macro *macro;
+        unsigned long length;
+
+        if (nameEnd == NULL || nameEnd - *position >= MAX_MACRO_NAME_LENGTH)
+            return false;
+        macro = (Macro *) allocateMemory(MEMORY_MACROS, sizeof(Macro));
+        if (macro == NULL)
+            return false;
+        memcpy(macro->name, *position, (size_t) (nameEnd - *position));
+        macro->name[nameEnd - *position] = '\0';
+        macro->next = NULL;
+        addMacro(&library->macroTable, macro);
+
+        *position = nameEnd + 1;
+        if (!readLibraryNumber(position, end, &length) || length >= MAX_LINE_LENGTH ||
+            (long) length > end - *position)
+            return false;
+        memcpy(macro->content, *position, (size_t) length);
+        macro->content[length] = '\0';
+        *position += length;
+    }
+    return true;
+}
+
+/* Read the precompiled library of a file from the cache directory, returns NULL if there's none or it's stale */
+static MacroLibrary *readPrecompiledLibrary(const char *directory, const MacroDependency *file) {
+    BatchFile precompiled;
+    MacroLibrary *library;
+    const char *position, *end;
+    char path[MAX_LINE_LENGTH];
+    unsigned long numOfDependencies = 0, numOfMacros = 0, size = 0; /* Left 0 when the header can't being read */
+    int isRead;
+    unsigned long i = 0;
+
+    if (!getPrecompiledPath(directory, file, path) || !readWholeFile(path, &precompiled))
+        return NULL;
+    library = (MacroLibrary *) allocateMemory(MEMORY_MACROS, sizeof(MacroLibrary));
+    if (library == NULL) {
+        freeBatchFile(&precompiled);
+        return NULL;
+    }
+    memset(library, 0, sizeof(MacroLibrary));
+
+    position = precompiled.data;
+    end = precompiled.data + precompiled.size;
+    isRead = precompiled.size > (long) strlen(PRECOMPILED_MAGIC) &&
+             strncmp(position, PRECOMPILED_MAGIC, strlen(PRECOMPILED_MAGIC)) == 0;
+    if (isRead) {
+        position += strlen(PRECOMPILED_MAGIC);
+        isRead = readLibraryNumber(&position, end, &numOfDependencies) &&
+                 readLibraryNumber(&position, end, &numOfMacros) && readLibraryNumber(&position, end, &size) &&
+                 readLibraryFile(&position, end, &library->file);
+        if (isRead)
+            library->size = (long) size;
+    }
+    if (isRead && numOfDependencies > 0) {
+        library->dependencies = (MacroDependency *) allocateMemory(MEMORY_MACROS,
+                                                                   numOfDependencies * sizeof(MacroDependency));
+        isRead = library->dependencies != NULL;
+        for (; isRead && i < numOfDependencies; ++i)
+            isRead = readLibraryFile(&position, end, &library->dependencies[library->numOfDependencies++]);
+    }
+    isRead = isRead && readLibraryMacros(&position, end, library, numOfMacros) && library->size == end - position;
+    if (isRead && library->size > 0) {
+        library->text = (char *) allocateMemory(MEMORY_MACROS, (size_t) library->size + 1);
+        isRead = library->text != NULL;
+        if (isRead) {
+            memcpy(library->text, position, (size_t) library->size);
+            library->text[library->size] = '\0';
+        }
+    }
+    freeBatchFile(&precompiled);
+
+    /* A precompiled library of the same content has been included from another path, or a file it includes has
+      been changed */
+    if (!isRead || !isLibraryCurrent(library, file)) {
+        freeLibrary(library);
+        return NULL;
+    }
+    return library;
+}
+
+/* Add the files a library includes (and the files they include) to it's dependencies */
+static int addDependencies(MacroLibrary *library, const MacroScope *scope) {
+    int numOfDependencies = 0;
+    int i = 0;
+    int j;
+
+    for (; i < scope->numOfLibraries; ++i)
+        numOfDependencies += 1 + scope->libraries[i].library->numOfDependencies;
+    if (numOfDependencies == 0)
+        return true;
+
+    library->dependencies = (MacroDependency *) allocateMemory(MEMORY_MACROS,
+                                                               numOfDependencies * sizeof(MacroDependency));
+    if (library->dependencies == NULL)
+        return false;
+    for (i = 0; i < scope->numOfLibraries; ++i) {
+        const MacroLibrary *included = scope->libraries[i].library;
+
+        library->dependencies[library->numOfDependencies++] = scope->libraries[i].file;
+        for (j = 0; j < included->numOfDependencies; ++j)
+            library->dependencies[library->numOfDependencies++] = included->dependencies[j];
+    }
+    return true;
+}
+
+/* Add the macros of the libraries a library includes after it's own macros, so a source which includes it can
+  expand them as well */
+static int addIncludedMacros(MacroLibrary *library, const MacroScope *scope) {
+    int i = 0;
+
+    for (; i < scope->numOfLibraries; ++i) {
+        const Macro *macro = scope->libraries[i].library->macroTable;
+
+        for (; macro != NULL; macro = macro->next) {
+            Macro *copy = (Macro *) allocateMemory(MEMORY_MACROS, sizeof(Macro));
+
+            if (copy == NULL)
+                return false;
+            *copy = *macro;
+            copy->next = NULL;
+            addMacro(&library->macroTable, copy);
+        }
+    }
+    return true;
+}
+
+/* Span a library with a context of it's own, returns NULL if an error has been reported */
+static MacroLibrary *spanLibrary(AssemblerContext *context, const char *path, const BatchFile *source,
+                                 const MacroDependency *file) {
+    AssemblerContext libraryContext;
+    SourceReader reader;
+    TextBuffer text = {NULL, 0, 0};
+    MacroScope scope = {NULL, NULL, 0, 0, NULL, 0, 0};
+    MacroLibrary *library = (MacroLibrary *) allocateMemory(MEMORY_MACROS, sizeof(MacroLibrary));
+    int isSpanned;
+
+    if (library == NULL) {
+        reportError(context, 12, path);
+        return NULL;
+    }
+    memset(library, 0, sizeof(MacroLibrary));
+    library->file = *file;
+
+    initAssemblerContext(&libraryContext);
+    libraryContext.sourcePath = file->path;
+    libraryContext.macroCacheDirectory = context->macroCacheDirectory;
+    libraryContext.includeDepth = context->includeDepth + 1;
+    initSourceReader(&reader, source->data != NULL ? source->data : "", source->size);
+    spanMacros(&libraryContext, &reader, &text, &scope);
+
+    /* The macros of the library itself come before the ones it includes */
+    library->macroTable = scope.macroTable;
+    scope.macroTable = NULL;
+    library->text = text.text;
+    library->size = text.size;
+
+    isSpanned = !libraryContext.errorFlag;
+    if (!isSpanned)
+        reportError(context, 25, path);
+    else if (!addIncludedMacros(library, &scope) || !addDependencies(library, &scope)) {
+        isSpanned = false;
+        reportError(context, 12, path);
+    }
+    freeAssemblerContext(&libraryContext);
+    freeMacroScope(&scope);
+
+    if (!isSpanned) {
+        freeLibrary(library);
+        return NULL;
+    }
+    return library;
+}
+
+const MacroLibrary *loadMacroLibrary(AssemblerContext *context, const char *path, MacroDependency *file) {
+    const MacroLibrary *library;
+    MacroLibrary *newLibrary;
+    BatchFile source;
+
+    /* A library which includes itself, directly or not */
+    if (context->includeDepth >= MAX_INCLUDE_DEPTH) {
+        reportError(context, 26, path);
+        return NULL;
+    }
+    /* File couldn't being found/opened */
+    if (!resolvePath(context->sourcePath, path, file->path) || !readWholeFile(file->path, &source)) {
+        reportError(context, 24, path);
+        return NULL;
+    }
+    hashContent(source.data != NULL ? source.data : "", source.size, file);
+
+    /* The cache of the run first, then the precompiled libraries of the previous runs */
+    library = findLibrary(file);
+    if (library == NULL && context->macroCacheDirectory != NULL &&
+        (newLibrary = readPrecompiledLibrary(context->macroCacheDirectory, file)) != NULL)
+        library = addLibrary(newLibrary);
+    if (library == NULL && (newLibrary = spanLibrary(context, path, &source, file)) != NULL) {
+        if (context->macroCacheDirectory != NULL)
+            writePrecompiledLibrary(context->macroCacheDirectory, newLibrary);
+        library = addLibrary(newLibrary);
+    }
+
+    freeBatchFile(&source);
+    return library;
+}
+
+void freeMacroLibraries(void) {
+    MacroLibrary *library;
+
+    pthread_mutex_lock(&librariesMutex);
+    library = libraries;
+    libraries = NULL;
+    pthread_mutex_unlock(&librariesMutex);
+
+    while (library != NULL) {
+        MacroLibrary *next = library->next;
+
+        freeLibrary(library);
+        library = next;
+    }
+}
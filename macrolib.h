@@ -0,0 +1,50 @@
+#ifndef MACROLIB_H
+#define MACROLIB_H
+
+/**
+ * @file macrolib.h
+ * @brief The cache of the macro libraries which are included by .include directives.
+ *
+ * A library is keyed by the hash of it's content, so the same library is spanned once however many sources (or
+ * different paths) include it, for the whole run. When a cache directory is given (the --macro-cache option), a
+ * spanned library is also written into it as a precompiled library, named by the hash, which later runs read
+ * instead of spanning the library again. A library which includes other files is keyed by it's path as well, and
+ * it's kept only as long as the files it includes have the same content.
+ *
+ * The libraries are shared by all the sources (and threads), they aren't changed once they are in the cache, and
+ * they are freed by freeMacroLibraries once no source is assembled.
+ */
+
+/**
+ * @struct MacroLibrary
+ * @brief Structure to represent a macro library which has been spanned.
+ */
+typedef struct MacroLibrary {
+    MacroDependency file;               /* The file of the library, as it has been read first. */
+    Macro *macroTable;                  /* The macros, including those of the libraries it includes. */
+    char *text;                         /* The lines which aren't macro definitions, after spanning. */
+    long size;                          /* The number of characters of the text. */
+    MacroDependency *dependencies;      /* The files the library includes, directly or not. */
+    int numOfDependencies;              /* The number of files the library includes. */
+    struct MacroLibrary *next;          /* The next library of the cache. */
+} MacroLibrary;
+
+/**
+ * @brief Gets a library from the cache, or reads, spans and adds it.
+ *
+ * The path is relative to the directory of the source which includes it (context->sourcePath). An error is
+ * reported when the file can't be read, when the library has errors, and when it's included too deep.
+ *
+ * @param context The context of the source which includes the library.
+ * @param path The path of the library, as it's written in the directive.
+ * @param file Set to the file the library has been read from.
+ * @return The library, or NULL if an error has been reported.
+ */
+const MacroLibrary *loadMacroLibrary(AssemblerContext *context, const char *path, MacroDependency *file);
+
+/**
+ * @brief Frees every library of the cache.
+ */
+void freeMacroLibraries(void);
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file objconvert.c
+ * @details This program converts the outputs of the assembler between the text format (".ob" machine code,
+ * ".ent" entry points and ".ext" extern uses) and the binary object file format (".obj", see objectfile.h).
+ * @example Run ./objconvert file1, file2, ..., etc              to convert file1.ob (+ .ent/.ext) into file1.obj.
+ * @example Run ./objconvert -t file1, file2, ..., etc           to convert file1.obj back into file1.ob (+ .ent/.ext).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "objectfile.h"
+
+int main(int argc, char *argv[]) {
+    int toTextFlag = 0; /* Convert binary object files into text files */
+    int status = EXIT_SUCCESS;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        char fileName[FILENAME_MAX];
+        ObjectFile object;
+        FILE *file;
+
+        if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--text") == 0) {
+            toTextFlag = 1;
+            continue;
+        }
+
+        strcat(strcpy(fileName, argv[i]), ".obj");
+        if (toTextFlag) {
+            /* Binary object file into ".ob", ".ent" and ".ext" files */
+            if (!readBinaryObjectFile(fileName, &object)) {
+                printf("%s isn't a valid binary object file.\n", fileName);
+                status = EXIT_FAILURE;
+                continue;
+            }
+            if (!writeTextObjectFiles(&object, argv[i])) {
+                printf("Couldn't write the text files of %s.\n", argv[i]);
+                status = EXIT_FAILURE;
+            }
+        } else {
+            /* ".ob", ".ent" and ".ext" files into a binary object file */
+            if (!readTextObjectFiles(argv[i], &object)) {
+                printf("Couldn't read %s.ob.\n", argv[i]);
+                status = EXIT_FAILURE;
+                continue;
+            }
+            file = fopen(fileName, "wb");
+            if (file == NULL || !writeBinaryObjectFile(&object, file)) {
+                printf("Couldn't write %s.\n", fileName);
+                status = EXIT_FAILURE;
+            }
+            if (file != NULL)
+                fclose(file);
+        }
+        freeObjectFile(&object);
+    }
+
+    return status;
+}
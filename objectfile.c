@@ -0,0 +1,432 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "data.h"
+#include "objectfile.h"
+#include "decoder.h"
+
+/* Round a byte offset up to the next multiple of 4 */
+#define ALIGN4(offset) (((offset) + 3) & ~3L)
+
+/* Number of bytes of the given number of words, two 12-bit words are packed in 3 bytes */
+#if ISA_WORD_BITS == 12
+#define WORDS_SIZE(numOfWords) (((numOfWords) + 1) / 2 * 3)
+#else
+#define WORDS_SIZE(numOfWords) ((numOfWords) * ISA_WORD_BYTES)
+#endif
+
+void writeObjectField(unsigned char *bytes, long offset, unsigned long value) {
+    bytes[offset] = (unsigned char) (value & 0xFF);
+    bytes[offset + 1] = (unsigned char) ((value >> 8) & 0xFF);
+    bytes[offset + 2] = (unsigned char) ((value >> 16) & 0xFF);
+    bytes[offset + 3] = (unsigned char) ((value >> 24) & 0xFF);
+}
+
+unsigned long readObjectField(const unsigned char *bytes, long offset) {
+    return (unsigned long) bytes[offset] | ((unsigned long) bytes[offset + 1] << 8) |
+           ((unsigned long) bytes[offset + 2] << 16) | ((unsigned long) bytes[offset + 3] << 24);
+}
+
+unsigned int getObjectWord(const unsigned char *bytes, int index) {
+#if ISA_WORD_BITS == 12
+    const unsigned char *pair = bytes + readObjectField(bytes, OBJECT_FIELD_WORDS_OFFSET) + (long) (index / 2) * 3;
+
+    /* Even word: byte 0 and the low nibble of byte 1. Odd word: the high nibble of byte 1 and byte 2 */
+    if (index % 2 == 0)
+        return pair[0] | ((pair[1] & 0x0F) << 8);
+    return (pair[1] >> 4) | (pair[2] << 4);
+#else
+    const unsigned char *word = bytes + readObjectField(bytes, OBJECT_FIELD_WORDS_OFFSET) + (long) index * ISA_WORD_BYTES;
+    unsigned int value = 0;
+    int i = ISA_WORD_BYTES - 1;
+
+    /* The least significant byte first */
+    for (; i >= 0; --i)
+        value = (value << 8) | word[i];
+    return value;
+#endif
+}
+
+const char *getObjectSymbolName(const unsigned char *bytes, unsigned long tableOffset, int index) {
+    return (const char *) bytes + readObjectField(bytes, OBJECT_FIELD_STRINGS_OFFSET) +
+           readObjectField(bytes, (long) tableOffset + (long) index * 8);
+}
+
+int getObjectSymbolValue(const unsigned char *bytes, unsigned long tableOffset, int index) {
+    return (int) readObjectField(bytes, (long) tableOffset + (long) index * 8 + 4);
+}
+
+/* Check that every name of a table of symbols starts in the strings table and ends with a null byte in it */
+static int isValidSymbolTable(const unsigned char *bytes, int offsetField, int countField) {
+    unsigned long stringsOffset = readObjectField(bytes, OBJECT_FIELD_STRINGS_OFFSET);
+    unsigned long stringsSize = readObjectField(bytes, OBJECT_FIELD_STRINGS_SIZE);
+    unsigned long tableOffset = readObjectField(bytes, offsetField);
+    unsigned long count = readObjectField(bytes, countField);
+    unsigned long i = 0;
+
+    for (; i < count; ++i) {
+        unsigned long nameOffset = readObjectField(bytes, (long) (tableOffset + i * 8));
+
+        if (nameOffset >= stringsSize ||
+            memchr(bytes + stringsOffset + nameOffset, '\0', (size_t) (stringsSize - nameOffset)) == NULL)
+            return false;
+    }
+    return true;
+}
+
+int isValidObjectFile(const unsigned char *bytes, long size) {
+    unsigned long words, stringsEnd, wordBits;
+
+    if (size < OBJECT_HEADER_SIZE || memcmp(bytes, OBJECT_MAGIC, 4) != 0 ||
+        readObjectField(bytes, OBJECT_FIELD_VERSION) != OBJECT_VERSION ||
+        readObjectField(bytes, OBJECT_FIELD_FILE_SIZE) != (unsigned long) size)
+        return false;
+
+    /* The words of another machine can't being read */
+    wordBits = readObjectField(bytes, OBJECT_FIELD_WORD_BITS);
+    if ((wordBits == 0 ? OBJECT_DEFAULT_WORD_BITS : wordBits) != ISA_WORD_BITS)
+        return false;
+
+    /* Every table has to fit in the file */
+    words = readObjectField(bytes, OBJECT_FIELD_CODE_WORDS) + readObjectField(bytes, OBJECT_FIELD_DATA_WORDS);
+    stringsEnd = readObjectField(bytes, OBJECT_FIELD_STRINGS_OFFSET) + readObjectField(bytes, OBJECT_FIELD_STRINGS_SIZE);
+    if (readObjectField(bytes, OBJECT_FIELD_WORDS_OFFSET) + WORDS_SIZE(words) > (unsigned long) size ||
+        readObjectField(bytes, OBJECT_FIELD_ENTRY_OFFSET) + readObjectField(bytes, OBJECT_FIELD_ENTRY_COUNT) * 8 > (unsigned long) size ||
+        readObjectField(bytes, OBJECT_FIELD_EXTERN_OFFSET) + readObjectField(bytes, OBJECT_FIELD_EXTERN_COUNT) * 8 > (unsigned long) size ||
+        readObjectField(bytes, OBJECT_FIELD_RELOCATION_OFFSET) + readObjectField(bytes, OBJECT_FIELD_RELOCATION_SIZE) > (unsigned long) size ||
+        stringsEnd > (unsigned long) size)
+        return false;
+
+    /* Every name has to be a null terminated string of the strings table */
+    return isValidSymbolTable(bytes, OBJECT_FIELD_ENTRY_OFFSET, OBJECT_FIELD_ENTRY_COUNT) &&
+           isValidSymbolTable(bytes, OBJECT_FIELD_EXTERN_OFFSET, OBJECT_FIELD_EXTERN_COUNT);
+}
+
+int mapFile(const char *path, MappedObjectFile *mapped) {
+    struct stat status;
+    void *bytes;
+    int descriptor = open(path, O_RDONLY);
+
+    /* File couldn't being found/opened */
+    if (descriptor < 0)
+        return false;
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        close(descriptor);
+        return false;
+    }
+
+    bytes = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor); /* The mapping stays valid after closing the descriptor */
+    if (bytes == MAP_FAILED)
+        return false;
+
+    mapped->bytes = (const unsigned char *) bytes;
+    mapped->size = (long) status.st_size;
+    return true;
+}
+
+int mapObjectFile(const char *path, MappedObjectFile *mapped) {
+    if (!mapFile(path, mapped))
+        return false;
+
+    if (!isValidObjectFile(mapped->bytes, mapped->size)) {
+        unmapObjectFile(mapped);
+        return false;
+    }
+    return true;
+}
+
+void unmapObjectFile(MappedObjectFile *mapped) {
+    if (mapped->bytes != NULL)
+        munmap((void *) mapped->bytes, (size_t) mapped->size);
+    mapped->bytes = NULL;
+    mapped->size = 0;
+}
+
+/* Write a table of entry points/extern uses, and append their names to the strings table */
+static void writeSymbolTable(unsigned char *bytes, long tableOffset, long stringsOffset, long *stringsSize,
+                             const ObjectSymbol *symbols, int numOfSymbols) {
+    int i = 0;
+    for (; i < numOfSymbols; ++i) {
+        size_t length = strlen(symbols[i].name) + 1;
+
+        writeObjectField(bytes, tableOffset + (long) i * 8, (unsigned long) *stringsSize);
+        writeObjectField(bytes, tableOffset + (long) i * 8 + 4, (unsigned long) symbols[i].value);
+        memcpy(bytes + stringsOffset + *stringsSize, symbols[i].name, length);
+        *stringsSize += (long) length;
+    }
+}
+
+unsigned char *encodeBinaryObjectFile(const ObjectFile *object, long *size) {
+    int numOfWords = object->codeWords + object->dataWords;
+    long wordsOffset = OBJECT_HEADER_SIZE;
+    long entryOffset = ALIGN4(wordsOffset + (long) WORDS_SIZE(numOfWords));
+    long externOffset = entryOffset + (long) object->numOfEntries * 8;
+    long relocationOffset = externOffset + (long) object->numOfExterns * 8;
+    long stringsOffset = ALIGN4(relocationOffset + object->relocationsSize);
+    long stringsSize = 0;
+    long fileSize;
+    unsigned char *bytes;
+    int i;
+
+    /* The strings table can't be larger than every name at it's maximal length */
+    fileSize = stringsOffset + (long) (object->numOfEntries + object->numOfExterns) * (MAX_LABEL_LENGTH + 1);
+    bytes = (unsigned char *) allocateZeroedMemory(MEMORY_OBJECTS, (size_t) fileSize + 4, 1);
+    if (bytes == NULL)
+        return NULL;
+
+#if ISA_WORD_BITS == 12
+    /* Pack the words, two words in 3 bytes */
+    for (i = 0; i < numOfWords; i += 2) {
+        unsigned int even = object->words[i] & 0xFFF;
+        unsigned int odd = i + 1 < numOfWords ? object->words[i + 1] & 0xFFF : 0;
+        unsigned char *pair = bytes + wordsOffset + (long) (i / 2) * 3;
+
+        pair[0] = (unsigned char) (even & 0xFF);
+        pair[1] = (unsigned char) ((even >> 8) | ((odd & 0x0F) << 4));
+        pair[2] = (unsigned char) (odd >> 4);
+    }
+#else
+    /* Store the words, the least significant byte first */
+    for (i = 0; i < numOfWords * ISA_WORD_BYTES; ++i)
+        bytes[wordsOffset + i] = (unsigned char) ((object->words[i / ISA_WORD_BYTES] & ISA_WORD_MASK) >>
+                                                  (8 * (i % ISA_WORD_BYTES)));
+#endif
+
+    writeSymbolTable(bytes, entryOffset, stringsOffset, &stringsSize, object->entries, object->numOfEntries);
+    writeSymbolTable(bytes, externOffset, stringsOffset, &stringsSize, object->externs, object->numOfExterns);
+    if (object->relocationsSize > 0)
+        memcpy(bytes + relocationOffset, object->relocations, (size_t) object->relocationsSize);
+    fileSize = ALIGN4(stringsOffset + stringsSize);
+
+    /* Header */
+    memcpy(bytes, OBJECT_MAGIC, 4);
+    writeObjectField(bytes, OBJECT_FIELD_VERSION, OBJECT_VERSION);
+    writeObjectField(bytes, OBJECT_FIELD_CODE_WORDS, (unsigned long) object->codeWords);
+    writeObjectField(bytes, OBJECT_FIELD_DATA_WORDS, (unsigned long) object->dataWords);
+    writeObjectField(bytes, OBJECT_FIELD_WORDS_OFFSET, (unsigned long) wordsOffset);
+    writeObjectField(bytes, OBJECT_FIELD_ENTRY_COUNT, (unsigned long) object->numOfEntries);
+    writeObjectField(bytes, OBJECT_FIELD_ENTRY_OFFSET, (unsigned long) entryOffset);
+    writeObjectField(bytes, OBJECT_FIELD_EXTERN_COUNT, (unsigned long) object->numOfExterns);
+    writeObjectField(bytes, OBJECT_FIELD_EXTERN_OFFSET, (unsigned long) externOffset);
+    writeObjectField(bytes, OBJECT_FIELD_STRINGS_OFFSET, (unsigned long) stringsOffset);
+    writeObjectField(bytes, OBJECT_FIELD_STRINGS_SIZE, (unsigned long) stringsSize);
+    writeObjectField(bytes, OBJECT_FIELD_FILE_SIZE, (unsigned long) fileSize);
+    writeObjectField(bytes, OBJECT_FIELD_RELOCATION_COUNT, (unsigned long) object->numOfRelocations);
+    writeObjectField(bytes, OBJECT_FIELD_RELOCATION_OFFSET, (unsigned long) relocationOffset);
+    writeObjectField(bytes, OBJECT_FIELD_RELOCATION_SIZE, (unsigned long) object->relocationsSize);
+    writeObjectField(bytes, OBJECT_FIELD_WORD_BITS, ISA_WORD_BITS);
+
+    *size = fileSize;
+    return bytes;
+}
+
+int writeBinaryObjectFile(const ObjectFile *object, FILE *file) {
+    long size;
+    int written;
+    unsigned char *bytes = encodeBinaryObjectFile(object, &size);
+
+    if (bytes == NULL)
+        return false;
+
+    written = fwrite(bytes, 1, (size_t) size, file) == (size_t) size;
+    freeMemory(bytes);
+    return written;
+}
+
+/* Copy a table of entry points/extern uses of a binary object file */
+static ObjectSymbol *readSymbolTable(const unsigned char *bytes, int countField, int offsetField, int *numOfSymbols) {
+    unsigned long tableOffset = readObjectField(bytes, offsetField);
+    ObjectSymbol *symbols;
+    int i = 0;
+
+    *numOfSymbols = (int) readObjectField(bytes, countField);
+    symbols = (ObjectSymbol *) allocateMemory(MEMORY_OBJECTS, (*numOfSymbols + 1) * sizeof(ObjectSymbol));
+    if (symbols == NULL)
+        return NULL;
+
+    for (; i < *numOfSymbols; ++i) {
+        strncpy(symbols[i].name, getObjectSymbolName(bytes, tableOffset, i), MAX_LABEL_LENGTH);
+        symbols[i].name[MAX_LABEL_LENGTH] = '\0';
+        symbols[i].value = getObjectSymbolValue(bytes, tableOffset, i);
+    }
+    return symbols;
+}
+
+int loadObjectFile(const unsigned char *bytes, long size, ObjectFile *object) {
+    int numOfWords, i;
+
+    if (!isValidObjectFile(bytes, size))
+        return false;
+
+    object->codeWords = (int) readObjectField(bytes, OBJECT_FIELD_CODE_WORDS);
+    object->dataWords = (int) readObjectField(bytes, OBJECT_FIELD_DATA_WORDS);
+    numOfWords = object->codeWords + object->dataWords;
+    object->words = (unsigned int *) allocateMemory(MEMORY_OBJECTS, (numOfWords + 1) * sizeof(unsigned int));
+    object->entries = readSymbolTable(bytes, OBJECT_FIELD_ENTRY_COUNT, OBJECT_FIELD_ENTRY_OFFSET, &object->numOfEntries);
+    object->externs = readSymbolTable(bytes, OBJECT_FIELD_EXTERN_COUNT, OBJECT_FIELD_EXTERN_OFFSET, &object->numOfExterns);
+    object->numOfRelocations = (int) readObjectField(bytes, OBJECT_FIELD_RELOCATION_COUNT);
+    object->relocationsSize = (long) readObjectField(bytes, OBJECT_FIELD_RELOCATION_SIZE);
+    object->relocations = (unsigned char *) allocateMemory(MEMORY_OBJECTS, (size_t) object->relocationsSize + 1);
+
+    if (object->relocations != NULL)
+        memcpy(object->relocations, bytes + readObjectField(bytes, OBJECT_FIELD_RELOCATION_OFFSET),
+               (size_t) object->relocationsSize);
+    if (object->words != NULL)
+        for (i = 0; i < numOfWords; ++i)
+            object->words[i] = getObjectWord(bytes, i);
+
+    if (object->words == NULL || object->entries == NULL || object->externs == NULL || object->relocations == NULL) {
+        freeObjectFile(object);
+        return false;
+    }
+    return true;
+}
+
+int readBinaryObjectFile(const char *path, ObjectFile *object) {
+    MappedObjectFile mapped;
+    int loaded;
+
+    if (!mapObjectFile(path, &mapped))
+        return false;
+
+    loaded = loadObjectFile(mapped.bytes, mapped.size, object);
+    unmapObjectFile(&mapped);
+    return loaded;
+}
+
+/* Write a table of entry points/extern uses as "name address" lines, the file is produced only if not empty */
+static int writeSymbolLines(const char *baseName, const char *ending, const ObjectSymbol *symbols, int numOfSymbols) {
+    char fileName[FILENAME_MAX];
+    FILE *file;
+    int i = 0;
+
+    if (numOfSymbols == 0)
+        return true;
+
+    strcat(strcpy(fileName, baseName), ending);
+    file = fopen(fileName, "w");
+    if (file == NULL)
+        return false;
+
+    for (; i < numOfSymbols; ++i)
+        fprintf(file, "%s %d\n", symbols[i].name, symbols[i].value);
+    fclose(file);
+    return true;
+}
+
+int writeTextObjectFiles(const ObjectFile *object, const char *baseName) {
+    char fileName[FILENAME_MAX];
+    FILE *file;
+    int i = 0;
+
+    strcat(strcpy(fileName, baseName), ".ob");
+    file = fopen(fileName, "w");
+    if (file == NULL)
+        return false;
+
+    for (; i < object->codeWords + object->dataWords; ++i) {
+        char base64Number[ISA_BASE64_DIGITS + 1];
+        fprintf(file, "%s\n", convertToBase64(object->words[i], base64Number));
+    }
+    fclose(file);
+
+    return writeSymbolLines(baseName, ".ent", object->entries, object->numOfEntries) &&
+           writeSymbolLines(baseName, ".ext", object->externs, object->numOfExterns);
+}
+
+/* Read a table of "name address" lines, a missing file is an empty table */
+static ObjectSymbol *readSymbolLines(const char *baseName, const char *ending, int *numOfSymbols) {
+    char fileName[FILENAME_MAX];
+    ObjectSymbol symbol;
+    ObjectSymbol *symbols;
+    int capacity = 16;
+    FILE *file;
+
+    *numOfSymbols = 0;
+    symbols = (ObjectSymbol *) allocateMemory(MEMORY_OBJECTS, capacity * sizeof(ObjectSymbol));
+    if (symbols == NULL)
+        return NULL;
+
+    strcat(strcpy(fileName, baseName), ending);
+    file = fopen(fileName, "r");
+    if (file == NULL)
+        return symbols;
+
+    while (fscanf(file, "%31s %d", symbol.name, &symbol.value) == 2) {
+        if (*numOfSymbols == capacity) {
+            ObjectSymbol *newSymbols = (ObjectSymbol *) reallocateMemory(MEMORY_OBJECTS, symbols,
+                                                                         capacity * 2 * sizeof(ObjectSymbol));
+            if (newSymbols == NULL) {
+                freeMemory(symbols);
+                fclose(file);
+                return NULL;
+            }
+            symbols = newSymbols;
+            capacity *= 2;
+        }
+        symbols[(*numOfSymbols)++] = symbol;
+    }
+    fclose(file);
+    return symbols;
+}
+
+int readTextObjectFiles(const char *baseName, ObjectFile *object) {
+    char fileName[FILENAME_MAX];
+    MappedObjectFile mapped = {NULL, 0};
+    FILE *file;
+
+    strcat(strcpy(fileName, baseName), ".ob");
+    if (!mapFile(fileName, &mapped)) {
+        /* An empty file can't be mapped, but it's still a valid file without words */
+        file = fopen(fileName, "r");
+        if (file == NULL)
+            return false;
+        fclose(file);
+    }
+
+    object->codeWords = 0;
+    object->dataWords = 0;
+    object->numOfRelocations = 0;
+    object->relocationsSize = 0;
+    object->relocations = NULL;
+    object->words = (unsigned int *) allocateMemory(MEMORY_OBJECTS, ((size_t) mapped.size / 2 + 1) * sizeof(unsigned int));
+    object->entries = readSymbolLines(baseName, ".ent", &object->numOfEntries);
+    object->externs = readSymbolLines(baseName, ".ext", &object->numOfExterns);
+
+    /* The whole file is decoded at once, each line holds one word as base 64 characters (two of a 12-bit word) */
+    if (object->words != NULL) {
+        int numOfWords = decodeBase64Words((const char *) mapped.bytes, mapped.size, object->words);
+
+        /* The ".ob" file has no header, the instruction words are the longest run of valid instructions from the
+          start of the image and the words after them are data words */
+        object->codeWords = findCodeWords(object->words, numOfWords);
+        object->dataWords = numOfWords - object->codeWords;
+    }
+    unmapObjectFile(&mapped);
+
+    if (object->words == NULL || object->entries == NULL || object->externs == NULL) {
+        freeObjectFile(object);
+        return false;
+    }
+    return true;
+}
+
+void freeObjectFile(ObjectFile *object) {
+    freeMemory(object->words);
+    freeMemory(object->entries);
+    freeMemory(object->externs);
+    freeMemory(object->relocations);
+    object->words = NULL;
+    object->entries = NULL;
+    object->externs = NULL;
+    object->relocations = NULL;
+    object->codeWords = object->dataWords = 0;
+    object->numOfEntries = object->numOfExterns = object->numOfRelocations = 0;
+    object->relocationsSize = 0;
+}
@@ -0,0 +1,243 @@
+#ifndef OBJECTFILE_H
+#define OBJECTFILE_H
+
+/**
+ * @file objectfile.h
+ * @brief Definitions and functions related to the binary object file format.
+ *
+ * A binary object file holds the same machine code as the ".ob" text file, together with the entry and extern
+ * tables of the ".ent" and ".ext" files. All the fields are 32-bit little endian numbers, and every table is
+ * aligned to 4 bytes, so the file can be memory-mapped and used as it is:
+ *
+ *   header       OBJECT_HEADER_SIZE bytes (see the OBJECT_* field offsets below)
+ *   words        codeWords + dataWords 12-bit words, packed two words in 3 bytes (like the in-memory code image),
+ *                wider words take whole bytes each, the least significant byte first
+ *   entries      entryCount records of {name offset, address}
+ *   externs      externCount records of {name offset, address of use}
+ *   relocations  relocationCount delta encoded relocation entries, relocationSize bytes (see relocation.h)
+ *   strings      null terminated symbol names, the name offsets are relative to the start of this table
+ */
+
+/**
+ * The magic number at the start of a binary object file.
+ */
+#define OBJECT_MAGIC "AOBJ"
+
+/**
+ * The version of the binary object file format.
+ */
+#define OBJECT_VERSION 2
+
+/**
+ * Size of the header of a binary object file.
+ */
+#define OBJECT_HEADER_SIZE 64
+
+/**
+ * Byte offsets of the header fields.
+ */
+#define OBJECT_FIELD_VERSION 4
+#define OBJECT_FIELD_CODE_WORDS 8
+#define OBJECT_FIELD_DATA_WORDS 12
+#define OBJECT_FIELD_WORDS_OFFSET 16
+#define OBJECT_FIELD_ENTRY_COUNT 20
+#define OBJECT_FIELD_ENTRY_OFFSET 24
+#define OBJECT_FIELD_EXTERN_COUNT 28
+#define OBJECT_FIELD_EXTERN_OFFSET 32
+#define OBJECT_FIELD_STRINGS_OFFSET 36
+#define OBJECT_FIELD_STRINGS_SIZE 40
+#define OBJECT_FIELD_FILE_SIZE 44
+#define OBJECT_FIELD_RELOCATION_COUNT 48
+#define OBJECT_FIELD_RELOCATION_OFFSET 52
+#define OBJECT_FIELD_RELOCATION_SIZE 56
+#define OBJECT_FIELD_WORD_BITS 60
+
+/**
+ * The width of the words of a file whose OBJECT_FIELD_WORD_BITS field is 0 (written before the field existed).
+ * A file is only read by an assembler built for the same width (see isa.h).
+ */
+#define OBJECT_DEFAULT_WORD_BITS 12
+
+/**
+ * @struct ObjectSymbol
+ * @brief Structure to represent a symbol of an object file - an entry point or a use of an extern symbol.
+ */
+typedef struct ObjectSymbol {
+    char name[MAX_LABEL_LENGTH + 1];   /* The name of the symbol. */
+    int value;                         /* The address of the entry point/the address of the extern use. */
+} ObjectSymbol;
+
+/**
+ * @struct ObjectFile
+ * @brief Structure to represent an object file loaded into the memory.
+ */
+typedef struct ObjectFile {
+    int codeWords;            /* The number of instruction words. */
+    int dataWords;            /* The number of data words, which follow the instruction words. */
+    unsigned int *words;      /* The machine code words. */
+    int numOfEntries;         /* The number of entry points. */
+    ObjectSymbol *entries;    /* The entry points. */
+    int numOfExterns;         /* The number of extern uses. */
+    ObjectSymbol *externs;    /* The extern uses. */
+    int numOfRelocations;     /* The number of relocation entries, 0 when unknown (converted from text). */
+    long relocationsSize;     /* The number of bytes of the encoded relocation entries. */
+    unsigned char *relocations; /* The delta encoded relocation entries (see relocation.h). */
+} ObjectFile;
+
+/**
+ * @struct MappedObjectFile
+ * @brief Structure to represent a binary object file which is memory-mapped.
+ */
+typedef struct MappedObjectFile {
+    const unsigned char *bytes;   /* The content of the file. */
+    long size;                    /* The size of the file in bytes. */
+} MappedObjectFile;
+
+/**
+ * @brief Reads a 32-bit little endian field of a binary object file.
+ *
+ * @param bytes The content of the file.
+ * @param offset The byte offset of the field.
+ * @return The value of the field.
+ */
+unsigned long readObjectField(const unsigned char *bytes, long offset);
+
+/**
+ * @brief Writes a 32-bit little endian field of a binary object file.
+ *
+ * @param bytes The content of the file.
+ * @param offset The byte offset of the field.
+ * @param value The value of the field.
+ */
+void writeObjectField(unsigned char *bytes, long offset, unsigned long value);
+
+/**
+ * @brief Gets a word of a binary object file straight from it's packed word array.
+ *
+ * @param bytes The content of the file.
+ * @param index The index of the word (instruction words first, then data words).
+ * @return The 12-bit machine code word.
+ */
+unsigned int getObjectWord(const unsigned char *bytes, int index);
+
+/**
+ * @brief Gets the name of an entry point/extern use record of a binary object file.
+ *
+ * @param bytes The content of the file.
+ * @param tableOffset The offset of the table (OBJECT_FIELD_ENTRY_OFFSET/OBJECT_FIELD_EXTERN_OFFSET field value).
+ * @param index The index of the record in the table.
+ * @return The null terminated name of the symbol (in the strings table of a file isValidObjectFile accepts).
+ */
+const char *getObjectSymbolName(const unsigned char *bytes, unsigned long tableOffset, int index);
+
+/**
+ * @brief Gets the address of an entry point/extern use record of a binary object file.
+ *
+ * @param bytes The content of the file.
+ * @param tableOffset The offset of the table (OBJECT_FIELD_ENTRY_OFFSET/OBJECT_FIELD_EXTERN_OFFSET field value).
+ * @param index The index of the record in the table.
+ * @return The address of the record.
+ */
+int getObjectSymbolValue(const unsigned char *bytes, unsigned long tableOffset, int index);
+
+/**
+ * @brief Checks that a buffer holds a valid binary object file.
+ *
+ * @param bytes The content of the file.
+ * @param size The size of the content in bytes.
+ * @return True if the header and the tables fit in the buffer and every name is a null terminated string of the
+ * strings table, false otherwise.
+ */
+int isValidObjectFile(const unsigned char *bytes, long size);
+
+/**
+ * @brief Memory-maps a file for reading, without checking it's content.
+ *
+ * @param path The path of the file.
+ * @param mapped Pointer to store the mapping.
+ * @return True if the file has been mapped, false otherwise.
+ */
+int mapFile(const char *path, MappedObjectFile *mapped);
+
+/**
+ * @brief Memory-maps a binary object file.
+ *
+ * @param path The path of the file.
+ * @param mapped Pointer to store the mapping.
+ * @return True if the file has been mapped and is a valid binary object file, false otherwise.
+ */
+int mapObjectFile(const char *path, MappedObjectFile *mapped);
+
+/**
+ * @brief Releases a memory-mapped binary object file.
+ *
+ * @param mapped The mapping to release.
+ */
+void unmapObjectFile(MappedObjectFile *mapped);
+
+/**
+ * @brief Encodes an object file in the binary object file format.
+ *
+ * @param object The object file to encode.
+ * @param size Pointer to store the size of the encoded file in bytes.
+ * @return The allocated content of the file (to be freed by the caller), or NULL if memory allocation has been failed.
+ */
+unsigned char *encodeBinaryObjectFile(const ObjectFile *object, long *size);
+
+/**
+ * @brief Writes an object file in the binary object file format.
+ *
+ * @param object The object file to write.
+ * @param file The output file, opened in binary mode.
+ * @return True if the file has been written, false otherwise.
+ */
+int writeBinaryObjectFile(const ObjectFile *object, FILE *file);
+
+/**
+ * @brief Loads a binary object file which is already in the memory (e.g. a member of an archive).
+ *
+ * @param bytes The content of the file.
+ * @param size The size of the content in bytes.
+ * @param object Pointer to the object file structure to fill.
+ * @return True if the content is a valid binary object file and has been loaded, false otherwise.
+ */
+int loadObjectFile(const unsigned char *bytes, long size, ObjectFile *object);
+
+/**
+ * @brief Loads a binary object file into an object file structure.
+ *
+ * @param path The path of the file.
+ * @param object Pointer to the object file structure to fill.
+ * @return True if the file has been loaded, false otherwise.
+ */
+int readBinaryObjectFile(const char *path, ObjectFile *object);
+
+/**
+ * @brief Writes the text outputs of an object file: the ".ob" words, and the ".ent"/".ext" tables when not empty.
+ *
+ * @param object The object file to write.
+ * @param baseName The name of the outputs without the ending.
+ * @return True if the files have been written, false otherwise.
+ */
+int writeTextObjectFiles(const ObjectFile *object, const char *baseName);
+
+/**
+ * @brief Loads the text outputs of the assembler: the ".ob" words, and the ".ent"/".ext" tables if they exist.
+ *
+ * The ".ob" file doesn't tell where the data words start, so the instruction words are the longest run of valid
+ * instructions from the start of the image (see findCodeWords), and there are no relocation entries.
+ *
+ * @param baseName The name of the outputs without the ending.
+ * @param object Pointer to the object file structure to fill.
+ * @return True if the files have been loaded, false otherwise.
+ */
+int readTextObjectFiles(const char *baseName, ObjectFile *object);
+
+/**
+ * @brief Frees the memory used by an object file structure.
+ *
+ * @param object The object file to be freed.
+ */
+void freeObjectFile(ObjectFile *object);
+
+#endif
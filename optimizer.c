@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "data.h"
+#include "optimizer.h"
+#include "cfg.h"
+
+/* Split the next word of a line, like strtok with it's position kept by the caller */
+static char *nextWord(char **position, const char *delimiters) {
+    char *word = *position + strspn(*position, delimiters);
+
+    if (*word == '\0') {
+        *position = word;
+        return NULL;
+    }
+    *position = word + strcspn(word, delimiters);
+    if (**position != '\0')
+        *(*position)++ = '\0';
+    return word;
+}
+
+/* Parse an operand, it's addressing method is left METHOD_NONE when it isn't a plain number, register or symbol */
+static void parseOperand(ProgramOperand *operand, const char *text) {
+    int i = 0;
+
+    operand->method = METHOD_NONE;
+    if (strlen(text) > MAX_LABEL_LENGTH)
+        return;
+    strcpy(operand->text, text);
+
+    if (text[0] == '@') {
+        /* Only the registers of the machine exactly (@r0-@r7 on the classic machine, see isa.h), any other register
+         * is reported by the passes */
+        if (text[1] == 'r' && isdigit((unsigned char) text[2])) {
+            int number = text[2] - '0';
+
+            i = 3;
+            if (ISA_NUM_OF_REGISTERS > 10 && number > 0 && isdigit((unsigned char) text[3]))
+                number = number * 10 + (text[i++] - '0');
+            if (text[i] == '\0' && number < ISA_NUM_OF_REGISTERS)
+                operand->method = METHOD_DIRECT_REGISTER;
+        }
+    } else if (isCharacter(text[0])) {
+        for (i = 1; isalnum((unsigned char) text[i]); ++i);
+        if (text[i] == '\0')
+            operand->method = METHOD_DIRECT;
+    } else {
+        if (text[0] == '-' || text[0] == '+')
+            i = 1;
+        if (isdigit((unsigned char) text[i])) {
+            for (; isdigit((unsigned char) text[i]); ++i);
+            if (text[i] == '\0')
+                operand->method = METHOD_IMMEDIATE;
+        }
+    }
+}
+
+/* Parse an instruction, the line is left PROGRAM_LINE_OTHER when the passes would report an error for it */
+static void parseInstruction(ProgramLine *programLine, const char *mnemonic, char *position) {
+    int numOfOperands = getInstructionNumOfOperands(mnemonic);
+    ProgramOperand operands[2];
+    char *word;
+    int count = 0;
+
+    if (numOfOperands < 0)
+        return;
+    while ((word = nextWord(&position, " ,\t\r\n")) != NULL) {
+        if (count == numOfOperands)
+            return;
+        parseOperand(&operands[count], word);
+        if (operands[count++].method == METHOD_NONE)
+            return;
+    }
+    if (count != numOfOperands)
+        return;
+
+    /* The operands are validated exactly like processInstruction does */
+    programLine->source.method = METHOD_NONE;
+    programLine->destination.method = METHOD_NONE;
+    if (numOfOperands == 2) {
+        if (!isValidAddressingMethod(mnemonic, operands[1].method, operands[0].method))
+            return;
+        programLine->source = operands[0];
+        programLine->destination = operands[1];
+    } else if (numOfOperands == 1) {
+        if (!isValidAddressingMethod(mnemonic, -1, operands[0].method))
+            return;
+        programLine->destination = operands[0];
+    } else if (!isValidAddressingMethod(mnemonic, -1, -1))
+        return;
+
+    programLine->opCode = getInstructionCode(mnemonic);
+    programLine->kind = PROGRAM_LINE_INSTRUCTION;
+}
+
+/* Parse a line of the source into a program line */
+static void parseLine(ProgramLine *programLine, char *line) {
+    char *position = line;
+    char *word;
+
+    programLine->kind = PROGRAM_LINE_OTHER;
+    programLine->label[0] = '\0';
+
+    /* Empty lines and comments */
+    word = nextWord(&position, " \t\r\n");
+    if (line[0] == ';' || word == NULL || word[0] == ';') {
+        programLine->kind = PROGRAM_LINE_EMPTY;
+        return;
+    }
+
+    /* Label declaration, like isLabelDeclaration */
+    if (isCharacter(word[0]) && word[strlen(word) - 1] == ':') {
+        if (strlen(word) - 1 > MAX_LABEL_LENGTH)
+            return;
+        memcpy(programLine->label, word, strlen(word) - 1); /* Without the ':', terminated below */
+        programLine->label[strlen(word) - 1] = '\0';
+        if ((word = nextWord(&position, " \t\r\n")) == NULL)
+            return;
+    }
+
+    if (strcmp(word, ".data") == 0 || strcmp(word, ".string") == 0)
+        programLine->kind = PROGRAM_LINE_DATA;
+    else if (strcmp(word, ".extern") == 0)
+        programLine->kind = PROGRAM_LINE_EXTERN;
+    else if (strcmp(word, ".entry") == 0) {
+        /* The entry point is kept as the destination, an entry of several symbols isn't optimized */
+        if ((word = nextWord(&position, " ,\t\r\n")) == NULL)
+            return;
+        parseOperand(&programLine->destination, word);
+        if (programLine->destination.method == METHOD_DIRECT && nextWord(&position, " ,\t\r\n") == NULL)
+            programLine->kind = PROGRAM_LINE_ENTRY;
+    } else
+        parseInstruction(programLine, word, position);
+}
+
+int parseProgram(Program *program, const char *text, long size) {
+    long position = 0;
+
+    program->text = text;
+    program->lines = NULL;
+    program->numOfLines = 0;
+    program->linesCapacity = 0;
+
+    while (position < size) {
+        char line[MAX_LINE_LENGTH];
+        ProgramLine *programLine;
+        long length = 0;
+
+        if (program->numOfLines == program->linesCapacity) {
+            int newCapacity = program->linesCapacity == 0 ? 256 : program->linesCapacity * 2;
+            ProgramLine *newLines = (ProgramLine *) reallocateMemory(MEMORY_OPTIMIZER, program->lines,
+                                                                     newCapacity * sizeof(ProgramLine));
+            if (newLines == NULL) {
+                freeProgram(program);
+                return false;
+            }
+            program->lines = newLines;
+            program->linesCapacity = newCapacity;
+        }
+
+        /* Split the lines exactly like readSourceLine does for the passes, a line which is too long is split */
+        while (length < MAX_LINE_LENGTH - 1 && position + length < size) {
+            line[length] = text[position + length];
+            if (line[length++] == '\n')
+                break;
+        }
+        line[length] = '\0';
+
+        programLine = &program->lines[program->numOfLines++];
+        memset(programLine, 0, sizeof(ProgramLine));
+        programLine->start = position;
+        programLine->length = length;
+        if (line[length - 1] == '\n' || position + length == size)
+            parseLine(programLine, line);
+        else
+            programLine->kind = PROGRAM_LINE_OTHER;
+        position += length;
+    }
+    return true;
+}
+
+int writeProgram(const Program *program, TextBuffer *optimized) {
+    int i = 0;
+
+    for (; i < program->numOfLines; ++i) {
+        const ProgramLine *programLine = &program->lines[i];
+        char line[MAX_LINE_LENGTH];
+        int hasNewLine = program->text[programLine->start + programLine->length - 1] == '\n';
+
+        /* A removed line is left empty, so the lines after it keep their numbers */
+        if (programLine->removed)
+            strcpy(line, hasNewLine ? "\n" : "");
+        else if (programLine->rewritten) /* Only an instruction of a single operand is rewritten */
+            sprintf(line, "%s%s%.4s %s%s", programLine->label, programLine->label[0] != '\0' ? ": " : "",
+                    instructionsTable[programLine->opCode].name, programLine->destination.text,
+                    hasNewLine ? "\n" : "");
+        else {
+            memcpy(line, program->text + programLine->start, (size_t) programLine->length);
+            line[programLine->length] = '\0';
+        }
+        if (!appendText(optimized, line))
+            return false;
+    }
+    return true;
+}
+
+int findProgramLabel(const Program *program, const char *name) {
+    int i = 0;
+
+    for (; i < program->numOfLines; ++i)
+        if (!program->lines[i].removed && strcmp(program->lines[i].label, name) == 0)
+            return i;
+    return -1;
+}
+
+/* Get the number of words of an instruction */
+static int getInstructionWords(const ProgramLine *programLine) {
+    /* Two registers share a single word */
+    if (programLine->source.method == METHOD_DIRECT_REGISTER &&
+        programLine->destination.method == METHOD_DIRECT_REGISTER)
+        return 2;
+    return 1 + (programLine->source.method != METHOD_NONE) + (programLine->destination.method != METHOD_NONE);
+}
+
+int getProgramWords(const Program *program) {
+    int words = 0;
+    int i = 0;
+
+    for (; i < program->numOfLines; ++i)
+        if (program->lines[i].kind == PROGRAM_LINE_INSTRUCTION && !program->lines[i].removed)
+            words += getInstructionWords(&program->lines[i]);
+    return words;
+}
+
+/* Get the index of the next instruction which is executed after a line (when it doesn't jump), or -1 if there's
+  none or a line the optimizer doesn't understand comes before it */
+static int getNextInstruction(const Program *program, int index) {
+    int i = index + 1;
+
+    for (; i < program->numOfLines; ++i) {
+        const ProgramLine *programLine = &program->lines[i];
+
+        if (programLine->removed || programLine->kind == PROGRAM_LINE_EMPTY ||
+            programLine->kind == PROGRAM_LINE_DATA || programLine->kind == PROGRAM_LINE_ENTRY ||
+            programLine->kind == PROGRAM_LINE_EXTERN)
+            continue;
+        return programLine->kind == PROGRAM_LINE_INSTRUCTION ? i : -1;
+    }
+    return -1;
+}
+
+/* Check if the result of a cmp is never read: the next instructions which are executed after it compare again or
+  stop before any bne, and don't jump anywhere the result might be read */
+static int isDeadCompare(const Program *program, int index) {
+    int i = getNextInstruction(program, index);
+
+    for (; i != -1; i = getNextInstruction(program, i)) {
+        int opCode = program->lines[i].opCode;
+
+        if (opCode == OPCODE_CMP || opCode == OPCODE_STOP)
+            return true;
+        if (opCode == OPCODE_BNE || opCode == OPCODE_JMP || opCode == OPCODE_JSR || opCode == OPCODE_RTS)
+            return false;
+    }
+    return false;
+}
+
+/* Check if an instruction has no effect */
+static int isRedundantInstruction(const Program *program, int index) {
+    const ProgramLine *programLine = &program->lines[index];
+    int next;
+
+    switch (programLine->opCode) {
+        case OPCODE_MOV: /* An operand which is moved into itself */
+            return strcmp(programLine->source.text, programLine->destination.text) == 0;
+        case OPCODE_CMP:
+            return isDeadCompare(program, index);
+        case OPCODE_JMP: /* A jump to the instruction which follows it anyway */
+            next = getNextInstruction(program, index);
+            return programLine->destination.method == METHOD_DIRECT && next != -1 &&
+                   strcmp(program->lines[next].label, programLine->destination.text) == 0;
+        default:
+            return false;
+    }
+}
+
+void optimizePeephole(Program *program) {
+    int isChanged = true;
+
+    /* Removing an instruction may make another one redundant, such as a jmp over it */
+    while (isChanged) {
+        int i = 0;
+
+        isChanged = false;
+        for (; i < program->numOfLines; ++i) {
+            ProgramLine *programLine = &program->lines[i];
+
+            if (programLine->kind == PROGRAM_LINE_INSTRUCTION && !programLine->removed &&
+                programLine->label[0] == '\0' && isRedundantInstruction(program, i)) {
+                programLine->removed = true;
+                isChanged = true;
+            }
+        }
+    }
+}
+
+/* Check if an instruction jumps to a label */
+static int isDirectJump(const ProgramLine *programLine) {
+    return programLine->kind == PROGRAM_LINE_INSTRUCTION && !programLine->removed &&
+           programLine->destination.method == METHOD_DIRECT && (programLine->opCode == OPCODE_JMP ||
+           programLine->opCode == OPCODE_BNE || programLine->opCode == OPCODE_JSR);
+}
+
+void threadJumps(Program *program) {
+    int i = 0;
+
+    for (; i < program->numOfLines; ++i) {
+        ProgramLine *programLine = &program->lines[i];
+        int hops = 0;
+        int target;
+
+        if (!isDirectJump(programLine))
+            continue;
+
+        /* Follow the chain, a cycle of jumps is cut once every line has been passed */
+        while (hops++ < program->numOfLines &&
+               (target = findProgramLabel(program, programLine->destination.text)) != -1 &&
+               target != i && isDirectJump(&program->lines[target]) &&
+               program->lines[target].opCode == OPCODE_JMP &&
+               strcmp(program->lines[target].destination.text, programLine->destination.text) != 0) {
+            strcpy(programLine->destination.text, program->lines[target].destination.text);
+            programLine->rewritten = true;
+        }
+    }
+}
+
+/* Check if a label is declared by a single line of the program */
+static int isLabelDeclaredOnce(const Program *program, const char *name) {
+    int count = 0;
+    int i = 0;
+
+    for (; i < program->numOfLines; ++i)
+        if (!program->lines[i].removed && strcmp(program->lines[i].label, name) == 0)
+            ++count;
+    return count == 1;
+}
+
+int eliminateDeadCode(Program *program) {
+    ControlFlowGraph graph;
+    int i = 0;
+
+    /* Anything may be reached through a line which isn't understood, and removing a label which is declared twice
+      would hide the error of the passes */
+    for (; i < program->numOfLines; ++i) {
+        const ProgramLine *programLine = &program->lines[i];
+
+        if (programLine->removed)
+            continue;
+        if (programLine->kind == PROGRAM_LINE_OTHER ||
+            (programLine->label[0] != '\0' && !isLabelDeclaredOnce(program, programLine->label)))
+            return true;
+    }
+
+    if (!buildControlFlowGraph(program, &graph))
+        return false;
+    if (!markReachableBlocks(program, &graph)) {
+        freeControlFlowGraph(&graph);
+        return false;
+    }
+
+    for (i = 0; i < graph.numOfBlocks; ++i) {
+        int line = graph.blocks[i].first;
+
+        if (graph.blocks[i].isReachable)
+            continue;
+        for (; line <= graph.blocks[i].last; ++line)
+            if (program->lines[line].kind == PROGRAM_LINE_INSTRUCTION)
+                program->lines[line].removed = true;
+    }
+
+    freeControlFlowGraph(&graph);
+    return true;
+}
+
+void freeProgram(Program *program) {
+    freeMemory(program->lines);
+    program->lines = NULL;
+    program->numOfLines = 0;
+    program->linesCapacity = 0;
+}
+
+int optimizeSource(const char *text, long size, int optimizations, TextBuffer *optimized) {
+    Program program;
+    int originalWords;
+    int wordsSaved;
+
+    if (!parseProgram(&program, text, size))
+        return -1;
+    originalWords = getProgramWords(&program);
+
+    /* Threading the jumps may leave the jumps it passes by unreachable, and removing the dead code may leave a
+      jump to the instruction which follows it */
+    if (optimizations & OPTIMIZE_DEAD_CODE) {
+        threadJumps(&program);
+        if (!eliminateDeadCode(&program)) {
+            freeProgram(&program);
+            return -1;
+        }
+    }
+    if (optimizations & OPTIMIZE_PEEPHOLE)
+        optimizePeephole(&program);
+
+    wordsSaved = originalWords - getProgramWords(&program);
+    if (!writeProgram(&program, optimized))
+        wordsSaved = -1;
+    freeProgram(&program);
+    return wordsSaved;
+}
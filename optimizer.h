@@ -0,0 +1,165 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+/**
+ * @file optimizer.h
+ * @brief Definitions and functions related to the optimizer (the -O option).
+ *
+ * The optimizer runs on the source after macro spanning, before the first pass. Every line is parsed into a
+ * program line (a label, an instruction and it's operands, a directive), the optimizations remove or rewrite
+ * instructions, and the program is written back as a source which the passes lay out again, so the labels, the
+ * entry points and the uses of the extern symbols get their new addresses. A removed line is written as an empty
+ * line, so the errors of the passes refer to the lines of the original source. A line the optimizer doesn't fully
+ * understand (an erroneous line, a line which is too long) is written as it is, and nothing is moved across it.
+ */
+
+/**
+ * The optimizations, which can be combined.
+ */
+#define OPTIMIZE_PEEPHOLE 1     /* Remove instructions which have no effect. */
+#define OPTIMIZE_DEAD_CODE 2    /* Thread jumps and remove the instructions which are never executed. */
+#define OPTIMIZE_POOL_LITERALS 4    /* Share the equal data payloads, applied by the passes (see literals.h). */
+
+/**
+ * The optimizations which are applied to the source by the optimizer.
+ */
+#define OPTIMIZE_SOURCE (OPTIMIZE_PEEPHOLE | OPTIMIZE_DEAD_CODE)
+
+/**
+ * Kinds of program lines.
+ */
+#define PROGRAM_LINE_OTHER 0            /* A line which isn't optimized, written as it is. */
+#define PROGRAM_LINE_EMPTY 1            /* An empty line or a comment. */
+#define PROGRAM_LINE_INSTRUCTION 2      /* An instruction. */
+#define PROGRAM_LINE_DATA 3             /* A .data or .string directive. */
+#define PROGRAM_LINE_ENTRY 4            /* An .entry directive of a single symbol, the destination operand. */
+#define PROGRAM_LINE_EXTERN 5           /* An .extern directive. */
+
+/**
+ * Opcodes of the instructions the optimizer reasons about.
+ */
+#define OPCODE_MOV 0
+#define OPCODE_CMP 1
+#define OPCODE_JMP 9
+#define OPCODE_BNE 10
+#define OPCODE_JSR 13
+#define OPCODE_RTS 14
+#define OPCODE_STOP 15
+
+/**
+ * @struct ProgramOperand
+ * @brief Structure to represent an operand of an instruction.
+ */
+typedef struct ProgramOperand {
+    int method;                         /* The addressing method, METHOD_NONE when there's no operand. */
+    char text[MAX_LABEL_LENGTH + 1];    /* The operand as it's written. */
+} ProgramOperand;
+
+/**
+ * @struct ProgramLine
+ * @brief Structure to represent a line of the source, as it's read by the passes.
+ */
+typedef struct ProgramLine {
+    long start;                         /* The offset of the line in the source. */
+    long length;                        /* The number of characters of the line, with it's new line. */
+    int kind;                           /* The kind of the line (PROGRAM_LINE_*). */
+    char label[MAX_LABEL_LENGTH + 1];   /* The label declared by the line, empty if there's none. */
+    int opCode;                         /* The opcode of an instruction. */
+    ProgramOperand source;              /* The source operand of an instruction. */
+    ProgramOperand destination;         /* The destination operand (the only operand of a one operand instruction). */
+    int removed;                        /* True once the line has been removed. */
+    int rewritten;                      /* True once the destination of the instruction has been rewritten. */
+} ProgramLine;
+
+/**
+ * @struct Program
+ * @brief Structure to represent a source which is optimized.
+ */
+typedef struct Program {
+    const char *text;       /* The source. */
+    ProgramLine *lines;     /* The lines, in the order of the source. */
+    int numOfLines;         /* The number of lines. */
+    int linesCapacity;      /* The number of lines allocated. */
+} Program;
+
+/**
+ * @brief Parses a source into a program.
+ *
+ * @param program The program to parse into.
+ * @param text The source.
+ * @param size The number of characters of the source.
+ * @return True if the source has been parsed, false if memory allocation has been failed.
+ */
+int parseProgram(Program *program, const char *text, long size);
+
+/**
+ * @brief Writes a program back as a source.
+ *
+ * @param program The program.
+ * @param optimized The text to write the source into.
+ * @return True if the source has been written, false if memory allocation has been failed.
+ */
+int writeProgram(const Program *program, TextBuffer *optimized);
+
+/**
+ * @brief Finds the line which declares a label.
+ *
+ * @param program The program.
+ * @param name The name of the label.
+ * @return The index of the line, or -1 if no line which hasn't been removed declares the label.
+ */
+int findProgramLabel(const Program *program, const char *name);
+
+/**
+ * @brief Gets the number of instruction words of a program.
+ *
+ * @param program The program.
+ * @return The number of words of the instructions which haven't been removed.
+ */
+int getProgramWords(const Program *program);
+
+/**
+ * @brief Removes instructions which have no effect: a mov of an operand into itself, a cmp whose result is never
+ * read by a bne, and a jmp to the instruction which follows it. Instructions which declare a label are kept.
+ *
+ * @param program The program.
+ */
+void optimizePeephole(Program *program);
+
+/**
+ * @brief Threads the jumps: a jmp, bne or jsr to a label whose instruction is a jmp jumps to the target of that jmp
+ * instead, along the whole chain of jumps.
+ *
+ * @param program The program.
+ */
+void threadJumps(Program *program);
+
+/**
+ * @brief Removes the instructions of the basic blocks which aren't reachable from an entry of the program (see
+ * cfg.h), including the code after a stop, rts or jmp which no label reaches. Nothing is removed from a program
+ * which has a line the optimizer doesn't understand or a label which is declared twice.
+ *
+ * @param program The program.
+ * @return True if the program has been optimized, false if memory allocation has been failed.
+ */
+int eliminateDeadCode(Program *program);
+
+/**
+ * @brief Frees the lines of a program.
+ *
+ * @param program The program.
+ */
+void freeProgram(Program *program);
+
+/**
+ * @brief Optimizes a source.
+ *
+ * @param text The source.
+ * @param size The number of characters of the source.
+ * @param optimizations The optimizations to apply (OPTIMIZE_*).
+ * @param optimized The text to write the optimized source into.
+ * @return The number of words which have been saved, or -1 if memory allocation has been failed.
+ */
+int optimizeSource(const char *text, long size, int optimizations, TextBuffer *optimized);
+
+#endif
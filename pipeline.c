@@ -0,0 +1,72 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <pthread.h>
+#include "data.h"
+#include "pipeline.h"
+
+int initPipelineQueue(PipelineQueue *queue) {
+    queue->head = 0;
+    queue->count = 0;
+    queue->closed = false;
+    if (pthread_mutex_init(&queue->mutex, NULL) != 0)
+        return false;
+    if (pthread_cond_init(&queue->notEmpty, NULL) != 0) {
+        pthread_mutex_destroy(&queue->mutex);
+        return false;
+    }
+    if (pthread_cond_init(&queue->notFull, NULL) != 0) {
+        pthread_cond_destroy(&queue->notEmpty);
+        pthread_mutex_destroy(&queue->mutex);
+        return false;
+    }
+    return true;
+}
+
+void pushPipelineQueue(PipelineQueue *queue, void *item) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == PIPELINE_QUEUE_SIZE)
+        pthread_cond_wait(&queue->notFull, &queue->mutex);
+    queue->items[(queue->head + queue->count) % PIPELINE_QUEUE_SIZE] = item;
+    queue->count++;
+    pthread_cond_signal(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void *popPipelineQueue(PipelineQueue *queue) {
+    void *item = NULL;
+
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == 0 && !queue->closed)
+        pthread_cond_wait(&queue->notEmpty, &queue->mutex);
+
+    /* The queue is empty only when it has been closed */
+    if (queue->count > 0) {
+        item = queue->items[queue->head];
+        queue->head = (queue->head + 1) % PIPELINE_QUEUE_SIZE;
+        queue->count--;
+        pthread_cond_signal(&queue->notFull);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return item;
+}
+
+void closePipelineQueue(PipelineQueue *queue) {
+    pthread_mutex_lock(&queue->mutex);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void reopenPipelineQueue(PipelineQueue *queue) {
+    pthread_mutex_lock(&queue->mutex);
+    queue->head = 0;
+    queue->count = 0;
+    queue->closed = false;
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void destroyPipelineQueue(PipelineQueue *queue) {
+    pthread_cond_destroy(&queue->notFull);
+    pthread_cond_destroy(&queue->notEmpty);
+    pthread_mutex_destroy(&queue->mutex);
+}
@@ -0,0 +1,80 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+/**
+ * @file pipeline.h
+ * @brief A bounded queue which joins the stages of the assembler (read -> assemble -> write).
+ *
+ * Every stage runs on a thread of it's own and hands the sources it's done with to the next stage through a
+ * queue. A stage which pushes into a full queue waits for the next stage, and a stage which pops from an empty
+ * queue waits for the previous stage, so no stage runs more than the size of a queue ahead of the next one. The
+ * items leave a queue in the order they have been pushed in.
+ */
+
+#include <pthread.h>
+
+/**
+ * The largest number of items a queue holds at once.
+ */
+#define PIPELINE_QUEUE_SIZE 256
+
+/**
+ * @struct PipelineQueue
+ * @brief Structure to represent a bounded queue between two stages.
+ */
+typedef struct PipelineQueue {
+    void *items[PIPELINE_QUEUE_SIZE];   /* The items, a ring starting at the head. */
+    int head;                           /* The index of the first item. */
+    int count;                          /* The number of items in the queue. */
+    int closed;                         /* True once no more items will be pushed. */
+    pthread_mutex_t mutex;              /* Guards the items. */
+    pthread_cond_t notEmpty;            /* Signaled when an item has been pushed or the queue has been closed. */
+    pthread_cond_t notFull;             /* Signaled when an item has been popped. */
+} PipelineQueue;
+
+/**
+ * @brief Initializes an empty queue.
+ *
+ * @param queue The queue to initialize.
+ * @return True if the queue has been initialized, false otherwise.
+ */
+int initPipelineQueue(PipelineQueue *queue);
+
+/**
+ * @brief Pushes an item at the end of a queue, waits while the queue is full.
+ *
+ * @param queue The queue.
+ * @param item The item.
+ */
+void pushPipelineQueue(PipelineQueue *queue, void *item);
+
+/**
+ * @brief Pops the first item of a queue, waits while the queue is empty.
+ *
+ * @param queue The queue.
+ * @return The item, or NULL if the queue has been closed and all of it's items have been popped.
+ */
+void *popPipelineQueue(PipelineQueue *queue);
+
+/**
+ * @brief Marks that no more items will be pushed into a queue.
+ *
+ * @param queue The queue.
+ */
+void closePipelineQueue(PipelineQueue *queue);
+
+/**
+ * @brief Empties a queue and opens it again, so it can join the stages of another run.
+ *
+ * @param queue The queue, which isn't used by any stage.
+ */
+void reopenPipelineQueue(PipelineQueue *queue);
+
+/**
+ * @brief Releases a queue which isn't used by any stage anymore.
+ *
+ * @param queue The queue.
+ */
+void destroyPipelineQueue(PipelineQueue *queue);
+
+#endif
@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include "data.h"
+#include "relocation.h"
+
+int addRelocation(RelocationTable *table, int address, int type) {
+    unsigned long value;
+
+    if (address < table->lastAddress)
+        return false;
+
+    /* Room for the longest encoding of an entry */
+    if (table->size + 8 > table->capacity) {
+        long newCapacity = table->capacity == 0 ? 64 : table->capacity * 2;
+        unsigned char *newBytes = (unsigned char *) reallocateMemory(MEMORY_ENCODING, table->bytes, newCapacity);
+        if (newBytes == NULL)
+            return false;
+        table->bytes = newBytes;
+        table->capacity = newCapacity;
+    }
+
+    /* Difference from the previous address, tagged with the type, 7 bits per byte */
+    value = ((unsigned long) (address - table->lastAddress) << 2) | (type & 0x3);
+    while (value >= 0x80) {
+        table->bytes[table->size++] = (unsigned char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    table->bytes[table->size++] = (unsigned char) value;
+
+    table->lastAddress = address;
+    table->count++;
+    return true;
+}
+
+void freeRelocationTable(RelocationTable *table) {
+    freeMemory(table->bytes);
+    table->bytes = NULL;
+    table->size = 0;
+    table->capacity = 0;
+    table->count = 0;
+    table->lastAddress = INITIAL_ADDRESS_VALUE;
+}
+
+void initRelocationReader(RelocationReader *reader, const unsigned char *bytes, long size) {
+    reader->bytes = bytes;
+    reader->size = size;
+    reader->position = 0;
+    reader->address = INITIAL_ADDRESS_VALUE;
+}
+
+int nextRelocation(RelocationReader *reader, int *address, int *type) {
+    unsigned long value = 0;
+    int shift = 0;
+
+    if (reader->position >= reader->size)
+        return false;
+
+    /* Decode 7 bits per byte, until a byte without the high bit */
+    while (reader->position < reader->size) {
+        unsigned char byte = reader->bytes[reader->position++];
+        value |= (unsigned long) (byte & 0x7F) << shift;
+        shift += 7;
+        if (!(byte & 0x80))
+            break;
+    }
+
+    reader->address += (int) (value >> 2);
+    *address = reader->address;
+    *type = (int) (value & 0x3);
+    return true;
+}
+
+int rebaseWords(unsigned int *words, int numOfWords, int codeWords, const unsigned char *bytes, long size,
+                int codeDelta, int dataDelta) {
+    RelocationReader reader;
+    int address, type;
+    int count = 0;
+
+    initRelocationReader(&reader, bytes, size);
+    while (nextRelocation(&reader, &address, &type)) {
+        int index = address - INITIAL_ADDRESS_VALUE;
+        int target;
+
+        /* Only relocatable words move, absolute and external words stay as they are */
+        if (type != RELOCATION_RELOCATABLE || index < 0 || index >= numOfWords)
+            continue;
+
+        /* Operand field is the bits above the ARE bits, the ARE bits stay in place */
+        target = (int) (words[index] >> 2);
+        target += target - INITIAL_ADDRESS_VALUE < codeWords ? codeDelta : dataDelta;
+        if (!isOperandAddress(target))
+            return -1;
+        words[index] = convertTo12BitBinary(target, RELOCATION_RELOCATABLE);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,109 @@
+#ifndef RELOCATION_H
+#define RELOCATION_H
+
+/**
+ * @file relocation.h
+ * @brief Definitions and functions related to the relocation table.
+ *
+ * The relocation table records the address of every word which holds an address, tagged with it's ARE bits,
+ * so a module can be moved to another load address without being assembled again.
+ * The entries are kept in ascending address order, and each entry is encoded as the difference from the
+ * previous address, shifted left by 2 bits and tagged with the type in the 2 least significant bits, in a
+ * variable length encoding of 7 bits per byte (the high bit notates that another byte follows).
+ */
+
+/**
+ * Type of an absolute word, which isn't changed by relocation.
+ */
+#define RELOCATION_ABSOLUTE 0
+
+/**
+ * Type of a word which uses an external symbol.
+ */
+#define RELOCATION_EXTERNAL 1
+
+/**
+ * Type of a word which holds a relocatable address.
+ */
+#define RELOCATION_RELOCATABLE 2
+
+/**
+ * @struct RelocationTable
+ * @brief Structure to represent a growable, delta encoded relocation table.
+ */
+typedef struct RelocationTable {
+    unsigned char *bytes;   /* The encoded entries. */
+    long size;              /* The number of bytes in use. */
+    long capacity;          /* The number of bytes allocated. */
+    int count;              /* The number of entries. */
+    int lastAddress;        /* The address of the last entry. */
+} RelocationTable;
+
+/**
+ * @struct RelocationReader
+ * @brief Structure to represent a sequential reader of an encoded relocation table.
+ */
+typedef struct RelocationReader {
+    const unsigned char *bytes;  /* The encoded entries. */
+    long size;                   /* The number of bytes of the encoded entries. */
+    long position;               /* The position of the next entry. */
+    int address;                 /* The address of the last entry read. */
+} RelocationReader;
+
+/**
+ * @brief Adds an entry to a relocation table.
+ *
+ * @param table The relocation table.
+ * @param address The address of the word, not lower than the address of the last entry.
+ * @param type The type of the word (RELOCATION_ABSOLUTE, RELOCATION_EXTERNAL or RELOCATION_RELOCATABLE).
+ * @return True if the entry has been added, false if memory allocation has been failed.
+ */
+int addRelocation(RelocationTable *table, int address, int type);
+
+/**
+ * @brief Frees the memory used by a relocation table and resets it to an empty table.
+ *
+ * @param table The relocation table to be freed.
+ */
+void freeRelocationTable(RelocationTable *table);
+
+/**
+ * @brief Initializes a reader of an encoded relocation table.
+ *
+ * @param reader The reader to initialize.
+ * @param bytes The encoded entries.
+ * @param size The number of bytes of the encoded entries.
+ */
+void initRelocationReader(RelocationReader *reader, const unsigned char *bytes, long size);
+
+/**
+ * @brief Reads the next entry of an encoded relocation table.
+ *
+ * @param reader The reader.
+ * @param address Pointer to store the address of the word.
+ * @param type Pointer to store the type of the word.
+ * @return True if an entry has been read, false at the end of the table.
+ */
+int nextRelocation(RelocationReader *reader, int *address, int *type);
+
+/**
+ * @brief Moves a module to new load addresses in one sweep over it's relocation table.
+ *
+ * Every relocatable word is given the new address of the word it points at: addresses of instruction words
+ * are moved by codeDelta, and addresses of data words (which follow the codeWords instruction words) by dataDelta.
+ * The addresses of the relocation table are relative to the module as it has been assembled, at INITIAL_ADDRESS_VALUE.
+ *
+ * @param words The words of the module (instruction words first, then data words).
+ * @param numOfWords The number of words of the module.
+ * @param codeWords The number of instruction words of the module.
+ * @param bytes The encoded relocation table of the module.
+ * @param size The number of bytes of the encoded relocation table.
+ * @param codeDelta The distance the instruction words are moved by.
+ * @param dataDelta The distance the data words are moved by.
+ * @return The number of words which have been relocated, or -1 if a word would be given an address out of the range
+ * of an operand (see isOperandAddress), the word is left as it was and the words after it aren't relocated.
+ */
+int rebaseWords(unsigned int *words, int numOfWords, int codeWords, const unsigned char *bytes, long size,
+                int codeDelta, int dataDelta);
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file simulator.c
+ * @details This program runs assembled programs on a simulation of the machine (see cpu.h), from address
+ * INITIAL_ADDRESS_VALUE until stop. A program is read from it's binary object file (".obj") if there's one,
+ * otherwise from it's ".ob" file. red/prn use the standard input/output, and a summary of the run is written
+ * to the standard error.
+ * @example Run ./simulator file1                         (on command line) to execute this program.
+ * @example Run ./simulator --budget 1000000 file1        to stop the program after at most 1000000 instructions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "data.h"
+#include "objectfile.h"
+#include "cpu.h"
+
+int main(int argc, char *argv[]) {
+    static Cpu cpu;
+    unsigned long budget = 0; /* No limit */
+    int status = EXIT_SUCCESS;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        char fileName[FILENAME_MAX];
+        ObjectFile object;
+        clock_t start;
+        double seconds;
+        int result;
+
+        if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budget = strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+
+        strcat(strcpy(fileName, argv[i]), ".obj");
+        if (!readBinaryObjectFile(fileName, &object) && !readTextObjectFiles(argv[i], &object)) {
+            fprintf(stderr, "Couldn't read %s.obj/%s.ob.\n", argv[i], argv[i]);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        if (!loadCpu(&cpu, object.words, object.codeWords + object.dataWords)) {
+            fprintf(stderr, "%s doesn't fit in the memory of %d words.\n", argv[i], CPU_MEMORY_SIZE);
+            freeObjectFile(&object);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        freeObjectFile(&object);
+
+        start = clock();
+        result = runCpu(&cpu, budget);
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        fflush(stdout);
+
+        if (result == CPU_STOPPED)
+            fprintf(stderr, "%s: stopped at %d", argv[i], getCpuAddress(&cpu));
+        else if (result == CPU_OUT_OF_BUDGET)
+            fprintf(stderr, "%s: the budget has run out at %d", argv[i], getCpuAddress(&cpu));
+        else if (result == CPU_INVALID_INSTRUCTION)
+            fprintf(stderr, "%s: invalid instruction at %d", argv[i], getCpuAddress(&cpu));
+        else
+            fprintf(stderr, "%s: return stack %s at %d", argv[i], result == CPU_STACK_OVERFLOW ? "overflow" : "underflow",
+                    getCpuAddress(&cpu));
+        fprintf(stderr, " after %lu instructions", cpu.executed);
+        if (seconds > 0)
+            fprintf(stderr, " (%.1f million instructions per second)", cpu.executed / seconds / 1e6);
+        fprintf(stderr, "\n");
+
+        if (result != CPU_STOPPED)
+            status = EXIT_FAILURE;
+        freeCpu(&cpu);
+    }
+
+    return status;
+}
@@ -0,0 +1,72 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "data.h"
+#include "stats.h"
+
+#ifdef ASSEMBLER_STATS
+
+AssemblerStats assemblerStats;
+
+/* The totals of all the files which have been assembled */
+static AssemblerStats totalStats;
+
+static const char *phaseNames[STATS_NUM_OF_PHASES] = {"macro scan", "macro spanning", "first pass", "second pass",
+                                                      "output"};
+
+double getStatsTime() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+void resetStats() {
+    memset(&assemblerStats, 0, sizeof(assemblerStats));
+}
+
+/* Write the phases and counters of statistics */
+static void writeStats(FILE *file, const AssemblerStats *stats) {
+    double total = 0;
+    int i = 0;
+
+    for (; i < STATS_NUM_OF_PHASES; ++i)
+        total += stats->phaseSeconds[i];
+    for (i = 0; i < STATS_NUM_OF_PHASES; ++i)
+        fprintf(file, "  %-16s %10.6f s %6.1f%%\n", phaseNames[i], stats->phaseSeconds[i],
+                total > 0 ? stats->phaseSeconds[i] * 100 / total : 0.0);
+    fprintf(file, "  %-16s %10.6f s", "total", total);
+    if (total > 0)
+        fprintf(file, " (%.0f lines/s)", stats->lines / total);
+    fprintf(file, "\n");
+
+    fprintf(file, "  lines %lu, words emitted %lu, macro expansions %lu\n", stats->lines, stats->wordsEmitted,
+            stats->macroExpansions);
+    fprintf(file, "  symbol lookups %lu, symbol comparisons %lu", stats->symbolLookups, stats->symbolComparisons);
+    if (stats->symbolLookups > 0)
+        fprintf(file, " (%.1f per lookup)", (double) stats->symbolComparisons / stats->symbolLookups);
+    fprintf(file, "\n");
+}
+
+void reportFileStats(FILE *file, const char *fileName) {
+    int i = 0;
+
+    for (; i < STATS_NUM_OF_PHASES; ++i)
+        totalStats.phaseSeconds[i] += assemblerStats.phaseSeconds[i];
+    totalStats.lines += assemblerStats.lines;
+    totalStats.wordsEmitted += assemblerStats.wordsEmitted;
+    totalStats.symbolLookups += assemblerStats.symbolLookups;
+    totalStats.symbolComparisons += assemblerStats.symbolComparisons;
+    totalStats.macroExpansions += assemblerStats.macroExpansions;
+
+    fprintf(file, "Statistics of %s:\n", fileName);
+    writeStats(file, &assemblerStats);
+}
+
+void reportTotalStats(FILE *file, int numOfFiles) {
+    fprintf(file, "Statistics of all the %d file(s):\n", numOfFiles);
+    writeStats(file, &totalStats);
+}
+
+#endif
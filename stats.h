@@ -0,0 +1,86 @@
+#ifndef STATS_H
+#define STATS_H
+
+/**
+ * @file stats.h
+ * @brief Definitions and functions related to the statistics of the assembler (the --stats option).
+ *
+ * The statistics are counters of the hot paths (lines, emitted words, symbol table walks and the symbols they
+ * compare, macro expansions) and the time of every phase, by a monotonic clock. They're only compiled in when
+ * ASSEMBLER_STATS is defined: otherwise every STATS_ macro expands to nothing, and the hot paths pay no cost.
+ */
+
+/**
+ * The phases of assembling a file.
+ */
+#define STATS_PHASE_MACRO_SCAN 0
+#define STATS_PHASE_MACRO_SPANNING 1
+#define STATS_PHASE_FIRST_PASS 2
+#define STATS_PHASE_SECOND_PASS 3
+#define STATS_PHASE_OUTPUT 4
+#define STATS_NUM_OF_PHASES 5
+
+#ifdef ASSEMBLER_STATS
+
+/**
+ * @struct AssemblerStats
+ * @brief Structure to represent the statistics of a file, or the totals of all the files.
+ */
+typedef struct AssemblerStats {
+    double phaseSeconds[STATS_NUM_OF_PHASES];   /* The time spent in every phase. */
+    double phaseStart[STATS_NUM_OF_PHASES];     /* The time the running phase has started at. */
+    unsigned long lines;                        /* The source lines read by the first pass. */
+    unsigned long wordsEmitted;                 /* The words written into the object file. */
+    unsigned long symbolLookups;                /* The walks of the symbol tables. */
+    unsigned long symbolComparisons;            /* The symbols visited by those walks. */
+    unsigned long macroExpansions;              /* The macro invocations which have been expanded. */
+} AssemblerStats;
+
+/**
+ * @brief The statistics of the file being assembled.
+ */
+extern AssemblerStats assemblerStats;
+
+/**
+ * @brief Gets the time of a monotonic clock.
+ *
+ * @return The time in seconds, from an arbitrary starting point.
+ */
+double getStatsTime();
+
+/**
+ * @brief Clears the statistics of the file being assembled.
+ */
+void resetStats();
+
+/**
+ * @brief Writes the statistics of the file which has been assembled, and adds them to the totals.
+ *
+ * @param file The file to write into.
+ * @param fileName The name of the source file.
+ */
+void reportFileStats(FILE *file, const char *fileName);
+
+/**
+ * @brief Writes the totals of all the files which have been assembled.
+ *
+ * @param file The file to write into.
+ * @param numOfFiles The number of source files.
+ */
+void reportTotalStats(FILE *file, int numOfFiles);
+
+#define STATS_ADD(counter, amount) (assemblerStats.counter += (amount))
+#define STATS_INCREMENT(counter) (++assemblerStats.counter)
+#define STATS_START(phase) (assemblerStats.phaseStart[phase] = getStatsTime())
+#define STATS_STOP(phase) (assemblerStats.phaseSeconds[phase] += getStatsTime() - assemblerStats.phaseStart[phase])
+
+#else
+
+#define STATS_ADD(counter, amount) ((void) 0)
+#define STATS_INCREMENT(counter) ((void) 0)
+#define STATS_START(phase) ((void) 0)
+#define STATS_STOP(phase) ((void) 0)
+
+#endif
+
+#endif
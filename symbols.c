@@ -1,250 +1,354 @@
-#include <stdio.h>
-#include <string.h>
-#include <stdlib.h>
-#include "data.h"
-#include "symbols.h"
-#include "analyze.h"
-
-typedef struct Symbol {
-    char name[MAX_LABEL_LENGTH];
-    int value;
-    int isEntry;
-    int isExtern;
-    struct Symbol* next;
-} Symbol;
-
-Symbol* symbolTable = NULL;
-Symbol* externSymbolTable = NULL;
-
-void addToSymbolTable(const char *fileName, char *name, int value, int isEntry, int isExtern) {
-    /* Create dynamic memory space for new symbol */
-    Symbol* newSymbol = (Symbol*)malloc(sizeof(Symbol));
-
-    /* Report memory allocation has been failed for new symbol */
-    if(newSymbol == NULL) {
-        reportError(fileName, 12, " ");
-        return;
-    }
-
-    /* Set new symbol parameters */
-    strcpy(newSymbol->name, name);
-    newSymbol->value = value;
-    newSymbol->isEntry = isEntry;
-    newSymbol->isExtern = isExtern;
-    newSymbol->next = NULL;
-
-    /* Symbol table is empty */
-    if (symbolTable == NULL) {
-        symbolTable = newSymbol;
-    } else {
-        Symbol* current = symbolTable;
-
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = newSymbol;
-    }
-}
-
-int isSymbolExist(char* symbolName) {
-    Symbol* current = symbolTable;
-
-    while (current != NULL) {
-        /* symbolName has been found in the symbol table */
-        if (strcmp(current->name, symbolName) == 0)
-            return true;
-        current = current->next;
-    }
-    return false;  /* Symbol  hasn't been found */
-}
-
-int getSymbolValue(const char* symbolName) {
-    Symbol* current = symbolTable;
-
-    while (current != NULL) {
-        /* symbolName has been found in the symbol table */
-        if (strcmp(current->name, symbolName) == 0)
-            return current->value;
-        current = current->next;
-    }
-    return -1;  /* Symbol  hasn't been found */
-}
-
-int getSymbolType(const char *symbolName) {
-    Symbol* current = symbolTable;
-
-    while (current != NULL) {
-        /* symbolName has been found in the symbol table */
-        if (strcmp(current->name, symbolName) == 0) {
-            if (!current->isExtern) /* Current symbol isn't marked as extern point */
-                return 2; /* Entry */
-            else
-                return 1; /* Extern */
-        }
-        current = current->next;
-    }
-    return -1;  /* Symbol  hasn't been found */
-}
-
-void updateSymbolTable(char* name, int value) {
-    Symbol* symbol = symbolTable;
-
-    while (symbol != NULL) {
-        /* symbol has been found in the symbol table */
-        if(strcmp(symbol->name, name) == 0) {
-            symbol->value = value;
-            return;
-        }
-        symbol = symbol->next;
-    }
-}
-
-void setEntrySymbol(char *symbolName) {
-    Symbol *current = symbolTable;
-
-    while (current != NULL) {
-        /* symbolName has been found in the symbol table */
-        if (strcmp(current->name, symbolName) == 0) {
-            current->isEntry = 1;
-            return;
-        }
-        current = current->next;
-    }
-}
-
-void setExternSymbol(char *symbolName) {
-    Symbol *current = symbolTable;
-
-    while (current != NULL) {
-        /* symbolName has been found in the symbol table */
-        if (strcmp(current->name, symbolName) == 0) {
-            current->isExtern = 1;
-            return;
-        }
-        current = current->next;
-    }
-}
-
-void addToExternSymbolTable(const char *fileName, const char *name, int value) {
-    /* Create dynamic memory space for new symbol */
-    Symbol* newSymbol = (Symbol*)malloc(sizeof(Symbol));
-
-    /* Report memory allocation has been failed for new symbol */
-    if(newSymbol == NULL) {
-        reportError(fileName, 12, " ");
-        return;
-    }
-
-    /* Set new symbol parameters */
-    strcpy(newSymbol->name, name);
-    newSymbol->value = value;
-    newSymbol->isEntry = 0;
-    newSymbol->isExtern = 1;
-    newSymbol->next = NULL;
-
-    /* Extern symbol table is empty */
-    if (externSymbolTable == NULL) {
-        externSymbolTable = newSymbol;
-    } else {
-        Symbol* current = externSymbolTable;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = newSymbol;
-    }
-}
-
-int hasEntry() {
-    Symbol *current = symbolTable;
-
-    /* Search for entry point symbol */
-    while (current != NULL) {
-        /* Entry point symbol has been found in the symbol table */
-        if (current->isEntry)
-            return true;
-        current = current->next;
-    }
-    return false; /* Entry point symbol hasn't been found in the symbol table */
-}
-
-int hasExtern() {
-    Symbol *current = symbolTable;
-
-    /* Search for extern point symbol */
-    while (current != NULL) {
-        /* Extern point symbol has been found in the symbol table */
-        if (current->isExtern)
-            return true;
-        current = current->next;
-    }
-    return false; /* Extern point symbol hasn't been found in the symbol table */
-}
-
-int isExtern(const char *name) {
-    Symbol *symbol = symbolTable;
-
-    while (symbol != NULL) {
-        /* symbol has been found in the symbol table */
-        if (strcmp(symbol->name, name) == 0 && symbol->isExtern)
-            return true;
-        symbol = symbol->next;
-    }
-    return false; /* symbol hasn't been found in the symbol table */
-}
-
-int isEntry(char *name) {
-    Symbol *symbol = symbolTable;
-
-    while (symbol != NULL) {
-        /* symbol has been found in the symbol table and is marked as an entry point symbol */
-        if (strcmp(symbol->name, name) == 0 && symbol->isEntry)
-            return true;
-        symbol = symbol->next;
-    }
-    return false; /* symbol isn't marked as an entry point symbol */
-}
-
-void produceEntryFile(FILE* file) {
-    Symbol *symbol = symbolTable;
-
-    while (symbol != NULL) {
-        /* Current symbol is marked as an entry point symbol, so write it's name and value into the entry file*/
-        if (symbol->isEntry)
-            fprintf(file, "%s %d\n", symbol->name, symbol->value);
-        symbol = symbol->next;
-    }
-}
-
-void produceExternFile(FILE* file) {
-    Symbol *symbol = externSymbolTable;
-
-    while (symbol != NULL) {
-        /* Write it's name and value into the extern file*/
-        fprintf(file, "%s %d\n", symbol->name, symbol->value);
-        symbol = symbol->next;
-    }
-}
-
-void freeSymbolTable() {
-    Symbol *current = symbolTable;
-
-    /* Release each symbol node of symbol table out of the memory */
-    while (current != NULL) {
-        Symbol *temp = current;
-        current = current->next;
-        free(temp);
-    }
-    symbolTable = NULL;
-}
-
-void freeExternSymbolTable() {
-    Symbol *current = externSymbolTable;
-
-    /* Release each symbol node of extern symbol table out of the memory */
-    while (current != NULL) {
-        Symbol *temp = current;
-        current = current->next;
-        free(temp);
-    }
-    externSymbolTable = NULL;
-}
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "data.h"
+#include "symbols.h"
+#include "analyze.h"
+#include "objectfile.h"
+
+typedef struct Symbol {
+    char name[MAX_LABEL_LENGTH];
+    int value;
+    int isEntry;
+    int isExtern;
+    int isData;
+    struct Symbol* next;
+} Symbol;
+
+void addToSymbolTable(AssemblerContext *context, char *name, int value, int isEntry, int isExtern) {
+    /* Create dynamic memory space for new symbol */
+    Symbol* newSymbol = (Symbol*)allocateMemory(MEMORY_SYMBOLS, sizeof(Symbol));
+
+    /* Report memory allocation has been failed for new symbol */
+    if(newSymbol == NULL) {
+        reportError(context, 12, " ");
+        return;
+    }
+
+    /* Set new symbol parameters */
+    strcpy(newSymbol->name, name);
+    newSymbol->value = value;
+    newSymbol->isEntry = isEntry;
+    newSymbol->isExtern = isExtern;
+    newSymbol->isData = 0;
+    newSymbol->next = NULL;
+
+    /* Symbol table is empty */
+    if (context->symbolTable == NULL) {
+        context->symbolTable = newSymbol;
+    } else {
+        Symbol* current = context->symbolTable;
+
+        STATS_INCREMENT(symbolLookups);
+        while (current->next != NULL) {
+            STATS_INCREMENT(symbolComparisons);
+            current = current->next;
+        }
+        current->next = newSymbol;
+    }
+}
+
+int isSymbolExist(AssemblerContext *context, char* symbolName) {
+    Symbol* current = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (current != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbolName has been found in the symbol table */
+        if (strcmp(current->name, symbolName) == 0)
+            return true;
+        current = current->next;
+    }
+    return false;  /* Symbol  hasn't been found */
+}
+
+int getSymbolValue(AssemblerContext *context, const char* symbolName) {
+    Symbol* current = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (current != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbolName has been found in the symbol table */
+        if (strcmp(current->name, symbolName) == 0)
+            return current->value;
+        current = current->next;
+    }
+    return -1;  /* Symbol  hasn't been found */
+}
+
+int getSymbolType(AssemblerContext *context, const char *symbolName) {
+    Symbol* current = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (current != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbolName has been found in the symbol table */
+        if (strcmp(current->name, symbolName) == 0) {
+            if (!current->isExtern) /* Current symbol isn't marked as extern point */
+                return 2; /* Entry */
+            else
+                return 1; /* Extern */
+        }
+        current = current->next;
+    }
+    return -1;  /* Symbol  hasn't been found */
+}
+
+void updateSymbolTable(AssemblerContext *context, char* name, int value) {
+    Symbol* symbol = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (symbol != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbol has been found in the symbol table */
+        if(strcmp(symbol->name, name) == 0) {
+            symbol->value = value;
+            return;
+        }
+        symbol = symbol->next;
+    }
+}
+
+void setEntrySymbol(AssemblerContext *context, char *symbolName) {
+    Symbol *current = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (current != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbolName has been found in the symbol table */
+        if (strcmp(current->name, symbolName) == 0) {
+            current->isEntry = 1;
+            return;
+        }
+        current = current->next;
+    }
+}
+
+void setExternSymbol(AssemblerContext *context, char *symbolName) {
+    Symbol *current = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (current != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbolName has been found in the symbol table */
+        if (strcmp(current->name, symbolName) == 0) {
+            current->isExtern = 1;
+            return;
+        }
+        current = current->next;
+    }
+}
+
+void setDataSymbol(AssemblerContext *context, char *symbolName) {
+    Symbol *current = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (current != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbolName has been found in the symbol table */
+        if (strcmp(current->name, symbolName) == 0) {
+            current->isData = 1;
+            return;
+        }
+        current = current->next;
+    }
+}
+
+int isDataSymbol(AssemblerContext *context, const char *name) {
+    Symbol *symbol = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (symbol != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbol has been found in the symbol table and is marked as a data symbol */
+        if (strcmp(symbol->name, name) == 0 && symbol->isData)
+            return true;
+        symbol = symbol->next;
+    }
+    return false; /* symbol isn't marked as a data symbol */
+}
+
+void relocateDataSymbols(AssemblerContext *context, int instructionCounter) {
+    Symbol *symbol = context->symbolTable;
+
+    /* Move each data symbol from the data counter to it's final address after the code image */
+    while (symbol != NULL) {
+        if (symbol->isData)
+            symbol->value += instructionCounter;
+        symbol = symbol->next;
+    }
+}
+
+void markDataSymbols(AssemblerContext *context, int *isLabeled, int instructionCounter) {
+    Symbol *symbol = context->symbolTable;
+
+    while (symbol != NULL) {
+        if (symbol->isData && symbol->value >= instructionCounter &&
+            symbol->value <= instructionCounter + context->dataCounter)
+            isLabeled[symbol->value - instructionCounter] = true;
+        symbol = symbol->next;
+    }
+}
+
+void moveDataSymbols(AssemblerContext *context, const int *newIndices, int instructionCounter) {
+    Symbol *symbol = context->symbolTable;
+
+    while (symbol != NULL) {
+        if (symbol->isData && symbol->value >= instructionCounter &&
+            symbol->value <= instructionCounter + context->dataCounter)
+            symbol->value = instructionCounter + newIndices[symbol->value - instructionCounter];
+        symbol = symbol->next;
+    }
+}
+
+void addToExternSymbolTable(AssemblerContext *context, const char *name, int value) {
+    /* Create dynamic memory space for new symbol */
+    Symbol* newSymbol = (Symbol*)allocateMemory(MEMORY_EXTERN_USES, sizeof(Symbol));
+
+    /* Report memory allocation has been failed for new symbol */
+    if(newSymbol == NULL) {
+        reportError(context, 12, " ");
+        return;
+    }
+
+    /* Set new symbol parameters */
+    strcpy(newSymbol->name, name);
+    newSymbol->value = value;
+    newSymbol->isEntry = 0;
+    newSymbol->isExtern = 1;
+    newSymbol->isData = 0;
+    newSymbol->next = NULL;
+
+    /* Extern symbol table is empty */
+    if (context->externSymbolTable == NULL) {
+        context->externSymbolTable = newSymbol;
+    } else {
+        Symbol* current = context->externSymbolTable;
+
+        STATS_INCREMENT(symbolLookups);
+        while (current->next != NULL) {
+            STATS_INCREMENT(symbolComparisons);
+            current = current->next;
+        }
+        current->next = newSymbol;
+    }
+}
+
+int hasEntry(AssemblerContext *context) {
+    Symbol *current = context->symbolTable;
+
+    /* Search for entry point symbol */
+    while (current != NULL) {
+        /* Entry point symbol has been found in the symbol table */
+        if (current->isEntry)
+            return true;
+        current = current->next;
+    }
+    return false; /* Entry point symbol hasn't been found in the symbol table */
+}
+
+int hasExtern(AssemblerContext *context) {
+    Symbol *current = context->symbolTable;
+
+    /* Search for extern point symbol */
+    while (current != NULL) {
+        /* Extern point symbol has been found in the symbol table */
+        if (current->isExtern)
+            return true;
+        current = current->next;
+    }
+    return false; /* Extern point symbol hasn't been found in the symbol table */
+}
+
+int getNumOfDefinedSymbols(AssemblerContext *context) {
+    Symbol *current = context->symbolTable;
+    int count = 0;
+
+    /* Every symbol which isn't an extern point is defined by the source */
+    for (; current != NULL; current = current->next)
+        if (!current->isExtern)
+            count++;
+    return count;
+}
+
+int isExtern(AssemblerContext *context, const char *name) {
+    Symbol *symbol = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (symbol != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbol has been found in the symbol table */
+        if (strcmp(symbol->name, name) == 0 && symbol->isExtern)
+            return true;
+        symbol = symbol->next;
+    }
+    return false; /* symbol hasn't been found in the symbol table */
+}
+
+int isEntry(AssemblerContext *context, char *name) {
+    Symbol *symbol = context->symbolTable;
+
+    STATS_INCREMENT(symbolLookups);
+    while (symbol != NULL) {
+        STATS_INCREMENT(symbolComparisons);
+        /* symbol has been found in the symbol table and is marked as an entry point symbol */
+        if (strcmp(symbol->name, name) == 0 && symbol->isEntry)
+            return true;
+        symbol = symbol->next;
+    }
+    return false; /* symbol isn't marked as an entry point symbol */
+}
+
+/* Copy the symbols of a table which pass the filter into a new array */
+static int collectSymbols(Symbol *table, int onlyEntries, ObjectSymbol **symbols) {
+    Symbol *symbol;
+    int count = 0;
+
+    for (symbol = table; symbol != NULL; symbol = symbol->next)
+        if (!onlyEntries || symbol->isEntry)
+            count++;
+
+    *symbols = (ObjectSymbol *) allocateMemory(MEMORY_OBJECTS, (count + 1) * sizeof(ObjectSymbol));
+    if (*symbols == NULL)
+        return -1;
+
+    count = 0;
+    for (symbol = table; symbol != NULL; symbol = symbol->next)
+        if (!onlyEntries || symbol->isEntry) {
+            strcpy((*symbols)[count].name, symbol->name);
+            (*symbols)[count++].value = symbol->value;
+        }
+    return count;
+}
+
+int collectEntrySymbols(AssemblerContext *context, ObjectSymbol **entries) {
+    return collectSymbols(context->symbolTable, true, entries);
+}
+
+int collectExternUses(AssemblerContext *context, ObjectSymbol **externs) {
+    return collectSymbols(context->externSymbolTable, false, externs);
+}
+
+void freeSymbolTable(AssemblerContext *context) {
+    Symbol *current = context->symbolTable;
+
+    /* Release each symbol node of symbol table out of the memory */
+    while (current != NULL) {
+        Symbol *temp = current;
+        current = current->next;
+        freeMemory(temp);
+    }
+    context->symbolTable = NULL;
+}
+
+void freeExternSymbolTable(AssemblerContext *context) {
+    Symbol *current = context->externSymbolTable;
+
+    /* Release each symbol node of extern symbol table out of the memory */
+    while (current != NULL) {
+        Symbol *temp = current;
+        current = current->next;
+        freeMemory(temp);
+    }
+    context->externSymbolTable = NULL;
+}
@@ -1,176 +1,229 @@
-#ifndef  SYMBOLS_H
-#define SYMBOLS_H
-
-/**
- * @file symbols.h
- * @brief Definitions and functions related to symbol table and symbols.
- */
-
-/**
- * @struct Symbol
- * @brief Structure to represent a symbol in the symbol table.
- *
- * This structure holds information about a symbol, including its name, value,
- * whether it is an entry point, whether it is external, and a pointer to the next symbol.
- */
-typedef struct Symbol Symbol;
-
-/**
- * @brief Pointer to the symbol table.
- *
- * This pointer points to the head of the symbol table, which is a linked list of symbols.
- * The symbol table stores information about symbols encountered during the assembly process.
- * Each symbol has a name, a value (address), and flags to indicate if it's an entry point or external.
- */
-extern Symbol* symbolTable;
-
-/**
- * @brief Pointer to the extern symbol table.
- *
- * This pointer points to the head of the extern symbol table, which is a linked list of symbols.
- * The extern symbol table stores information about symbols encountered during the assembly process.
- * Each symbol has a name, a value (address), and flags to indicate if it's an entry point or external.
- */
-extern Symbol* externSymbolTable;
-
-/**
- * @brief Add a new symbol to the symbol table.
- *
- * This function adds a new symbol to the symbol table with the given attributes.
- *
- * @param fileName The name of the file being processed.
- * @param name The name of the symbol.
- * @param value The value (address) of the symbol.
- * @param isEntry Flag indicating if the symbol is an entry point (true) or not (false).
- * @param isExtern Flag indicating if the symbol is external (true) or not (false).
- */
-void addToSymbolTable(const char *fileName, char *name, int value, int isEntry, int isExtern);
-
-/**
- * @brief Check if a symbol with the given name exists in the symbol table.
- *
- * This function checks if a symbol with the given name exists in the symbol table.
- *
- * @param symbolName The name of the symbol to check.
- * @return True if the symbol exists, false otherwise.
- */
-int isSymbolExist(char* symbolName);
-
-/**
- * @brief Get the value (address) of a symbol with the given name.
- *
- * This function returns the value (address) of a symbol with the given name from the symbol table.
- *
- * @param symbolName The name of the symbol.
- * @return The value (address) of the symbol, or -1 if the symbol isn't found.
- */
-int getSymbolValue(const char* symbolName);
-
-/**
- * @brief Get the type of a symbol in the symbol table.
- *
- * This function returns the type of a symbol in the symbol table, which can be 1 (extern) or 2 (entry).
- *
- * @param symbolName The name of the symbol.
- * @return The type of the symbol (1 for extern, 2 for entry), or -1 if the symbol is not found.
- */
-int getSymbolType(const char* symbolName);
-
-/**
- * Updates the value of an existing symbol in the symbol table with the given name.
- *
- * @param name  The name of the symbol to update.
- * @param value The new value for the symbol.
- */
-void updateSymbolTable(char *name, int value);
-
-/**
- * @brief Sets the entry attribute for a symbol with the given name in the symbol table.
- *
- * This function sets the entry attribute of a symbol with the specified name to 1,
- * indicating that it is an entry point in the assembly program.
- *
- * @param symbolName The name of the symbol to set as an entry point.
- */
-void setEntrySymbol(char *symbolName);
-
-/**
- * @brief Sets the extern attribute for a symbol with the given name in the symbol table.
- *
- * This function sets the extern attribute of a symbol with the specified name to 1,
- * indicating that it is an external symbol in the assembly program.
- *
- * @param symbolName The name of the symbol to set as an external symbol.
- */
-void setExternSymbol(char *symbolName);
-
-/**
- * Adds a new symbol to the extern symbol table with the given name and value.
- *
- * @param fileName The name of the file being processed.
- * @param name  The name of the symbol to add.
- * @param value The value of the symbol.
- */
-void addToExternSymbolTable(const char *fileName, const char *name, int value);
-
-/**
-* @brief Check if the symbol table contains any entry symbols.
-*
-* @return true if the file has an entry point symbol, false otherwise.
-*/
-int hasEntry();
-
-/**
- * @brief Check if the symbol table contains any external symbols.
- *
- * @return true if the symbol table has an external symbol, false otherwise.
- */
-int hasExtern();
-
-/**
- * @brief Checks if a symbol with the given name exists in the symbol table and if it is marked as an external symbol.
- *
- * @param name The name of the symbol to check.
- * @return True if the symbol with the given name is marked as an external symbol, false otherwise.
- */
-int isExtern(const char *name);
-
-/**
- * @brief Checks if a symbol with the given name exists in the symbol table and if it is marked as an entry symbol.
- *
- * @param name The name of the symbol to check.
- * @return True if the symbol with the given name is marked as an entry symbol, false otherwise.
- */
-int isEntry(char *name);
-
-/**
- * @brief Produce the entry file with entry point symbols.
- *
- * This function writes the entry point symbols to the output file,
- * producing the entry file for the assembly program.
- *
- * @param file The output file to write the entry point symbols.
- */
-void produceEntryFile(FILE* file);
-
-/**
- * @brief Produce the extern file with external symbols.
- *
- * This function writes the external symbols to the output file,
- * producing the extern file for the assembly program.
- *
- * @param file The output file to write the external symbols.
- */
-void produceExternFile(FILE* file);
-
-/**
- * @brief Frees the memory used by the symbol table.
- */
-void freeSymbolTable();
-
-/**
- * @brief Frees the memory used by the external symbol table.
- */
-void freeExternSymbolTable();
-
-#endif
+#ifndef  SYMBOLS_H
+#define SYMBOLS_H
+
+/**
+ * @file symbols.h
+ * @brief Definitions and functions related to symbol table and symbols.
+ */
+
+/**
+ * @struct Symbol
+ * @brief Structure to represent a symbol in the symbol table.
+ *
+ * This structure holds information about a symbol, including its name, value,
+ * whether it is an entry point, whether it is external, whether it labels data, and a pointer to the next symbol.
+ */
+typedef struct Symbol Symbol;
+
+/**
+ * An entry point/extern use record of an object file (see objectfile.h).
+ */
+struct ObjectSymbol;
+
+/**
+ * @brief Add a new symbol to the symbol table.
+ *
+ * This function adds a new symbol to the symbol table with the given attributes.
+ *
+ * @param context The context of the source being assembled.
+ * @param name The name of the symbol.
+ * @param value The value (address) of the symbol.
+ * @param isEntry Flag indicating if the symbol is an entry point (true) or not (false).
+ * @param isExtern Flag indicating if the symbol is external (true) or not (false).
+ */
+void addToSymbolTable(AssemblerContext *context, char *name, int value, int isEntry, int isExtern);
+
+/**
+ * @brief Check if a symbol with the given name exists in the symbol table.
+ *
+ * This function checks if a symbol with the given name exists in the symbol table.
+ *
+ * @param context The context of the source being assembled.
+ * @param symbolName The name of the symbol to check.
+ * @return True if the symbol exists, false otherwise.
+ */
+int isSymbolExist(AssemblerContext *context, char* symbolName);
+
+/**
+ * @brief Get the value (address) of a symbol with the given name.
+ *
+ * This function returns the value (address) of a symbol with the given name from the symbol table.
+ *
+ * @param context The context of the source being assembled.
+ * @param symbolName The name of the symbol.
+ * @return The value (address) of the symbol, or -1 if the symbol isn't found.
+ */
+int getSymbolValue(AssemblerContext *context, const char* symbolName);
+
+/**
+ * @brief Get the type of a symbol in the symbol table.
+ *
+ * This function returns the type of a symbol in the symbol table, which can be 1 (extern) or 2 (entry).
+ *
+ * @param context The context of the source being assembled.
+ * @param symbolName The name of the symbol.
+ * @return The type of the symbol (1 for extern, 2 for entry), or -1 if the symbol is not found.
+ */
+int getSymbolType(AssemblerContext *context, const char* symbolName);
+
+/**
+ * Updates the value of an existing symbol in the symbol table with the given name.
+ *
+ * @param context The context of the source being assembled.
+ * @param name  The name of the symbol to update.
+ * @param value The new value for the symbol.
+ */
+void updateSymbolTable(AssemblerContext *context, char *name, int value);
+
+/**
+ * @brief Sets the entry attribute for a symbol with the given name in the symbol table.
+ *
+ * This function sets the entry attribute of a symbol with the specified name to 1,
+ * indicating that it is an entry point in the assembly program.
+ *
+ * @param context The context of the source being assembled.
+ * @param symbolName The name of the symbol to set as an entry point.
+ */
+void setEntrySymbol(AssemblerContext *context, char *symbolName);
+
+/**
+ * @brief Sets the extern attribute for a symbol with the given name in the symbol table.
+ *
+ * This function sets the extern attribute of a symbol with the specified name to 1,
+ * indicating that it is an external symbol in the assembly program.
+ *
+ * @param context The context of the source being assembled.
+ * @param symbolName The name of the symbol to set as an external symbol.
+ */
+void setExternSymbol(AssemblerContext *context, char *symbolName);
+
+/**
+ * @brief Sets the data attribute for a symbol with the given name in the symbol table.
+ *
+ * A data symbol holds the data counter during the first pass, and is relocated after the code image
+ * at the end of the first pass.
+ *
+ * @param context The context of the source being assembled.
+ * @param symbolName The name of the symbol to set as a data symbol.
+ */
+void setDataSymbol(AssemblerContext *context, char *symbolName);
+
+/**
+ * @brief Checks if a symbol with the given name exists in the symbol table and if it is marked as a data symbol.
+ *
+ * @param context The context of the source being assembled.
+ * @param name The name of the symbol to check.
+ * @return True if the symbol with the given name is marked as a data symbol, false otherwise.
+ */
+int isDataSymbol(AssemblerContext *context, const char *name);
+
+/**
+ * @brief Relocates every data symbol to follow the code image.
+ *
+ * @param context The context of the source being assembled.
+ * @param instructionCounter The final address of the code image, which becomes the base address of the data image.
+ */
+void relocateDataSymbols(AssemblerContext *context, int instructionCounter);
+
+/**
+ * @brief Marks the words of the data image which are labeled by a data symbol.
+ *
+ * @param context The context of the source being assembled, after the data symbols have been relocated.
+ * @param isLabeled The flag of every word of the data image (and one past it's end), set for a labeled word.
+ * @param instructionCounter The base address of the data image.
+ */
+void markDataSymbols(AssemblerContext *context, int *isLabeled, int instructionCounter);
+
+/**
+ * @brief Moves every data symbol to a new word of the data image.
+ *
+ * @param context The context of the source being assembled, after the data symbols have been relocated.
+ * @param newIndices The new index of every word of the data image (and one past it's end).
+ * @param instructionCounter The base address of the data image.
+ */
+void moveDataSymbols(AssemblerContext *context, const int *newIndices, int instructionCounter);
+
+/**
+ * Adds a new symbol to the extern symbol table with the given name and value.
+ *
+ * @param context The context of the source being assembled.
+ * @param name  The name of the symbol to add.
+ * @param value The value of the symbol.
+ */
+void addToExternSymbolTable(AssemblerContext *context, const char *name, int value);
+
+/**
+* @brief Check if the symbol table contains any entry symbols.
+*
+* @param context The context of the source being assembled.
+* @return true if the file has an entry point symbol, false otherwise.
+*/
+int hasEntry(AssemblerContext *context);
+
+/**
+ * @brief Check if the symbol table contains any external symbols.
+ *
+ * @param context The context of the source being assembled.
+ * @return true if the symbol table has an external symbol, false otherwise.
+ */
+int hasExtern(AssemblerContext *context);
+
+/**
+ * @brief Counts the symbols which are defined by the source, every symbol which isn't an extern symbol.
+ *
+ * @param context The context of the source being assembled.
+ * @return The number of defined symbols.
+ */
+int getNumOfDefinedSymbols(AssemblerContext *context);
+
+/**
+ * @brief Checks if a symbol with the given name exists in the symbol table and if it is marked as an external symbol.
+ *
+ * @param context The context of the source being assembled.
+ * @param name The name of the symbol to check.
+ * @return True if the symbol with the given name is marked as an external symbol, false otherwise.
+ */
+int isExtern(AssemblerContext *context, const char *name);
+
+/**
+ * @brief Checks if a symbol with the given name exists in the symbol table and if it is marked as an entry symbol.
+ *
+ * @param context The context of the source being assembled.
+ * @param name The name of the symbol to check.
+ * @return True if the symbol with the given name is marked as an entry symbol, false otherwise.
+ */
+int isEntry(AssemblerContext *context, char *name);
+
+/**
+ * @brief Copies the entry point symbols into a new array, in the order of the entry file.
+ *
+ * @param context The context of the source being assembled.
+ * @param entries Pointer to store the new array, which should be freed by the caller.
+ * @return The number of entry point symbols, or -1 if memory allocation has been failed.
+ */
+int collectEntrySymbols(AssemblerContext *context, struct ObjectSymbol **entries);
+
+/**
+ * @brief Copies the uses of the external symbols into a new array, in the order of the extern file.
+ *
+ * @param context The context of the source being assembled.
+ * @param externs Pointer to store the new array, which should be freed by the caller.
+ * @return The number of uses of external symbols, or -1 if memory allocation has been failed.
+ */
+int collectExternUses(AssemblerContext *context, struct ObjectSymbol **externs);
+
+/**
+ * @brief Frees the memory used by the symbol table.
+ *
+ * @param context The context of the source being assembled.
+ */
+void freeSymbolTable(AssemblerContext *context);
+
+/**
+ * @brief Frees the memory used by the external symbol table.
+ *
+ * @param context The context of the source being assembled.
+ */
+void freeExternSymbolTable(AssemblerContext *context);
+
+#endif
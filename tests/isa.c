@@ -0,0 +1,187 @@
+/**
+ * @file isa.c
+ * @details This program tests the assembler and the decoder of a hardware revision (see isa.h), it's compiled
+ * once for every variant. A fixture which uses the last register, the extreme numbers of a word and an entry point
+ * is assembled, and the outputs have to hold words of ISA_WORD_BITS bits, the registers of the variant and the code
+ * at ISA_BASE_ADDRESS. Every word is decoded and encoded back like disassembler --verify does, and a register past
+ * the last register has to be reported.
+ * @example Run ./test-isa0                       (on command line) to test the classic machine.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "libasm.h"
+#include "objectfile.h"
+#include "decoder.h"
+
+/**
+ * The name of the text outputs the test writes and reads back.
+ */
+#define OUTPUT_NAME "test-" ISA_NAME
+
+/**
+ * The largest number a data word holds (2047 on the classic machine).
+ */
+#define MAX_DATA_NUMBER ((int) ((1L << (ISA_WORD_BITS - 1)) - 1))
+
+/* Report a failed check of the test and return false */
+static int fail(const char *check) {
+    printf("test-%s: %s.\n", ISA_NAME, check);
+    return false;
+}
+
+/* Assemble a source, returns the value of failed of the assembly */
+static int assembleText(const char *source, Assembly *assembly) {
+    AssemblyOptions options;
+
+    memset(&options, 0, sizeof(AssemblyOptions));
+    assembleSourceWithOptions(source, (long) strlen(source), &options, assembly);
+    return assembly->failed;
+}
+
+/* Decode every word of an object and encode it back, returns false if a word doesn't come back the same */
+static int verifyRoundTrip(const ObjectFile *object) {
+    DecodedInstruction decoded;
+    unsigned int encoded[3];
+    int numOfWords = object->codeWords + object->dataWords;
+    int i = 0;
+
+    while (i < object->codeWords) {
+        int length = decodeInstruction(object->words + i, object->codeWords - i, &decoded);
+
+        if (length == 0 || encodeInstruction(&decoded, encoded) != length ||
+            memcmp(encoded, object->words + i, length * sizeof(unsigned int)) != 0)
+            return false;
+        i += length;
+    }
+    for (; i < numOfWords; ++i)
+        if (((unsigned int) decodeDataWord(object->words[i]) & ISA_WORD_MASK) != object->words[i])
+            return false;
+    return true;
+}
+
+/* Check the text outputs: every line of the ".ob" file is a word of ISA_BASE64_DIGITS characters, and the words
+  and entry points come back the same */
+static int checkTextOutputs(const ObjectFile *object) {
+    ObjectFile loaded;
+    char line[MAX_LINE_LENGTH];
+    FILE *file;
+    int numOfLines = 0;
+    int isValid = true;
+
+    if (!writeTextObjectFiles(object, OUTPUT_NAME) || (file = fopen(OUTPUT_NAME ".ob", "r")) == NULL)
+        return fail("the text outputs couldn't be written");
+    while (fgets(line, sizeof(line), file) != NULL) {
+        isValid = isValid && strlen(line) == ISA_BASE64_DIGITS + 1;
+        numOfLines++;
+    }
+    fclose(file);
+    if (!isValid || numOfLines != object->codeWords + object->dataWords)
+        return fail("a word of the .ob file doesn't have ISA_BASE64_DIGITS characters");
+
+    if (!readTextObjectFiles(OUTPUT_NAME, &loaded))
+        return fail("the text outputs couldn't be read back");
+    isValid = loaded.codeWords + loaded.dataWords == numOfLines &&
+              memcmp(loaded.words, object->words, numOfLines * sizeof(unsigned int)) == 0 &&
+              loaded.numOfEntries == object->numOfEntries && loaded.entries[0].value == ISA_BASE_ADDRESS;
+    freeObjectFile(&loaded);
+    remove(OUTPUT_NAME ".ob");
+    remove(OUTPUT_NAME ".ent");
+    remove(OUTPUT_NAME ".ext");
+    return isValid ? true : fail("the text outputs don't read back the same");
+}
+
+/* Check the binary output: it's header tells the width of the words, and it loads back the same */
+static int checkBinaryOutput(const ObjectFile *object) {
+    ObjectFile loaded;
+    long size;
+    unsigned char *bytes = encodeBinaryObjectFile(object, &size);
+    int isValid;
+
+    if (bytes == NULL)
+        return fail("the binary object file couldn't be encoded");
+    if (readObjectField(bytes, OBJECT_FIELD_WORD_BITS) != ISA_WORD_BITS) {
+        freeMemory(bytes);
+        return fail("the binary object file doesn't tell ISA_WORD_BITS");
+    }
+    isValid = loadObjectFile(bytes, size, &loaded);
+    freeMemory(bytes);
+    if (!isValid)
+        return fail("the binary object file couldn't be loaded back");
+    isValid = loaded.codeWords == object->codeWords && loaded.dataWords == object->dataWords &&
+              memcmp(loaded.words, object->words, (loaded.codeWords + loaded.dataWords) * sizeof(unsigned int)) == 0;
+    freeObjectFile(&loaded);
+    return isValid ? true : fail("the binary object file doesn't load back the same");
+}
+
+/* Check the words of the fixture: their width, the registers and the numbers they hold */
+static int checkWords(const ObjectFile *object) {
+    DecodedInstruction decoded;
+    int numOfWords = object->codeWords + object->dataWords;
+    int i = 0;
+
+    for (; i < numOfWords; ++i)
+        if (object->words[i] > ISA_WORD_MASK)
+            return fail("a word is wider than ISA_WORD_BITS");
+
+    /* MAIN: mov @r<last>, @r0 */
+    if (decodeInstruction(object->words, object->codeWords, &decoded) != 2 ||
+        decoded.source.value != ISA_NUM_OF_REGISTERS - 1 || decoded.destination.value != 0)
+        return fail("the last register doesn't decode back");
+
+    /* mov NUMS, @r<last>, the address of NUMS is above ISA_BASE_ADDRESS */
+    if (decodeInstruction(object->words + 2, object->codeWords - 2, &decoded) != 3 ||
+        decoded.source.value != ISA_BASE_ADDRESS + object->codeWords ||
+        decoded.destination.value != ISA_NUM_OF_REGISTERS - 1)
+        return fail("the address of the data doesn't start after the code at ISA_BASE_ADDRESS");
+
+    /* NUMS: .data <max>, <min>, -1 */
+    if (decodeDataWord(object->words[object->codeWords]) != MAX_DATA_NUMBER ||
+        decodeDataWord(object->words[object->codeWords + 1]) != -MAX_DATA_NUMBER - 1 ||
+        object->words[object->codeWords + 2] != ISA_WORD_MASK)
+        return fail("the numbers of a word don't take ISA_WORD_BITS bits");
+
+    if (object->numOfEntries != 1 || object->entries[0].value != ISA_BASE_ADDRESS)
+        return fail("the code doesn't start at ISA_BASE_ADDRESS");
+    if (object->numOfExterns != 1 || object->externs[0].value != ISA_BASE_ADDRESS + 8)
+        return fail("the use of the extern symbol isn't at it's address");
+    return true;
+}
+
+int main() {
+    char source[MAX_LINE_LENGTH * 16];
+    char note[MAX_LINE_LENGTH];
+    Assembly assembly;
+    int isPassed;
+
+    sprintf(source, ".entry MAIN\n.extern OUT\nMAIN: mov @r%d, @r0\nmov NUMS, @r%d\nprn -1\njsr OUT\n"
+                    "cmp NUMS, LAST\nstop\nNUMS: .data %d, %d, -1\nLAST: .string \"ab\"\n",
+            ISA_NUM_OF_REGISTERS - 1, ISA_NUM_OF_REGISTERS - 1, MAX_DATA_NUMBER, -MAX_DATA_NUMBER - 1);
+    if (assembleText(source, &assembly)) {
+        fail("the fixture couldn't be assembled");
+        freeAssembly(&assembly);
+        return EXIT_FAILURE;
+    }
+    isPassed = checkWords(&assembly.object);
+    isPassed = isPassed && (verifyRoundTrip(&assembly.object) || fail("a word doesn't decode and encode back"));
+    isPassed = isPassed && checkBinaryOutput(&assembly.object);
+    isPassed = isPassed && checkTextOutputs(&assembly.object);
+    freeAssembly(&assembly);
+
+    /* A register past the last register isn't a register of the machine */
+    sprintf(source, "mov @r%d, @r0\nstop\n", ISA_NUM_OF_REGISTERS);
+    assembleText(source, &assembly);
+    sprintf(note, "r%d is an invalid register.", ISA_NUM_OF_REGISTERS);
+    isPassed = isPassed && ((assembly.numOfDiagnostics > 0 && assembly.diagnostics[0].code == DIAGNOSTIC_NOTE &&
+                             strcmp(assembly.diagnostics[0].text, note) == 0) ||
+                            fail("a register past the last isn't reported"));
+    freeAssembly(&assembly);
+
+    if (!isPassed)
+        return EXIT_FAILURE;
+    printf("test-%s: %d-bit words, %d registers and the code at %d.\n", ISA_NAME, ISA_WORD_BITS, ISA_NUM_OF_REGISTERS,
+           ISA_BASE_ADDRESS);
+    return EXIT_SUCCESS;
+}
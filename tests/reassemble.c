@@ -0,0 +1,351 @@
+/**
+ * @file reassemble.c
+ * @details This program tests reassembleSource against assembleSourceWithOptions. A source is edited again and
+ * again: lines are inserted, deleted and resized, labels, extern and entry declarations are moved, added and
+ * removed, and symbols are declared in the ways the passes treat specially. After every edit the source is
+ * assembled again incrementally and whole, and the results have to be the same to the byte: the words, the
+ * relocations, the extern uses, the entry points and the diagnostics.
+ * A list of edits which go through every case comes first, random edits of the source follow it.
+ * @example Run ./test-reassemble                 (on command line) to run the test.
+ * @example Run ./test-reassemble 7 2000           to run 2000 random edits from the seed 7.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "libasm.h"
+
+/**
+ * The largest number of lines of the edited source.
+ */
+#define MAX_TEST_LINES 2048
+
+/**
+ * Insert the text before the target line (at the end of the source if there's no target).
+ */
+#define EDIT_INSERT 0
+
+/**
+ * Delete the target line.
+ */
+#define EDIT_DELETE 1
+
+/**
+ * Replace the target line by the text.
+ */
+#define EDIT_REPLACE 2
+
+/**
+ * @struct SourceEdit
+ * @brief Structure to represent an edit of the source, the target line is found by it's text.
+ */
+typedef struct SourceEdit {
+    const char *name;       /* What the edit does, for the report. */
+    int kind;               /* The kind of the edit (EDIT_*). */
+    const char *target;     /* The text of the line the edit applies to, NULL for the end of the source. */
+    const char *text;       /* The text of the inserted line, or of the replacing line. */
+    int count;              /* The number of lines which are inserted or deleted. */
+} SourceEdit;
+
+/* The lines of the source, as it has been edited so far */
+static char lines[MAX_TEST_LINES][MAX_LINE_LENGTH];
+static int numOfLines = 0;
+
+/* The source before it has been edited */
+static const char *const initialSource[] = {
+        "; The source the edits are applied to",
+        ".extern OUT",
+        ".entry MAIN",
+        ".entry LIST",
+        "mcro twice",
+        "inc @r1",
+        "inc @r1",
+        "endmcro",
+        "MAIN: mov LIST, @r1",
+        "mov STR, @r2",
+        "LOOP: cmp @r1, COUNT",
+        "bne END",
+        "twice",
+        "jsr OUT",
+        "add @r2, @r3",
+        "sub @r3, @r4",
+        "jmp LOOP",
+        "END: prn COUNT",
+        "stop",
+        "STR: .string \"edit\"",
+        "LIST: .data 1, -2, 3",
+        "COUNT: .data 4"
+};
+
+/* The edits which go through every case, in order */
+static const SourceEdit scriptedEdits[] = {
+        {"insert an instruction",           EDIT_INSERT,  "jsr OUT",              "prn @r1",                  1},
+        {"delete an instruction",           EDIT_DELETE,  "sub @r3, @r4",         NULL,                       1},
+        {"resize an instruction",           EDIT_REPLACE, "add @r2, @r3",           "add LIST, COUNT",          1},
+        {"shrink an instruction",           EDIT_REPLACE, "add LIST, COUNT",      "rts",                      1},
+        {"remove a label",                  EDIT_REPLACE, "LOOP: cmp @r1, COUNT", "cmp @r1, COUNT",           1},
+        {"move the label to another line",  EDIT_REPLACE, "mov STR, @r2",         "LOOP: mov STR, @r2",       1},
+        {"add a label",                     EDIT_REPLACE, "stop",                 "HALT: stop",               1},
+        {"use the new label",               EDIT_INSERT,  "jsr OUT",              "jmp HALT",                 1},
+        {"remove a label which is used",    EDIT_REPLACE, "HALT: stop",           "stop",                     1},
+        {"remove the use",                  EDIT_DELETE,  "jmp HALT",             NULL,                       1},
+        {"add an extern",                   EDIT_INSERT,  ".entry MAIN",          ".extern IN",               1},
+        {"use the extern",                  EDIT_INSERT,  "stop",                 "jsr IN",                   1},
+        {"remove an extern which is used",  EDIT_DELETE,  ".extern IN",           NULL,                       1},
+        {"declare the extern again",        EDIT_INSERT,  NULL,                   ".extern IN",               1},
+        {"remove an entry",                 EDIT_DELETE,  ".entry LIST",          NULL,                       1},
+        {"add an entry of data",            EDIT_INSERT,  "mcro twice",           ".entry COUNT",             1},
+        {"add an entry before the others",  EDIT_INSERT,  ".extern OUT",          ".entry END",               1},
+        {"declare an entry twice",          EDIT_INSERT,  NULL,                   ".entry MAIN",              1},
+        {"drop the first of the two",       EDIT_DELETE,  ".entry MAIN",          NULL,                       1},
+        {"declare a label twice",           EDIT_INSERT,  "stop",                 "LOOP: rts",                1},
+        {"remove the second label",         EDIT_DELETE,  "LOOP: rts",            NULL,                       1},
+        {"declare an entry extern",         EDIT_INSERT,  NULL,                   ".extern COUNT",            1},
+        {"remove the extern declaration",   EDIT_DELETE,  ".extern COUNT",        NULL,                       1},
+        {"declare a label extern",          EDIT_INSERT,  NULL,                   ".extern LOOP",             1},
+        {"remove the extern label",         EDIT_DELETE,  ".extern LOOP",         NULL,                       1},
+        {"add a line with an error",        EDIT_INSERT,  "stop",                 "mov @r9, @r1",             1},
+        {"fix the error",                   EDIT_REPLACE, "mov @r9, @r1",         "mov @r7, @r1",             1},
+        {"change the macro",                EDIT_REPLACE, "inc @r1",              "dec @r2",                  1},
+        {"use the macro again",             EDIT_INSERT,  "stop",                 "twice",                    1},
+        {"grow the data",                   EDIT_REPLACE, "COUNT: .data 4",       "COUNT: .data 4, 5, 6, 7",  1},
+        {"grow the string",                 EDIT_REPLACE, "STR: .string \"edit\"", "STR: .string \"edited\"", 1},
+        {"move the symbols out of range",   EDIT_INSERT,  "END: prn COUNT",       "not @r5",                  600},
+        {"bring the symbols back",          EDIT_DELETE,  "not @r5",              NULL,                       600},
+        {"label the first line",            EDIT_REPLACE, "; The source the edits are applied to", "TOP: rts", 1},
+        {"jump to the first line",          EDIT_INSERT,  "stop",                 "jmp TOP",                  1}
+};
+
+/* The lines random edits insert */
+static const char *const randomLines[] = {
+        "NEWA: .data 1, 2, 3", "inc NEWA", "jmp NEWB", "NEWB: mov NEWA, @r1", ".entry NEWA", ".extern XNEW",
+        "mov XNEW, @r2", "NEWC: .string \"hi\"", ".entry NEWC", "prn NEWC", "jmp END", "mov @r9, @r1",
+        "NEWA: inc @r1", ".extern NEWA", "stop", "cmp NEWB, NEWC", "NEWD: .entry NEWE", "NEWE: rts", "add LIST, @r3",
+        "   ", "; comment", "red @r1", "twice", "prn -5", "LIST: .data 9", ".entry END", "jsr OUT", "bne LOOP"
+};
+
+/* Get a random number from a seed, the same sequence on every platform */
+static int nextRandom(unsigned long *seed) {
+    *seed = (*seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return (int) ((*seed >> 16) & 0x7FFF);
+}
+
+/* Find the first line whose text is the given one, returns it's index or -1 */
+static int findLine(const char *text) {
+    int i = 0;
+
+    for (; i < numOfLines; ++i)
+        if (strcmp(lines[i], text) == 0)
+            return i;
+    return -1;
+}
+
+/* Insert lines before the given line, returns false if the source is full */
+static int insertLines(int index, const char *text, int count) {
+    int i = 0;
+
+    if (numOfLines + count > MAX_TEST_LINES)
+        return false;
+    memmove(lines[index + count], lines[index], (size_t) (numOfLines - index) * MAX_LINE_LENGTH);
+    for (; i < count; ++i)
+        strcpy(lines[index + i], text);
+    numOfLines += count;
+    return true;
+}
+
+/* Delete lines from the given line on */
+static void deleteLines(int index, int count) {
+    memmove(lines[index], lines[index + count], (size_t) (numOfLines - index - count) * MAX_LINE_LENGTH);
+    numOfLines -= count;
+}
+
+/* Apply an edit to the source, returns false if the edit doesn't apply */
+static int applyEdit(const SourceEdit *edit) {
+    int index = edit->target != NULL ? findLine(edit->target) : numOfLines;
+
+    if (index == -1)
+        return false;
+    if (edit->kind == EDIT_INSERT)
+        return insertLines(index, edit->text, edit->count);
+    if (edit->kind == EDIT_DELETE) {
+        if (index + edit->count > numOfLines)
+            return false;
+        deleteLines(index, edit->count);
+    } else
+        strcpy(lines[index], edit->text);
+    return true;
+}
+
+/* Join the lines into a source, returns it's size */
+static long joinLines(char *source) {
+    long size = 0;
+    int i = 0;
+
+    for (; i < numOfLines; ++i) {
+        size_t length = strlen(lines[i]);
+
+        memcpy(source + size, lines[i], length);
+        size += (long) length;
+        source[size++] = '\n';
+    }
+    return size;
+}
+
+/* Compare the symbols of two objects, returns false if they differ */
+static int compareSymbols(const ObjectSymbol *first, const ObjectSymbol *second, int count) {
+    int i = 0;
+
+    for (; i < count; ++i)
+        if (strcmp(first[i].name, second[i].name) != 0 || first[i].value != second[i].value)
+            return false;
+    return true;
+}
+
+/* Compare an incremental assembly with a whole assembly, returns what differs or NULL if nothing does */
+static const char *compareAssemblies(const Assembly *incremental, const Assembly *whole) {
+    const ObjectFile *first = &incremental->object;
+    const ObjectFile *second = &whole->object;
+    int i = 0;
+
+    if (incremental->failed != whole->failed)
+        return "the result";
+    if (incremental->numOfDiagnostics != whole->numOfDiagnostics)
+        return "the number of diagnostics";
+    for (; i < whole->numOfDiagnostics; ++i)
+        if (incremental->diagnostics[i].line != whole->diagnostics[i].line ||
+            incremental->diagnostics[i].code != whole->diagnostics[i].code ||
+            strcmp(incremental->diagnostics[i].text, whole->diagnostics[i].text) != 0)
+            return "a diagnostic";
+    if (incremental->hasExternDeclarations != whole->hasExternDeclarations)
+        return "the extern declarations";
+    if (incremental->expandedSize != whole->expandedSize ||
+        (incremental->expandedSource == NULL) != (whole->expandedSource == NULL) ||
+        (whole->expandedSource != NULL &&
+         memcmp(incremental->expandedSource, whole->expandedSource, (size_t) whole->expandedSize) != 0))
+        return "the expanded source";
+    if (whole->failed)
+        return NULL;
+
+    if (first->codeWords != second->codeWords || first->dataWords != second->dataWords)
+        return "the number of words";
+    if (memcmp(first->words, second->words, (first->codeWords + first->dataWords) * sizeof(unsigned int)) != 0)
+        return "the words";
+    if (first->numOfRelocations != second->numOfRelocations || first->relocationsSize != second->relocationsSize ||
+        memcmp(first->relocations, second->relocations, (size_t) first->relocationsSize) != 0)
+        return "the relocations";
+    if (first->numOfExterns != second->numOfExterns ||
+        !compareSymbols(first->externs, second->externs, first->numOfExterns))
+        return "the extern uses";
+    if (first->numOfEntries != second->numOfEntries ||
+        !compareSymbols(first->entries, second->entries, first->numOfEntries))
+        return "the entry points";
+    return NULL;
+}
+
+/* Assemble the source incrementally and whole and compare, returns false (and reports) if they differ. Sets
+  isFailed if the source has errors */
+static int checkSource(IncrementalAssembly *incremental, char *source, const char *editName, int *isFailed) {
+    AssemblyOptions options;
+    Assembly incrementalAssembly, wholeAssembly;
+    long size = joinLines(source);
+    const char *difference;
+
+    memset(&options, 0, sizeof(AssemblyOptions));
+    reassembleSource(incremental, source, size, &options, &incrementalAssembly);
+    assembleSourceWithOptions(source, size, &options, &wholeAssembly);
+    difference = compareAssemblies(&incrementalAssembly, &wholeAssembly);
+    if (difference != NULL)
+        printf("test-reassemble: after \"%s\" the incremental assembly differs from the whole assembly in %s.\n",
+               editName, difference);
+    *isFailed = wholeAssembly.failed;
+    freeAssembly(&incrementalAssembly);
+    freeAssembly(&wholeAssembly);
+    return difference == NULL;
+}
+
+/* Apply a random edit to the source */
+static void applyRandomEdit(unsigned long *seed) {
+    int kind = nextRandom(seed) % 4;
+    int index = numOfLines > 0 ? nextRandom(seed) % numOfLines : 0;
+    const char *text = randomLines[nextRandom(seed) % (sizeof(randomLines) / sizeof(randomLines[0]))];
+
+    if (kind == 0 && numOfLines > 1)
+        deleteLines(index, 1);
+    else if (kind == 1 && numOfLines > 0)
+        strcpy(lines[index], text);
+    else if (kind == 2 && numOfLines > 1) {
+        /* Swap two lines */
+        char line[MAX_LINE_LENGTH];
+        int other = nextRandom(seed) % numOfLines;
+
+        memcpy(line, lines[index], MAX_LINE_LENGTH);
+        memmove(lines[index], lines[other], MAX_LINE_LENGTH);
+        memcpy(lines[other], line, MAX_LINE_LENGTH);
+    } else
+        insertLines(index, text, 1);
+}
+
+int main(int argc, char *argv[]) {
+    static char source[MAX_TEST_LINES * MAX_LINE_LENGTH];
+    static char savedLines[MAX_TEST_LINES][MAX_LINE_LENGTH];
+    unsigned long seed = argc > 1 ? strtoul(argv[1], NULL, 10) : 1;
+    int numOfRandomEdits = argc > 2 ? atoi(argv[2]) : 1000;
+    int numOfSavedLines;
+    int numOfFailed = 0;
+    int isPassed = true;
+    int isFailed;
+    IncrementalAssembly incremental;
+    int i = 0;
+
+    initIncrementalAssembly(&incremental);
+    for (; i < (int) (sizeof(initialSource) / sizeof(initialSource[0])); ++i)
+        insertLines(numOfLines, initialSource[i], 1);
+    isPassed = checkSource(&incremental, source, "the first assembly", &isFailed);
+
+    for (i = 0; isPassed && i < (int) (sizeof(scriptedEdits) / sizeof(scriptedEdits[0])); ++i) {
+        if (!applyEdit(&scriptedEdits[i])) {
+            printf("test-reassemble: \"%s\" doesn't apply to the source.\n", scriptedEdits[i].name);
+            isPassed = false;
+            break;
+        }
+        isPassed = checkSource(&incremental, source, scriptedEdits[i].name, &isFailed);
+        numOfFailed += isFailed;
+    }
+
+    /* Random edits. The source is saved while it's valid, an edit which fails it is mostly undone and one more
+      edit at most is applied to a failed source, so the source stays mostly valid */
+    memcpy(savedLines, lines, (size_t) numOfLines * MAX_LINE_LENGTH);
+    numOfSavedLines = numOfLines;
+    isFailed = false;
+    for (i = 0; isPassed && i < numOfRandomEdits; ++i) {
+        int isPreviousFailed = isFailed;
+
+        applyRandomEdit(&seed);
+        isPassed = checkSource(&incremental, source, "a random edit", &isFailed);
+        numOfFailed += isFailed;
+        if (!isFailed) {
+            memcpy(savedLines, lines, (size_t) numOfLines * MAX_LINE_LENGTH);
+            numOfSavedLines = numOfLines;
+        } else if (isPreviousFailed || nextRandom(&seed) % 4 != 0) {
+            memcpy(lines, savedLines, (size_t) numOfSavedLines * MAX_LINE_LENGTH);
+            numOfLines = numOfSavedLines;
+            isFailed = false;
+        }
+    }
+    freeIncrementalAssembly(&incremental);
+
+    if (!isPassed) {
+        FILE *file = fopen("test-reassemble.as", "w");
+
+        if (file != NULL) {
+            fwrite(source, 1, (size_t) joinLines(source), file);
+            fclose(file);
+            printf("test-reassemble: the source is kept in test-reassemble.as.\n");
+        }
+        return EXIT_FAILURE;
+    }
+    printf("test-reassemble: %d edits (%d of them with errors) are assembled incrementally like whole.\n",
+           (int) (sizeof(scriptedEdits) / sizeof(scriptedEdits[0])) + numOfRandomEdits, numOfFailed);
+    return EXIT_SUCCESS;
+}
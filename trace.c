@@ -0,0 +1,164 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "data.h"
+#include "trace.h"
+
+/* Phases of the trace events */
+#define TRACE_SPAN 'X'
+#define TRACE_COUNTER 'C'
+
+/* The largest number of threads which get a thread ID of their own, other threads share the last one */
+#define TRACE_MAX_THREADS 256
+
+/* A span or a sample of a counter */
+typedef struct TraceEvent {
+    char name[MAX_LINE_LENGTH + 1];   /* The name of the span/counter. */
+    const char *category;             /* The category of a span. */
+    char phase;                       /* TRACE_SPAN or TRACE_COUNTER. */
+    int thread;                       /* The thread ID of the thread which has recorded the event. */
+    double start;                     /* The time the span starts at/the time of the sample, in microseconds. */
+    double duration;                  /* The duration of a span, in microseconds. */
+    long value;                       /* The value of the counter. */
+} TraceEvent;
+
+static pthread_mutex_t traceMutex = PTHREAD_MUTEX_INITIALIZER;
+static int traceFlag = 0;
+static double traceOrigin;
+static TraceEvent *events;
+static int numOfEvents;
+static int eventsCapacity;
+static pthread_t threads[TRACE_MAX_THREADS];
+static int numOfThreads;
+
+/* Get the time of a monotonic clock, in microseconds */
+static double getTraceTime() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1e6 + (double) now.tv_nsec / 1e3;
+}
+
+/* Get the thread ID of the calling thread, the threads are numbered in the order they've recorded their first event */
+static int getTraceThread() {
+    pthread_t self = pthread_self();
+    int i = 0;
+
+    for (; i < numOfThreads; ++i)
+        if (pthread_equal(threads[i], self))
+            return i + 1;
+    if (numOfThreads == TRACE_MAX_THREADS)
+        return TRACE_MAX_THREADS;
+    threads[numOfThreads++] = self;
+    return numOfThreads;
+}
+
+/* Add an event to the timeline, the events which don't fit in memory are dropped */
+static void addTraceEvent(char phase, const char *category, const char *name, double start, double duration,
+                          long value) {
+    TraceEvent *event;
+
+    pthread_mutex_lock(&traceMutex);
+    if (numOfEvents == eventsCapacity) {
+        int newCapacity = eventsCapacity == 0 ? 1024 : eventsCapacity * 2;
+        TraceEvent *newEvents = (TraceEvent *) reallocateMemory(MEMORY_TRACE, events,
+                                                                newCapacity * sizeof(TraceEvent));
+        if (newEvents == NULL) {
+            pthread_mutex_unlock(&traceMutex);
+            return;
+        }
+        events = newEvents;
+        eventsCapacity = newCapacity;
+    }
+
+    event = &events[numOfEvents++];
+    strncpy(event->name, name, MAX_LINE_LENGTH);
+    event->name[MAX_LINE_LENGTH] = '\0';
+    event->category = category;
+    event->phase = phase;
+    event->thread = getTraceThread();
+    event->start = start;
+    event->duration = duration;
+    event->value = value;
+    pthread_mutex_unlock(&traceMutex);
+}
+
+int enableTracing() {
+    pthread_mutex_lock(&traceMutex);
+    traceOrigin = getTraceTime();
+    traceFlag = 1;
+    pthread_mutex_unlock(&traceMutex);
+    return true;
+}
+
+int isTracing() {
+    return traceFlag;
+}
+
+double traceBegin() {
+    return traceFlag ? getTraceTime() - traceOrigin : 0;
+}
+
+void traceEnd(const char *category, const char *name, double start) {
+    if (traceFlag)
+        addTraceEvent(TRACE_SPAN, category, name, start, getTraceTime() - traceOrigin - start, 0);
+}
+
+void traceCounter(const char *name, long value) {
+    if (traceFlag)
+        addTraceEvent(TRACE_COUNTER, NULL, name, getTraceTime() - traceOrigin, 0, value);
+}
+
+/* Write a string as a JSON string */
+static void writeJsonString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (; *text != '\0'; ++text) {
+        if (*text == '"' || *text == '\\')
+            fprintf(file, "\\%c", *text);
+        else if ((unsigned char) *text < 0x20)
+            fprintf(file, "\\u%04x", (unsigned char) *text);
+        else
+            fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+int writeTrace(FILE *file) {
+    int i = 0;
+
+    pthread_mutex_lock(&traceMutex);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    /* Name the threads by their thread IDs */
+    for (; i < numOfThreads; ++i)
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n",
+                i + 1, i + 1);
+    for (i = 0; i < numOfEvents; ++i) {
+        const TraceEvent *event = &events[i];
+
+        fprintf(file, "{\"name\":");
+        writeJsonString(file, event->name);
+        if (event->phase == TRACE_SPAN)
+            fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                    event->category, event->start, event->duration, event->thread);
+        else
+            fprintf(file, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%ld}}",
+                    event->start, event->thread, event->value);
+        fprintf(file, i + 1 < numOfEvents ? ",\n" : "\n");
+    }
+    fprintf(file, "]}\n");
+    pthread_mutex_unlock(&traceMutex);
+    return !ferror(file);
+}
+
+void freeTrace() {
+    pthread_mutex_lock(&traceMutex);
+    traceFlag = 0;
+    freeMemory(events);
+    events = NULL;
+    numOfEvents = 0;
+    eventsCapacity = 0;
+    numOfThreads = 0;
+    pthread_mutex_unlock(&traceMutex);
+}
@@ -0,0 +1,73 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * @file trace.h
+ * @brief Functions to record a timeline of the assembler in the Chrome trace event format (the --trace option).
+ *
+ * Once the tracing is enabled, every span (a file, a phase of a file) and every counter sample is recorded in
+ * memory with the thread it has been recorded by, and the whole timeline is written at the end as a JSON file
+ * which can be opened by chrome://tracing or Perfetto. Recording is synchronized, so spans can be recorded from
+ * several threads at once. While the tracing isn't enabled, recording costs a single check of a flag.
+ */
+
+#include <stdio.h>
+
+/**
+ * The categories of the spans.
+ */
+#define TRACE_CATEGORY_FILE "file"
+#define TRACE_CATEGORY_PHASE "phase"
+
+/**
+ * @brief Starts recording spans and counters.
+ *
+ * @return True if the tracing has been enabled, false if the recorder couldn't be initialized.
+ */
+int enableTracing();
+
+/**
+ * @brief Checks if the tracing is enabled.
+ *
+ * @return True if spans and counters are recorded, false otherwise.
+ */
+int isTracing();
+
+/**
+ * @brief Gets the time a span starts at.
+ *
+ * @return The time, in microseconds since the tracing has been enabled (0 if it isn't enabled).
+ */
+double traceBegin();
+
+/**
+ * @brief Records a span which has started at a time returned by traceBegin and ends now.
+ *
+ * @param category The category of the span (TRACE_CATEGORY_*).
+ * @param name The name of the span (truncated to MAX_LINE_LENGTH).
+ * @param start The time the span has started at.
+ */
+void traceEnd(const char *category, const char *name, double start);
+
+/**
+ * @brief Records a sample of a counter.
+ *
+ * @param name The name of the counter.
+ * @param value The value of the counter.
+ */
+void traceCounter(const char *name, long value);
+
+/**
+ * @brief Writes the recorded timeline as a JSON trace.
+ *
+ * @param file The file to write into.
+ * @return True if the trace has been written, false otherwise.
+ */
+int writeTrace(FILE *file);
+
+/**
+ * @brief Stops the tracing and frees the recorded timeline.
+ */
+void freeTrace();
+
+#endif
@@ -1,392 +1,362 @@
-#include <stdio.h>
-#include <string.h>
-#include <ctype.h>
-#include "data.h"
-#include "symbols.h"
-#include "utilities.h"
-#include "analyze.h"
-
-int isCharacter(char c) {
-    /* Check if the character is an uppercase letter (A-Z) or a lowercase letter (a-z) */
-    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
-}
-
-int isLabelDeclaration(const char *fileName, char *line) {
-    if(line == NULL)
-        return false;
-
-    char copiedLine [MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
-    strcpy(copiedLine, line); /* Make a copy of the original line */
-
-    char* token = strtok(line, " \t");
-    if(strlen(token) > MAX_LABEL_LENGTH)
-        reportError(fileName, 9, copiedLine);
-    return isCharacter(token[0]) && token[strlen(token) - 1] == ':';
-}
-
-int isDirectiveDeclaration(char *directive) {
-    return directive[0] == '.';
-}
-
-int isNumeric(char* operand) {
-    if (operand == NULL) {
-        return false; /* Operand is NULL, not a numeric value */
-    }
-
-    int i = 0;
-    if (operand[0] == '-' || operand[0] == '+') {
-        i = 1; /* Skip the sign character */
-    }
-    for (; operand[i] != '\0'; i++) {
-        if (!isdigit(operand[i])) {
-            return false; /* Operand is not a numeric value */
-        }
-    }
-    return true; /* Operand is numeric */
-}
-
-int getRegister(const char* operand) {
-    if (operand == NULL || strlen(operand) < 3)
-        return -1;
-
-    if (strncmp(operand, "@r", 2) == 0) {
-        operand += 2;
-
-        switch (*operand) {
-            case '0':
-                return 0;
-            case '1':
-                return 1;
-            case '2':
-                return 2;
-            case '3':
-                return 3;
-            case '4':
-                return 4;
-            case '5':
-                return 5;
-            case '6':
-                return 6;
-            case '7':
-                return 7;
-            default:
-                printf("r%c is an invalid register.\n", *operand);
-                return -1;
-        }
-    }
-    return -1;
-}
-
-int getAddressingMethod(char* operand) {
-    if (operand == NULL)
-        return -1;
-
-    if (isNumeric(operand))
-        return METHOD_IMMEDIATE; /* Immediate addressing - operand is an integer */
-    else if (getRegister(operand) != -1)
-        return METHOD_DIRECT_REGISTER; /* Direct register addressing - operand is the name of a register */
-    return METHOD_DIRECT;
-}
-
-void initializeMemory() {
-    freeSymbolTable(); /* Free memory allocated for the symbol table */
-    freeExternSymbolTable(); /* Free memory allocated for the extern symbol table */
-
-    /* Initialize global variables to their initial value */
-    address = 100;
-    lineNum = 0;
-    directFlag = 0;
-    endFirstPassFlag = 0;
-    errorFlag = 0;
-}
-
-void reportError(const char *fileName, int errorCode, const char *errorMessage) {
-    errorFlag = 1;
-
-    /* Skipping second pass errors to avoid duplicate errors. */
-    if(endFirstPassFlag)
-        return;
-
-    printf("ERROR has been occurred in %s file at line <%d>: %s --->>> ",fileName, lineNum, errorMessage);
-
-    switch (errorCode) {
-        case 1:
-            printf("*Too Many Operands For Such Instruction*\n");
-            break;
-        case 2:
-            printf("*Missing Operands*\n");
-            break;
-        case 3:
-            printf("*Invalid Operand(s) For Such Instruction*\n");
-            break;
-        case 4:
-            printf("*No Source File Provided*\n");
-            break;
-        case 5:
-            printf("*File Couldn't Be Found/Opened*\n");
-            break;
-        case 6:
-            printf("*No Such Register Exist*\n");
-            break;
-        case 7:
-            printf("*No Such Instruction Exist*\n");
-            break;
-        case 8:
-            printf("*Invalid Directive*\n");
-            break;
-        case 9:
-            printf("*Overflow Label Declaration Exception*\n");
-            break;
-        case 10:
-            printf("*Symbol Is Already Defined As Extern*\n");
-            break;
-        case 11:
-            printf("*Symbol Is Already Defined As Entry*\n");
-            break;
-        case 12:
-            printf("*Memory Allocation Has Been Failed*\n");
-            break;
-        case 13:
-            printf("*Macro Cannot Be Defined As A Reserved KeyWord*\n");
-            break;
-        case 14:
-            printf("*Too Many Operands For Macro Declaration*\n");
-            break;
-        case 15:
-            printf("*Overflow Line Exception*\n");
-            break;
-        case 16:
-            printf("*Memory Access Violation*\n");
-            break;
-        case 17:
-            printf("*Missing Opening Double Quotes*\n");
-            break;
-        case 18:
-            printf("*Missing Closing Double Quotes*\n");
-            break;
-        case 19:
-            printf("*Symbol Is Already Defined*\n");
-            break;
-        case 20:
-            printf("*Invalid Comma At The Beginning Of The Data Directive*\n");
-            break;
-        case 21:
-            printf("*Invalid Comma At The End Of The Data Directive*\n");
-            break;
-        case 22:
-            printf("*Invalid Consecutive Commas At The Data Directive*\n");
-            break;
-        case 23:
-            printf("*Too Many Operands For Ending Macro Declaration*\n");
-            break;
-        default:
-            printf("*Unknown Error*\n");
-    }
-    printf("\n");
-}
-
-int checkNumOfOperands(const char* operand1, const char* operand2, const char* operand3) {
-    int cnt = 0;
-
-    if(operand1 != NULL)
-        cnt++;
-    if(operand2 != NULL)
-        cnt++;
-    if(operand3 != NULL)
-        cnt++;
-
-    return cnt;
-}
-
-int isValidAddress() {
-    return address < MAX_CODE_WORD_TABLE_SIZE + INITIAL_ADDRESS_VALUE;
-}
-
-void tokenizeArguments(char *line, char **directive, char **arguments) {
-    if (directFlag == 0) {
-        (*directive) = line;
-        (*arguments) = strtok(NULL, " ,\t\n");
-    } else {
-        (*arguments) = strtok(line, " ,\t\n");
-        (*directive) = (*arguments);
-        (*arguments) = strtok(NULL, " ,\t\n");
-    }
-}
-
-void checkCommas(const char *fileName, char *line) {
-    if(line != NULL) {
-        if(!directFlag) {
-            char* copyLine = line;
-            while (strncmp(copyLine, ".data", 5) != 0)
-                copyLine++;
-            if(copyLine[6] == ',')
-                reportError(fileName, 20, line);
-            else if (copyLine[strlen(copyLine) - 1] == ',')
-                reportError(fileName, 21, line);
-            else if (strstr(copyLine, ",,"))
-                reportError(fileName, 22, line);
-        } else {
-            if (line[10] == ',')
-                reportError(fileName, 20, line);
-            else if (line[strlen(line) - 1] == ',')
-                reportError(fileName, 21, line);
-            else if (strstr(line, ",,"))
-                reportError(fileName, 22, line);
-        }
-    }
-}
-
-void processDataDirective(const char *fileName, const char *copiedLine, char *arguments) {
-    while (arguments != NULL && isNumeric(arguments)) {
-        unsigned int binaryCode = decimalToBinary12Bit(strtol(arguments,
-                                                              NULL, 10));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        address++;
-        arguments = strtok(NULL, " ,\t");
-    }
-}
-
-void processStringDirective(const char *fileName, const char *copiedLine, char *arguments) {
-    /* Check for valid string enclosed with double quotes */
-    /* Missing opening double quotes */
-    if (*arguments != '\"') {
-        reportError(fileName, 17, copiedLine);
-        return;
-    }
-    /* Missing closing double quotes */
-    if (arguments[strlen(arguments) - 1] != '\"') {
-        reportError(fileName, 18, copiedLine);
-        return;
-    }
-
-    arguments++; /* Skip first " quotation occurrence */
-    unsigned int binaryCode;
-    while (arguments != NULL && *arguments != '\0' && *arguments != '\"') {
-        /* Skipping non alphabetic characters */
-        if (!isCharacter(*arguments)) {
-            arguments++;
-            continue;
-        }
-
-        /* Current character is alphabetic */
-        binaryCode = asciiToBinary12Bit(*arguments);
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        address++;
-        arguments++;
-    }
-
-    /* Including the '\0' of the string */
-    binaryCode = asciiToBinary12Bit('\0');
-    addToCodeWordTable(fileName, copiedLine, binaryCode);
-    address++;
-}
-
-void processEntryDirective(const char *fileName, const char *copiedLine, char *arguments) {
-    /* Setting entry symbol into the symbol table */
-    do {
-        /* Remove carriage return character from the symbol name */
-        arguments[strcspn(arguments, "\r\n")] = '\0';
-
-        /* Process entry directive according to it's existence in the symbol table */
-        char *symbolName = arguments;
-        if (!isSymbolExist(symbolName)) /* Symbol isn't exist yet in the symbol table */
-            addToSymbolTable(fileName, symbolName, 0, 1, 0);
-        else {
-            /* Mark the symbol as an entry point in the symbol table if not marked as extern yet*/
-            if (!isExtern(symbolName))
-                setEntrySymbol(symbolName);
-            else /* Report error for attempting to mark a symbol both as an entry point and as an extern point */
-                reportError(fileName, 10, copiedLine);
-        }
-        /* Tokenizing the rest of the symbols if there are any left */
-        arguments = strtok(NULL, " ,\t");
-    } while (arguments != NULL);
-}
-
-void processExternDirective(const char *fileName, const char *copiedLine, char *arguments) {
-    do {
-        /* Process external directive */
-        char *symbolName = arguments;
-
-        /* Add the symbol to the symbol table with a temporary value if symbol isn't exist yet */
-        if (!isSymbolExist(symbolName))
-            addToSymbolTable(fileName, symbolName, 0, 0, 1);
-        else {
-            /* Mark the symbol as an extern point in the symbol table  if not marked at entry point */
-            if (!isEntry(symbolName))
-                setExternSymbol(symbolName);
-            else /* Report error for attempting to mark a symbol both as an entry point and as an extern point */
-                reportError(fileName, 11, copiedLine);
-        }
-        arguments = strtok(NULL, " ,\t"); /* Tokenizing the rest of the symbols if there are any left */
-    } while (arguments != NULL);
-}
-
-void processInstructionWith0Operands(const char *fileName, const char *copiedLine, const char *opCode) {
-    unsigned int binaryCode = generateBinaryCode(0, getInstructionCode(opCode), 0);
-    addToCodeWordTable(fileName, copiedLine, binaryCode);
-    address++;
-}
-
-void processInstructionWith1Operands(const char *fileName, const char *copiedLine, const char *opCode, const char *operand1, int addressingMethod1) {
-    unsigned int binaryCode;
-    if (addressingMethod1 == METHOD_IMMEDIATE) {
-        binaryCode = generateBinaryCode(addressingMethod1, getInstructionCode(opCode), 0);
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        address++;
-        binaryCode = decimalToBinary12Bit(strtol(operand1, NULL, 10));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-    } else if (addressingMethod1 == METHOD_DIRECT) {
-        binaryCode = generateBinaryCode(addressingMethod1, getInstructionCode(opCode), 0);
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        address++;
-        binaryCode = convertTo12BitBinary(getSymbolValue(operand1), getSymbolType(operand1));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        /* Add operand to extern symbol table while the second pass is being processed */
-        if (isExtern(operand1) && endFirstPassFlag == 1)
-            addToExternSymbolTable(fileName, operand1, address);
-    } else if (addressingMethod1 == METHOD_DIRECT_REGISTER) {
-        binaryCode = registersToBinary(0, getRegister(operand1));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-    }
-    address++;
-}
-
-void processInstructionWith2Operands(const char *fileName, const char *copiedLine, const char *opCode, const char *operand1, int addressingMethod1, int addressingMethod2, const char *operand2) {
-    unsigned int binaryCode;
-
-    binaryCode = generateBinaryCode(addressingMethod2, getInstructionCode(opCode), addressingMethod1);
-    addToCodeWordTable(fileName, copiedLine, binaryCode);
-    address++;
-
-    if (addressingMethod1 == METHOD_DIRECT_REGISTER && addressingMethod2 == METHOD_DIRECT_REGISTER) {
-        if (getRegister(operand1) != -1 && getRegister(operand2) != -1) {
-            binaryCode = registersToBinary(getRegister(operand2), getRegister(operand1));
-            addToCodeWordTable(fileName, copiedLine, binaryCode);
-            address++;
-        } else if (getRegister(operand1) == -1)
-            reportError(fileName, 6, copiedLine);
-        else
-            reportError(fileName, 6, copiedLine);
-    } else if (addressingMethod1 == METHOD_DIRECT_REGISTER && addressingMethod2 == METHOD_DIRECT) {
-        binaryCode = registersToBinary(0, getRegister(operand1));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        address++;
-        binaryCode = convertTo12BitBinary(getSymbolValue(operand2), getSymbolType(operand2));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        /* Add operand to extern symbol table while the second pass is being processed */
-        if (isExtern(operand2) && endFirstPassFlag == 1)
-            addToExternSymbolTable(fileName, operand2, address);
-        address++;
-    } else if (addressingMethod1 == METHOD_DIRECT && addressingMethod2 == METHOD_IMMEDIATE) {
-        binaryCode = generateBinaryCode(addressingMethod2, getInstructionCode(opCode), addressingMethod1);
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        /* Add operand to extern symbol table while the second pass is being processed */
-        if (isExtern(operand1) && endFirstPassFlag == 1)
-            addToExternSymbolTable(fileName, operand1, address);
-        address++;
-        binaryCode = convertTo12BitBinary(getSymbolValue(operand2), getSymbolType(operand2));
-        addToCodeWordTable(fileName, copiedLine, binaryCode);
-        address++;
-    }
-}
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "data.h"
+#include "symbols.h"
+#include "utilities.h"
+#include "analyze.h"
+
+int isCharacter(char c) {
+    /* Check if the character is an uppercase letter (A-Z) or a lowercase letter (a-z) */
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+int isLabelDeclaration(AssemblerContext *context, char *line) {
+    if(line == NULL)
+        return false;
+
+    char copiedLine [MAX_LINE_LENGTH]; /* Create an array to hold the copy of the line */
+    strcpy(copiedLine, line); /* Make a copy of the original line */
+
+    char* token = nextToken(context, line, " \t");
+    if(strlen(token) > MAX_LABEL_LENGTH)
+        reportError(context, 9, copiedLine);
+    return isCharacter(token[0]) && token[strlen(token) - 1] == ':';
+}
+
+int isDirectiveDeclaration(char *directive) {
+    return directive[0] == '.';
+}
+
+int isNumeric(char* operand) {
+    if (operand == NULL) {
+        return false; /* Operand is NULL, not a numeric value */
+    }
+
+    int i = 0;
+    if (operand[0] == '-' || operand[0] == '+') {
+        i = 1; /* Skip the sign character */
+    }
+    for (; operand[i] != '\0'; i++) {
+        if (!isdigit(operand[i])) {
+            return false; /* Operand is not a numeric value */
+        }
+    }
+    return true; /* Operand is numeric */
+}
+
+int getRegister(AssemblerContext *context, const char* operand) {
+    if (operand == NULL || strlen(operand) < 3)
+        return -1;
+
+    if (strncmp(operand, "@r", 2) == 0) {
+        int number = 0;
+        int length = 0;
+        operand += 2;
+
+        /* The number of the register, a single digit unless the machine has more than 10 registers (see isa.h) */
+        while (length < (ISA_NUM_OF_REGISTERS > 10 ? 2 : 1) && isdigit((unsigned char) operand[length]))
+            number = number * 10 + (operand[length++] - '0');
+        if (length > 0 && number < ISA_NUM_OF_REGISTERS)
+            return number;
+
+        {
+            char note[MAX_LINE_LENGTH];
+            sprintf(note, "r%.*s is an invalid register.", length > 0 ? length : 1, operand);
+            addDiagnostic(context, DIAGNOSTIC_NOTE, note);
+            return -1;
+        }
+    }
+    return -1;
+}
+
+int getAddressingMethod(AssemblerContext *context, char* operand) {
+    if (operand == NULL)
+        return -1;
+
+    if (isNumeric(operand))
+        return METHOD_IMMEDIATE; /* Immediate addressing - operand is an integer */
+    else if (getRegister(context, operand) != -1)
+        return METHOD_DIRECT_REGISTER; /* Direct register addressing - operand is the name of a register */
+    return METHOD_DIRECT;
+}
+
+void reportError(AssemblerContext *context, int errorCode, const char *errorMessage) {
+    context->errorFlag = 1;
+
+    /* Skipping second pass errors to avoid duplicate errors. */
+    if(context->endFirstPassFlag)
+        return;
+
+    addDiagnostic(context, errorCode, errorMessage);
+}
+
+const char *getErrorMessage(int errorCode) {
+    switch (errorCode) {
+        case 1:
+            return "Too Many Operands For Such Instruction";
+        case 2:
+            return "Missing Operands";
+        case 3:
+            return "Invalid Operand(s) For Such Instruction";
+        case 4:
+            return "No Source File Provided";
+        case 5:
+            return "File Couldn't Be Found/Opened";
+        case 6:
+            return "No Such Register Exist";
+        case 7:
+            return "No Such Instruction Exist";
+        case 8:
+            return "Invalid Directive";
+        case 9:
+            return "Overflow Label Declaration Exception";
+        case 10:
+            return "Symbol Is Already Defined As Extern";
+        case 11:
+            return "Symbol Is Already Defined As Entry";
+        case 12:
+            return "Memory Allocation Has Been Failed";
+        case 13:
+            return "Macro Cannot Be Defined As A Reserved KeyWord";
+        case 14:
+            return "Too Many Operands For Macro Declaration";
+        case 15:
+            return "Overflow Line Exception";
+        case 16:
+            return "Memory Access Violation";
+        case 17:
+            return "Missing Opening Double Quotes";
+        case 18:
+            return "Missing Closing Double Quotes";
+        case 19:
+            return "Symbol Is Already Defined";
+        case 20:
+            return "Invalid Comma At The Beginning Of The Data Directive";
+        case 21:
+            return "Invalid Comma At The End Of The Data Directive";
+        case 22:
+            return "Invalid Consecutive Commas At The Data Directive";
+        case 23:
+            return "Too Many Operands For Ending Macro Declaration";
+        case 24:
+            return "Included File Couldn't Be Found/Opened";
+        case 25:
+            return "Errors Have Been Found In The Included File";
+        case 26:
+            return "Too Many Nested Includes";
+        case 27:
+            return "File Name Is Too Long";
+        default:
+            return "Unknown Error";
+    }
+}
+
+int checkNumOfOperands(const char* operand1, const char* operand2, const char* operand3) {
+    int cnt = 0;
+
+    if(operand1 != NULL)
+        cnt++;
+    if(operand2 != NULL)
+        cnt++;
+    if(operand3 != NULL)
+        cnt++;
+
+    return cnt;
+}
+
+void tokenizeArguments(AssemblerContext *context, char *line, char **directive, char **arguments) {
+    if (context->directFlag == 0) {
+        (*directive) = line;
+        (*arguments) = nextToken(context, NULL, " ,\t\n");
+    } else {
+        (*arguments) = nextToken(context, line, " ,\t\n");
+        (*directive) = (*arguments);
+        (*arguments) = nextToken(context, NULL, " ,\t\n");
+    }
+}
+
+void checkCommas(AssemblerContext *context, char *line) {
+    if(line != NULL) {
+        if(!context->directFlag) {
+            char* copyLine = line;
+            while (strncmp(copyLine, ".data", 5) != 0)
+                copyLine++;
+            /* The characters after the end of the line are never checked */
+            if(strlen(copyLine) > 6 && copyLine[6] == ',')
+                reportError(context, 20, line);
+            else if (copyLine[strlen(copyLine) - 1] == ',')
+                reportError(context, 21, line);
+            else if (strstr(copyLine, ",,"))
+                reportError(context, 22, line);
+        } else {
+            if (strlen(line) > 10 && line[10] == ',')
+                reportError(context, 20, line);
+            else if (line[strlen(line) - 1] == ',')
+                reportError(context, 21, line);
+            else if (strstr(line, ",,"))
+                reportError(context, 22, line);
+        }
+    }
+}
+
+void processDataDirective(AssemblerContext *context, const char *copiedLine, char *arguments) {
+    char list[MAX_LINE_LENGTH];
+    const char *directive = strstr(copiedLine, ".data");
+
+    if (arguments == NULL)
+        return;
+
+    /* The whole list is encoded in one pass, from the text of the line after the directive */
+    strcpy(list, directive != NULL ? directive + 5 : arguments);
+    list[strcspn(list, "\r\n")] = '\0';
+    context->dataCounter += encodeDataList(&context->dataImage, context->dataCounter, list);
+}
+
+void processStringDirective(AssemblerContext *context, const char *copiedLine, char *arguments) {
+    /* Check for valid string enclosed with double quotes */
+    /* Missing opening double quotes */
+    if (*arguments != '\"') {
+        reportError(context, 17, copiedLine);
+        return;
+    }
+    /* Missing closing double quotes */
+    if (arguments[strlen(arguments) - 1] != '\"') {
+        reportError(context, 18, copiedLine);
+        return;
+    }
+
+    arguments++; /* Skip first " quotation occurrence */
+    encodeString(context, copiedLine, arguments);
+}
+
+void encodeString(AssemblerContext *context, const char *copiedLine, const char *characters) {
+    while (*characters != '\0' && *characters != '\"') {
+        /* Skipping non alphabetic characters */
+        if (!isCharacter(*characters)) {
+            characters++;
+            continue;
+        }
+
+        /* Encode the whole run of alphabetic characters at once */
+        int length = 0;
+        while (isCharacter(characters[length]))
+            length++;
+        context->dataCounter += encodeCharacters(&context->dataImage, context->dataCounter, characters, length);
+        characters += length;
+    }
+
+    /* Including the '\0' of the string */
+    addToDataWordTable(context, copiedLine, asciiToBinary12Bit('\0'));
+    context->dataCounter++;
+}
+
+void processEntryDirective(AssemblerContext *context, const char *copiedLine, char *arguments) {
+    /* Setting entry symbol into the symbol table */
+    do {
+        /* Remove carriage return character from the symbol name */
+        arguments[strcspn(arguments, "\r\n")] = '\0';
+
+        /* Process entry directive according to it's existence in the symbol table */
+        char *symbolName = arguments;
+        if (!isSymbolExist(context, symbolName)) /* Symbol isn't exist yet in the symbol table */
+            addToSymbolTable(context, symbolName, 0, 1, 0);
+        else {
+            /* Mark the symbol as an entry point in the symbol table if not marked as extern yet*/
+            if (!isExtern(context, symbolName))
+                setEntrySymbol(context, symbolName);
+            else /* Report error for attempting to mark a symbol both as an entry point and as an extern point */
+                reportError(context, 10, copiedLine);
+        }
+        /* Tokenizing the rest of the symbols if there are any left */
+        arguments = nextToken(context, NULL, " ,\t");
+    } while (arguments != NULL);
+}
+
+void processExternDirective(AssemblerContext *context, const char *copiedLine, char *arguments) {
+    do {
+        /* Process external directive */
+        char *symbolName = arguments;
+
+        /* Add the symbol to the symbol table with a temporary value if symbol isn't exist yet */
+        if (!isSymbolExist(context, symbolName))
+            addToSymbolTable(context, symbolName, 0, 0, 1);
+        else {
+            /* Mark the symbol as an extern point in the symbol table  if not marked at entry point */
+            if (!isEntry(context, symbolName))
+                setExternSymbol(context, symbolName);
+            else /* Report error for attempting to mark a symbol both as an entry point and as an extern point */
+                reportError(context, 11, copiedLine);
+        }
+        arguments = nextToken(context, NULL, " ,\t"); /* Tokenizing the rest of the symbols if there are any left */
+    } while (arguments != NULL);
+}
+
+void processInstructionWith0Operands(AssemblerContext *context, const char *copiedLine, const char *opCode) {
+    unsigned int binaryCode = generateBinaryCode(0, getInstructionCode(opCode), 0);
+    addToCodeWordTable(context, copiedLine, binaryCode);
+    context->address++;
+}
+
+void processOperandWord(AssemblerContext *context, const char *copiedLine, const char *operand, int addressingMethod, int isSource) {
+    unsigned int binaryCode;
+
+    if (addressingMethod == METHOD_IMMEDIATE)
+        binaryCode = decimalToBinary12Bit(strtol(operand, NULL, 10));
+    else if (addressingMethod == METHOD_DIRECT) {
+        int value = getSymbolValue(context, operand);
+        int type = getSymbolType(context, operand);
+
+        binaryCode = convertTo12BitBinary(value, type);
+        /* A symbol whose address doesn't fit in the operand would be wrapped. It's known by the second pass only,
+          whose errors reportError skips */
+        if (context->endFirstPassFlag == 1 && type != -1 && !isOperandAddress(value)) {
+            context->errorFlag = 1;
+            addDiagnostic(context, 16, copiedLine);
+        }
+        /* Add operand to extern symbol table while the second pass is being processed */
+        if (isExtern(context, operand) && context->endFirstPassFlag == 1)
+            addToExternSymbolTable(context, operand, context->address);
+        /* Record the address of the word in the relocation table while the second pass is being processed */
+        if (context->endFirstPassFlag == 1 &&
+            !addRelocation(&context->relocationTable, context->address, isExtern(context, operand) ? RELOCATION_EXTERNAL : RELOCATION_RELOCATABLE))
+            reportError(context, 12, copiedLine);
+    } else if (isSource) /* Source register takes bits 7-11 */
+        binaryCode = registersToBinary(0, getRegister(context, operand));
+    else /* Destination register takes bits 2-6 */
+        binaryCode = registersToBinary(getRegister(context, operand), 0);
+
+    addToCodeWordTable(context, copiedLine, binaryCode);
+    context->address++;
+}
+
+void processInstructionWith1Operands(AssemblerContext *context, const char *copiedLine, const char *opCode, const char *operand1, int addressingMethod1) {
+    /* First word: the opcode and the addressing method of the (destination) operand */
+    unsigned int binaryCode = generateBinaryCode(addressingMethod1, getInstructionCode(opCode), 0);
+    addToCodeWordTable(context, copiedLine, binaryCode);
+    context->address++;
+
+    processOperandWord(context, copiedLine, operand1, addressingMethod1, false);
+}
+
+void processInstructionWith2Operands(AssemblerContext *context, const char *copiedLine, const char *opCode, const char *operand1, int addressingMethod1, int addressingMethod2, const char *operand2) {
+    unsigned int binaryCode;
+
+    binaryCode = generateBinaryCode(addressingMethod2, getInstructionCode(opCode), addressingMethod1);
+    addToCodeWordTable(context, copiedLine, binaryCode);
+    context->address++;
+
+    /* Two registers share a single word */
+    if (addressingMethod1 == METHOD_DIRECT_REGISTER && addressingMethod2 == METHOD_DIRECT_REGISTER) {
+        if (getRegister(context, operand1) != -1 && getRegister(context, operand2) != -1) {
+            binaryCode = registersToBinary(getRegister(context, operand2), getRegister(context, operand1));
+            addToCodeWordTable(context, copiedLine, binaryCode);
+            context->address++;
+        } else
+            reportError(context, 6, copiedLine);
+    } else {
+        /* A word for the source operand, then a word for the destination operand */
+        processOperandWord(context, copiedLine, operand1, addressingMethod1, true);
+        processOperandWord(context, copiedLine, operand2, addressingMethod2, false);
+    }
+}
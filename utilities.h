@@ -1,192 +1,219 @@
-#ifndef UTILITIES_H
-#define UTILITIES_H
-
-/**
- * @file utilities.h
- * @brief Functions to facilitate processing the source file.
- */
-
-/**
- * @brief Check if a character is an alphabetic character (A-Z or a-z).
- *
- * @param c The character to check.
- * @return True if the character is alphabetic, false otherwise.
- */
-int isCharacter(char c);
-
-/**
- * @brief Check if a line is a label declaration.
- *
- * This function checks if a line in the assembly code is a label declaration.
- *
- * @param fileName The name of the file being processed.
- * @param line The line to check.
- * @return True if the line is a label declaration, false otherwise.
- */
-int isLabelDeclaration(const char *fileName, char *line);
-
-/**
- * Checks if a given string is a directive declaration.
- *
- * @param directive The string to be checked.
- * @return True if the string is a directive declaration (starts with a dot - '.'), otherwise false.
- */
-int isDirectiveDeclaration(char *directive);
-
-/**
- * @brief Check if a string represents a numeric value (integer).
- *
- * @param operand The string to check.
- * @return True if the string represents a numeric value, false otherwise.
- */
-int isNumeric(char *operand);
-
-/**
- * @brief Gets the register number corresponding to the given operand.
- *
- * @param operand The operand to check for the register.
- * @return The register number (0 to 7) if the operand is a valid register, or -1 if the operand is invalid.
- */
-int getRegister(const char *operand);
-
-/**
- * @brief Get the addressing method of an operand.
- *
- * This function determines the addressing method of an operand based on its syntax.
- * It can return METHOD_IMMEDIATE, METHOD_DIRECT_REGISTER, or METHOD_DIRECT.
- *
- * @param operand The operand to determine the addressing method for.
- * @return The addressing method of the operand.
- */
-int getAddressingMethod(char *operand);
-
-/**
- * @brief Initializes the memory used for the assembler, resetting relevant variables and freeing allocated memory.
- */
-void initializeMemory();
-
-/**
- * @brief Reports an error encountered during the assembly process.
- *
- * This function prints a certain error which encountered during process a line. Also, this function raises the
- * errorFlag to notify that at least one error has been found in the source file.
- *
- * @param fileName The name of the file being processed.
- * @param errorCode The error code representing the specific type of error.
- * @param errorMessage The error message representing the specific line the error has been occurred at.
- */
-void reportError(const char *fileName, int errorCode, const char *errorMessage);
-
-/**
- * @brief Counts the number of non-null operands among the given operands.
- *
- * This function counts the number of non-null operands among the provided
- * operand pointers. It checks each operand pointer and increments the count
- * for each non-null operand. The function returns the total count of
- * non-null operands.
- *
- * @param operand1 Pointer to the first operand.
- * @param operand2 Pointer to the second operand.
- * @param operand3 Pointer to the third operand.
- * @return The number of non-null operands among the given operands.
- */
-int checkNumOfOperands(const char *operand1, const char *operand2, const char *operand3);
-
-/**
- * Checks if the current address is a valid address within the code word table.
- *
- * @return True if the current address is valid, false otherwise.
- */
-int isValidAddress();
-
-/**
- * Tokenizes the arguments in the given line and returns the directive and arguments separately.
- * The directFlag determines the tokenization order.
- *
- * @param line The input line to be tokenized.
- * @param directive Pointer to a char pointer to store the directive.
- * @param arguments Pointer to a char pointer to store the arguments.
- */
-void tokenizeArguments(char *line, char **directive, char **arguments);
-
-/**
-  * Checks for comma-related errors in a given line.
-  *
-  * @param fileName    The name of the file being checked.
-  * @param line        The line to be checked for comma errors.
-  */
-void checkCommas(const char *fileName, char *line);
-
-/**
- * Processes the ".data" directive and adds the binary data to the code word table.
- *
- * @param fileName The name of the source file being processed.
- * @param copiedLine A copy of the original line for error reporting.
- * @param arguments The arguments of the ".data" directive to be processed.
- */
-void processDataDirective(const char *fileName, const char *copiedLine, char *arguments);
-
-/**
- * Processes the ".string" directive and adds the binary data to the code word table.
- *
- * @param fileName The name of the source file being processed.
- * @param copiedLine A copy of the original line for error reporting.
- * @param arguments The arguments of the ".string" directive to be processed.
- */
-void processStringDirective(const char *fileName, const char *copiedLine, char *arguments);
-
-/**
- * Processes the ".entry" directive and adds the entry symbol(s) to the symbol table.
- *
- * @param fileName The name of the source file being processed.
- * @param copiedLine A copy of the original line for error reporting.
- * @param arguments The arguments of the ".entry" directive to be processed.
- */
-void processEntryDirective(const char *fileName, const char *copiedLine, char *arguments);
-
-/**
- * Processes the ".extern" directive and adds the external symbol(s) to the symbol table.
- *
- * @param fileName The name of the source file being processed.
- * @param copiedLine A copy of the original line for error reporting.
- * @param arguments The arguments of the ".extern" directive to be processed.
- */
-void processExternDirective(const char *fileName, const char *copiedLine, char *arguments);
-
-/**
- * Process an instruction with zero operands.
- *
- * @param fileName The name of the source file.
- * @param copiedLine The copied line from the source file.
- * @param opCode The opcode of the instruction.
- */
-void processInstructionWith0Operands(const char *fileName, const char *copiedLine, const char *opCode);
-
-/**
- * Process an instruction with one operand.
- *
- * @param fileName The name of the source file.
- * @param copiedLine The copied line from the source file.
- * @param opCode The opcode of the instruction.
- * @param operand1 The first operand.
- * @param addressingMethod1 The addressing method for the first operand.
- */
-void processInstructionWith1Operands(const char *fileName, const char *copiedLine, const char *opCode
-        , const char *operand1, int addressingMethod1);
-
-/**
- * Process an instruction with two operands.
- *
- * @param fileName The name of the source file.
- * @param copiedLine The copied line from the source file.
- * @param opCode The opcode of the instruction.
- * @param operand1 The first operand.
- * @param addressingMethod1 The addressing method for the first operand.
- * @param addressingMethod2 The addressing method for the second operand.
- * @param operand2 The second operand.
- */
-void
-processInstructionWith2Operands(const char *fileName, const char *copiedLine, const char *opCode, const char *operand1
-        , int addressingMethod1, int addressingMethod2, const char *operand2);
-
+#ifndef UTILITIES_H
+#define UTILITIES_H
+
+/**
+ * @file utilities.h
+ * @brief Functions to facilitate processing the source file.
+ */
+
+/**
+ * @brief Check if a character is an alphabetic character (A-Z or a-z).
+ *
+ * @param c The character to check.
+ * @return True if the character is alphabetic, false otherwise.
+ */
+int isCharacter(char c);
+
+/**
+ * @brief Check if a line is a label declaration.
+ *
+ * This function checks if a line in the assembly code is a label declaration.
+ *
+ * @param context The context of the source being assembled.
+ * @param line The line to check.
+ * @return True if the line is a label declaration, false otherwise.
+ */
+int isLabelDeclaration(AssemblerContext *context, char *line);
+
+/**
+ * Checks if a given string is a directive declaration.
+ *
+ * @param directive The string to be checked.
+ * @return True if the string is a directive declaration (starts with a dot - '.'), otherwise false.
+ */
+int isDirectiveDeclaration(char *directive);
+
+/**
+ * @brief Check if a string represents a numeric value (integer).
+ *
+ * @param operand The string to check.
+ * @return True if the string represents a numeric value, false otherwise.
+ */
+int isNumeric(char *operand);
+
+/**
+ * @brief Gets the register number corresponding to the given operand.
+ *
+ * A note is recorded in the context for a register operand with an invalid number.
+ *
+ * @param context The context of the source being assembled.
+ * @param operand The operand to check for the register.
+ * @return The register number (0 to 7) if the operand is a valid register, or -1 if the operand is invalid.
+ */
+int getRegister(AssemblerContext *context, const char *operand);
+
+/**
+ * @brief Get the addressing method of an operand.
+ *
+ * This function determines the addressing method of an operand based on its syntax.
+ * It can return METHOD_IMMEDIATE, METHOD_DIRECT_REGISTER, or METHOD_DIRECT.
+ *
+ * @param context The context of the source being assembled.
+ * @param operand The operand to determine the addressing method for.
+ * @return The addressing method of the operand.
+ */
+int getAddressingMethod(AssemblerContext *context, char *operand);
+
+/**
+ * @brief Reports an error encountered during the assembly process.
+ *
+ * This function records a certain error which encountered during process a line as a diagnostic of the context
+ * (errors of the second pass are skipped, since they have been recorded by the first pass). Also, this function
+ * raises the errorFlag to notify that at least one error has been found in the source file.
+ *
+ * @param context The context of the source being assembled.
+ * @param errorCode The error code representing the specific type of error.
+ * @param errorMessage The error message representing the specific line the error has been occurred at.
+ */
+void reportError(AssemblerContext *context, int errorCode, const char *errorMessage);
+
+/**
+ * @brief Gets the message of an error code.
+ *
+ * @param errorCode The error code representing the specific type of error.
+ * @return The message of the error, or "Unknown Error" for an unknown code.
+ */
+const char *getErrorMessage(int errorCode);
+
+/**
+ * @brief Counts the number of non-null operands among the given operands.
+ *
+ * This function counts the number of non-null operands among the provided
+ * operand pointers. It checks each operand pointer and increments the count
+ * for each non-null operand. The function returns the total count of
+ * non-null operands.
+ *
+ * @param operand1 Pointer to the first operand.
+ * @param operand2 Pointer to the second operand.
+ * @param operand3 Pointer to the third operand.
+ * @return The number of non-null operands among the given operands.
+ */
+int checkNumOfOperands(const char *operand1, const char *operand2, const char *operand3);
+
+/**
+ * Tokenizes the arguments in the given line and returns the directive and arguments separately.
+ * The directFlag determines the tokenization order.
+ *
+ * @param context The context of the source being assembled.
+ * @param line The input line to be tokenized.
+ * @param directive Pointer to a char pointer to store the directive.
+ * @param arguments Pointer to a char pointer to store the arguments.
+ */
+void tokenizeArguments(AssemblerContext *context, char *line, char **directive, char **arguments);
+
+/**
+  * Checks for comma-related errors in a given line.
+  *
+ * @param context The context of the source being assembled.
+  * @param line        The line to be checked for comma errors.
+  */
+void checkCommas(AssemblerContext *context, char *line);
+
+/**
+ * Processes the ".data" directive and adds the binary data to the data image.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine A copy of the original line, the numbers are read from the text after the directive.
+ * @param arguments The arguments of the ".data" directive to be processed.
+ */
+void processDataDirective(AssemblerContext *context, const char *copiedLine, char *arguments);
+
+/**
+ * Processes the ".string" directive and adds the binary data to the data image.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine A copy of the original line for error reporting.
+ * @param arguments The arguments of the ".string" directive to be processed.
+ */
+void processStringDirective(AssemblerContext *context, const char *copiedLine, char *arguments);
+
+/**
+ * Adds the alphabetic characters of a string, followed by a '\0' word, to the data image.
+ *
+ * The string ends at it's closing double quotes or at it's end, other non alphabetic characters are skipped.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine A copy of the original line for error reporting.
+ * @param characters The characters of the string, after it's opening double quotes.
+ */
+void encodeString(AssemblerContext *context, const char *copiedLine, const char *characters);
+
+/**
+ * Processes the ".entry" directive and adds the entry symbol(s) to the symbol table.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine A copy of the original line for error reporting.
+ * @param arguments The arguments of the ".entry" directive to be processed.
+ */
+void processEntryDirective(AssemblerContext *context, const char *copiedLine, char *arguments);
+
+/**
+ * Processes the ".extern" directive and adds the external symbol(s) to the symbol table.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine A copy of the original line for error reporting.
+ * @param arguments The arguments of the ".extern" directive to be processed.
+ */
+void processExternDirective(AssemblerContext *context, const char *copiedLine, char *arguments);
+
+/**
+ * Process an instruction with zero operands.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine The copied line from the source file.
+ * @param opCode The opcode of the instruction.
+ */
+void processInstructionWith0Operands(AssemblerContext *context, const char *copiedLine, const char *opCode);
+
+/**
+ * Process an operand which takes a word of it's own, and adds the word at the current address.
+ *
+ * An immediate operand is encoded as it's 12-bit value, a direct operand as the address of the symbol with
+ * it's ARE bits, and a register operand at the source (bits 7-11)/destination (bits 2-6) register field.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine The copied line from the source file.
+ * @param operand The operand.
+ * @param addressingMethod The addressing method of the operand.
+ * @param isSource True for the source operand, false for the destination operand.
+ */
+void processOperandWord(AssemblerContext *context, const char *copiedLine, const char *operand, int addressingMethod, int isSource);
+
+/**
+ * Process an instruction with one operand.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine The copied line from the source file.
+ * @param opCode The opcode of the instruction.
+ * @param operand1 The first operand.
+ * @param addressingMethod1 The addressing method for the first operand.
+ */
+void processInstructionWith1Operands(AssemblerContext *context, const char *copiedLine, const char *opCode
+        , const char *operand1, int addressingMethod1);
+
+/**
+ * Process an instruction with two operands.
+ *
+ * @param context The context of the source being assembled.
+ * @param copiedLine The copied line from the source file.
+ * @param opCode The opcode of the instruction.
+ * @param operand1 The first operand.
+ * @param addressingMethod1 The addressing method for the first operand.
+ * @param addressingMethod2 The addressing method for the second operand.
+ * @param operand2 The second operand.
+ */
+void
+processInstructionWith2Operands(AssemblerContext *context, const char *copiedLine, const char *opCode, const char *operand1
+        , int addressingMethod1, int addressingMethod2, const char *operand2);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,167 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "data.h"
+#include "watch.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#define WATCH_INOTIFY
+#endif
+
+#ifdef WATCH_INOTIFY
+
+/* The changes a directory is watched for */
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE)
+
+/* The number of bytes of the events which are read at once */
+#define WATCH_BUFFER_SIZE 4096
+
+/* Get the number of characters of the directory of a path, up to it's last '/' */
+static size_t getPrefixLength(const char *path) {
+    const char *slash = strrchr(path, '/');
+
+    return slash == NULL ? 0 : (size_t) (slash - path + 1);
+}
+
+/* Add a changed file, unless it has been changed already */
+static void addChange(FileWatcher *watcher, const char *prefix, const char *name) {
+    int i = 0;
+
+    if (strlen(prefix) + strlen(name) >= MAX_LINE_LENGTH)
+        return;
+    for (; i < watcher->numOfChanges; ++i)
+        if (strncmp(watcher->changedPaths[i], prefix, strlen(prefix)) == 0 &&
+            strcmp(watcher->changedPaths[i] + strlen(prefix), name) == 0)
+            return;
+    if (watcher->numOfChanges == MAX_WATCHED_CHANGES) {
+        watcher->isOverflowed = true;
+        return;
+    }
+    strcat(strcpy(watcher->changedPaths[watcher->numOfChanges++], prefix), name);
+}
+
+/* Read the pending events, a file is changed by the path of every directory it's watched through */
+static int readEvents(FileWatcher *watcher) {
+    union {
+        struct inotify_event event; /* Aligns the buffer for the events */
+        char bytes[WATCH_BUFFER_SIZE];
+    } buffer;
+    long length = (long) read(watcher->descriptor, buffer.bytes, sizeof(buffer.bytes));
+    long position = 0;
+
+    if (length < 0)
+        return false;
+    while (position < length) {
+        const struct inotify_event *event = (const struct inotify_event *) (buffer.bytes + position);
+        int i = 0;
+
+        if ((event->mask & IN_Q_OVERFLOW) != 0)
+            watcher->isOverflowed = true;
+        for (; event->len > 0 && i < watcher->numOfDirectories; ++i)
+            if (watcher->directories[i].descriptor == event->wd)
+                addChange(watcher, watcher->directories[i].prefix, event->name);
+        position += (long) sizeof(struct inotify_event) + event->len;
+    }
+    return true;
+}
+
+#endif
+
+int openFileWatcher(FileWatcher *watcher) {
+    memset(watcher, 0, sizeof(FileWatcher));
+    watcher->descriptor = -1;
+#ifdef WATCH_INOTIFY
+    watcher->descriptor = inotify_init();
+#endif
+    return watcher->descriptor >= 0;
+}
+
+int watchFile(FileWatcher *watcher, const char *path) {
+#ifdef WATCH_INOTIFY
+    char prefix[MAX_LINE_LENGTH];
+    size_t prefixLength = getPrefixLength(path);
+    int descriptor;
+    int i = 0;
+
+    if (watcher->descriptor < 0 || prefixLength >= MAX_LINE_LENGTH)
+        return false;
+    memcpy(prefix, path, prefixLength); /* The length has been checked, the prefix is terminated below */
+    prefix[prefixLength] = '\0';
+
+    /* The directory is watched already */
+    for (; i < watcher->numOfDirectories; ++i)
+        if (strcmp(watcher->directories[i].prefix, prefix) == 0)
+            return true;
+
+    descriptor = inotify_add_watch(watcher->descriptor, prefixLength > 0 ? prefix : ".", WATCH_EVENTS);
+    if (descriptor < 0)
+        return false;
+    if (watcher->numOfDirectories == watcher->directoriesCapacity) {
+        int newCapacity = watcher->directoriesCapacity == 0 ? 4 : watcher->directoriesCapacity * 2;
+        WatchedDirectory *newDirectories = (WatchedDirectory *) reallocateMemory(
+                MEMORY_IO, watcher->directories, newCapacity * sizeof(WatchedDirectory));
+        if (newDirectories == NULL)
+            return false;
+        watcher->directories = newDirectories;
+        watcher->directoriesCapacity = newCapacity;
+    }
+    watcher->directories[watcher->numOfDirectories].descriptor = descriptor;
+    strcpy(watcher->directories[watcher->numOfDirectories++].prefix, prefix);
+    return true;
+#else
+    (void) watcher;
+    (void) path;
+    return false;
+#endif
+}
+
+int waitForChanges(FileWatcher *watcher, int settleMilliseconds) {
+#ifdef WATCH_INOTIFY
+    struct pollfd poller;
+    int timeout = -1; /* No change yet, wait for the first one */
+    int ready;
+
+    watcher->numOfChanges = 0;
+    watcher->isOverflowed = false;
+    poller.fd = watcher->descriptor;
+    poller.events = POLLIN;
+
+    /* Collect the changes until none has come for a while */
+    while ((ready = poll(&poller, 1, timeout)) > 0) {
+        if (!readEvents(watcher))
+            return false;
+        if (watcher->numOfChanges > 0 || watcher->isOverflowed)
+            timeout = settleMilliseconds;
+    }
+    return ready == 0;
+#else
+    (void) watcher;
+    (void) settleMilliseconds;
+    return false;
+#endif
+}
+
+int hasFileChanged(const FileWatcher *watcher, const char *path) {
+    int i = 0;
+
+    if (watcher->isOverflowed)
+        return true;
+    for (; i < watcher->numOfChanges; ++i)
+        if (strcmp(watcher->changedPaths[i], path) == 0)
+            return true;
+    return false;
+}
+
+void closeFileWatcher(FileWatcher *watcher) {
+    if (watcher->descriptor >= 0)
+        close(watcher->descriptor);
+    freeMemory(watcher->directories);
+    watcher->descriptor = -1;
+    watcher->directories = NULL;
+    watcher->numOfDirectories = 0;
+    watcher->directoriesCapacity = 0;
+}
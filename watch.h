@@ -0,0 +1,85 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+/**
+ * @file watch.h
+ * @brief Functions to wait until files are changed (the --watch option).
+ *
+ * The directories of the files are watched rather than the files themselves, so a file which is replaced by a
+ * rename (like editors save it) or deleted and created again is still watched. A file is changed once it has been
+ * closed after writing, moved into it's directory or deleted. The changes are collected until no file has been
+ * changed for a moment, so a file which is saved in a few steps is changed once. The files are watched through
+ * inotify, where it's available (Linux).
+ */
+
+/**
+ * The largest number of changed files which are told apart, more changes are reported as an overflow.
+ */
+#define MAX_WATCHED_CHANGES 64
+
+/**
+ * @struct WatchedDirectory
+ * @brief Structure to represent a directory which is watched.
+ */
+typedef struct WatchedDirectory {
+    int descriptor;                 /* The watch descriptor, directories which are the same have the same one. */
+    char prefix[MAX_LINE_LENGTH];   /* The path of the directory as the files are given, up to the last '/'. */
+} WatchedDirectory;
+
+/**
+ * @struct FileWatcher
+ * @brief Structure to represent the files which are watched and their changes.
+ */
+typedef struct FileWatcher {
+    int descriptor;                                          /* The inotify file descriptor, -1 if none. */
+    WatchedDirectory *directories;                           /* The directories which are watched. */
+    int numOfDirectories;                                    /* The number of directories. */
+    int directoriesCapacity;                                 /* The number of directories allocated. */
+    char changedPaths[MAX_WATCHED_CHANGES][MAX_LINE_LENGTH]; /* The paths of the changed files. */
+    int numOfChanges;                                        /* The number of changed files. */
+    int isOverflowed;                                        /* True if some changes couldn't being told apart. */
+} FileWatcher;
+
+/**
+ * @brief Sets up a watcher which watches no file yet.
+ *
+ * @param watcher The watcher to set up.
+ * @return True if the watcher has been set up, false if files can't be watched.
+ */
+int openFileWatcher(FileWatcher *watcher);
+
+/**
+ * @brief Watches a file (a file which doesn't exist yet is watched as well, as long as it's directory exists).
+ *
+ * @param watcher The watcher.
+ * @param path The path of the file, changes are reported by the same path.
+ * @return True if the file is watched, false otherwise.
+ */
+int watchFile(FileWatcher *watcher, const char *path);
+
+/**
+ * @brief Waits until at least one of the watched files has been changed, and collects the changes.
+ *
+ * @param watcher The watcher.
+ * @param settleMilliseconds How long no file has to be changed before the changes are returned.
+ * @return True if files have been changed, false if the wait has been interrupted by a signal or failed.
+ */
+int waitForChanges(FileWatcher *watcher, int settleMilliseconds);
+
+/**
+ * @brief Checks if a file is among the changes of the last wait.
+ *
+ * @param watcher The watcher.
+ * @param path The path of the file, as it has been watched.
+ * @return True if the file has been changed (or the changes have overflowed), false otherwise.
+ */
+int hasFileChanged(const FileWatcher *watcher, const char *path);
+
+/**
+ * @brief Stops watching the files and releases the watcher.
+ *
+ * @param watcher The watcher.
+ */
+void closeFileWatcher(FileWatcher *watcher);
+
+#endif